@@ -7,16 +7,18 @@
 #include "HAL/Timer.h"
 #include "HAL/LED.h"
 #include "HAL/Button.h"
+#include "HAL/InputTrace.h"
+#include "HAL/Latency.h"
+#include "HAL/WakeStats.h"
+#include "HAL/ScopeTiming.h"
+#include "HAL/EventTrace.h"
 
 
-// A boolean variable that is true when a high-to-low transition is sensed on JSB
-// For a global variable, the keyword static limits the scope of the variable to this function only.
+// The buttons of this device, bound by initButtons(). Each button's modified flag is true when a
+// high-to-low transition is sensed on it.
+// For a global variable, the keyword static limits the scope of the variable to this file only.
 // This means functions in other files of the project cannot access this variable
-volatile static bool JSBmodified;
-volatile static bool BB1modified;
-volatile static bool BB2modified;
-volatile static bool LB1modified;
-volatile static bool LB2modified;
+static DEVICE_LOCAL Buttons* deviceButtons;
 
 // 300 ms debouncing wait
 #define DEBOUNCE_WAIT 300
@@ -46,14 +48,19 @@ void initButton(uint_fast8_t selectedPort,
 }
 
 
-void initButtons() {
+void initButtons(Buttons* buttons_p) {
+
+    // Bind the buttons before any of their interrupts is enabled
+    deviceButtons = buttons_p;
+
     initButton(GPIO_PORT_P4, GPIO_PIN1); //JSB
 
     // enable the port 4 interrupt related to JSB
     Interrupt_enableInterrupt(INT_PORT4);
 
     // This allows us to start from a clean slate
-    JSBmodified = false;
+    buttons_p->JSB.modified = false;
+    buttons_p->JSB.debouncing = false;
 
     initButton(GPIO_PORT_P5, GPIO_PIN1); //BB1
 
@@ -61,7 +68,8 @@ void initButtons() {
     Interrupt_enableInterrupt(INT_PORT5);
 
     // This allows us to start from a clean slate
-    BB1modified = false;
+    buttons_p->BB1.modified = false;
+    buttons_p->BB1.debouncing = false;
 
     initButton(GPIO_PORT_P3, GPIO_PIN5); //BB2
 
@@ -69,7 +77,8 @@ void initButtons() {
     Interrupt_enableInterrupt(INT_PORT3);
 
     // This allows us to start from a clean slate
-    BB2modified = false;
+    buttons_p->BB2.modified = false;
+    buttons_p->BB2.debouncing = false;
 
     initButton(GPIO_PORT_P1, GPIO_PIN1); //LB1
 
@@ -77,7 +86,8 @@ void initButtons() {
     Interrupt_enableInterrupt(INT_PORT1);
 
     // This allows us to start from a clean slate
-    LB1modified = false;
+    buttons_p->LB1.modified = false;
+    buttons_p->LB1.debouncing = false;
 
     initButton(GPIO_PORT_P1, GPIO_PIN4); //LB2
 
@@ -85,7 +95,8 @@ void initButtons() {
     Interrupt_enableInterrupt(INT_PORT1);
 
     // This allows us to start from a clean slate
-    LB2modified = false;
+    buttons_p->LB2.modified = false;
+    buttons_p->LB2.debouncing = false;
 
 
 }
@@ -93,11 +104,15 @@ void initButtons() {
 
 void PORT4_IRQHandler() {
 
+    WakeStats_interrupt(WAKE_PORT4);
+    EventTrace_record(EVENT_INTERRUPT, WAKE_PORT4);
+
     // We check to see if the port4 interrupt came from JSB
     if (GPIO_getInterruptStatus(GPIO_PORT_P4,
                                 GPIO_PIN1))
     {
-        JSBmodified = true;
+        deviceButtons->JSB.modified = true;
+        InputTrace_recordButton(INPUT_TRACE_JSB);
 
         // A very critical step: If we don't clear the interrupt, the ISR will be called again and again.
         GPIO_clearInterruptFlag(GPIO_PORT_P4,
@@ -108,11 +123,16 @@ void PORT4_IRQHandler() {
 
 void PORT5_IRQHandler() {
 
+    WakeStats_interrupt(WAKE_PORT5);
+    EventTrace_record(EVENT_INTERRUPT, WAKE_PORT5);
+
     // We check to see if the port5 interrupt came from BB1
     if (GPIO_getInterruptStatus(GPIO_PORT_P5,
                                 GPIO_PIN1))
     {
-        BB1modified = true;
+        deviceButtons->BB1.modified = true;
+        InputTrace_recordButton(INPUT_TRACE_BB1);
+        Latency_markInput(LATENCY_BB1);
 
         // A very critical step: If we don't clear the interrupt, the ISR will be called again and again.
         GPIO_clearInterruptFlag(GPIO_PORT_P5,
@@ -123,11 +143,15 @@ void PORT5_IRQHandler() {
 
 void PORT3_IRQHandler() {
 
+    WakeStats_interrupt(WAKE_PORT3);
+    EventTrace_record(EVENT_INTERRUPT, WAKE_PORT3);
+
     // We check to see if the port5 interrupt came from BB2
     if (GPIO_getInterruptStatus(GPIO_PORT_P3,
                                 GPIO_PIN5))
     {
-        BB2modified = true;
+        deviceButtons->BB2.modified = true;
+        InputTrace_recordButton(INPUT_TRACE_BB2);
 
         // A very critical step: If we don't clear the interrupt, the ISR will be called again and again.
         GPIO_clearInterruptFlag(GPIO_PORT_P3,
@@ -138,11 +162,15 @@ void PORT3_IRQHandler() {
 
 void PORT1_IRQHandler() {
 
+    WakeStats_interrupt(WAKE_PORT1);
+    EventTrace_record(EVENT_INTERRUPT, WAKE_PORT1);
+
     // We check to see if the port5 interrupt came from LB1
     if (GPIO_getInterruptStatus(GPIO_PORT_P1,
                                 GPIO_PIN1))
     {
-        LB1modified = true;
+        deviceButtons->LB1.modified = true;
+        InputTrace_recordButton(INPUT_TRACE_LB1);
 
         // A very critical step: If we don't clear the interrupt, the ISR will be called again and again.
         GPIO_clearInterruptFlag(GPIO_PORT_P1,
@@ -152,7 +180,8 @@ void PORT1_IRQHandler() {
     if (GPIO_getInterruptStatus(GPIO_PORT_P1,
                                 GPIO_PIN4))
     {
-        LB2modified = true;
+        deviceButtons->LB2.modified = true;
+        InputTrace_recordButton(INPUT_TRACE_LB2);
 
         // A very critical step: If we don't clear the interrupt, the ISR will be called again and again.
         GPIO_clearInterruptFlag(GPIO_PORT_P1,
@@ -163,218 +192,59 @@ void PORT1_IRQHandler() {
 }
 
 
-bool JSBtapped()
+// The debouncing FSM of a single button. Its output is true when a tap is detected.
+static bool buttonTapped(Button* button_p)
 {
-    // This variable is true if we are in debouncing state (we are ignoring the extra transitions)
-    // This variable has to be static so that it "remembers"
-    static bool debouncing = false;
-
-    // The SW timer used for debouncing. It has to be static, otherwise it won't work.
-    static SWTimer debounceTimer;
-
     // the single output of the FMS
     bool tapped = false;
 
     // If we are in debouncing state and the debouncing timer is expired, in other words,
     // if wait time is over, we should leave the debouncing state.
-    if (debouncing && SWTimer_expired(&debounceTimer))
-        debouncing = false;
+    if (button_p->debouncing && SWTimer_expired(&button_p->debounceTimer))
+        button_p->debouncing = false;
 
     // if we are not in the debouncing state and a transition is detected
-    if (!debouncing && JSBmodified) {
+    if (!button_p->debouncing && button_p->modified) {
 
         // We are not in debouncing and the first transition is detected
         tapped = true;
 
         // Let's enter debouncing state
-        debouncing = true;
+        button_p->debouncing = true;
 
         // We should setup a timer for how much to wait
-        debounceTimer = SWTimer_construct(DEBOUNCE_WAIT);
-        SWTimer_start(&debounceTimer);
+        button_p->debounceTimer = SWTimer_construct(DEBOUNCE_WAIT);
+        SWTimer_start(&button_p->debounceTimer);
 
     }
 
     // This is a very critical step similar to clearing interrupt flag.
     // If we don't refresh this variable, next time we enter this function, we think a new transition has happened.
-    JSBmodified = false;
-
-    return tapped;
-}
-
-bool BB1tapped()
-{
-    // This variable is true if we are in debouncing state (we are ignoring the extra transitions)
-    // This variable has to be static so that it "remembers"
-    static bool debouncing = false;
-
-    // The SW timer used for debouncing. It has to be static, otherwise it won't work.
-    static SWTimer debounceTimer;
-
-    // the single output of the FMS
-    bool tapped = false;
-
-    // If we are in debouncing state and the debouncing timer is expired, in other words,
-    // if wait time is over, we should leave the debouncing state.
-    if (debouncing && SWTimer_expired(&debounceTimer))
-        debouncing = false;
-
-    // if we are not in the debouncing state and a transition is detected
-    if (!debouncing && BB1modified) {
-
-        // We are not in debouncing and the first transition is detected
-        tapped = true;
-
-        // Let's enter debouncing state
-        debouncing = true;
-
-        // We should setup a timer for how much to wait
-        debounceTimer = SWTimer_construct(DEBOUNCE_WAIT);
-        SWTimer_start(&debounceTimer);
-
-    }
-
-    // This is a very critical step similar to clearing interrupt flag.
-    // If we don't refresh this variable, next time we enter this function, we think a new transition has happened.
-    BB1modified = false;
-
-    return tapped;
-}
-
-bool BB2tapped()
-{
-    // This variable is true if we are in debouncing state (we are ignoring the extra transitions)
-    // This variable has to be static so that it "remembers"
-    static bool debouncing = false;
-
-    // The SW timer used for debouncing. It has to be static, otherwise it won't work.
-    static SWTimer debounceTimer;
-
-    // the single output of the FMS
-    bool tapped = false;
-
-    // If we are in debouncing state and the debouncing timer is expired, in other words,
-    // if wait time is over, we should leave the debouncing state.
-    if (debouncing && SWTimer_expired(&debounceTimer))
-        debouncing = false;
-
-    // if we are not in the debouncing state and a transition is detected
-    if (!debouncing && BB2modified) {
-
-        // We are not in debouncing and the first transition is detected
-        tapped = true;
-
-        // Let's enter debouncing state
-        debouncing = true;
-
-        // We should setup a timer for how much to wait
-        debounceTimer = SWTimer_construct(DEBOUNCE_WAIT);
-        SWTimer_start(&debounceTimer);
-
-    }
-
-    // This is a very critical step similar to clearing interrupt flag.
-    // If we don't refresh this variable, next time we enter this function, we think a new transition has happened.
-    BB2modified = false;
-
-    return tapped;
-}
-
-bool LB1tapped()
-{
-    // This variable is true if we are in debouncing state (we are ignoring the extra transitions)
-    // This variable has to be static so that it "remembers"
-    static bool debouncing = false;
-
-    // The SW timer used for debouncing. It has to be static, otherwise it won't work.
-    static SWTimer debounceTimer;
-
-    // the single output of the FMS
-    bool tapped = false;
-
-    // If we are in debouncing state and the debouncing timer is expired, in other words,
-    // if wait time is over, we should leave the debouncing state.
-    if (debouncing && SWTimer_expired(&debounceTimer))
-        debouncing = false;
-
-    // if we are not in the debouncing state and a transition is detected
-    if (!debouncing && LB1modified) {
-
-        // We are not in debouncing and the first transition is detected
-        tapped = true;
-
-        // Let's enter debouncing state
-        debouncing = true;
-
-        // We should setup a timer for how much to wait
-        debounceTimer = SWTimer_construct(DEBOUNCE_WAIT);
-        SWTimer_start(&debounceTimer);
-
-    }
-
-    // This is a very critical step similar to clearing interrupt flag.
-    // If we don't refresh this variable, next time we enter this function, we think a new transition has happened.
-    LB1modified = false;
-
-    return tapped;
-}
-
-bool LB2tapped()
-{
-    // This variable is true if we are in debouncing state (we are ignoring the extra transitions)
-    // This variable has to be static so that it "remembers"
-    static bool debouncing = false;
-
-    // The SW timer used for debouncing. It has to be static, otherwise it won't work.
-    static SWTimer debounceTimer;
-
-    // the single output of the FMS
-    bool tapped = false;
-
-    // If we are in debouncing state and the debouncing timer is expired, in other words,
-    // if wait time is over, we should leave the debouncing state.
-    if (debouncing && SWTimer_expired(&debounceTimer))
-        debouncing = false;
-
-    // if we are not in the debouncing state and a transition is detected
-    if (!debouncing && LB2modified) {
-
-        // We are not in debouncing and the first transition is detected
-        tapped = true;
-
-        // Let's enter debouncing state
-        debouncing = true;
-
-        // We should setup a timer for how much to wait
-        debounceTimer = SWTimer_construct(DEBOUNCE_WAIT);
-        SWTimer_start(&debounceTimer);
-
-    }
-
-    // This is a very critical step similar to clearing interrupt flag.
-    // If we don't refresh this variable, next time we enter this function, we think a new transition has happened.
-    LB2modified = false;
+    button_p->modified = false;
 
     return tapped;
 }
 
 // This function calls all the functions that check button status and stores them in one structure
 // This will allow the user to reliably get the latest button status.
-// If we choose not to use this method, the user has to be careful to call JSBtapped() or any similar function
+// If we choose not to use this method, the user has to be careful to call buttonTapped() on a button
 // only once in the main loop.
-buttons_t updateButtons() {
+buttons_t updateButtons(Buttons* buttons_p) {
+
+    SCOPE_TIMING_BEGIN(SCOPE_UPDATE_BUTTONS);
 
     buttons_t buttons;
 
-    buttons.JSBtapped = JSBtapped();
+    buttons.JSBtapped = buttonTapped(&buttons_p->JSB);
 
-    buttons.BB1tapped = BB1tapped();
+    buttons.BB1tapped = buttonTapped(&buttons_p->BB1);
 
-    buttons.BB2tapped = BB2tapped();
+    buttons.BB2tapped = buttonTapped(&buttons_p->BB2);
 
-    buttons.LB1tapped = LB1tapped();
+    buttons.LB1tapped = buttonTapped(&buttons_p->LB1);
 
-    buttons.LB2tapped = LB2tapped();
+    buttons.LB2tapped = buttonTapped(&buttons_p->LB2);
 
+    SCOPE_TIMING_END(SCOPE_UPDATE_BUTTONS);
     return (buttons);
 }
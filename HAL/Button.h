@@ -6,6 +6,8 @@
 #define HAL_BUTTON_H_
 
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <HAL/Device.h>
+#include <HAL/Timer.h>
 
 // This structure holds the tapping status of all the buttons in our kit
 typedef struct{
@@ -16,10 +18,26 @@ typedef struct{
     bool JSBtapped;
 } buttons_t;
 
-// This function initializes all buttons
-void initButtons();
+// The state of one button: the flag its port interrupt sets and its debouncing FSM
+typedef struct{
+    volatile bool modified;
+    bool debouncing;
+    SWTimer debounceTimer;
+} Button;
+
+// This structure holds the state of all the buttons in our kit
+typedef struct{
+    Button JSB;
+    Button BB1;
+    Button BB2;
+    Button LB1;
+    Button LB2;
+} Buttons;
+
+// This function initializes all buttons. Their port interrupts update the given state.
+void initButtons(Buttons* buttons_p);
 
 // This function updates the tapping status of all the buttons
-buttons_t updateButtons();
+buttons_t updateButtons(Buttons* buttons_p);
 
 #endif /* HAL_BUTTON_H_ */
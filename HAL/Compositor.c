@@ -0,0 +1,365 @@
+/*
+ * Compositor.c
+ *
+ */
+
+#include <stdbool.h>
+#include <string.h>
+#include <HAL/Compositor.h>
+#include <HAL/EventTrace.h>
+#include <LcdDriver/HAL_MSP_EXP432P401R_Crystalfontz128x128_ST7735.h>
+#include <LcdDriver/LcdCapture.h>
+
+static void Compositor_unite(Graphics_Rectangle* rect_p, const Graphics_Rectangle* other_p)
+{
+    if (other_p->sXMin < rect_p->sXMin) rect_p->sXMin = other_p->sXMin;
+    if (other_p->sYMin < rect_p->sYMin) rect_p->sYMin = other_p->sYMin;
+    if (other_p->sXMax > rect_p->sXMax) rect_p->sXMax = other_p->sXMax;
+    if (other_p->sYMax > rect_p->sYMax) rect_p->sYMax = other_p->sYMax;
+}
+
+static const uint8_t* Compositor_glyph(const Graphics_Font* font_p, char c)
+{
+    if (c < ' ' || c > '~')
+        c = ' ';
+    return font_p->data + font_p->offset[c - ' '];
+}
+
+#ifndef LCD_FRAME_BUFFER
+
+/**
+ * Half the width of the row dy rows above or below the center of a filled circle, or -1 if the
+ * circle does not reach it. It walks the same midpoint steps as Graphics_fillCircle, which draws
+ * some rows more than once, and keeps the widest line it draws on that row.
+ */
+static int Compositor_halfWidth(int radius, int dy)
+{
+    int a, b = radius, d = 3 - 2 * radius, half = -1;
+
+    for (a = 0; a <= b; a++) {
+        if (a == dy && b > half)
+            half = b;
+        if (d >= 0 && b != a) {
+            if (b == dy && a > half)
+                half = a;
+            d += 4 * (a - b) + 10;
+            b--;
+        }
+        else
+            d += 4 * a + 6;
+    }
+
+    return half;
+}
+
+// Sets the pixels x0 to x1 of a row that starts at the column left and ends at right
+static void Compositor_span(uint8_t* line_p, int left, int right, int x0, int x1, uint16_t color)
+{
+    if (x0 < left)
+        x0 = left;
+    if (x1 > right)
+        x1 = right;
+    if (x0 > x1)
+        return;
+
+    uint8_t* pixel_p = line_p + 2 * (x0 - left);
+    for (; x0 <= x1; x0++) {
+        *pixel_p++ = color >> 8;
+        *pixel_p++ = color;
+    }
+}
+
+// Paints what an item shows of the row y between the columns left and right
+static void Compositor_paintRow(const CompositorItem* item_p, const Graphics_Font* font_p,
+                                int y, int left, int right, uint8_t* line_p)
+{
+    const Graphics_Rectangle* bounds_p = &item_p->bounds;
+
+    if (y < bounds_p->sYMin || y > bounds_p->sYMax || right < bounds_p->sXMin || left > bounds_p->sXMax)
+        return;
+
+    switch (item_p->kind)
+    {
+        case COMPOSITOR_TEXT:
+        {
+            int x = bounds_p->sXMin, col;
+            const char* c_p;
+            for (c_p = item_p->text; *c_p && x <= right; c_p++) {
+                const uint8_t* glyph = Compositor_glyph(font_p, *c_p);
+                // The rows of an uncompressed glyph run on as one stream of bits
+                int bit = (y - bounds_p->sYMin) * glyph[1];
+                for (col = 0; col < glyph[1]; col++, bit++) {
+                    uint16_t color = ((glyph[2 + (bit >> 3)] >> (7 - (bit & 7))) & 1) ?
+                                     item_p->foreground : item_p->background;
+                    Compositor_span(line_p, left, right, x + col, x + col, color);
+                }
+                x += glyph[1];
+            }
+            break;
+        }
+        case COMPOSITOR_OUTLINE:
+            if (y == bounds_p->sYMin || y == bounds_p->sYMax)
+                Compositor_span(line_p, left, right, bounds_p->sXMin, bounds_p->sXMax, item_p->foreground);
+            else {
+                Compositor_span(line_p, left, right, bounds_p->sXMin, bounds_p->sXMin, item_p->foreground);
+                Compositor_span(line_p, left, right, bounds_p->sXMax, bounds_p->sXMax, item_p->foreground);
+            }
+            break;
+        case COMPOSITOR_DISC:
+        {
+            int radius = (bounds_p->sXMax - bounds_p->sXMin) / 2;
+            int dy = y - (bounds_p->sYMin + radius);
+            int half = Compositor_halfWidth(radius, dy < 0 ? -dy : dy);
+            if (half >= 0)
+                Compositor_span(line_p, left, right, bounds_p->sXMin + radius - half,
+                                bounds_p->sXMin + radius + half, item_p->foreground);
+            break;
+        }
+    }
+}
+
+/**
+ * Sends a rectangle of the panel as the list shows it, composing its rows in the line of the
+ * compositor. The line is copied into the display list as it goes out, so it is free again at
+ * once.
+ */
+static void Compositor_redraw(Compositor* compositor_p, GFX* gfx_p, const Graphics_Rectangle* area_p)
+{
+    int left = (area_p->sXMin > 0) ? area_p->sXMin : 0;
+    int top = (area_p->sYMin > 0) ? area_p->sYMin : 0;
+    int right = (area_p->sXMax < LCD_HORIZONTAL_MAX - 1) ? area_p->sXMax : LCD_HORIZONTAL_MAX - 1;
+    int bottom = (area_p->sYMax < LCD_VERTICAL_MAX - 1) ? area_p->sYMax : LCD_VERTICAL_MAX - 1;
+
+    if (left > right || top > bottom)
+        return;
+
+    int width = right - left + 1;
+    int rows = LCD_HORIZONTAL_MAX / width;
+    int packed = 0, y, i;
+
+    LCD_CAPTURE_RECORD(LCD_CAPTURE_ENTRY(LCD_ENTRY_COMPOSE));
+    EventTrace_record(EVENT_LCD_BEGIN, LCD_ENTRY_COMPOSE);
+
+    Crystalfontz128x128_SetDrawFrame(&gfx_p->lcd, left, top, right, bottom);
+    HAL_LCD_writeCommand(CM_RAMWR);
+
+    for (y = top; y <= bottom; y++) {
+        uint8_t* line_p = compositor_p->line + 2 * width * packed;
+
+        Compositor_span(line_p, left, right, left, right, compositor_p->background);
+        for (i = 0; i < compositor_p->count; i++)
+            Compositor_paintRow(&compositor_p->items[i], gfx_p->context.font, y, left, right, line_p);
+
+        if (++packed == rows || y == bottom) {
+            HAL_LCD_writeDataBurst(compositor_p->line, 2 * width * packed);
+            packed = 0;
+        }
+    }
+
+    EventTrace_record(EVENT_LCD_END, LCD_ENTRY_COMPOSE);
+}
+
+#else
+
+static bool Compositor_overlaps(const Graphics_Rectangle* rect_p, const Graphics_Rectangle* other_p)
+{
+    return rect_p->sXMin <= other_p->sXMax && other_p->sXMin <= rect_p->sXMax &&
+           rect_p->sYMin <= other_p->sYMax && other_p->sYMin <= rect_p->sYMax;
+}
+
+/**
+ * Draws a rectangle of the list into the frame buffer: the background, then each item that
+ * reaches into it, with grlib clipped to the rectangle.
+ */
+static void Compositor_redraw(const Compositor* compositor_p, GFX* gfx_p, const Graphics_Rectangle* area_p)
+{
+    Graphics_Context* context_p = &gfx_p->context;
+    Graphics_Rectangle clip = context_p->clipRegion;
+    uint32_t foreground = context_p->foreground;
+    uint32_t background = context_p->background;
+    int i;
+
+    if (!Compositor_overlaps(area_p, &clip))
+        return;
+
+    context_p->clipRegion = *area_p;
+    if (clip.sXMin > area_p->sXMin) context_p->clipRegion.sXMin = clip.sXMin;
+    if (clip.sYMin > area_p->sYMin) context_p->clipRegion.sYMin = clip.sYMin;
+    if (clip.sXMax < area_p->sXMax) context_p->clipRegion.sXMax = clip.sXMax;
+    if (clip.sYMax < area_p->sYMax) context_p->clipRegion.sYMax = clip.sYMax;
+
+    context_p->foreground = compositor_p->background;
+    Graphics_fillRectangle(context_p, &context_p->clipRegion);
+
+    for (i = 0; i < compositor_p->count; i++) {
+        const CompositorItem* item_p = &compositor_p->items[i];
+        const Graphics_Rectangle* bounds_p = &item_p->bounds;
+        int radius = (bounds_p->sXMax - bounds_p->sXMin) / 2;
+
+        if (!Compositor_overlaps(bounds_p, &context_p->clipRegion))
+            continue;
+
+        context_p->foreground = item_p->foreground;
+        context_p->background = item_p->background;
+        switch (item_p->kind)
+        {
+            case COMPOSITOR_TEXT:
+                Graphics_drawString(context_p, (int8_t*) item_p->text, -1, bounds_p->sXMin,
+                                    bounds_p->sYMin, OPAQUE_TEXT);
+                break;
+            case COMPOSITOR_OUTLINE:
+                Graphics_drawRectangle(context_p, bounds_p);
+                break;
+            case COMPOSITOR_DISC:
+                Graphics_fillCircle(context_p, bounds_p->sXMin + radius, bounds_p->sYMin + radius, radius);
+                break;
+        }
+    }
+
+    context_p->clipRegion = clip;
+    context_p->foreground = foreground;
+    context_p->background = background;
+}
+
+#endif
+
+static CompositorItem* Compositor_find(Compositor* compositor_p, CompositorKind kind, int x, int y)
+{
+    int i;
+    for (i = 0; i < compositor_p->count; i++) {
+        CompositorItem* item_p = &compositor_p->items[i];
+        if (item_p->kind == kind &&
+            (kind == COMPOSITOR_DISC || (item_p->bounds.sXMin == x && item_p->bounds.sYMin == y)))
+            return item_p;
+    }
+    return NULL;
+}
+
+// Appends an item in the colors of the context, or returns NULL if the list is full
+static CompositorItem* Compositor_add(Compositor* compositor_p, GFX* gfx_p, CompositorKind kind)
+{
+    if (compositor_p->count == COMPOSITOR_ITEMS)
+        return NULL;
+
+    CompositorItem* item_p = &compositor_p->items[compositor_p->count++];
+    item_p->kind = kind;
+    item_p->foreground = gfx_p->context.foreground;
+    item_p->background = gfx_p->context.background;
+    item_p->text[0] = '\0';
+    return item_p;
+}
+
+Compositor Compositor_construct()
+{
+    Compositor compositor;
+
+    memset(&compositor, 0, sizeof(compositor));
+
+    return compositor;
+}
+
+void Compositor_clear(Compositor* compositor_p, GFX* gfx_p)
+{
+    GFX_clear(gfx_p);
+    compositor_p->background = gfx_p->context.background;
+    compositor_p->count = 0;
+}
+
+void Compositor_print(Compositor* compositor_p, GFX* gfx_p, const char* text, int row, int col)
+{
+    const Graphics_Font* font_p = gfx_p->context.font;
+
+    // The glyphs are decoded here in the uncompressed layout only. Compressed and extended grlib
+    // fonts are left to grlib, drawn straight to the display and not kept in the scene.
+    if (font_p->format != FONT_FMT_UNCOMPRESSED) {
+        GFX_print(gfx_p, (char*) text, row, col);
+        return;
+    }
+
+    int x = col * Graphics_getFontMaxWidth(font_p);
+    int y = row * Graphics_getFontHeight(font_p);
+    CompositorItem* item_p = Compositor_find(compositor_p, COMPOSITOR_TEXT, x, y);
+    bool replacing = (item_p != NULL);
+    Graphics_Rectangle area;
+
+    if (replacing) {
+        if (strncmp(item_p->text, text, COMPOSITOR_TEXT_LENGTH) == 0 &&
+            item_p->foreground == gfx_p->context.foreground &&
+            item_p->background == gfx_p->context.background)
+            return;
+        area = item_p->bounds;
+    }
+    else if (!(item_p = Compositor_add(compositor_p, gfx_p, COMPOSITOR_TEXT)))
+        return;
+
+    strncpy(item_p->text, text, COMPOSITOR_TEXT_LENGTH);
+    item_p->text[COMPOSITOR_TEXT_LENGTH] = '\0';
+    item_p->foreground = gfx_p->context.foreground;
+    item_p->background = gfx_p->context.background;
+
+    int width = 0;
+    const char* c_p;
+    for (c_p = item_p->text; *c_p; c_p++)
+        width += Compositor_glyph(font_p, *c_p)[1];
+
+    item_p->bounds.sXMin = x;
+    item_p->bounds.sYMin = y;
+    item_p->bounds.sXMax = x + width - 1;
+    item_p->bounds.sYMax = y + Graphics_getFontHeight(font_p) - 1;
+
+    // A shorter text also clears what the longer one left past its end
+    if (replacing)
+        Compositor_unite(&area, &item_p->bounds);
+    else
+        area = item_p->bounds;
+    Compositor_redraw(compositor_p, gfx_p, &area);
+}
+
+void Compositor_drawRectangle(Compositor* compositor_p, GFX* gfx_p,
+                              const Graphics_Rectangle* rect_p)
+{
+    CompositorItem* item_p = Compositor_add(compositor_p, gfx_p, COMPOSITOR_OUTLINE);
+    if (!item_p)
+        return;
+
+    Graphics_Rectangle* bounds_p = &item_p->bounds;
+    bounds_p->sXMin = (rect_p->sXMin < rect_p->sXMax) ? rect_p->sXMin : rect_p->sXMax;
+    bounds_p->sXMax = (rect_p->sXMin < rect_p->sXMax) ? rect_p->sXMax : rect_p->sXMin;
+    bounds_p->sYMin = (rect_p->sYMin < rect_p->sYMax) ? rect_p->sYMin : rect_p->sYMax;
+    bounds_p->sYMax = (rect_p->sYMin < rect_p->sYMax) ? rect_p->sYMax : rect_p->sYMin;
+
+    // Only the four edges, not the inside the outline leaves alone
+    Graphics_Rectangle edge = *bounds_p;
+    edge.sYMax = edge.sYMin;
+    Compositor_redraw(compositor_p, gfx_p, &edge);
+    edge.sYMin = edge.sYMax = bounds_p->sYMax;
+    Compositor_redraw(compositor_p, gfx_p, &edge);
+    edge.sYMin = bounds_p->sYMin + 1;
+    edge.sYMax = bounds_p->sYMax - 1;
+    edge.sXMax = edge.sXMin;
+    Compositor_redraw(compositor_p, gfx_p, &edge);
+    edge.sXMin = edge.sXMax = bounds_p->sXMax;
+    Compositor_redraw(compositor_p, gfx_p, &edge);
+}
+
+void Compositor_fillCircle(Compositor* compositor_p, GFX* gfx_p, int x, int y, int radius)
+{
+    Graphics_Rectangle bounds = { x - radius, y - radius, x + radius, y + radius };
+    CompositorItem* item_p = Compositor_find(compositor_p, COMPOSITOR_DISC, x, y);
+    Graphics_Rectangle area = bounds;
+
+    if (item_p) {
+        if (memcmp(&item_p->bounds, &bounds, sizeof(bounds)) == 0 &&
+            item_p->foreground == gfx_p->context.foreground)
+            return;
+
+        // The old and the new circle in one pass, so the pet is never missing from the panel
+        Compositor_unite(&area, &item_p->bounds);
+    }
+    else if (!(item_p = Compositor_add(compositor_p, gfx_p, COMPOSITOR_DISC)))
+        return;
+
+    item_p->bounds = bounds;
+    item_p->foreground = gfx_p->context.foreground;
+    Compositor_redraw(compositor_p, gfx_p, &area);
+}
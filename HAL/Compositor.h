@@ -0,0 +1,79 @@
+/*
+ * Compositor.h
+ *
+ * The game screen as a retained list of what it shows: text, rectangle outlines and one filled
+ * circle, the pet. Each change redraws only the rectangle it touches, from the whole list, so
+ * the old and the new look of an item go out in a single pass. A pet that moves is not erased
+ * and then drawn again, and a value that gets shorter leaves no old digits behind.
+ *
+ * Without the LCD frame buffer (LCD_FRAME_BUFFER) the rectangle is composed one row at a time
+ * into a 256-byte line and streamed to the panel, so the screen costs the list and that line,
+ * well under 1 KB, all of it in the Compositor. With the frame buffer, grlib draws the list into it, clipped to the
+ * rectangle, and the next flush sends the result.
+ *
+ * The items come out as grlib draws them: the opaque text of GFX_print, the outline of
+ * Graphics_drawRectangle and the midpoint circle of Graphics_fillCircle, in the colors of the
+ * context when they were added. Anything else on the panel is left alone as long as it stays
+ * clear of the items, like the PerfOverlay rows.
+ */
+
+#ifndef HAL_COMPOSITOR_H_
+#define HAL_COMPOSITOR_H_
+
+#include <stdint.h>
+#include <HAL/Graphics.h>
+
+#define COMPOSITOR_ITEMS        8       // The game screen has six texts, the playpen and the pet
+#define COMPOSITOR_TEXT_LENGTH  11      // Characters a text item keeps; the rest are dropped
+
+enum _CompositorKind
+{
+    COMPOSITOR_TEXT,
+    COMPOSITOR_OUTLINE,
+    COMPOSITOR_DISC
+};
+typedef enum _CompositorKind CompositorKind;
+
+struct _CompositorItem
+{
+    uint8_t kind;                   // A CompositorKind
+    Graphics_Rectangle bounds;      // Every pixel the item covers, with sXMin <= sXMax
+    uint16_t foreground;            // Colors as the display driver takes them
+    uint16_t background;            // Behind the text
+    char text[COMPOSITOR_TEXT_LENGTH + 1];
+};
+typedef struct _CompositorItem CompositorItem;
+
+struct _Compositor
+{
+    uint16_t background;            // What the items are drawn on
+    uint8_t count;
+    CompositorItem items[COMPOSITOR_ITEMS];     // In drawing order
+#ifndef LCD_FRAME_BUFFER
+    // One row of the panel, each pixel high byte first as the panel takes it. The rows of a
+    // rectangle narrower than the panel are packed into it as many at a time as fit.
+    uint8_t line[2 * LCD_HORIZONTAL_MAX];
+#endif
+};
+typedef struct _Compositor Compositor;
+
+// Constructs an empty list
+Compositor Compositor_construct();
+
+// Clears the panel to the background color of the context and empties the list
+void Compositor_clear(Compositor* compositor_p, GFX* gfx_p);
+
+// Shows a text at a row and a column of the font, as GFX_print does. A text already at that spot
+// is replaced, and nothing is drawn if it is unchanged. A font that is not FONT_FMT_UNCOMPRESSED
+// is printed with GFX_print instead, outside the scene.
+void Compositor_print(Compositor* compositor_p, GFX* gfx_p, const char* text, int row, int col);
+
+// Adds the outline of a rectangle, in either corner order, as Graphics_drawRectangle draws it
+void Compositor_drawRectangle(Compositor* compositor_p, GFX* gfx_p,
+                              const Graphics_Rectangle* rect_p);
+
+// Shows the one filled circle of the list at a new spot, size or color, and draws nothing if it
+// is unchanged
+void Compositor_fillCircle(Compositor* compositor_p, GFX* gfx_p, int x, int y, int radius);
+
+#endif /* HAL_COMPOSITOR_H_ */
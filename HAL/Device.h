@@ -0,0 +1,27 @@
+/*
+ * Device.h
+ *
+ * Storage for the state of one device.
+ *
+ * All of the firmware's state lives in the HAL and the application objects that main() owns.
+ * Interrupt handlers take no arguments, so each module that has one keeps a pointer to the
+ * instance it serves, bound by that instance's constructor. Those pointers are declared
+ * DEVICE_LOCAL. On the board there is one device and DEVICE_LOCAL is empty. A host build
+ * that runs one simulated device per thread defines it as _Thread_local, so each thread's
+ * interrupt handlers reach that thread's device.
+ *
+ * A few buffers are DEVICE_LOCAL storage themselves, because the debugger saves them whole or
+ * the hardware or a reset dictates where they live: EventTrace_log, Profiler_profile,
+ * ScopeTiming_stats, the DMA control table and the .noinit PostMortem_log. Their constructors
+ * clear them, as the start-up code clears .bss on the board, so that a host thread can run one
+ * device after another. PostMortem_log alone survives a boot, and the host clears it at power-up.
+ */
+
+#ifndef HAL_DEVICE_H_
+#define HAL_DEVICE_H_
+
+#ifndef DEVICE_LOCAL
+#define DEVICE_LOCAL
+#endif
+
+#endif /* HAL_DEVICE_H_ */
@@ -0,0 +1,46 @@
+/*
+ * EventTrace.c
+ *
+ */
+
+#include <HAL/EventTrace.h>
+
+#ifdef EVENT_TRACE
+
+#include <string.h>
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <HAL/Timer.h>
+
+DEVICE_LOCAL EventTraceLog EventTrace_log;
+
+void EventTrace_construct()
+{
+    // The whole log is saved, so it starts clear even where no start-up code zeroed it
+    memset(&EventTrace_log, 0, sizeof(EventTrace_log));
+    EventTrace_log.header.capacity = EVENT_TRACE_LENGTH;
+    EventTrace_log.header.clockHz = SYSTEM_CLOCK / PRESCALER;
+    EventTrace_log.header.magic = EVENT_TRACE_MAGIC;
+}
+
+void EventTrace_record(EventType type, int16_t arg)
+{
+    EventTraceLog* log_p = &EventTrace_log;
+    if (log_p->header.magic != EVENT_TRACE_MAGIC)
+        return;
+
+    // Claim the slot and stamp it together, so that the records stay in time order when an
+    // interrupt handler records in between
+    bool wasDisabled = Interrupt_disableMaster();
+
+    EventRecord* record_p = &log_p->records[log_p->header.count % EVENT_TRACE_LENGTH];
+    record_p->cycles = (uint32_t) SystemTiming_cycles();
+    record_p->type = type;
+    record_p->reserved = 0;
+    record_p->arg = arg;
+    log_p->header.count++;
+
+    if (!wasDisabled)
+        Interrupt_enableMaster();
+}
+
+#endif
@@ -0,0 +1,90 @@
+/*
+ * EventTrace.h
+ *
+ * A timeline of what the firmware does: every interrupt, each sleep and wake, each SWTimer as
+ * it expires, each change of screen or of the pet's spot, and each display driver entry point
+ * as it starts and returns. Every event is 8 bytes stamped with the system timer, written into
+ * a RAM ring that keeps the latest EVENT_TRACE_LENGTH of them. The main loop and the interrupt
+ * handlers both record, so a record briefly masks interrupts.
+ *
+ * Building with EVENT_TRACE defined keeps the ring in EventTrace_log. Saving the whole
+ * EventTrace_log structure from the debugger gives a file that host/trace_json turns into a
+ * Chrome trace (chrome://tracing or ui.perfetto.dev); tamagotchi_sim --event-trace writes the
+ * same format. Without EVENT_TRACE the recording compiles to nothing.
+ *
+ * All fields are little-endian, as on the MSP432.
+ */
+
+#ifndef HAL_EVENTTRACE_H_
+#define HAL_EVENTTRACE_H_
+
+#include <stdint.h>
+#include <HAL/Device.h>
+
+#define EVENT_TRACE_MAGIC       0x56455454      // "TTEV"
+
+// Number of events the RAM ring holds (8 bytes each)
+#ifndef EVENT_TRACE_LENGTH
+#define EVENT_TRACE_LENGTH      512
+#endif
+
+// What an event records, and what its argument is
+enum _EventType
+{
+    EVENT_INTERRUPT,        // A handler started; the WakeSource it counts as
+    EVENT_SLEEP,            // sleep() enters LPM0
+    EVENT_WAKE,             // sleep() returns
+    EVENT_TIMER_EXPIRED,    // SWTimer_expired() saw a timer run out; its wait in ms
+    EVENT_SCREEN,           // A pass of main_loop changed the GameState; the new one
+    EVENT_SPOT,             // A pass of main_loop moved the pet; its new spot
+    EVENT_LCD_BEGIN,        // A display driver entry point starts; its LcdCaptureEntry
+    EVENT_LCD_END,          // It returns; the same LcdCaptureEntry
+    EVENT_TYPE_COUNT
+};
+typedef enum _EventType EventType;
+
+struct _EventRecord
+{
+    uint32_t cycles;        // The low 32 bits of SystemTiming_cycles(); they wrap every 89 s
+    uint8_t type;
+    uint8_t reserved;
+    int16_t arg;
+};
+typedef struct _EventRecord EventRecord;
+
+// A trace: this header, then capacity records. Once count exceeds capacity the ring has
+// wrapped and the oldest record is at count % capacity.
+struct _EventTraceHeader
+{
+    uint32_t magic;         // Zero until EventTrace_construct()
+    uint32_t capacity;
+    uint32_t count;         // Records written so far
+    uint32_t clockHz;       // Rate of the timer the records are stamped with
+};
+typedef struct _EventTraceHeader EventTraceHeader;
+
+#ifdef EVENT_TRACE
+
+struct _EventTraceLog
+{
+    EventTraceHeader header;
+    EventRecord records[EVENT_TRACE_LENGTH];
+};
+typedef struct _EventTraceLog EventTraceLog;
+
+extern DEVICE_LOCAL EventTraceLog EventTrace_log;
+
+// Empties the ring and starts recording; needs the system timing to be running
+void EventTrace_construct();
+
+// Appends an event stamped with the current time; does nothing before EventTrace_construct()
+void EventTrace_record(EventType type, int16_t arg);
+
+#else
+
+#define EventTrace_construct()
+#define EventTrace_record(type, arg)    ((void) 0)
+
+#endif
+
+#endif /* HAL_EVENTTRACE_H_ */
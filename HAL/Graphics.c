@@ -3,26 +3,24 @@
  */
 
 #include <HAL/Graphics.h>
+#include <HAL/ScopeTiming.h>
 
-GFX GFX_construct(uint32_t defaultForeground, uint32_t defaultBackground)
+// Constructed in place, since the context points at the display and the display at the panel
+void GFX_construct(GFX* gfx_p, uint32_t defaultForeground, uint32_t defaultBackground)
 {
-    GFX gfx;
-
-    gfx.defaultForeground = defaultForeground;
-    gfx.defaultBackground = defaultBackground;
+    gfx_p->defaultForeground = defaultForeground;
+    gfx_p->defaultBackground = defaultBackground;
 
     //initializing the display
-    Crystalfontz128x128_Init();
-    Crystalfontz128x128_SetOrientation(LCD_ORIENTATION_UP);
+    Crystalfontz128x128_Init(&gfx_p->lcd, &gfx_p->display);
+    Crystalfontz128x128_SetOrientation(&gfx_p->lcd, LCD_ORIENTATION_UP);
 
     // setting up the graphics
-    Graphics_initContext(&gfx.context, &g_sCrystalfontz128x128, &g_sCrystalfontz128x128_funcs);
-    Graphics_setFont(&gfx.context, &g_sFontFixed6x8);
-
-    GFX_resetColors(&gfx);
-    GFX_clear(&gfx);
+    Graphics_initContext(&gfx_p->context, &gfx_p->display, &g_sCrystalfontz128x128_funcs);
+    Graphics_setFont(&gfx_p->context, &g_sFontFixed6x8);
 
-    return gfx;
+    GFX_resetColors(gfx_p);
+    GFX_clear(gfx_p);
 }
 
 void GFX_resetColors(GFX* gfx_p)
@@ -39,12 +37,21 @@ void GFX_clear(GFX* gfx_p)
     Graphics_clearDisplay(&gfx_p->context);
 }
 
+// Sends what has been drawn to the panel, which only matters with a frame buffer or deferred
+// drawing; it returns once the sending has started
+void GFX_flush(GFX* gfx_p)
+{
+    Graphics_flushBuffer(&gfx_p->context);
+}
+
 void GFX_print(GFX* gfx_p, char* string, int row, int col)
 {
     int yPosition = row * Graphics_getFontHeight(gfx_p->context.font);
     int xPosition = col * Graphics_getFontMaxWidth(gfx_p->context.font);
 
+    SCOPE_TIMING_BEGIN(SCOPE_GFX_PRINT);
     Graphics_drawString(&gfx_p->context, (int8_t*) string, -1, xPosition, yPosition, OPAQUE_TEXT);
+    SCOPE_TIMING_END(SCOPE_GFX_PRINT);
 }
 
 void GFX_setForeground(GFX* gfx_p, uint32_t foreground)
@@ -61,7 +68,9 @@ void GFX_setBackground(GFX* gfx_p, uint32_t background)
 
 void GFX_drawSolidCircle(GFX* gfx_p, int x, int y, int radius)
 {
+    SCOPE_TIMING_BEGIN(SCOPE_FILL_CIRCLE);
     Graphics_fillCircle(&gfx_p->context, x, y, radius);
+    SCOPE_TIMING_END(SCOPE_FILL_CIRCLE);
 }
 
 void GFX_drawHollowCircle(GFX* gfx_p, int x, int y, int radius)
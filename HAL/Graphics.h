@@ -16,6 +16,9 @@
 
 struct _GFX
 {
+    // The panel and the grlib display that draws on it; context refers to both
+    Crystalfontz128x128 lcd;
+    Graphics_Display display;
     Graphics_Context context;
     uint32_t foreground;
     uint32_t background;
@@ -24,10 +27,11 @@ struct _GFX
 };
 typedef struct _GFX GFX;
 
-GFX GFX_construct(uint32_t defaultForeground, uint32_t defaultBackground);
+void GFX_construct(GFX* gfx_p, uint32_t defaultForeground, uint32_t defaultBackground);
 
 void GFX_resetColors(GFX* gfx_p);
 void GFX_clear(GFX* gfx_p);
+void GFX_flush(GFX* gfx_p);
 
 void GFX_print(GFX* gfx_p, char* string, int row, int col);
 void GFX_setForeground(GFX* gfx_p, uint32_t foreground);
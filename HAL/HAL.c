@@ -9,20 +9,46 @@
 
 /**
  * Constructs a new HAL object. The HAL constructor should simply call the constructors of each
- * of its sub-members with the proper inputs.
+ * of its sub-members with the proper inputs. It should be called right after the Watchdog timer
+ * is stopped, since it also sets up the system timing.
  *
- * @return a properly constructed HAL object.
+ * @param hal_p:  The HAL to construct. Interrupt handlers keep pointers into it from now on.
  */
-HAL HAL_construct()
+void HAL_construct(HAL* hal_p)
 {
-    // The HAL object which will be returned at the end of construction
-    HAL hal;
+    // Paint the stack before anything can push an interrupt frame onto it.
+    StackUsage_paint();
+
+    // Check what the post-mortem log kept through the reset before the new run records into it.
+    PostMortem_construct();
+
+    // The wake counters come before any interrupt is enabled, the Timer32 one included.
+    WakeStats_construct(&hal_p->wakeStats);
+
+    // Set up the system clock and the reference timer first; the rest depends on them.
+    InitSystemTiming(&hal_p->timing);
+    ScopeTiming_init();
+    EventTrace_construct();
 
     // Initialize all LEDs by calling their constructors with correctly-defined arguments.
+    initLEDs();
+
+    // The trace and the latencies have to exist before the interrupts that record into them are enabled.
+    InputTrace_construct(&hal_p->inputTrace);
+    Latency_construct(&hal_p->latency);
+    initButtons(&hal_p->buttons);
+
+    // Open the telemetry channel and announce the boot on it.
+    Uart_construct(&hal_p->uart);
+    Telemetry_sendBoot();
+    PostMortem_sendReport();
 
     // Initialize the LCD by calling its constructor with user-defined foreground and background colors.
-    hal.gfx = GFX_construct(GRAPHICS_COLOR_BLACK, GRAPHICS_COLOR_WHITE);
+    GFX_construct(&hal_p->gfx, GRAPHICS_COLOR_BLACK, GRAPHICS_COLOR_WHITE);
+
+    // Start sampling the joystick.
+    Joystick_construct(&hal_p->joystick);
 
-    // Once we have finished building the HAL, return the completed struct.
-    return hal;
+    // Sample the program counter last, so that the profile covers the game and not the start-up.
+    Profiler_start(PROFILER_HZ);
 }
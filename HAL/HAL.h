@@ -12,6 +12,16 @@
 #include <HAL/Timer.h>
 #include <HAL/Graphics.h>
 #include <HAL/Joystick.h>
+#include <HAL/InputTrace.h>
+#include <HAL/Latency.h>
+#include <HAL/WakeStats.h>
+#include <HAL/ScopeTiming.h>
+#include <HAL/Profiler.h>
+#include <HAL/EventTrace.h>
+#include <HAL/StackUsage.h>
+#include <HAL/Uart.h>
+#include <HAL/Telemetry.h>
+#include <HAL/PostMortem.h>
 
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
 
@@ -20,24 +30,49 @@
  * in this application as individual members. This includes all LEDs, all
  * Buttons, one HWTimer from which all software timers should reference, the
  * Joystick, and any other peripherals with which you wish to interface.
+ *
+ * Every piece of state the drivers keep is a member of this struct, so one HAL
+ * is one complete device. The interrupt handlers keep pointers into it, which
+ * is why it is constructed in place and must not be copied or moved after.
  * ============================================================================
  * USAGE WARNINGS
  * ============================================================================
- * YOU SHOULD HAVE EXACTLY ONE HAL STRUCT IN YOUR ENTIRE PROJECT. We recommend
+ * YOU SHOULD HAVE EXACTLY ONE HAL STRUCT PER DEVICE (on the board, in your
+ * entire project; in the host build, per simulated device thread). We recommend
  * you put this struct inside of a main [Application] object or in the main
  * function so that every single function in your application has access to the
  * main inputs and outputs which interface with the hardware on the MSP432.
  */
 struct _HAL
 {
+    // The reference timer all software timers count from
+    SystemTiming timing;
+
+    // The Launchpad and BoosterPack buttons
+    Buttons buttons;
+
+    // The BoosterPack joystick
+    Joystick joystick;
+
+    // The record of every input change
+    InputTrace inputTrace;
+
+    // How long inputs take to show on the LCD
+    Latency latency;
+
+    // What wakes the CPU, and how often for nothing
+    WakeStats wakeStats;
+
+    // The backchannel UART the telemetry goes out on
+    Uart uart;
 
     // Graphics - LCD control
     GFX gfx;
 };
 typedef struct _HAL HAL;
 
-// Constructs an HAL object by calling the constructor of each individual member
-HAL HAL_construct();
+// Constructs an HAL object in place by calling the constructor of each individual member
+void HAL_construct(HAL* hal_p);
 
 // Refreshes all necessary inputs in the HAL
 void HAL_refresh(HAL* hal_p);
@@ -0,0 +1,106 @@
+/*
+ * InputTrace.c
+ *
+ */
+
+#include <HAL/InputTrace.h>
+#include <HAL/Joystick.h>
+#include <HAL/Timer.h>
+
+// The trace of this device, bound by InputTrace_construct()
+static DEVICE_LOCAL InputTrace* deviceTrace;
+
+void InputTrace_construct(InputTrace* trace_p)
+{
+    trace_p->head = 0;
+    trace_p->tail = 0;
+    trace_p->dropped = 0;
+    trace_p->lastCycles = 0;
+
+    // No reading is in these zones, so the first conversion is always recorded
+    trace_p->lastXZone = 0xFF;
+    trace_p->lastYZone = 0xFF;
+
+    deviceTrace = trace_p;
+}
+
+/**
+ * Appends an event to the ring buffer, or counts it as dropped if the buffer is full.
+ *
+ * @return true if the event was stored
+ */
+static bool InputTrace_push(InputTrace* trace_p, uint32_t delta, uint32_t payload)
+{
+    uint16_t next = (trace_p->head + 1) % INPUT_TRACE_CAPACITY;
+    if (next == trace_p->tail) {
+        trace_p->dropped++;
+        return false;
+    }
+
+    trace_p->events[trace_p->head].delta = delta;
+    trace_p->events[trace_p->head].payload = payload;
+    trace_p->head = next;
+    return true;
+}
+
+/**
+ * Stores an event stamped with the current time. Deltas are taken from the last event that
+ * was stored, so the events that remain keep their exact times when others are dropped. Gaps
+ * too long for a delta are bridged with IDLE events.
+ *
+ * @return true if the event was stored
+ */
+static bool InputTrace_record(InputTrace* trace_p, uint32_t payload)
+{
+    uint64_t now = SystemTiming_cycles();
+    uint64_t delta = now - trace_p->lastCycles;
+
+    while (delta > UINT32_MAX) {
+        if (!InputTrace_push(trace_p, UINT32_MAX, INPUT_TRACE_IDLE))
+            return false;
+        trace_p->lastCycles += UINT32_MAX;
+        delta -= UINT32_MAX;
+    }
+
+    if (!InputTrace_push(trace_p, (uint32_t) delta, payload))
+        return false;
+    trace_p->lastCycles = now;
+    return true;
+}
+
+void InputTrace_recordButton(InputTraceSource button)
+{
+    InputTrace_record(deviceTrace, INPUT_TRACE_PAYLOAD(button, 0, 0));
+}
+
+void InputTrace_recordJoystick(uint16_t x, uint16_t y)
+{
+    InputTrace* trace_p = deviceTrace;
+
+    // The ADC noise moves the readings by a few counts on every conversion
+    uint8_t xZone = JOYSTICK_ZONE(x, LEFT_THRESHOLD, RIGHT_THRESHOLD);
+    uint8_t yZone = JOYSTICK_ZONE(y, DOWN_THRESHOLD, UP_THRESHOLD);
+    if (xZone == trace_p->lastXZone && yZone == trace_p->lastYZone)
+        return;
+
+    if (InputTrace_record(trace_p, INPUT_TRACE_PAYLOAD(INPUT_TRACE_JOYSTICK, x, y))) {
+        trace_p->lastXZone = xZone;
+        trace_p->lastYZone = yZone;
+    }
+}
+
+bool InputTrace_read(InputTraceEvent* event_p)
+{
+    InputTrace* trace_p = deviceTrace;
+    if (trace_p->tail == trace_p->head)
+        return false;
+
+    *event_p = trace_p->events[trace_p->tail];
+    trace_p->tail = (trace_p->tail + 1) % INPUT_TRACE_CAPACITY;
+    return true;
+}
+
+uint32_t InputTrace_dropped()
+{
+    return deviceTrace->dropped;
+}
@@ -0,0 +1,99 @@
+/*
+ * InputTrace.h
+ *
+ * A record of every change on the game's inputs: taps on LB1, LB2, BB1, BB2 and JSB, and each
+ * joystick reading that moved an axis across a threshold, stamped with the system timer. The port and ADC interrupt handlers
+ * record into a RAM ring buffer; the same events saved to a file (an InputTraceHeader followed
+ * by the events) can be replayed by the host build to reproduce a game exactly.
+ *
+ * All fields are little-endian, as on the MSP432.
+ */
+
+#ifndef HAL_INPUTTRACE_H_
+#define HAL_INPUTTRACE_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <HAL/Device.h>
+
+#define INPUT_TRACE_MAGIC       0x4E494754      // "TGIN"
+#define INPUT_TRACE_VERSION     1
+
+// Number of events the ring buffer holds (8 bytes each)
+#ifndef INPUT_TRACE_CAPACITY
+#define INPUT_TRACE_CAPACITY    512
+#endif
+
+// What an event records
+enum _InputTraceSource
+{
+    INPUT_TRACE_IDLE,       // Nothing; only advances time when a gap does not fit in delta
+    INPUT_TRACE_LB1,
+    INPUT_TRACE_LB2,
+    INPUT_TRACE_BB1,
+    INPUT_TRACE_BB2,
+    INPUT_TRACE_JSB,
+    INPUT_TRACE_JOYSTICK    // A conversion that moved X (MEM0) or Y (MEM1) to another zone
+};
+typedef enum _InputTraceSource InputTraceSource;
+
+// The payload packs the source into bits 0-3 and, for the joystick, X into bits 4-17 and Y
+// into bits 18-31
+#define INPUT_TRACE_PAYLOAD(source, x, y) \
+    ((uint32_t) (source) | ((uint32_t) ((x) & 0x3FFF) << 4) | ((uint32_t) ((y) & 0x3FFF) << 18))
+#define INPUT_TRACE_SOURCE(payload)     ((InputTraceSource) ((payload) & 0xF))
+#define INPUT_TRACE_X(payload)          ((uint16_t) (((payload) >> 4) & 0x3FFF))
+#define INPUT_TRACE_Y(payload)          ((uint16_t) (((payload) >> 18) & 0x3FFF))
+
+struct _InputTraceEvent
+{
+    // System timer cycles since the previous event (since InitSystemTiming() for the first)
+    uint32_t delta;
+    uint32_t payload;
+};
+typedef struct _InputTraceEvent InputTraceEvent;
+
+// Starts a trace file
+struct _InputTraceHeader
+{
+    uint32_t magic;
+    uint16_t version;
+    uint16_t eventSize;     // sizeof(InputTraceEvent)
+    uint32_t clockHz;       // Rate of the timer the deltas count
+    uint32_t eventCount;
+};
+typedef struct _InputTraceHeader InputTraceHeader;
+
+// The ring buffer and the time and joystick zones of the last event stored in it. Only
+// interrupt handlers write to it and they do not preempt each other, so head is only ever
+// changed by one writer at a time and tail only by the reader.
+struct _InputTrace
+{
+    InputTraceEvent events[INPUT_TRACE_CAPACITY];
+    volatile uint16_t head;
+    volatile uint16_t tail;
+    volatile uint32_t dropped;
+
+    uint64_t lastCycles;
+    uint8_t lastXZone;      // JOYSTICK_ZONE() of each axis
+    uint8_t lastYZone;
+};
+typedef struct _InputTrace InputTrace;
+
+// Constructs an empty trace in place; the interrupt handlers record into it from then on
+void InputTrace_construct(InputTrace* trace_p);
+
+// Records a button tap; called from the port interrupt handlers
+void InputTrace_recordButton(InputTraceSource button);
+
+// Records a joystick conversion if either reading moved to another zone of the Joystick's
+// thresholds; the readings in between would replay alike. Called from ADC14_IRQHandler
+void InputTrace_recordJoystick(uint16_t x, uint16_t y);
+
+// Takes the oldest event out of this device's ring buffer; returns false when it is empty
+bool InputTrace_read(InputTraceEvent* event_p);
+
+// The number of events this device lost because the ring buffer was full
+uint32_t InputTrace_dropped();
+
+#endif /* HAL_INPUTTRACE_H_ */
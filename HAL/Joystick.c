@@ -5,20 +5,32 @@
  *      Author: Antonio Dominguez
  */
 #include <HAL/Joystick.h>
+#include <HAL/InputTrace.h>
+#include <HAL/Latency.h>
+#include <HAL/WakeStats.h>
+#include <HAL/ScopeTiming.h>
+#include <HAL/EventTrace.h>
 
-#define UP_THRESHOLD 12000
-#define DOWN_THRESHOLD 3000
-#define LEFT_THRESHOLD 3000
-#define RIGHT_THRESHOLD 12000
+// Mid-scale of the 14-bit ADC; the Joystick reads as centered until the first conversion
+#define CENTER_READING 8192
 
-enum _JoystickDebounceState {MIDDLE, UP, DOWN, RIGHT, LEFT};
-typedef enum _JoystickDebounceState JoystickDebounceState;
-
-static volatile bool JoystickX_modified;
+// The Joystick of this device, bound by Joystick_construct()
+static DEVICE_LOCAL Joystick* deviceJoystick;
 
 void ADC14_IRQHandler(){
+    WakeStats_interrupt(WAKE_ADC14);
+    EventTrace_record(EVENT_INTERRUPT, WAKE_ADC14);
+
     if(ADC14_getEnabledInterruptStatus() && ADC_INT0){
-        JoystickX_modified = true;
+        deviceJoystick->xModified = true;
+        InputTrace_recordJoystick(ADC14_getResult(ADC_MEM0), ADC14_getResult(ADC_MEM1));
+
+        // The conversion that first sees X past a threshold is the edge of a left or right tap
+        uint_fast16_t x = ADC14_getResult(ADC_MEM0);
+        bool xDeflected = x > RIGHT_THRESHOLD || x < LEFT_THRESHOLD;
+        if (xDeflected && !deviceJoystick->xDeflected)
+            Latency_markInput(LATENCY_JOYSTICK);
+        deviceJoystick->xDeflected = xDeflected;
     }
     ADC14_clearInterruptFlag(ADC_INT0);
 
@@ -103,16 +115,27 @@ void initJoyStick() {
 
 /**
  * Constructs a Joystick
- * Initializes the output FSMs.
+ * Initializes the output FSMs. The Joystick is constructed in place because the ADC
+ * interrupt keeps a pointer to it.
  *
  *
- * @return a constructed Joystick with debouncing and output FSMs initialized
+ * @param joystick_p:   The Joystick to construct, with debouncing and output FSMs initialized
  */
 
-Joystick Joystick_construct()
+void Joystick_construct(Joystick* joystick_p)
 {
-    // The Joystick object which will be returned at the end of construction
-    Joystick Joystick;
+    joystick_p->x = CENTER_READING;
+    joystick_p->y = CENTER_READING;
+    joystick_p->xModified = false;
+    joystick_p->xDeflected = false;
+    joystick_p->state = MIDDLE;
+    joystick_p->isTappedUp = false;
+    joystick_p->isTappedDown = false;
+    joystick_p->isTappedRight = false;
+    joystick_p->isTappedLeft = false;
+
+    // Bind the Joystick before its interrupt is enabled
+    deviceJoystick = joystick_p;
 
     initADC();
     initJoyStick();
@@ -124,9 +147,6 @@ Joystick Joystick_construct()
     // Initialize all buffered outputs of the Joystick
 //    Joystick.pushState = RELEASED;
 //    Joystick.isTapped = false;
-
-    // Return the constructed Joystick object to the user
-    return Joystick;
 }
 
 
@@ -138,15 +158,17 @@ Joystick Joystick_construct()
  */
 void Joystick_refresh(Joystick* joystick_p)
 {
-    if(JoystickX_modified){
+    SCOPE_TIMING_BEGIN(SCOPE_JOYSTICK_REFRESH);
+
+    if(joystick_p->xModified){
         joystick_p->x = ADC14_getResult(ADC_MEM0);
-        JoystickX_modified = false;
+        joystick_p->xModified = false;
     }
 
 
     joystick_p->y =ADC14_getResult(ADC_MEM1);
 
-    static JoystickDebounceState state = MIDDLE;
+    JoystickDebounceState state = joystick_p->state;
     joystick_p->isTappedUp = false;
     joystick_p->isTappedDown = false;
     joystick_p->isTappedLeft = false;
@@ -203,6 +225,9 @@ void Joystick_refresh(Joystick* joystick_p)
 
     }
 
+    joystick_p->state = state;
+
+    SCOPE_TIMING_END(SCOPE_JOYSTICK_REFRESH);
 }
 
 
@@ -9,12 +9,37 @@
 #define HAL_JOYSTICK_H_
 
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <HAL/Device.h>
+
+// The readings past which the joystick counts as pushed; the ADC reads 14 bits
+#define UP_THRESHOLD 12000
+#define DOWN_THRESHOLD 3000
+#define LEFT_THRESHOLD 3000
+#define RIGHT_THRESHOLD 12000
+
+// Which side of the thresholds of its axis a reading is on: 0 below low, 2 above high, 1 in
+// between. The Joystick only ever compares readings with the thresholds, so two readings in
+// the same zone act alike.
+#define JOYSTICK_ZONE(reading, low, high) \
+    ((reading) < (low) ? 0 : (reading) > (high) ? 2 : 1)
+
+enum _JoystickDebounceState {MIDDLE, UP, DOWN, RIGHT, LEFT};
+typedef enum _JoystickDebounceState JoystickDebounceState;
 
 struct _Joystick
 {
     uint_fast16_t x;
     uint_fast16_t y;
 
+    // Set by the ADC interrupt when a new X reading is available
+    volatile bool xModified;
+
+    // Set by the ADC interrupt while the X reading is past the left or right threshold
+    bool xDeflected;
+
+    // The state of the tap FSM
+    JoystickDebounceState state;
+
 
     bool isTappedUp;
     bool isTappedDown;
@@ -26,8 +51,8 @@ struct _Joystick
 };
 typedef struct _Joystick Joystick;
 
-/** Constructs a new Joystick object, given a valid port and pin. */
-Joystick Joystick_construct();
+/** Constructs a Joystick in place and starts the ADC that its interrupt reads from. */
+void Joystick_construct(Joystick* joystick_p);
 
 /** Given a Joystick, determines if the switch is currently pressed to left */
 bool Joystick_isPressedToLeft(Joystick* Joystick_p);
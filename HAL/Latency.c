@@ -0,0 +1,106 @@
+/*
+ * Latency.c
+ *
+ */
+
+#include <HAL/Latency.h>
+#include <HAL/Timer.h>
+#include <LcdDriver/HAL_MSP_EXP432P401R_Crystalfontz128x128_ST7735.h>
+
+#define CYCLES_IN_US    (SYSTEM_CLOCK / US_DIVISION_FACTOR)
+
+// The latencies of this device, bound by Latency_construct()
+static DEVICE_LOCAL Latency* deviceLatency;
+
+void Latency_construct(Latency* latency_p)
+{
+    int input, bucket;
+    for (input = 0; input < LATENCY_INPUT_COUNT; input++) {
+        LatencyHistogram* histogram_p = &latency_p->histograms[input];
+        for (bucket = 0; bucket < LATENCY_BUCKETS; bucket++)
+            histogram_p->buckets[bucket] = 0;
+        histogram_p->count = 0;
+        histogram_p->minCycles = UINT32_MAX;
+        histogram_p->maxCycles = 0;
+        histogram_p->totalCycles = 0;
+
+        latency_p->edgeCycles[input] = 0;
+        latency_p->pending[input] = false;
+        latency_p->drawn[input] = false;
+    }
+
+    deviceLatency = latency_p;
+}
+
+void Latency_markInput(LatencyInput input)
+{
+    deviceLatency->edgeCycles[input] = SystemTiming_cycles();
+    deviceLatency->pending[input] = true;
+}
+
+/**
+ * Adds the latency of an answer that has just reached the panel to the histogram of its input.
+ */
+static void Latency_stamp(Latency* latency_p, LatencyInput input)
+{
+    uint64_t elapsed = SystemTiming_cycles() - latency_p->answeredEdge[input];
+    uint32_t cycles = (elapsed > UINT32_MAX) ? UINT32_MAX : (uint32_t) elapsed;
+
+    // The bucket is the position of the highest set bit of the latency in us
+    uint32_t us = cycles / CYCLES_IN_US;
+    int bucket = 0;
+    while (us > 1 && bucket < LATENCY_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+
+    LatencyHistogram* histogram_p = &latency_p->histograms[input];
+    histogram_p->buckets[bucket]++;
+    histogram_p->count++;
+    histogram_p->totalCycles += cycles;
+    if (cycles < histogram_p->minCycles)
+        histogram_p->minCycles = cycles;
+    if (cycles > histogram_p->maxCycles)
+        histogram_p->maxCycles = cycles;
+}
+
+void Latency_markOutput(LatencyInput input)
+{
+    Latency* latency_p = deviceLatency;
+    if (!latency_p->pending[input])
+        return;
+    latency_p->pending[input] = false;
+
+    // The DMA interrupt must not stamp the answer as well, between the check and the arming
+    bool wasDisabled = Interrupt_disableMaster();
+    latency_p->answeredEdge[input] = latency_p->edgeCycles[input];
+    latency_p->fence[input] = HAL_LCD_fence();
+    latency_p->drawn[input] = !HAL_LCD_fenceReached(latency_p->fence[input]);
+    if (!latency_p->drawn[input])
+        Latency_stamp(latency_p, input);
+    if (!wasDisabled)
+        Interrupt_enableMaster();
+
+    HAL_LCD_flush();
+}
+
+void Latency_lcdProgress()
+{
+    // The LCD driver also runs on its own, without the HAL and so without histograms
+    Latency* latency_p = deviceLatency;
+    if (!latency_p)
+        return;
+
+    int input;
+    for (input = 0; input < LATENCY_INPUT_COUNT; input++) {
+        if (latency_p->drawn[input] && HAL_LCD_fenceReached(latency_p->fence[input])) {
+            latency_p->drawn[input] = false;
+            Latency_stamp(latency_p, (LatencyInput) input);
+        }
+    }
+}
+
+const LatencyHistogram* Latency_histogram(LatencyInput input)
+{
+    return &deviceLatency->histograms[input];
+}
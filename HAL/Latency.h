@@ -0,0 +1,75 @@
+/*
+ * Latency.h
+ *
+ * Input-to-photon latency: the time from the interrupt that saw an input edge to the moment
+ * the pixels that answer it are on the LCD. The port and ADC interrupt handlers stamp the
+ * edge; the game marks the answer right after the drawing calls return. Those return with
+ * their commands still in the display list, so the game only records a fence behind them and
+ * goes on. The LCD's DMA interrupt stamps the answer once the engine has sent up to the fence,
+ * which leaves at most the last byte or two on the SPI link, about 1 us.
+ * Each latency goes into a histogram with one bucket per power of two microseconds.
+ */
+
+#ifndef HAL_LATENCY_H_
+#define HAL_LATENCY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <HAL/Device.h>
+
+// Bucket b counts latencies from 2^b us up to 2^(b+1) us; the last one also counts longer ones
+#define LATENCY_BUCKETS     24
+
+// The inputs whose answers are timed
+enum _LatencyInput
+{
+    LATENCY_BB1,            // Feeding: the new energy value
+    LATENCY_JOYSTICK,       // A tap left or right: the pet in its new spot
+    LATENCY_INPUT_COUNT
+};
+typedef enum _LatencyInput LatencyInput;
+
+struct _LatencyHistogram
+{
+    uint32_t buckets[LATENCY_BUCKETS];
+    uint32_t count;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+};
+typedef struct _LatencyHistogram LatencyHistogram;
+
+// The edge each input is waiting to have answered, and the histograms
+struct _Latency
+{
+    volatile uint64_t edgeCycles[LATENCY_INPUT_COUNT];
+    volatile bool pending[LATENCY_INPUT_COUNT];
+
+    // The answers drawn but still in the display list: their edge and the fence behind them
+    volatile uint64_t answeredEdge[LATENCY_INPUT_COUNT];
+    volatile uint32_t fence[LATENCY_INPUT_COUNT];
+    volatile bool drawn[LATENCY_INPUT_COUNT];
+    LatencyHistogram histograms[LATENCY_INPUT_COUNT];
+};
+typedef struct _Latency Latency;
+
+// Constructs empty histograms in place; the interrupt handlers stamp into them from then on
+void Latency_construct(Latency* latency_p);
+
+// Stamps an input edge; called from the interrupt handler that sees it. A later edge of the
+// same input replaces one that was never answered.
+void Latency_markInput(LatencyInput input);
+
+// Marks the answer to the pending edge of an input as drawn. It is stamped once its pixels are
+// on the LCD, at once in direct mode, and otherwise from the LCD's DMA interrupt. A later
+// answer of the same input replaces one still in the display list.
+void Latency_markOutput(LatencyInput input);
+
+// Stamps the answers whose fence the display list engine has reached; called from its
+// interrupt each time the engine moves on
+void Latency_lcdProgress();
+
+// The histogram of an input on this device
+const LatencyHistogram* Latency_histogram(LatencyInput input);
+
+#endif /* HAL_LATENCY_H_ */
@@ -0,0 +1,108 @@
+/*
+ * PerfOverlay.c
+ *
+ */
+
+#include <stdio.h>
+#include <HAL/PerfOverlay.h>
+#include <HAL/WakeStats.h>
+#include <HAL/StackUsage.h>
+#include <HAL/Telemetry.h>
+#include <HAL/Uart.h>
+
+// One row of the 6x8 font across the 128-pixel panel
+#define PERF_OVERLAY_COLUMNS    21
+
+/**
+ * Starts a new period from the current time and counters.
+ */
+static void PerfOverlay_sample(PerfOverlay* overlay_p)
+{
+    const WakeStats* stats_p = WakeStats_counters();
+
+    overlay_p->cycles = SystemTiming_cycles();
+    overlay_p->sleepCycles = stats_p->sleepCycles;
+    overlay_p->passCycles = stats_p->passCycles;
+    overlay_p->passes = stats_p->passes;
+
+    overlay_p->wakes = 0;
+    int source;
+    for (source = 0; source < WAKE_SOURCE_COUNT; source++)
+        overlay_p->wakes += stats_p->wakes[source];
+
+    SWTimer_start(&overlay_p->timer);
+}
+
+PerfOverlay PerfOverlay_construct()
+{
+    PerfOverlay overlay;
+
+    overlay.shown = false;
+    overlay.timer = SWTimer_construct(PERF_OVERLAY_PERIOD);
+    PerfOverlay_sample(&overlay);
+
+    return overlay;
+}
+
+// Prints a row padded with spaces, so that it covers whatever the previous one left
+static void PerfOverlay_printRow(GFX* gfx_p, const char* text, int row)
+{
+    char buffer[PERF_OVERLAY_COLUMNS + 1];
+    snprintf(buffer, sizeof(buffer), "%-*.*s", PERF_OVERLAY_COLUMNS, PERF_OVERLAY_COLUMNS, text);
+    GFX_print(gfx_p, buffer, row, 0);
+}
+
+void PerfOverlay_toggle(PerfOverlay* overlay_p, GFX* gfx_p)
+{
+    overlay_p->shown = !overlay_p->shown;
+
+    // The figures show from the end of the period in progress
+    if (overlay_p->shown) {
+        PerfOverlay_printRow(gfx_p, "CPU --.-%  --- wk/s", PERF_OVERLAY_ROW);
+        PerfOverlay_printRow(gfx_p, "wake ------ stk ----", PERF_OVERLAY_ROW + 1);
+    }
+    else {
+        PerfOverlay_printRow(gfx_p, "", PERF_OVERLAY_ROW);
+        PerfOverlay_printRow(gfx_p, "", PERF_OVERLAY_ROW + 1);
+    }
+}
+
+bool PerfOverlay_refresh(PerfOverlay* overlay_p, GFX* gfx_p)
+{
+    if (!SWTimer_expired(&overlay_p->timer))
+        return false;
+
+    PerfOverlay before = *overlay_p;
+    PerfOverlay_sample(overlay_p);
+
+    uint64_t period = overlay_p->cycles - before.cycles;
+    uint64_t awake = period - (overlay_p->sleepCycles - before.sleepCycles);
+    uint32_t permille = (uint32_t) (awake * 1000 / period);
+    uint32_t wakes = overlay_p->wakes - before.wakes;
+    uint32_t wakesPerSecond = (uint32_t) ((uint64_t) wakes * SYSTEM_CLOCK / period);
+    uint32_t passes = overlay_p->passes - before.passes;
+    uint32_t cyclesPerWake =
+        passes ? (uint32_t) ((overlay_p->passCycles - before.passCycles) / passes) : 0;
+    uint32_t stackHighWater = StackUsage_highWater();
+
+    TelemetryPerf perf;
+    perf.ms = Telemetry_ms();
+    perf.awakePermille = (uint16_t) permille;
+    perf.wakesPerSecond = (uint16_t) (wakesPerSecond > UINT16_MAX ? UINT16_MAX : wakesPerSecond);
+    perf.cyclesPerWake = cyclesPerWake;
+    perf.stackHighWater = (uint16_t) (stackHighWater > UINT16_MAX ? UINT16_MAX : stackHighWater);
+    perf.droppedWrites = (uint16_t) (Uart_dropped() > UINT16_MAX ? UINT16_MAX : Uart_dropped());
+    Telemetry_send(TELEMETRY_PERF, &perf, sizeof(perf));
+
+    if (!overlay_p->shown)
+        return true;
+
+    char text[32];
+    snprintf(text, sizeof(text), "CPU %2u.%u%% %4u wk/s", (unsigned) (permille / 10),
+             (unsigned) (permille % 10), (unsigned) wakesPerSecond);
+    PerfOverlay_printRow(gfx_p, text, PERF_OVERLAY_ROW);
+    snprintf(text, sizeof(text), "wake %6u stk %4u", (unsigned) cyclesPerWake,
+             (unsigned) stackHighWater);
+    PerfOverlay_printRow(gfx_p, text, PERF_OVERLAY_ROW + 1);
+    return true;
+}
@@ -0,0 +1,52 @@
+/*
+ * PerfOverlay.h
+ *
+ * A two-line readout in the bottom-left corner of the LCD, below everything the screens draw:
+ * the share of time the CPU was awake (the rest it spent in LPM0), the wakes per second, and
+ * the system timer cycles an average wake took from leaving LPM0 to the end of its main_loop
+ * pass. The figures come from WakeStats and cover the second before each redraw. Next to them
+ * is the deepest the stack has been since boot, in bytes (StackUsage_highWater()).
+ *
+ * The overlay redraws at most once per PERF_OVERLAY_PERIOD, so it adds one short pass of text
+ * per second to what it measures. A screen change erases it until the next redraw.
+ *
+ * The figures are taken every period whether the overlay is shown or not, and each set also
+ * goes out as a TELEMETRY_PERF record (HAL/Telemetry.h).
+ */
+
+#ifndef HAL_PERFOVERLAY_H_
+#define HAL_PERFOVERLAY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <HAL/Graphics.h>
+#include <HAL/Timer.h>
+
+#define PERF_OVERLAY_PERIOD     1000    // ms between redraws
+#define PERF_OVERLAY_ROW        14      // The first of its two text rows
+
+struct _PerfOverlay
+{
+    bool shown;
+    SWTimer timer;
+
+    // The time and the WakeStats counters at the last redraw
+    uint64_t cycles;
+    uint64_t sleepCycles;
+    uint64_t passCycles;
+    uint32_t wakes;
+    uint32_t passes;
+};
+typedef struct _PerfOverlay PerfOverlay;
+
+// Constructs a hidden overlay and starts its first period
+PerfOverlay PerfOverlay_construct();
+
+// Shows the overlay if it is hidden, or erases it
+void PerfOverlay_toggle(PerfOverlay* overlay_p, GFX* gfx_p);
+
+// Takes the figures once a period has passed since the last time, sends them, and redraws the
+// overlay if it is shown. Returns whether it took them.
+bool PerfOverlay_refresh(PerfOverlay* overlay_p, GFX* gfx_p);
+
+#endif /* HAL_PERFOVERLAY_H_ */
@@ -0,0 +1,112 @@
+/*
+ * PostMortem.c
+ *
+ */
+
+#include <stddef.h>
+#include <string.h>
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <HAL/PostMortem.h>
+#include <HAL/WakeStats.h>
+#include <HAL/Telemetry.h>
+
+// The linker command file keeps .noinit out of the C start-up code's initialization
+#ifdef __TI_COMPILER_VERSION__
+#pragma DATA_SECTION(PostMortem_log, ".noinit")
+#endif
+DEVICE_LOCAL PostMortemLog PostMortem_log;
+
+/**
+ * CRC-16/CCITT (polynomial 0x1021, seed 0xFFFF), bit by bit; a table would cost 512 bytes of
+ * flash to speed up the ten bytes of the one entry each pass writes.
+ */
+static uint16_t PostMortem_crc(const void* data, size_t length)
+{
+    const uint8_t* byte_p = data;
+    uint16_t crc = 0xFFFF;
+
+    while (length--) {
+        crc ^= (uint16_t) *byte_p++ << 8;
+        int bit;
+        for (bit = 0; bit < 8; bit++)
+            crc = (crc & 0x8000) ? (uint16_t) ((crc << 1) ^ 0x1021) : (uint16_t) (crc << 1);
+    }
+    return crc;
+}
+
+static uint16_t PostMortem_headerCrc(const PostMortemLog* log_p)
+{
+    return PostMortem_crc(log_p, offsetof(PostMortemLog, crc));
+}
+
+bool PostMortem_valid(const PostMortemEntry* entry_p)
+{
+    return entry_p->crc == PostMortem_crc(entry_p, offsetof(PostMortemEntry, crc));
+}
+
+void PostMortem_construct()
+{
+    PostMortemLog* log_p = &PostMortem_log;
+
+    if (log_p->magic != POST_MORTEM_MAGIC || log_p->crc != PostMortem_headerCrc(log_p) ||
+        log_p->head >= POST_MORTEM_LENGTH) {
+        // Zeroed entries fail their CRC, so the ring reads as empty
+        memset(log_p, 0, sizeof(*log_p));
+        log_p->magic = POST_MORTEM_MAGIC;
+    }
+
+    log_p->boots++;
+    log_p->hardResets = ResetCtl_getHardResetSource();
+    log_p->softResets = ResetCtl_getSoftResetSource();
+    ResetCtl_clearHardResetSource(log_p->hardResets);
+    ResetCtl_clearSoftResetSource(log_p->softResets);
+    log_p->crc = PostMortem_headerCrc(log_p);
+}
+
+void PostMortem_record(uint8_t state, int spot)
+{
+    PostMortemLog* log_p = &PostMortem_log;
+    const WakeStats* stats_p = WakeStats_counters();
+    PostMortemEntry* entry_p = &log_p->entries[log_p->head];
+
+    entry_p->passCycles = stats_p->lastPassCycles;
+    entry_p->pass = (uint16_t) stats_p->passes;
+    entry_p->boot = (uint8_t) log_p->boots;
+    entry_p->source = (uint8_t) stats_p->lastSource;
+    entry_p->state = state;
+    entry_p->spot = (int8_t) spot;
+    entry_p->crc = PostMortem_crc(entry_p, offsetof(PostMortemEntry, crc));
+
+    log_p->head = (log_p->head + 1) % POST_MORTEM_LENGTH;
+}
+
+void PostMortem_sendReport()
+{
+    const PostMortemLog* log_p = &PostMortem_log;
+
+    TelemetryReset reset;
+    memset(&reset, 0, sizeof(reset));
+    reset.boots = log_p->boots;
+    reset.hardResets = log_p->hardResets;
+    reset.softResets = log_p->softResets;
+
+    // Only the runs before this boot have entries yet; the newest is the one before head
+    int n;
+    for (n = 1; n <= POST_MORTEM_LENGTH; n++) {
+        const PostMortemEntry* entry_p =
+            &log_p->entries[(log_p->head + POST_MORTEM_LENGTH - n) % POST_MORTEM_LENGTH];
+        if (!PostMortem_valid(entry_p))
+            continue;
+        if (reset.entries++ == 0) {
+            reset.lastPass = entry_p->pass;
+            reset.lastPassCycles = entry_p->passCycles;
+            reset.lastSource = entry_p->source;
+            reset.lastState = entry_p->state;
+            reset.lastSpot = entry_p->spot;
+        }
+        if (entry_p->passCycles > reset.longestPassCycles)
+            reset.longestPassCycles = entry_p->passCycles;
+    }
+
+    Telemetry_send(TELEMETRY_RESET, &reset, sizeof(reset));
+}
@@ -0,0 +1,76 @@
+/*
+ * PostMortem.h
+ *
+ * The last POST_MORTEM_LENGTH passes of main_loop, kept where a reset does not clear them. The
+ * log lives in the .noinit section, which msp432p401r.cmd places in SRAM_DATA as NOINIT: the
+ * C start-up code neither loads nor zeroes it, and SRAM keeps its contents through the warm
+ * resets (watchdog, reset button, SYSRESETREQ) that follow a hang or a fault. Nothing is
+ * written to flash.
+ *
+ * At boot, PostMortem_construct() checks the log's magic and the CRC of its header. If they
+ * hold, the entries of the runs before are kept and the new run appends to them; if not, as
+ * after a power-up, the log starts empty. Every entry carries its own CRC, so one that was
+ * being written when the reset came is ignored rather than misread. The header also records
+ * the reset controller's hard and soft reset sources of the latest boot.
+ *
+ * Read it with the debugger (PostMortem_log) after a reset, or from the RESET telemetry record
+ * (HAL/Telemetry.h) that sums it up at every boot.
+ */
+
+#ifndef HAL_POSTMORTEM_H_
+#define HAL_POSTMORTEM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <HAL/Device.h>
+
+#define POST_MORTEM_MAGIC       0x4D54524D      // "MRTM"
+
+// Entries in the ring (12 bytes each)
+#ifndef POST_MORTEM_LENGTH
+#define POST_MORTEM_LENGTH      32
+#endif
+
+struct _PostMortemEntry
+{
+    uint32_t passCycles;    // From the wake to the end of the pass
+    uint16_t pass;          // The pass's number since its boot, modulo 65536
+    uint8_t boot;           // The low byte of PostMortemLog.boots for the boot it ran in
+    uint8_t source;         // The WakeSource that started the pass
+    uint8_t state;          // The GameState at the end of the pass
+    int8_t spot;            // The pet's spot at the end of the pass
+    uint16_t crc;           // CRC-16 of the bytes above
+};
+typedef struct _PostMortemEntry PostMortemEntry;
+
+struct _PostMortemLog
+{
+    uint32_t magic;
+    uint32_t boots;         // Boots since the log was last started empty, this one included
+    uint32_t hardResets;    // ResetCtl_getHardResetSource() at the latest boot
+    uint32_t softResets;    // ResetCtl_getSoftResetSource() at the latest boot
+    uint16_t crc;           // CRC-16 of the fields above
+
+    // Where the next entry goes; not covered by the CRC, so only trusted below the length
+    volatile uint16_t head;
+
+    PostMortemEntry entries[POST_MORTEM_LENGTH];
+};
+typedef struct _PostMortemLog PostMortemLog;
+
+// The log, for the debugger and the host build
+extern DEVICE_LOCAL PostMortemLog PostMortem_log;
+
+// Validates the log, or starts it empty, and counts the boot; called first thing at boot
+void PostMortem_construct();
+
+// Records the pass of main_loop that just ended, after WakeStats_endPass()
+void PostMortem_record(uint8_t state, int spot);
+
+// Whether an entry is intact and belongs to the log
+bool PostMortem_valid(const PostMortemEntry* entry_p);
+
+// Sends the RESET telemetry record about the entries that survived from the runs before
+void PostMortem_sendReport();
+
+#endif /* HAL_POSTMORTEM_H_ */
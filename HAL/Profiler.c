@@ -0,0 +1,69 @@
+/*
+ * Profiler.c
+ *
+ */
+
+#include <HAL/Profiler.h>
+
+#ifdef PROFILER
+
+#include <string.h>
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <HAL/Timer.h>
+
+DEVICE_LOCAL Profile Profiler_profile;
+
+void Profiler_start(uint32_t sampleHz)
+{
+    memset(&Profiler_profile, 0, sizeof(Profiler_profile));
+    Profiler_profile.magic = PROFILER_MAGIC;
+    Profiler_profile.bucketShift = PROFILER_BUCKET_SHIFT;
+    Profiler_profile.bucketCount = PROFILER_BUCKETS;
+    Profiler_profile.sampleHz = sampleHz;
+
+    // The 24-bit SysTick counter runs on MCLK; at 48 MHz the slowest rate is about 3 Hz
+    SysTick_setPeriod(SYSTEM_CLOCK / sampleHz);
+    SysTick_enableInterrupt();
+    SysTick_enableModule();
+}
+
+void Profiler_pause()
+{
+    SysTick_disableModule();
+}
+
+void Profiler_resume()
+{
+    SysTick_enableModule();
+}
+
+void Profiler_sample(const uint32_t* frame)
+{
+    uint32_t pc = frame[6];
+    Profile* profile_p = &Profiler_profile;
+
+    profile_p->samples++;
+    if (pc < PROFILER_CODE_BYTES) {
+        uint16_t* bucket_p = &profile_p->buckets[pc >> PROFILER_BUCKET_SHIFT];
+        if (*bucket_p != 0xFFFF)
+            (*bucket_p)++;
+    }
+    else if (pc - PROFILER_ROM_BASE < PROFILER_ROM_BYTES)
+        profile_p->romSamples++;
+    else
+        profile_p->otherSamples++;
+}
+
+// The handler has to find the stacked frame before a prologue of its own moves the stack
+// pointer, so it is a naked tail call. The firmware never leaves the main stack. The host build
+// has no SysTick and feeds Profiler_sample() itself (host/profile_synth.c).
+#if defined(__TI_ARM__) || defined(__arm__)
+__attribute__((naked)) void SysTick_Handler(void)
+{
+    __asm volatile(
+        "    mov     r0, sp\n"
+        "    b       Profiler_sample\n");
+}
+#endif
+
+#endif
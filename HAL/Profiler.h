@@ -0,0 +1,73 @@
+/*
+ * Profiler.h
+ *
+ * A statistical profiler. SysTick interrupts the CPU at a fixed rate while it is awake, and its
+ * handler counts the program counter it interrupted in a histogram of the flash, one 16-bit
+ * counter per PROFILER_BUCKET_BYTES of code. Nothing has to be instrumented by hand: the
+ * spin loops in HAL_LCD_writeData() and the game logic show up in proportion to the active time
+ * they take, interrupt handlers included.
+ *
+ * Everything here compiles to nothing unless PROFILER is defined. With it, HAL_construct()
+ * starts sampling at PROFILER_HZ, and sleep() pauses the SysTick counter in LPM0 so that the
+ * profiler neither wakes the CPU nor counts idle time. To read the profile, halt the board,
+ * save the Profiler_profile structure from the debugger as raw binary, and pass it with the
+ * linker map to host/pc_profile.
+ */
+
+#ifndef HAL_PROFILER_H_
+#define HAL_PROFILER_H_
+
+#include <stdint.h>
+#include <HAL/Device.h>
+
+#define PROFILER_MAGIC          0x464F5250      // "PROF", little-endian
+#define PROFILER_HZ             2000
+
+// The histogram covers the start of the MAIN flash, where the linker puts .text. Raise
+// PROFILER_CODE_BYTES if host/pc_profile reports that the map's code ends past it.
+#define PROFILER_BUCKET_SHIFT   4
+#define PROFILER_BUCKET_BYTES   (1 << PROFILER_BUCKET_SHIFT)
+#define PROFILER_CODE_BYTES     0x8000
+#define PROFILER_BUCKETS        (PROFILER_CODE_BYTES >> PROFILER_BUCKET_SHIFT)
+
+// DriverLib functions called through ROM_ or MAP_ run from the ROM at this address
+#define PROFILER_ROM_BASE       0x02000000
+#define PROFILER_ROM_BYTES      0x00010000
+
+// The layout host/pc_profile reads; all fields are little-endian words or half-words
+struct _Profile
+{
+    uint32_t magic;
+    uint16_t bucketShift;
+    uint16_t bucketCount;
+    uint32_t sampleHz;
+    uint32_t samples;
+    uint32_t romSamples;            // PCs in the DriverLib ROM
+    uint32_t otherSamples;          // PCs past the histogram, in SRAM, or in the ROM bootcode
+    uint16_t buckets[PROFILER_BUCKETS];     // Saturate at 0xFFFF
+};
+typedef struct _Profile Profile;
+
+#ifdef PROFILER
+
+extern DEVICE_LOCAL Profile Profiler_profile;
+
+// Clears the profile and starts sampling at the given rate; needs the system clock to be set
+void Profiler_start(uint32_t sampleHz);
+
+// Stops and restarts the SysTick counter around LPM0; the count in progress carries over
+void Profiler_pause();
+void Profiler_resume();
+
+// Counts the sample in the exception frame SysTick_Handler stacked: R0-R3, R12, LR, PC, xPSR
+void Profiler_sample(const uint32_t* frame);
+
+#else
+
+#define Profiler_start(sampleHz)
+#define Profiler_pause()
+#define Profiler_resume()
+
+#endif
+
+#endif /* HAL_PROFILER_H_ */
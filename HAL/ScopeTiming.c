@@ -0,0 +1,41 @@
+/*
+ * ScopeTiming.c
+ *
+ */
+
+#include <HAL/ScopeTiming.h>
+
+#ifdef SCOPE_TIMING
+
+DEVICE_LOCAL ScopeStats ScopeTiming_stats[SCOPE_COUNT];
+
+const char* const ScopeTiming_names[SCOPE_COUNT] =
+{
+    "main_loop",
+    "updateButtons",
+    "Joystick_refresh",
+    "GFX_print",
+    "Graphics_fillCircle",
+    "Compositor_fillCircle",
+    "Crystalfontz128x128_RectFill",
+    "Crystalfontz128x128_SetDrawFrame",
+};
+
+void ScopeTiming_init()
+{
+    // A reset that keeps SRAM, or another device on the host, must not inherit the figures
+    int scope;
+    for (scope = 0; scope < SCOPE_COUNT; scope++) {
+        ScopeTiming_stats[scope].calls = 0;
+        ScopeTiming_stats[scope].minCycles = UINT32_MAX;
+        ScopeTiming_stats[scope].maxCycles = 0;
+        ScopeTiming_stats[scope].totalCycles = 0;
+    }
+
+    // The DWT only counts while trace is enabled in the debug monitor control register
+    CoreDebug->DEMCR |= CoreDebug_DEMCR_TRCENA_Msk;
+    DWT->CYCCNT = 0;
+    DWT->CTRL |= DWT_CTRL_CYCCNTENA_Msk;
+}
+
+#endif
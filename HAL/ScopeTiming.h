@@ -0,0 +1,77 @@
+/*
+ * ScopeTiming.h
+ *
+ * Cycle counts of the firmware's hot paths, read from the Cortex-M4 DWT cycle counter
+ * (CYCCNT). A scope is timed by bracketing it with SCOPE_TIMING_BEGIN() and SCOPE_TIMING_END()
+ * in the same block; each scope keeps its call count and its min, total and max cycles. Scopes
+ * include the scopes nested in them.
+ *
+ * Everything here compiles to nothing unless SCOPE_TIMING is defined, so the brackets stay in
+ * the code for good: define SCOPE_TIMING in the Debug build configuration and leave it out of
+ * Release. With it, a bracket costs two CYCCNT loads and a handful of adds and compares. The
+ * host build defines it, and its CYCCNT follows the simulated clock.
+ */
+
+#ifndef HAL_SCOPETIMING_H_
+#define HAL_SCOPETIMING_H_
+
+#include <stdint.h>
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <HAL/Device.h>
+
+// The timed scopes
+enum _Scope
+{
+    SCOPE_MAIN_LOOP,
+    SCOPE_UPDATE_BUTTONS,
+    SCOPE_JOYSTICK_REFRESH,
+    SCOPE_GFX_PRINT,
+    SCOPE_FILL_CIRCLE,          // Graphics_fillCircle(), timed where it is called
+    SCOPE_COMPOSE_CIRCLE,       // Compositor_fillCircle(), the pet, timed where it is called
+    SCOPE_RECT_FILL,            // Crystalfontz128x128_RectFill()
+    SCOPE_SET_DRAW_FRAME,       // Crystalfontz128x128_SetDrawFrame()
+    SCOPE_COUNT
+};
+typedef enum _Scope Scope;
+
+struct _ScopeStats
+{
+    uint32_t calls;
+    uint32_t minCycles;
+    uint32_t maxCycles;
+    uint64_t totalCycles;
+};
+typedef struct _ScopeStats ScopeStats;
+
+#ifdef SCOPE_TIMING
+
+// The statistics of this device, indexed by Scope
+extern DEVICE_LOCAL ScopeStats ScopeTiming_stats[SCOPE_COUNT];
+extern const char* const ScopeTiming_names[SCOPE_COUNT];
+
+// Clears the statistics and starts the cycle counter; called once the system clock is set
+void ScopeTiming_init();
+
+static inline void ScopeTiming_record(Scope scope, uint32_t cycles)
+{
+    ScopeStats* stats_p = &ScopeTiming_stats[scope];
+    if (stats_p->calls++ == 0 || cycles < stats_p->minCycles)
+        stats_p->minCycles = cycles;
+    if (cycles > stats_p->maxCycles)
+        stats_p->maxCycles = cycles;
+    stats_p->totalCycles += cycles;
+}
+
+// CYCCNT wraps every 89 s at 48 MHz; the unsigned difference is right for shorter scopes
+#define SCOPE_TIMING_BEGIN(scope)   uint32_t scope##_start = DWT->CYCCNT
+#define SCOPE_TIMING_END(scope)     ScopeTiming_record(scope, DWT->CYCCNT - scope##_start)
+
+#else
+
+#define ScopeTiming_init()
+#define SCOPE_TIMING_BEGIN(scope)
+#define SCOPE_TIMING_END(scope)
+
+#endif
+
+#endif /* HAL_SCOPETIMING_H_ */
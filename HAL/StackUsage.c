@@ -0,0 +1,35 @@
+/*
+ * StackUsage.c
+ *
+ */
+
+#include <HAL/StackUsage.h>
+
+void StackUsage_paint()
+{
+    // Everything below this function's frame is free, down to the bottom of the stack. The
+    // stores are volatile so that they stay a loop here rather than a call to memset().
+    volatile uint32_t here;
+    volatile uint32_t* word_p = STACK_USAGE_BOTTOM;
+    uintptr_t end = (uintptr_t) &here - STACK_USAGE_MARGIN * sizeof(uint32_t);
+
+    while ((uintptr_t) word_p < end)
+        *word_p++ = STACK_USAGE_PATTERN;
+}
+
+uint32_t StackUsage_highWater()
+{
+    const uint32_t* word_p = STACK_USAGE_BOTTOM;
+    const uint32_t* top_p = STACK_USAGE_TOP;
+
+    // The stack grows down, so the first overwritten word from the bottom is the deepest
+    while (word_p < top_p && *word_p == STACK_USAGE_PATTERN)
+        word_p++;
+
+    return (uint32_t) (top_p - word_p) * sizeof(uint32_t);
+}
+
+uint32_t StackUsage_size()
+{
+    return (uint32_t) (STACK_USAGE_TOP - STACK_USAGE_BOTTOM) * sizeof(uint32_t);
+}
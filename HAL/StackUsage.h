@@ -0,0 +1,41 @@
+/*
+ * StackUsage.h
+ *
+ * How deep the stack has ever been. HAL_construct() paints every free word of the stack with a
+ * known pattern before any interrupt is enabled; whatever the firmware pushes since overwrites
+ * it, so the lowest word that no longer holds the pattern marks the deepest the stack has gone,
+ * interrupt frames included. The stack is the .stack section of the linker (--stack_size in the
+ * CCS project), at the top of SRAM_DATA; host/sram_report lists what the rest of SRAM holds.
+ *
+ * The mark is exact only for pushes that change a word: a frame that happens to store the
+ * pattern itself goes unseen, which is one word in four billion.
+ */
+
+#ifndef HAL_STACKUSAGE_H_
+#define HAL_STACKUSAGE_H_
+
+#include <stdint.h>
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+
+#define STACK_USAGE_PATTERN     0xDEADBEEF
+
+// Words just below the painting function's frame that are left alone, for its own spills
+#define STACK_USAGE_MARGIN      32
+
+// The bounds of the stack, from the linker. The host build points them at its own stack.
+#ifndef STACK_USAGE_BOTTOM
+extern uint32_t __stack;
+extern uint32_t __STACK_END;
+#define STACK_USAGE_BOTTOM      (&__stack)
+#define STACK_USAGE_TOP         (&__STACK_END)
+#endif
+
+// Paints the free part of the stack; called first thing at boot, with interrupts still off
+void StackUsage_paint();
+
+// The most bytes of stack ever in use since the paint, and the size of the stack. A high water
+// mark equal to the size means the stack overflowed into whatever lies below it.
+uint32_t StackUsage_highWater();
+uint32_t StackUsage_size();
+
+#endif /* HAL_STACKUSAGE_H_ */
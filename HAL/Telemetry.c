@@ -0,0 +1,55 @@
+/*
+ * Telemetry.c
+ *
+ */
+
+#include <string.h>
+#include <HAL/Telemetry.h>
+#include <HAL/Uart.h>
+#include <HAL/Timer.h>
+#include <HAL/StackUsage.h>
+
+bool Telemetry_send(TelemetryType type, const void* payload, uint8_t length)
+{
+    uint8_t record[TELEMETRY_MAX_PAYLOAD + 4];
+    if (length > TELEMETRY_MAX_PAYLOAD)
+        return false;
+
+    record[0] = TELEMETRY_SYNC;
+    record[1] = type;
+    record[2] = length;
+    memcpy(&record[3], payload, length);
+
+    uint8_t sum = 0;
+    int i;
+    for (i = 1; i < length + 3; i++)
+        sum += record[i];
+    record[length + 3] = (uint8_t) -sum;
+
+    // One write, so that the record goes out whole or not at all
+    return Uart_write(record, length + 4);
+}
+
+uint32_t Telemetry_ms()
+{
+    return (uint32_t) (SystemTiming_cycles() / CLOCK_CYCLES_IN_MS);
+}
+
+void Telemetry_sendBoot()
+{
+    TelemetryBoot boot;
+    boot.clockHz = SYSTEM_CLOCK;
+    boot.version = TELEMETRY_VERSION;
+    boot.reserved = 0;
+    boot.stackBytes = StackUsage_size();
+    Telemetry_send(TELEMETRY_BOOT, &boot, sizeof(boot));
+}
+
+void Telemetry_sendScreen(uint8_t state)
+{
+    TelemetryScreen screen;
+    memset(&screen, 0, sizeof(screen));
+    screen.ms = Telemetry_ms();
+    screen.state = state;
+    Telemetry_send(TELEMETRY_SCREEN, &screen, sizeof(screen));
+}
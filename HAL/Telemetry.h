@@ -0,0 +1,95 @@
+/*
+ * Telemetry.h
+ *
+ * Binary records the firmware sends over the UART (HAL/Uart.h) for host/telemetry_decode. A
+ * record on the wire is
+ *
+ *   TELEMETRY_SYNC, type, length, payload (length bytes), checksum
+ *
+ * where the checksum makes type, length, payload and checksum add up to zero modulo 256. A
+ * reader that lost its place looks for the next SYNC whose record checks out. Payloads are
+ * the structures below, little-endian as on the MSP432, with no padding.
+ *
+ * A record is queued whole or not at all, and a record that does not fit in the UART's ring is
+ * lost: the next PERF record carries the count of lost writes.
+ */
+
+#ifndef HAL_TELEMETRY_H_
+#define HAL_TELEMETRY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define TELEMETRY_SYNC          0xA5
+#define TELEMETRY_VERSION       2
+#define TELEMETRY_MAX_PAYLOAD   32
+
+enum _TelemetryType
+{
+    TELEMETRY_BOOT = 1,     // TelemetryBoot, once the HAL is up
+    TELEMETRY_PERF,         // TelemetryPerf, once per PERF_OVERLAY_PERIOD
+    TELEMETRY_SCREEN,       // TelemetryScreen, on every screen change
+    TELEMETRY_RESET,        // TelemetryReset, after BOOT
+};
+typedef enum _TelemetryType TelemetryType;
+
+struct _TelemetryBoot
+{
+    uint32_t clockHz;       // SYSTEM_CLOCK
+    uint16_t version;       // TELEMETRY_VERSION
+    uint16_t reserved;
+    uint32_t stackBytes;    // StackUsage_size()
+};
+typedef struct _TelemetryBoot TelemetryBoot;
+
+// The performance overlay's figures for the period that just ended
+struct _TelemetryPerf
+{
+    uint32_t ms;                // Since boot
+    uint16_t awakePermille;     // Share of the period the CPU was out of LPM0
+    uint16_t wakesPerSecond;
+    uint32_t cyclesPerWake;     // From a wake to the end of its main_loop pass, on average
+    uint16_t stackHighWater;    // StackUsage_highWater()
+    uint16_t droppedWrites;     // Uart_dropped(), saturated
+};
+typedef struct _TelemetryPerf TelemetryPerf;
+
+struct _TelemetryScreen
+{
+    uint32_t ms;
+    uint8_t state;              // The new GameState
+    uint8_t reserved[3];
+};
+typedef struct _TelemetryScreen TelemetryScreen;
+
+// What the post-mortem log (HAL/PostMortem.h) kept from the runs before this boot
+struct _TelemetryReset
+{
+    uint32_t boots;             // Since the log was last started empty, this one included
+    uint32_t hardResets;        // The reset controller's sources of this boot
+    uint32_t softResets;
+    uint32_t lastPassCycles;    // The newest entry: the last pass before the reset
+    uint32_t longestPassCycles; // The longest pass of all the entries
+    uint16_t entries;           // Entries that passed their CRC; none after a power-up
+    uint16_t lastPass;
+    uint8_t lastSource;
+    uint8_t lastState;
+    int8_t lastSpot;
+    uint8_t reserved;
+};
+typedef struct _TelemetryReset TelemetryReset;
+
+// Frames a payload of up to TELEMETRY_MAX_PAYLOAD bytes and queues it on the UART; returns
+// false if the record was lost
+bool Telemetry_send(TelemetryType type, const void* payload, uint8_t length);
+
+// Sends the BOOT record
+void Telemetry_sendBoot();
+
+// Sends a SCREEN record for the given GameState
+void Telemetry_sendScreen(uint8_t state);
+
+// The milliseconds since boot, for the records' stamps
+uint32_t Telemetry_ms();
+
+#endif /* HAL_TELEMETRY_H_ */
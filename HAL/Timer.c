@@ -5,9 +5,14 @@
 
 #include <HAL/Timer.h>
 #include <HAL/LED.h>
+#include <HAL/WakeStats.h>
+#include <HAL/EventTrace.h>
 
-/** The reference counter which tracks how many rollovers have occurred. Used in timing SWTimers. */
-static volatile uint64_t hwTimerRollovers;
+/**
+ * The timing state of this device, bound by InitSystemTiming(). Its hwTimerRollovers is the
+ * reference counter which tracks how many rollovers have occurred. Used in timing SWTimers.
+ */
+static DEVICE_LOCAL SystemTiming* deviceTiming;
 
 /**
  * The ISR used to increment the total number of rollovers which have passed. When the
@@ -16,7 +21,9 @@ static volatile uint64_t hwTimerRollovers;
  */
 void T32_INT1_IRQHandler()
 {
-    hwTimerRollovers++;
+    WakeStats_interrupt(WAKE_T32_INT1);
+    EventTrace_record(EVENT_INTERRUPT, WAKE_T32_INT1);
+    deviceTiming->hwTimerRollovers++;
     Timer32_clearInterruptFlag(TIMER32_0_BASE);
 }
 
@@ -28,12 +35,18 @@ void T32_INT1_IRQHandler()
  * To change the system clock to different frequencies, use the #define on the SYSTEM_CLOCK in
  * Timer.h. DO NOT MODIFY THIS FUNCTION UNLESS YOU KNOW WHAT YOU ARE DOING. You can potentially
  * brick your board, which requires a factory reset to fix.
+ *
+ * @param timing_p:   The timing state the rollover interrupt and all software timers will use
  */
-void InitSystemTiming()
+void InitSystemTiming(SystemTiming* timing_p)
 {
     // Before initializing anything else, disable all interrupts
     Interrupt_disableMaster();
 
+    // Bind the timing state before the rollover interrupt is enabled
+    deviceTiming = timing_p;
+    deviceTiming->hwTimerRollovers = 0;
+
     // Before changing the clock frequency, we need to change the flash control to use 2 wait
     // states (2 delayed cycles per flash read). IF YOU DO NOT CHANGE YOUR FLASH CONTROL BEFORE
     // CALLING CS_setDCOFrequency(), YOU WILL BRICK YOUR BOARD AND WILL NEED TO PERFORM A
@@ -76,12 +89,37 @@ void InitSystemTiming()
     // Starts the main reference hardware timer and enables an interrupt which counts rollovers
     Timer32_startTimer(TIMER32_0_BASE, false);
 
-    hwTimerRollovers = 0;
+    deviceTiming->hwTimerRollovers = 0;
+}
+
+/**
+ * Returns the number of cycles TIMER32_0_BASE has counted since InitSystemTiming() started it.
+ * Safe to call from interrupt handlers: a rollover whose interrupt has not been serviced yet
+ * (because the caller is itself an ISR) is counted from the pending flag.
+ *
+ * @return the current system time in hardware timer cycles
+ */
+uint64_t SystemTiming_cycles()
+{
+    uint64_t rollovers;
+    uint32_t counter;
+
+    // Read until no rollover was serviced in between the two reads
+    do {
+        rollovers = deviceTiming->hwTimerRollovers;
+        counter = Timer32_getValue(TIMER32_0_BASE);
+    } while (rollovers != deviceTiming->hwTimerRollovers);
+
+    // A pending rollover wrapped the counter back to near LOADVALUE
+    if (Timer32_getInterruptStatus(TIMER32_0_BASE) && counter > LOADVALUE / 2)
+        rollovers++;
+
+    return rollovers * ((uint64_t) LOADVALUE + 1) + (LOADVALUE - counter);
 }
 
 /**
  * Constructs a new Software Timer, using a wait time in milliseconds. The timer uses the
- * hwTimerRollovers variable to keep track of its reference time, and is based off of time passing
+ * hwTimerRollovers counter to keep track of its reference time, and is based off of time passing
  * under the TIMER32_0_BASE. When first constructed, this timer is NOT conditioned to start. Before
  * any calls to SWTimer_expired(), SWTimer_elapsedTimeUS(), or SWTimer_percentElapsed(), you MUST
  * FIRST CALL the SWTimer_start() method.
@@ -95,6 +133,9 @@ SWTimer SWTimer_construct(uint64_t waitTime_ms)
 
     timer.startCounter = 0;
     timer.startRollovers = 0;
+#ifdef EVENT_TRACE
+    timer.expiryTraced = false;
+#endif
 
     uint64_t counterClock = SYSTEM_CLOCK / PRESCALER;
     uint64_t cyclesPerMillisecond = counterClock / MS_DIVISION_FACTOR;
@@ -112,7 +153,10 @@ SWTimer SWTimer_construct(uint64_t waitTime_ms)
 void SWTimer_start(SWTimer* timer_p)
 {
     timer_p->startCounter = Timer32_getValue(TIMER32_0_BASE);
-    timer_p->startRollovers = hwTimerRollovers;
+    timer_p->startRollovers = deviceTiming->hwTimerRollovers;
+#ifdef EVENT_TRACE
+    timer_p->expiryTraced = false;
+#endif
 }
 
 /**
@@ -127,7 +171,7 @@ void SWTimer_start(SWTimer* timer_p)
  */
 uint64_t SWTimer_elapsedCycles(SWTimer* timer_p)
 {
-    uint64_t rollovers = hwTimerRollovers - timer_p->startRollovers;
+    uint64_t rollovers = deviceTiming->hwTimerRollovers - timer_p->startRollovers;
     uint64_t startCounter = timer_p->startCounter;
     uint64_t currentCounter = Timer32_getValue(TIMER32_0_BASE);
     uint64_t elapsedCycles = (rollovers * (LOADVALUE + 1)) + startCounter - currentCounter;
@@ -144,7 +188,16 @@ uint64_t SWTimer_elapsedCycles(SWTimer* timer_p)
 bool SWTimer_expired(SWTimer* timer_p)
 {
     uint64_t elapsedCycles = SWTimer_elapsedCycles(timer_p);
-    return elapsedCycles >= timer_p->cyclesToWait;
+    bool expired = elapsedCycles >= timer_p->cyclesToWait;
+
+#ifdef EVENT_TRACE
+    if (expired && !timer_p->expiryTraced) {
+        EventTrace_record(EVENT_TIMER_EXPIRED, timer_p->cyclesToWait / CLOCK_CYCLES_IN_MS);
+        timer_p->expiryTraced = true;
+    }
+#endif
+
+    return expired;
 }
 
 
@@ -7,6 +7,7 @@
 #define HAL_TIMER_H_
 
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <HAL/Device.h>
 
 #define MS_DIVISION_FACTOR  1000        // Number of milliseconds in one second
 #define US_DIVISION_FACTOR  1000000     // Number of microseconds in one second
@@ -43,6 +44,11 @@ struct _SWTimer
 
     // The starting rollover value of the hardware timer, set when the timer is started
     uint32_t startRollovers;
+
+#ifdef EVENT_TRACE
+    // Whether the event trace has seen the timer expire since it was started
+    bool expiryTraced;
+#endif
 };
 typedef struct _SWTimer SWTimer;
 
@@ -59,9 +65,19 @@ uint64_t SWTimer_elapsedCycles(SWTimer* timer_p);
 // Determines if the timer has expired - i.e. if enough time has passed since the timer was started
 bool SWTimer_expired(SWTimer* timer_p);
 
+// The reference hardware timer's state: the number of rollovers counted by its interrupt
+struct _SystemTiming
+{
+    volatile uint64_t hwTimerRollovers;
+};
+typedef struct _SystemTiming SystemTiming;
+
 // Initializes the global clock system for the MSP432, as well as a hardware
 // timer under which all of the software timers are based.
-void InitSystemTiming();
+void InitSystemTiming(SystemTiming* timing_p);
+
+// Returns the number of hardware timer cycles since InitSystemTiming() started the timer
+uint64_t SystemTiming_cycles();
 
 // Initializes and starts a hardware timer (the second available Timer32)
 void startHWTimer(uint32_t waitTime_ms);
@@ -0,0 +1,99 @@
+/*
+ * Uart.c
+ *
+ */
+
+#include <string.h>
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <HAL/Uart.h>
+#include <HAL/WakeStats.h>
+#include <HAL/EventTrace.h>
+
+#define UART_TX_MASK            (UART_TX_CAPACITY - 1)
+
+// The UART of this device, bound by Uart_construct()
+static DEVICE_LOCAL Uart* deviceUart;
+
+/**
+ * Sends the next byte of the ring, or turns the transmit interrupt off once the ring is empty.
+ * The interrupt runs whenever the transmit buffer is empty and the interrupt is enabled.
+ */
+void EUSCIA0_IRQHandler()
+{
+    WakeStats_interrupt(WAKE_EUSCIA0);
+    EventTrace_record(EVENT_INTERRUPT, WAKE_EUSCIA0);
+
+    Uart* uart_p = deviceUart;
+    uint16_t tail = uart_p->tail;
+    if (tail == uart_p->head) {
+        UART_disableInterrupt(EUSCI_A0_BASE, EUSCI_A_UART_TRANSMIT_INTERRUPT);
+        return;
+    }
+
+    // The byte leaves the ring before it goes out, so the ring is consistent if the transmit
+    // buffer empties again at once
+    uint8_t byte = uart_p->ring[tail];
+    uart_p->tail = (tail + 1) & UART_TX_MASK;
+    UART_transmitData(EUSCI_A0_BASE, byte);
+}
+
+void Uart_construct(Uart* uart_p)
+{
+    uart_p->head = 0;
+    uart_p->tail = 0;
+    uart_p->dropped = 0;
+    deviceUart = uart_p;
+
+    // 115200 baud from the 48 MHz SMCLK, with 16x oversampling: 48 MHz / 115200 = 416.67, so
+    // UCBR = 26, UCBRF = 0 and UCBRS = 0x6F (the driverlib baud rate calculator's values)
+    const eUSCI_UART_ConfigV1 config =
+    {
+        EUSCI_A_UART_CLOCKSOURCE_SMCLK,
+        26,
+        0,
+        0x6F,
+        EUSCI_A_UART_NO_PARITY,
+        EUSCI_A_UART_LSB_FIRST,
+        EUSCI_A_UART_ONE_STOP_BIT,
+        EUSCI_A_UART_MODE,
+        EUSCI_A_UART_OVERSAMPLING_BAUDRATE_GENERATION,
+        EUSCI_A_UART_8_BIT_LEN
+    };
+
+    // P1.2 and P1.3 are the backchannel's RX and TX
+    GPIO_setAsPeripheralModuleFunctionInputPin(GPIO_PORT_P1, GPIO_PIN2 | GPIO_PIN3,
+                                               GPIO_PRIMARY_MODULE_FUNCTION);
+    UART_initModule(EUSCI_A0_BASE, &config);
+    UART_enableModule(EUSCI_A0_BASE);
+
+    // The transmit interrupt stays off in the module until there is something to send
+    Interrupt_enableInterrupt(INT_EUSCIA0);
+}
+
+bool Uart_write(const void* data, uint16_t length)
+{
+    Uart* uart_p = deviceUart;
+    uint16_t head = uart_p->head;
+    uint16_t used = (head - uart_p->tail) & UART_TX_MASK;
+    if (length > UART_TX_MASK - used) {
+        uart_p->dropped++;
+        return false;
+    }
+
+    // At most two copies, the second one when the write wraps around the end of the ring
+    uint16_t first = UART_TX_CAPACITY - head;
+    if (first > length)
+        first = length;
+    memcpy(&uart_p->ring[head], data, first);
+    memcpy(uart_p->ring, (const uint8_t*) data + first, length - first);
+
+    // Publish the bytes, then make sure the handler is sending them
+    uart_p->head = (head + length) & UART_TX_MASK;
+    UART_enableInterrupt(EUSCI_A0_BASE, EUSCI_A_UART_TRANSMIT_INTERRUPT);
+    return true;
+}
+
+uint32_t Uart_dropped()
+{
+    return deviceUart->dropped;
+}
@@ -0,0 +1,48 @@
+/*
+ * Uart.h
+ *
+ * The transmit side of eUSCI_A0 in UART mode, which the Launchpad's debug probe carries to the
+ * PC as its backchannel serial port (115200 baud, 8N1). Uart_write() copies bytes into a RAM
+ * ring buffer and returns at once; EUSCIA0_IRQHandler() sends them one at a time as the
+ * transmit buffer empties, and turns its interrupt off when the ring runs dry. The firmware
+ * never waits on the UART: when the ring is too full for a whole write, the write is dropped
+ * and counted instead.
+ *
+ * The ring has one writer, the main loop, and one reader, the interrupt handler, so head is
+ * only ever changed by Uart_write() and tail only by the handler, and neither needs a lock.
+ * Writes from interrupt handlers are not supported.
+ */
+
+#ifndef HAL_UART_H_
+#define HAL_UART_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <HAL/Device.h>
+
+#define UART_BAUD_RATE          115200
+
+// Bytes the ring holds, less one; a power of two
+#ifndef UART_TX_CAPACITY
+#define UART_TX_CAPACITY        256
+#endif
+
+struct _Uart
+{
+    uint8_t ring[UART_TX_CAPACITY];
+    volatile uint16_t head;         // Where the next write goes
+    volatile uint16_t tail;         // The next byte to send
+    uint32_t dropped;               // Writes that did not fit
+};
+typedef struct _Uart Uart;
+
+// Constructs an empty ring in place and sets up eUSCI_A0 and its pins
+void Uart_construct(Uart* uart_p);
+
+// Queues length bytes for sending, all of them or none; returns false if they did not fit
+bool Uart_write(const void* data, uint16_t length);
+
+// The number of writes this device dropped because the ring was full
+uint32_t Uart_dropped();
+
+#endif /* HAL_UART_H_ */
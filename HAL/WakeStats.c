@@ -0,0 +1,117 @@
+/*
+ * WakeStats.c
+ *
+ */
+
+#include <HAL/WakeStats.h>
+#include <HAL/Timer.h>
+
+// The counters of this device, bound by WakeStats_construct()
+static DEVICE_LOCAL WakeStats* deviceWakeStats;
+
+void WakeStats_construct(WakeStats* stats_p)
+{
+    int source;
+    for (source = 0; source < WAKE_SOURCE_COUNT; source++) {
+        stats_p->interrupts[source] = 0;
+        stats_p->wakes[source] = 0;
+        stats_p->uselessWakes[source] = 0;
+    }
+    stats_p->passes = 0;
+    stats_p->sleepCycles = 0;
+    stats_p->passCycles = 0;
+    stats_p->lastPassCycles = 0;
+    stats_p->sleeping = false;
+    stats_p->wokenBy = 0;
+    stats_p->lastSource = WAKE_T32_INT1;
+
+    deviceWakeStats = stats_p;
+}
+
+/**
+ * Charges the wake that just ended a sleep to its source and closes the time spent in LPM0.
+ */
+static void WakeStats_woke(WakeStats* stats_p, WakeSource source)
+{
+    uint64_t now = SystemTiming_cycles();
+
+    stats_p->sleeping = false;
+    stats_p->wakes[source]++;
+    stats_p->lastSource = source;
+    stats_p->sleepCycles += now - stats_p->sleepStart;
+    stats_p->wakeStart = now;
+}
+
+void WakeStats_sleep()
+{
+    WakeStats* stats_p = deviceWakeStats;
+    stats_p->sleepStart = SystemTiming_cycles();
+    stats_p->sleeping = true;
+    stats_p->wokenBy = 0;
+}
+
+void WakeStats_wake()
+{
+    WakeStats* stats_p = deviceWakeStats;
+    if (stats_p->sleeping)
+        WakeStats_woke(stats_p, WAKE_OTHER);
+}
+
+bool WakeStats_sleepAgain()
+{
+    // A wake that no handler claimed goes on to the pass, as does any foreground handler.
+    // The sources are not cleared, so a foreground handler that runs between this check and
+    // the WFI still gets its pass after the next wake
+    WakeStats* stats_p = deviceWakeStats;
+    uint32_t wokenBy = stats_p->wokenBy;
+    if (!wokenBy || (wokenBy & ~WAKE_BACKGROUND_SOURCES))
+        return false;
+
+    stats_p->sleepStart = SystemTiming_cycles();
+    stats_p->sleeping = true;
+    return true;
+}
+
+void WakeStats_beginWait()
+{
+    WakeStats* stats_p = deviceWakeStats;
+    if (stats_p)
+        stats_p->waitStart = SystemTiming_cycles();
+}
+
+void WakeStats_endWait()
+{
+    WakeStats* stats_p = deviceWakeStats;
+    if (stats_p)
+        stats_p->sleepCycles += SystemTiming_cycles() - stats_p->waitStart;
+}
+
+void WakeStats_interrupt(WakeSource source)
+{
+    // The LCD driver also runs on its own, without the HAL and so without counters
+    // (host/lcd_bench); its DMA interrupt still comes through here
+    WakeStats* stats_p = deviceWakeStats;
+    if (!stats_p)
+        return;
+    stats_p->interrupts[source]++;
+    stats_p->wokenBy |= 1u << source;
+
+    // Handlers do not preempt each other, so the first one after sleep() is the wake source
+    if (stats_p->sleeping)
+        WakeStats_woke(stats_p, source);
+}
+
+void WakeStats_endPass(bool useful)
+{
+    WakeStats* stats_p = deviceWakeStats;
+    stats_p->passes++;
+    stats_p->lastPassCycles = (uint32_t) (SystemTiming_cycles() - stats_p->wakeStart);
+    stats_p->passCycles += stats_p->lastPassCycles;
+    if (!useful)
+        stats_p->uselessWakes[stats_p->lastSource]++;
+}
+
+const WakeStats* WakeStats_counters()
+{
+    return deviceWakeStats;
+}
@@ -0,0 +1,90 @@
+/*
+ * WakeStats.h
+ *
+ * Why the CPU wakes up. Every interrupt handler counts its runs, and the first one to run after
+ * sleep() enters LPM0 is counted as the source of that wake. After each pass of main_loop the
+ * game reports whether the pass did anything: a pass that changed nothing in the application
+ * and sent nothing to the LCD is a useless wake, charged to the source that caused it.
+ *
+ * The counters also keep the time spent in LPM0 and the time from each wake to the end of its
+ * pass, in system timer cycles, from which the CPU duty cycle and the cost of a pass follow.
+ * A pass may itself wait in LPM0, for the LCD's DMA: that time counts as sleep, but it neither
+ * ends the pass nor starts a wake.
+ *
+ * Some handlers finish their work on their own and never need main_loop: the LCD's DMA takes
+ * the next step of the display list from its interrupt, and the UART sends the next byte of
+ * its ring. When only those ran, sleep() goes straight back to LPM0, so such a wake counts as
+ * a wake but not as a pass.
+ */
+
+#ifndef HAL_WAKESTATS_H_
+#define HAL_WAKESTATS_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <HAL/Device.h>
+
+// The interrupts that wake the CPU
+enum _WakeSource
+{
+    WAKE_T32_INT1,          // Timer32 rollover of the system timing
+    WAKE_ADC14,             // End of a joystick conversion
+    WAKE_PORT1,             // LB1, LB2
+    WAKE_PORT3,             // BB2
+    WAKE_PORT4,             // JSB
+    WAKE_PORT5,             // BB1
+    WAKE_EUSCIA0,           // The UART's transmit buffer emptied
+    WAKE_DMA_INT0,          // A DMA transfer to the LCD finished
+    WAKE_OTHER,             // A wake that none of the handlers above claimed
+    WAKE_SOURCE_COUNT
+};
+typedef enum _WakeSource WakeSource;
+
+// The sources whose handlers never need a pass of main_loop after them
+#define WAKE_BACKGROUND_SOURCES     ((1u << WAKE_EUSCIA0) | (1u << WAKE_DMA_INT0))
+
+struct _WakeStats
+{
+    volatile uint32_t interrupts[WAKE_SOURCE_COUNT];    // Every run of each handler
+    volatile uint32_t wakes[WAKE_SOURCE_COUNT];         // Runs that ended a sleep
+    uint32_t uselessWakes[WAKE_SOURCE_COUNT];           // Wakes after which nothing happened
+    uint32_t passes;
+
+    volatile uint64_t sleepCycles;      // Time in LPM0, from sleep() to the wake
+    uint64_t passCycles;                // Time from each wake to the end of its pass
+    uint32_t lastPassCycles;            // The same for the latest pass alone
+
+    volatile bool sleeping;
+    volatile uint32_t wokenBy;          // The sources whose handlers ran since sleep(), a bit each
+    volatile WakeSource lastSource;
+    uint64_t sleepStart;
+    uint64_t waitStart;
+    volatile uint64_t wakeStart;
+};
+typedef struct _WakeStats WakeStats;
+
+// Constructs zeroed counters in place; the interrupt handlers count into them from then on
+void WakeStats_construct(WakeStats* stats_p);
+
+// The CPU is about to enter LPM0, or has just left it; called by sleep() around PCM_gotoLPM0()
+void WakeStats_sleep();
+void WakeStats_wake();
+
+// Whether only background handlers ran since sleep(); if so the CPU counts as asleep again,
+// and sleep() goes back to LPM0 rather than waking main_loop
+bool WakeStats_sleepAgain();
+
+// The CPU is about to wait in LPM0 within a pass, or has just stopped waiting
+void WakeStats_beginWait();
+void WakeStats_endWait();
+
+// Counts a run of an interrupt handler; called first thing in the handler
+void WakeStats_interrupt(WakeSource source);
+
+// Ends a pass of main_loop that did (useful) or did not change anything
+void WakeStats_endPass(bool useful);
+
+// The counters of this device
+const WakeStats* WakeStats_counters();
+
+#endif /* HAL_WAKESTATS_H_ */
@@ -40,80 +40,202 @@
 #include "Crystalfontz128x128_ST7735.h"
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
 #include "HAL_MSP_EXP432P401R_Crystalfontz128x128_ST7735.h"
+#include "LcdCapture.h"
+#include <HAL/ScopeTiming.h>
+#include <HAL/EventTrace.h>
 #include <stdint.h>
 
-uint8_t Lcd_Orientation;
-uint16_t Lcd_ScreenWidth, Lcd_ScreenHeigth;
-uint8_t Lcd_PenSolid, Lcd_FontSolid, Lcd_FlagRead;
-uint16_t Lcd_TouchTrim;
+#ifdef LCD_FRAME_BUFFER
+
+//*****************************************************************************
+//
+// The frame buffer of a panel keeps each pixel high byte first, the order the
+// panel takes it in, so a row goes out of SRAM to the SPI as it is.  The
+// rectangles drawn since the last flush are kept merged into a few windows.
+//
+//*****************************************************************************
+
+// A 5-6-5 color as the frame buffer holds it, on the little-endian Cortex-M4
+#define LCD_FRAME_COLOR(color)  ((uint16_t) (((color) >> 8) | ((color) << 8)))
+
+// Pixels a window costs on the wire: CM_CASET, CM_RASET and CM_RAMWR with
+// their 8 parameter bytes are worth about 6 pixels of data
+#define LCD_WINDOW_PIXELS       6
+
+static int32_t Crystalfontz128x128_area(const Graphics_Rectangle *rect_p)
+{
+    return (int32_t) (rect_p->sXMax - rect_p->sXMin + 1) *
+           (rect_p->sYMax - rect_p->sYMin + 1);
+}
+
+static Graphics_Rectangle Crystalfontz128x128_union(const Graphics_Rectangle *a_p,
+                                                    const Graphics_Rectangle *b_p)
+{
+    Graphics_Rectangle rect;
+    rect.sXMin = (a_p->sXMin < b_p->sXMin) ? a_p->sXMin : b_p->sXMin;
+    rect.sYMin = (a_p->sYMin < b_p->sYMin) ? a_p->sYMin : b_p->sYMin;
+    rect.sXMax = (a_p->sXMax > b_p->sXMax) ? a_p->sXMax : b_p->sXMax;
+    rect.sYMax = (a_p->sYMax > b_p->sYMax) ? a_p->sYMax : b_p->sYMax;
+    return rect;
+}
+
+//*****************************************************************************
+//
+// Adds a rectangle to the ones the next flush sends.  It is merged with every
+// dirty rectangle whose union with it costs no more on the wire than sending
+// both; when all LCD_DIRTY_RECTS are taken, with the one it grows least.
+//
+//*****************************************************************************
+static void Crystalfontz128x128_markDirty(Crystalfontz128x128 *lcd_p,
+                                          int16_t x0, int16_t y0,
+                                          int16_t x1, int16_t y1)
+{
+    Graphics_Rectangle rect = { x0, y0, x1, y1 };
+    uint8_t i = 0;
+
+    while (i < lcd_p->dirtyCount)
+    {
+        Graphics_Rectangle both = Crystalfontz128x128_union(&rect, &lcd_p->dirty[i]);
+        if (Crystalfontz128x128_area(&both) <= Crystalfontz128x128_area(&rect) +
+            Crystalfontz128x128_area(&lcd_p->dirty[i]) + LCD_WINDOW_PIXELS)
+        {
+            // The merged rectangle may now be worth merging with one already passed
+            rect = both;
+            lcd_p->dirty[i] = lcd_p->dirty[--lcd_p->dirtyCount];
+            i = 0;
+        }
+        else
+            i++;
+    }
+
+    if (lcd_p->dirtyCount == LCD_DIRTY_RECTS)
+    {
+        uint8_t best = 0;
+        int32_t bestGrowth = INT32_MAX;
+        for (i = 0; i < lcd_p->dirtyCount; i++)
+        {
+            Graphics_Rectangle both = Crystalfontz128x128_union(&rect, &lcd_p->dirty[i]);
+            int32_t growth = Crystalfontz128x128_area(&both) -
+                             Crystalfontz128x128_area(&lcd_p->dirty[i]);
+            if (growth < bestGrowth)
+            {
+                best = i;
+                bestGrowth = growth;
+            }
+        }
+        rect = Crystalfontz128x128_union(&rect, &lcd_p->dirty[best]);
+        lcd_p->dirty[best] = lcd_p->dirty[--lcd_p->dirtyCount];
+    }
+
+    lcd_p->dirty[lcd_p->dirtyCount++] = rect;
+}
+
+static void Crystalfontz128x128_frameFill(Crystalfontz128x128 *lcd_p,
+                                          int16_t x0, int16_t y0,
+                                          int16_t x1, int16_t y1,
+                                          uint16_t ulValue)
+{
+    uint16_t color = LCD_FRAME_COLOR(ulValue);
+    int16_t x, y;
+
+    Crystalfontz128x128_markDirty(lcd_p, x0, y0, x1, y1);
+    for (y = y0; y <= y1; y++)
+        for (x = x0; x <= x1; x++)
+            lcd_p->frame[y][x] = color;
+}
+
+#endif
 
 //*****************************************************************************
 //
 //! Initializes the display driver.
 //!
+//! \param lcd_p is the panel state to initialize.
+//! \param display_p is the display structure to fill in for the panel; pass
+//! it to Graphics_initContext() along with g_sCrystalfontz128x128_funcs.
+//!
 //! This function initializes the ST7735 display controller on the panel,
 //! preparing it to display data.
 //!
 //! \return None.
 //
 //*****************************************************************************
-void Crystalfontz128x128_Init(void)
+void Crystalfontz128x128_Init(Crystalfontz128x128 *lcd_p,
+                              Graphics_Display *display_p)
 {
+    LCD_CAPTURE_RECORD(LCD_CAPTURE_ENTRY(LCD_ENTRY_INIT));
+    EventTrace_record(EVENT_LCD_BEGIN, LCD_ENTRY_INIT);
+
     HAL_LCD_PortInit();
-    HAL_LCD_SpiInit();
+    HAL_LCD_SpiInit(&lcd_p->link);
 
     GPIO_setOutputLowOnPin(LCD_RST_PORT, LCD_RST_PIN);
     HAL_LCD_delay(50);
     GPIO_setOutputHighOnPin(LCD_RST_PORT, LCD_RST_PIN);
     HAL_LCD_delay(120);
 
+    static const uint8_t gamset[] = { 0x04 };
+    static const uint8_t setpwctr[] = { 0x0A, 0x14 };
+    static const uint8_t setstba[] = { 0x0A, 0x00 };
+    static const uint8_t colmod[] = { 0x05 };
+    static const uint8_t madctl[] = { CM_MADCTL_BGR };
+
     HAL_LCD_writeCommand(CM_SLPOUT);
+    HAL_LCD_waitIdle();
     HAL_LCD_delay(200);
 
-    HAL_LCD_writeCommand(CM_GAMSET);
-    HAL_LCD_writeData(0x04);
-
-    HAL_LCD_writeCommand(CM_SETPWCTR);
-    HAL_LCD_writeData(0x0A);
-    HAL_LCD_writeData(0x14);
-
-    HAL_LCD_writeCommand(CM_SETSTBA);
-    HAL_LCD_writeData(0x0A);
-    HAL_LCD_writeData(0x00);
-
-    HAL_LCD_writeCommand(CM_COLMOD);
-    HAL_LCD_writeData(0x05);
+    HAL_LCD_writeCommandData(CM_GAMSET, gamset, sizeof(gamset));
+    HAL_LCD_writeCommandData(CM_SETPWCTR, setpwctr, sizeof(setpwctr));
+    HAL_LCD_writeCommandData(CM_SETSTBA, setstba, sizeof(setstba));
+    HAL_LCD_writeCommandData(CM_COLMOD, colmod, sizeof(colmod));
+    HAL_LCD_waitIdle();
     HAL_LCD_delay(10);
 
-    HAL_LCD_writeCommand(CM_MADCTL);
-    HAL_LCD_writeData(CM_MADCTL_BGR);
+    HAL_LCD_writeCommandData(CM_MADCTL, madctl, sizeof(madctl));
 
     HAL_LCD_writeCommand(CM_NORON);
 
-    Lcd_ScreenWidth  = LCD_VERTICAL_MAX;
-    Lcd_ScreenHeigth = LCD_HORIZONTAL_MAX;
-    Lcd_PenSolid  = 0;
-    Lcd_FontSolid = 1;
-    Lcd_FlagRead  = 0;
-    Lcd_TouchTrim = 0;
+    lcd_p->screenWidth  = LCD_VERTICAL_MAX;
+    lcd_p->screenHeigth = LCD_HORIZONTAL_MAX;
+    lcd_p->penSolid  = 0;
+    lcd_p->fontSolid = 1;
+    lcd_p->flagRead  = 0;
+    lcd_p->touchTrim = 0;
+
+    display_p->size = sizeof(Graphics_Display);
+    display_p->displayData = lcd_p;
+    display_p->width = LCD_VERTICAL_MAX;
+    display_p->heigth = LCD_HORIZONTAL_MAX;
 
-    Crystalfontz128x128_SetDrawFrame(0, 0, 127, 127);
+    Crystalfontz128x128_SetDrawFrame(lcd_p, 0, 0, 127, 127);
     HAL_LCD_writeCommand(CM_RAMWR);
-    int i;
-    for (i = 0; i < 16384; i++)
+    HAL_LCD_fillColor(0xFFFF, 16384);
+
+#ifdef LCD_FRAME_BUFFER
+    // The frame buffer starts out like the panel, all white and sent
     {
-        HAL_LCD_writeData(0xFF);
-        HAL_LCD_writeData(0xFF);
+        uint16_t *pixel_p = &lcd_p->frame[0][0];
+        uint16_t i;
+        for (i = 0; i < LCD_HORIZONTAL_MAX * LCD_VERTICAL_MAX; i++)
+            *pixel_p++ = 0xFFFF;
+        lcd_p->dirtyCount = 0;
     }
+#endif
 
+    HAL_LCD_waitIdle();
     HAL_LCD_delay(10);
     HAL_LCD_writeCommand(CM_DISPON);
+    EventTrace_record(EVENT_LCD_END, LCD_ENTRY_INIT);
 }
 
 
-void Crystalfontz128x128_SetDrawFrame(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1)
+void Crystalfontz128x128_SetDrawFrame(const Crystalfontz128x128 *lcd_p,
+                                      uint16_t x0, uint16_t y0,
+                                      uint16_t x1, uint16_t y1)
 {
-    switch (Lcd_Orientation) {
+    SCOPE_TIMING_BEGIN(SCOPE_SET_DRAW_FRAME);
+
+    switch (lcd_p->orientation) {
         case 0:
             x0 += 2;
             y0 += 3;
@@ -142,17 +264,12 @@ void Crystalfontz128x128_SetDrawFrame(uint16_t x0, uint16_t y0, uint16_t x1, uin
             break;
     }
 
-    HAL_LCD_writeCommand(CM_CASET);
-    HAL_LCD_writeData((uint8_t)(x0 >> 8));
-    HAL_LCD_writeData((uint8_t)(x0));
-    HAL_LCD_writeData((uint8_t)(x1 >> 8));
-    HAL_LCD_writeData((uint8_t)(x1));
-
-    HAL_LCD_writeCommand(CM_RASET);
-    HAL_LCD_writeData((uint8_t)(y0 >> 8));
-    HAL_LCD_writeData((uint8_t)(y0));
-    HAL_LCD_writeData((uint8_t)(y1 >> 8));
-    HAL_LCD_writeData((uint8_t)(y1));
+    uint8_t columns[4] = { x0 >> 8, x0, x1 >> 8, x1 };
+    uint8_t rows[4] = { y0 >> 8, y0, y1 >> 8, y1 };
+
+    HAL_LCD_writeWindow(columns, rows);
+
+    SCOPE_TIMING_END(SCOPE_SET_DRAW_FRAME);
 }
 
 
@@ -160,6 +277,7 @@ void Crystalfontz128x128_SetDrawFrame(uint16_t x0, uint16_t y0, uint16_t x1, uin
 //
 //! Sets the LCD Orientation.
 //!
+//! \param lcd_p is the panel to reorient.
 //! \param orientation is the desired orientation for the LCD. Valid values are:
 //!           - \b LCD_ORIENTATION_UP,
 //!           - \b LCD_ORIENTATION_LEFT,
@@ -171,11 +289,15 @@ void Crystalfontz128x128_SetDrawFrame(uint16_t x0, uint16_t y0, uint16_t x1, uin
 //! \return None.
 //
 //*****************************************************************************
-void Crystalfontz128x128_SetOrientation(uint8_t orientation)
+void Crystalfontz128x128_SetOrientation(Crystalfontz128x128 *lcd_p,
+                                        uint8_t orientation)
 {
-    Lcd_Orientation = orientation;
+    LCD_CAPTURE_RECORD(LCD_CAPTURE_ENTRY(LCD_ENTRY_SET_ORIENTATION));
+    EventTrace_record(EVENT_LCD_BEGIN, LCD_ENTRY_SET_ORIENTATION);
+
+    lcd_p->orientation = orientation;
     HAL_LCD_writeCommand(CM_MADCTL);
-    switch (Lcd_Orientation) {
+    switch (lcd_p->orientation) {
         case LCD_ORIENTATION_UP:
             HAL_LCD_writeData(CM_MADCTL_MX | CM_MADCTL_MY | CM_MADCTL_BGR);
             break;
@@ -189,6 +311,7 @@ void Crystalfontz128x128_SetOrientation(uint8_t orientation)
             HAL_LCD_writeData(CM_MADCTL_MX | CM_MADCTL_MV | CM_MADCTL_BGR);
             break;
     }
+    EventTrace_record(EVENT_LCD_END, LCD_ENTRY_SET_ORIENTATION);
 }
 
 
@@ -213,15 +336,21 @@ static void Crystalfontz128x128_PixelDraw(const Graphics_Display *pDisplay,
                                           int16_t lY,
                                           uint16_t ulValue)
 {
+    LCD_CAPTURE_RECORD(LCD_CAPTURE_ENTRY(LCD_ENTRY_PIXEL_DRAW));
+    EventTrace_record(EVENT_LCD_BEGIN, LCD_ENTRY_PIXEL_DRAW);
 
-    Crystalfontz128x128_SetDrawFrame(lX,lY,lX,lY);
+#ifdef LCD_FRAME_BUFFER
+    Crystalfontz128x128_frameFill(pDisplay->displayData, lX, lY, lX, lY, ulValue);
+#else
+    Crystalfontz128x128_SetDrawFrame(pDisplay->displayData, lX,lY,lX,lY);
 
     //
     // Write the pixel value.
     //
     HAL_LCD_writeCommand(CM_RAMWR);
-    HAL_LCD_writeData(ulValue>>8);
-    HAL_LCD_writeData(ulValue);
+    HAL_LCD_writeColor(ulValue, 1);
+#endif
+    EventTrace_record(EVENT_LCD_END, LCD_ENTRY_PIXEL_DRAW);
 }
 
 
@@ -261,10 +390,72 @@ static void Crystalfontz128x128_PixelDrawMultiple(const Graphics_Display *pDispl
 {
     uint16_t Data;
 
+    LCD_CAPTURE_RECORD(LCD_CAPTURE_ENTRY(LCD_ENTRY_PIXEL_DRAW_MULTIPLE));
+    EventTrace_record(EVENT_LCD_BEGIN, LCD_ENTRY_PIXEL_DRAW_MULTIPLE);
+
+#ifdef LCD_FRAME_BUFFER
+    //
+    // Translate the pixels into the row of the frame buffer.
+    //
+    if(lCount > 0)
+    {
+        uint16_t *pixel_p =
+            &((Crystalfontz128x128 *) pDisplay->displayData)->frame[lY][lX];
+
+        Crystalfontz128x128_markDirty(pDisplay->displayData,
+                                      lX, lY, lX + lCount - 1, lY);
+        switch(lBPP)
+        {
+            case 1:
+                pucData += lX0 >> 3;
+                lX0 &= 7;
+                while(lCount--)
+                {
+                    Data = pucPalette[(*pucData >> (7 - lX0)) & 1];
+                    *pixel_p++ = LCD_FRAME_COLOR(Data);
+                    if(++lX0 == 8)
+                    {
+                        lX0 = 0;
+                        pucData++;
+                    }
+                }
+                break;
+
+            case 4:
+                lX0 &= 1;
+                while(lCount--)
+                {
+                    Data = pucPalette[(*pucData >> (lX0 ? 0 : 4)) & 15];
+                    *pixel_p++ = LCD_FRAME_COLOR(Data);
+                    if(lX0)
+                        pucData++;
+                    lX0 ^= 1;
+                }
+                break;
+
+            case 8:
+                while(lCount--)
+                {
+                    Data = pucPalette[*pucData++];
+                    *pixel_p++ = LCD_FRAME_COLOR(Data);
+                }
+                break;
+
+            case 16:
+                while(lCount--)
+                {
+                    Data = *((uint16_t *)pucData);
+                    pucData += 2;
+                    *pixel_p++ = LCD_FRAME_COLOR(Data);
+                }
+                break;
+        }
+    }
+#else
     //
     // Set the cursor increment to left to right, followed by top to bottom.
     //
-    Crystalfontz128x128_SetDrawFrame(lX,lY,lX+lCount,127);
+    Crystalfontz128x128_SetDrawFrame(pDisplay->displayData, lX,lY,lX+lCount,127);
     HAL_LCD_writeCommand(CM_RAMWR);
 
     //
@@ -276,24 +467,11 @@ static void Crystalfontz128x128_PixelDrawMultiple(const Graphics_Display *pDispl
         // The pixel data is in 1 bit per pixel format
         case 1:
         {
-            // Loop while there are more pixels to draw
-            while(lCount > 0)
+            // Draw the pixels in the two pre-translated colors of the palette
+            if(lCount > 0)
             {
-                // Get the next byte of image data
-                Data = *pucData++;
-
-                // Loop through the pixels in this byte of image data
-                for(; (lX0 < 8) && lCount; lX0++, lCount--)
-                {
-                    // Draw this pixel in the appropriate color
-                    HAL_LCD_writeData((((uint32_t *)pucPalette)[(Data >>
-                                                             (7 - lX0)) & 1])>>8);
-                    HAL_LCD_writeData(((uint32_t *)pucPalette)[(Data >>
-                                                             (7 - lX0)) & 1]);
-                }
-
-                // Start at the beginning of the next byte of image data
-                lX0 = 0;
+                HAL_LCD_writeBits(pucData, lX0, lCount, pucPalette[0],
+                                  pucPalette[1]);
             }
             // The image data has been drawn
 
@@ -321,8 +499,7 @@ static void Crystalfontz128x128_PixelDrawMultiple(const Graphics_Display *pDispl
                         Data = (*pucData >> 4);
                         Data = (*(uint16_t *)(pucPalette + Data));
                         // Write to LCD screen
-                        HAL_LCD_writeData(Data>>8);
-                        HAL_LCD_writeData(Data);
+                        HAL_LCD_writeColor(Data, 1);
 
                         // Decrement the count of pixels to draw
                         lCount--;
@@ -337,8 +514,7 @@ static void Crystalfontz128x128_PixelDrawMultiple(const Graphics_Display *pDispl
                             Data = (*pucData++ & 15);
                             Data = (*(uint16_t *)(pucPalette + Data));
                             // Write to LCD screen
-                            HAL_LCD_writeData(Data>>8);
-                            HAL_LCD_writeData(Data);
+                            HAL_LCD_writeColor(Data, 1);
 
                             // Decrement the count of pixels to draw
                             lCount--;
@@ -361,8 +537,7 @@ static void Crystalfontz128x128_PixelDrawMultiple(const Graphics_Display *pDispl
                 Data = *pucData++;
                 Data = (*(uint16_t *)(pucPalette + Data));
                 // Write to LCD screen
-                HAL_LCD_writeData(Data>>8);
-                HAL_LCD_writeData(Data);
+                HAL_LCD_writeColor(Data, 1);
             }
             // The image data has been drawn
             break;
@@ -388,11 +563,12 @@ static void Crystalfontz128x128_PixelDrawMultiple(const Graphics_Display *pDispl
                 pucData += 2;
 
                 // Translate this palette entry and write it to the screen
-                HAL_LCD_writeData(usData>>8);
-                HAL_LCD_writeData(usData);
+                HAL_LCD_writeColor(usData, 1);
             }
         }
     }
+#endif
+    EventTrace_record(EVENT_LCD_END, LCD_ENTRY_PIXEL_DRAW_MULTIPLE);
 }
 
 
@@ -419,20 +595,21 @@ static void Crystalfontz128x128_LineDrawH(const Graphics_Display *pDisplay,
                                           int16_t lY,
                                           uint16_t ulValue)
 {
+    LCD_CAPTURE_RECORD(LCD_CAPTURE_ENTRY(LCD_ENTRY_LINE_DRAW_H));
+    EventTrace_record(EVENT_LCD_BEGIN, LCD_ENTRY_LINE_DRAW_H);
 
-
-    Crystalfontz128x128_SetDrawFrame(lX1, lY, lX2, lY);
+#ifdef LCD_FRAME_BUFFER
+    Crystalfontz128x128_frameFill(pDisplay->displayData, lX1, lY, lX2, lY, ulValue);
+#else
+    Crystalfontz128x128_SetDrawFrame(pDisplay->displayData, lX1, lY, lX2, lY);
 
     //
     // Write the pixel value.
     //
-    int16_t i;
     HAL_LCD_writeCommand(CM_RAMWR);
-    for (i = lX1; i <= lX2; i++)
-    {
-        HAL_LCD_writeData(ulValue>>8);
-        HAL_LCD_writeData(ulValue);
-    }
+    HAL_LCD_writeColor(ulValue, lX2 - lX1 + 1);
+#endif
+    EventTrace_record(EVENT_LCD_END, LCD_ENTRY_LINE_DRAW_H);
 }
 
 
@@ -459,18 +636,21 @@ static void Crystalfontz128x128_LineDrawV(const Graphics_Display *pDisplay,
                                           int16_t lY2,
                                           uint16_t ulValue)
 {
-    Crystalfontz128x128_SetDrawFrame(lX, lY1, lX, lY2);
+    LCD_CAPTURE_RECORD(LCD_CAPTURE_ENTRY(LCD_ENTRY_LINE_DRAW_V));
+    EventTrace_record(EVENT_LCD_BEGIN, LCD_ENTRY_LINE_DRAW_V);
+
+#ifdef LCD_FRAME_BUFFER
+    Crystalfontz128x128_frameFill(pDisplay->displayData, lX, lY1, lX, lY2, ulValue);
+#else
+    Crystalfontz128x128_SetDrawFrame(pDisplay->displayData, lX, lY1, lX, lY2);
 
     //
     // Write the pixel value.
     //
-    int16_t i;
     HAL_LCD_writeCommand(CM_RAMWR);
-    for (i = lY1; i <= lY2; i++)
-    {
-        HAL_LCD_writeData(ulValue>>8);
-        HAL_LCD_writeData(ulValue);
-    }
+    HAL_LCD_writeColor(ulValue, lY2 - lY1 + 1);
+#endif
+    EventTrace_record(EVENT_LCD_END, LCD_ENTRY_LINE_DRAW_V);
 }
 
 
@@ -500,19 +680,25 @@ static void Crystalfontz128x128_RectFill(const Graphics_Display *pDisplay,
     int16_t y0 = pRect->sYMin;
     int16_t y1 = pRect->sYMax;
 
-    Crystalfontz128x128_SetDrawFrame(x0, y0, x1, y1);
+    LCD_CAPTURE_RECORD(LCD_CAPTURE_ENTRY(LCD_ENTRY_RECT_FILL));
+    EventTrace_record(EVENT_LCD_BEGIN, LCD_ENTRY_RECT_FILL);
+    SCOPE_TIMING_BEGIN(SCOPE_RECT_FILL);
+
+#ifdef LCD_FRAME_BUFFER
+    Crystalfontz128x128_frameFill(pDisplay->displayData, x0, y0, x1, y1, ulValue);
+#else
+    Crystalfontz128x128_SetDrawFrame(pDisplay->displayData, x0, y0, x1, y1);
 
     //
-    // Write the pixel value.
+    // Write the pixel value, exactly once per pixel of the frame.
     //
-    int16_t i;
-    int16_t pixels = (x1 - x0 + 1) * (y1 - y0 + 1);
+    uint16_t pixels = (x1 - x0 + 1) * (y1 - y0 + 1);
     HAL_LCD_writeCommand(CM_RAMWR);
-    for (i = 0; i <= pixels; i++)
-    {
-        HAL_LCD_writeData(ulValue>>8);
-        HAL_LCD_writeData(ulValue);
-    }
+    HAL_LCD_fillColor(ulValue, pixels);
+#endif
+
+    SCOPE_TIMING_END(SCOPE_RECT_FILL);
+    EventTrace_record(EVENT_LCD_END, LCD_ENTRY_RECT_FILL);
 }
 
 //*****************************************************************************
@@ -553,8 +739,12 @@ static uint32_t Crystalfontz128x128_ColorTranslate(const Graphics_Display *pDisp
 //!
 //! This functions flushes any cached drawing operations to the display.  This
 //! is useful when a local frame buffer is used for drawing operations, and the
-//! flush would copy the local frame buffer to the display.  For the SSD2119
-//! driver, the flush is a no operation.
+//! flush would copy the local frame buffer to the display.  Built with
+//! LCD_FRAME_BUFFER, the driver draws into one, and the flush sends each dirty
+//! rectangle as a window whose rows the display list takes straight from the
+//! frame buffer.  Either way, in deferred mode the drawing calls leave their
+//! commands in the display list, and the flush starts sending them;
+//! HAL_LCD_finish() waits until they are on the panel.
 //!
 //! \return None.
 //
@@ -562,9 +752,39 @@ static uint32_t Crystalfontz128x128_ColorTranslate(const Graphics_Display *pDisp
 static void
 Crystalfontz128x128_Flush(const Graphics_Display *pDisplay)
 {
-    //
-    // There is nothing to be done.
-    //
+#ifdef LCD_FRAME_BUFFER
+    Crystalfontz128x128 *lcd_p = pDisplay->displayData;
+    uint8_t i;
+    int16_t y;
+
+    LCD_CAPTURE_RECORD(LCD_CAPTURE_ENTRY(LCD_ENTRY_FLUSH));
+    EventTrace_record(EVENT_LCD_BEGIN, LCD_ENTRY_FLUSH);
+
+    for (i = 0; i < lcd_p->dirtyCount; i++)
+    {
+        const Graphics_Rectangle *rect_p = &lcd_p->dirty[i];
+        uint16_t width = rect_p->sXMax - rect_p->sXMin + 1;
+
+        Crystalfontz128x128_SetDrawFrame(lcd_p,
+                                         rect_p->sXMin, rect_p->sYMin,
+                                         rect_p->sXMax, rect_p->sYMax);
+        HAL_LCD_writeCommand(CM_RAMWR);
+
+        // Rows as wide as the panel follow each other in the frame buffer
+        if (width == LCD_VERTICAL_MAX)
+        {
+            HAL_LCD_writeSpan((const uint8_t *) lcd_p->frame[rect_p->sYMin],
+                              2 * width * (rect_p->sYMax - rect_p->sYMin + 1));
+            continue;
+        }
+        for (y = rect_p->sYMin; y <= rect_p->sYMax; y++)
+            HAL_LCD_writeSpan((const uint8_t *) &lcd_p->frame[y][rect_p->sXMin], 2 * width);
+    }
+    lcd_p->dirtyCount = 0;
+
+    EventTrace_record(EVENT_LCD_END, LCD_ENTRY_FLUSH);
+#endif
+    HAL_LCD_flush();
 }
 
 
@@ -586,24 +806,13 @@ Crystalfontz128x128_ClearScreen (const Graphics_Display *pDisplay,
                                  uint16_t ulValue)
 {
     Graphics_Rectangle rect = { 0, 0, LCD_VERTICAL_MAX-1, LCD_VERTICAL_MAX-1};
+    LCD_CAPTURE_RECORD(LCD_CAPTURE_ENTRY(LCD_ENTRY_CLEAR_SCREEN));
+    EventTrace_record(EVENT_LCD_BEGIN, LCD_ENTRY_CLEAR_SCREEN);
     Crystalfontz128x128_RectFill(pDisplay, &rect, ulValue);
+    EventTrace_record(EVENT_LCD_END, LCD_ENTRY_CLEAR_SCREEN);
 }
 
 
-//*****************************************************************************
-//
-//! The display structure that describes the driver for the Kitronix
-//! K350QVG-V1-F TFT panel with an SSD2119 controller.
-//
-//*****************************************************************************
-Graphics_Display g_sCrystalfontz128x128 =
-{
-    sizeof(Graphics_Display),
-    0,
-    LCD_VERTICAL_MAX,
-    LCD_HORIZONTAL_MAX,
-};
-
 const Graphics_Display_Functions g_sCrystalfontz128x128_funcs =
 {
     Crystalfontz128x128_PixelDraw,
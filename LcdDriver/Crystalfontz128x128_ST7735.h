@@ -43,11 +43,20 @@
 #include <stdint.h>
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
 #include <ti/grlib/grlib.h>
+#include "HAL_MSP_EXP432P401R_Crystalfontz128x128_ST7735.h"
 
 // LCD Screen Dimensions
 #define LCD_VERTICAL_MAX                   128
 #define LCD_HORIZONTAL_MAX                 128
 
+// Defining LCD_FRAME_BUFFER makes the driver draw into a frame buffer in SRAM
+// instead of on the panel, and send the rectangles that changed, merged into
+// at most LCD_DIRTY_RECTS windows, when grlib flushes (Graphics_flushBuffer).
+// The 32 KB frame buffer is part of the panel's state.
+#ifndef LCD_DIRTY_RECTS
+#define LCD_DIRTY_RECTS                    8
+#endif
+
 #define LCD_ORIENTATION_UP    0
 #define LCD_ORIENTATION_LEFT  1
 #define LCD_ORIENTATION_DOWN  2
@@ -92,20 +101,42 @@
 #define CM_MADCTL_BGR      0x08
 #define CM_MADCTL_MH       0x04
 
-extern uint8_t Lcd_Orientation;
-extern uint16_t Lcd_ScreenWidth, Lcd_ScreenHeigth;
-extern uint8_t Lcd_PenSolid, Lcd_FontSolid, Lcd_FlagRead;
-extern uint16_t Lcd_TouchTrim;
-
-extern Graphics_Display g_sCrystalfontz128x128;
+//*****************************************************************************
+//
+// The state of one panel. Every driver call takes the panel it acts on, and
+// the display callbacks find it through the displayData of the
+// Graphics_Display that Crystalfontz128x128_Init() fills in. The link to the
+// panel is part of it too, but the HAL_LCD_* calls drive the link that was
+// initialized last, so a device drives one panel at a time.
+//
+//*****************************************************************************
+typedef struct _Crystalfontz128x128
+{
+    uint8_t orientation;
+    uint16_t screenWidth, screenHeigth;
+    uint8_t penSolid, fontSolid, flagRead;
+    uint16_t touchTrim;
+    HAL_LCD_Link link;
+#ifdef LCD_FRAME_BUFFER
+    // What the panel shows once it is flushed, row by row in grlib's
+    // coordinates, and the rectangles drawn since the last flush
+    uint16_t frame[LCD_HORIZONTAL_MAX][LCD_VERTICAL_MAX];
+    Graphics_Rectangle dirty[LCD_DIRTY_RECTS];
+    uint8_t dirtyCount;
+#endif
+} Crystalfontz128x128;
 
 extern const Graphics_Display_Functions g_sCrystalfontz128x128_funcs;
 
-extern void Crystalfontz128x128_Init(void);
+extern void Crystalfontz128x128_Init(Crystalfontz128x128 *lcd_p,
+                                     Graphics_Display *display_p);
 
-extern void Crystalfontz128x128_SetDrawFrame(uint16_t x0, uint16_t y0, uint16_t x1, uint16_t y1);
+extern void Crystalfontz128x128_SetDrawFrame(const Crystalfontz128x128 *lcd_p,
+                                             uint16_t x0, uint16_t y0,
+                                             uint16_t x1, uint16_t y1);
 
-extern void Crystalfontz128x128_SetOrientation(uint8_t orientation);
+extern void Crystalfontz128x128_SetOrientation(Crystalfontz128x128 *lcd_p,
+                                               uint8_t orientation);
 
 
 
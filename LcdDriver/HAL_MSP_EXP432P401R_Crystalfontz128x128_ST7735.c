@@ -38,9 +38,57 @@
 //*****************************************************************************
 
 #include "HAL_MSP_EXP432P401R_Crystalfontz128x128_ST7735.h"
+#include "Crystalfontz128x128_ST7735.h"
+#include "LcdCapture.h"
 #include <ti/grlib/grlib.h>
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <stdbool.h>
 #include <stdint.h>
+#include <string.h>
+#include <HAL/Device.h>
+#include <HAL/EventTrace.h>
+#include <HAL/Latency.h>
+#include <HAL/Profiler.h>
+#include <HAL/WakeStats.h>
+
+// The link that the HAL_LCD_* calls and DMA_INT0_IRQHandler act on, bound by HAL_LCD_SpiInit()
+static DEVICE_LOCAL HAL_LCD_Link *lcdLink;
+
+// The DMA controller's channel control table, which has to be aligned to its size. It belongs
+// to the controller rather than to a link. Only the primary structure of LCD_DMA_CHANNEL is
+// used. A misaligned table makes the controller fetch garbage control words, so a compiler
+// that cannot align it is rejected.
+#if defined(__TI_COMPILER_VERSION__)
+#pragma DATA_ALIGN(lcdDmaControlTable, 1024)
+#define LCD_DMA_TABLE_ALIGN
+#elif defined(__GNUC__)
+#define LCD_DMA_TABLE_ALIGN __attribute__((aligned(1024)))
+#else
+#error "Align lcdDmaControlTable to 1024 bytes for this compiler"
+#endif
+static DEVICE_LOCAL uint8_t lcdDmaControlTable[1024] LCD_DMA_TABLE_ALIGN;
+
+#define LCD_LIST_MASK         (LCD_LIST_SIZE - 1)
+
+// The records of the display list: an opcode, then its operands, with colors high byte first
+enum _LcdListOp
+{
+    LCD_OP_COMMAND,         // command
+    LCD_OP_WINDOW,          // CASET's 4 parameters, RASET's 4 parameters
+    LCD_OP_FILL,            // color, pixel count (low byte first)
+    LCD_OP_RUN,             // byte count, the bytes
+    LCD_OP_GLYPH,           // color of 0 bits, color of 1 bits, first bit, pixel count, the bits
+    LCD_OP_SPAN             // address of the bytes, byte count (low byte first)
+};
+
+#define LCD_WINDOW_LENGTH     9
+#define LCD_FILL_LENGTH       5
+#define LCD_RUN_HEADER        2
+#define LCD_GLYPH_HEADER      7
+#define LCD_SPAN_LENGTH       (3 + sizeof(const uint8_t *))
+
+// Most bytes of a run, and most pixels of a glyph, in one record
+#define LCD_RECORD_MAX        255
 
 void HAL_LCD_PortInit(void)
 {
@@ -56,8 +104,12 @@ void HAL_LCD_PortInit(void)
     GPIO_setAsOutputPin(LCD_CS_PORT, LCD_CS_PIN);
 }
 
-void HAL_LCD_SpiInit(void)
+void HAL_LCD_SpiInit(HAL_LCD_Link *link_p)
 {
+    lcdLink = link_p;
+    lcdLink->commandCount = 0;
+    lcdLink->listStalls = 0;
+
     eUSCI_SPI_MasterConfig config =
         {
             EUSCI_B_SPI_CLOCKSOURCE_SMCLK,
@@ -74,31 +126,173 @@ void HAL_LCD_SpiInit(void)
     GPIO_setOutputLowOnPin(LCD_CS_PORT, LCD_CS_PIN);
 
     GPIO_setOutputHighOnPin(LCD_DC_PORT, LCD_DC_PIN);
+    lcdLink->dataMode = true;
+
+    // Fills and staged records: bytes into TXBUF every time TXIFG is set. The table starts
+    // clear, as .bss does on the board, also for a device that follows another on its thread.
+    memset(lcdDmaControlTable, 0, sizeof(lcdDmaControlTable));
+    DMA_enableModule();
+    DMA_setControlBase(lcdDmaControlTable);
+    DMA_assignChannel(LCD_DMA_TRIGGER);
+    DMA_disableChannelAttribute(LCD_DMA_TRIGGER, UDMA_ATTR_ALL);
+    DMA_clearInterruptFlag(LCD_DMA_CHANNEL);
+    DMA_enableInterrupt(INT_DMA_INT0);
+    // DMA_enableInterrupt() only routes channels to INT1-3; the NVIC line is separate
+    Interrupt_enableInterrupt(INT_DMA_INT0);
+    lcdLink->dmaRemaining = 0;
+    lcdLink->dmaBusy = false;
+
+    // The driver starts out writing directly, with an empty display list
+    lcdLink->deferred = false;
+    lcdLink->listHead = 0;
+    lcdLink->listTail = 0;
+    lcdLink->engineRunning = false;
+    lcdLink->sending = 0;
 }
 
 
 //*****************************************************************************
 //
-// Writes a command to the CFAF128128B-0145T.  This function implements the basic SPI
-// interface to the LCD display.
+// Drives D/C for a command (false) or data (true), if it is not there already.
+// The byte on the wire still needs the old level, so the change waits for it.
 //
 //*****************************************************************************
-void HAL_LCD_writeCommand(uint8_t command)
+static void HAL_LCD_setDataMode(bool data)
 {
-    // Set to command mode
-    GPIO_setOutputLowOnPin(LCD_DC_PORT, LCD_DC_PIN);
+    if (data == lcdLink->dataMode)
+        return;
 
     // USCI_B0 Busy? //
     while (UCB0STATW & UCBUSY);
 
-    // Transmit data
-    UCB0TXBUF = command;
+    if (data)
+        GPIO_setOutputHighOnPin(LCD_DC_PORT, LCD_DC_PIN);
+    else
+        GPIO_setOutputLowOnPin(LCD_DC_PORT, LCD_DC_PIN);
+    lcdLink->dataMode = data;
+}
 
-    // USCI_B0 Busy? //
-    while (UCB0STATW & UCBUSY);
 
-    // Set back to data mode
-    GPIO_setOutputHighOnPin(LCD_DC_PORT, LCD_DC_PIN);
+//*****************************************************************************
+//
+// Queues one byte. TXBUF is free again as soon as the previous byte moves into
+// the shift register, so the next one is ready when it is out and the wire has
+// no gap between bytes.
+//
+//*****************************************************************************
+static inline void HAL_LCD_send(uint8_t byte)
+{
+    // USCI_B0 TX buffer ready? //
+    while (!(UCB0IFG & UCTXIFG));
+
+    UCB0TXBUF = byte;
+}
+
+
+//*****************************************************************************
+//
+// Sleeps in LPM0 until done(argument) holds.  It is checked with interrupts
+// masked, so an interrupt that makes it true in between still ends the WFI,
+// and runs as soon as they are unmasked again.  The time counts as a wait
+// within the pass, not as a wake.
+//
+//*****************************************************************************
+static void HAL_LCD_sleepUntil(bool (*done)(uint32_t), uint32_t argument)
+{
+    bool wasDisabled = Interrupt_disableMaster();
+    WakeStats_beginWait();
+    Profiler_pause();
+    while (!done(argument))
+    {
+        PCM_gotoLPM0InterruptSafe();
+        Interrupt_disableMaster();
+    }
+    Profiler_resume();
+    WakeStats_endWait();
+    if (!wasDisabled)
+        Interrupt_enableMaster();
+}
+
+
+//*****************************************************************************
+//
+// The color of bit number bit of a 1 bit per pixel image, most significant
+// bit first.
+//
+//*****************************************************************************
+static inline uint16_t HAL_LCD_bitColor(const uint8_t *data, uint16_t bit,
+                                        uint16_t color0, uint16_t color1)
+{
+    return ((data[bit >> 3] >> (7 - (bit & 7))) & 1) ? color1 : color0;
+}
+
+
+//*****************************************************************************
+//
+// Returns where a record of length bytes starts, once the display list has
+// room for it.  A full list is the back-pressure on the caller, who flushes
+// it and sleeps until the engine has sent enough.
+//
+//*****************************************************************************
+static uint32_t HAL_LCD_reserve(uint16_t length)
+{
+    uint32_t head = lcdLink->listHead;
+    if (head - lcdLink->listTail > (uint32_t) (LCD_LIST_SIZE - length))
+    {
+        lcdLink->listStalls++;
+        HAL_LCD_flush();
+        HAL_LCD_sleepUntil(HAL_LCD_fenceReached, head + length - LCD_LIST_SIZE);
+    }
+    return head;
+}
+
+static inline void HAL_LCD_put(uint32_t at, uint8_t byte)
+{
+    lcdLink->list[at & LCD_LIST_MASK] = byte;
+}
+
+
+//*****************************************************************************
+//
+// Publishes the records written up to head.  An engine that is running sends
+// them too; otherwise they wait for HAL_LCD_flush(), which comes at once for
+// a record the engine hands to the DMA, so that the SPI is busy with it while
+// the caller draws on, and otherwise from sleep().
+//
+//*****************************************************************************
+static inline void HAL_LCD_publish(uint32_t head, bool start)
+{
+    lcdLink->listHead = head;
+    if (start)
+        HAL_LCD_flush();
+}
+
+
+//*****************************************************************************
+//
+// Writes a command to the CFAF128128B-0145T.  This function implements the basic SPI
+// interface to the LCD display.
+//
+//*****************************************************************************
+void HAL_LCD_writeCommand(uint8_t command)
+{
+    LCD_CAPTURE_RECORD(LCD_CAPTURE_COMMAND(command));
+    lcdLink->commandCount++;
+
+    if (lcdLink->deferred)
+    {
+        uint32_t head = HAL_LCD_reserve(2);
+        HAL_LCD_put(head, LCD_OP_COMMAND);
+        HAL_LCD_put(head + 1, command);
+        HAL_LCD_publish(head + 2, false);
+        return;
+    }
+
+    // Set to command mode
+    HAL_LCD_setDataMode(false);
+
+    // Transmit data
+    HAL_LCD_send(command);
 }
 
 
@@ -110,16 +304,701 @@ void HAL_LCD_writeCommand(uint8_t command)
 //*****************************************************************************
 void HAL_LCD_writeData(uint8_t data)
 {
-    // USCI_B0 Busy? //
-    while (UCB0STATW & UCBUSY);
+    if (lcdLink->deferred)
+    {
+        HAL_LCD_writeDataBurst(&data, 1);
+        return;
+    }
+
+    LCD_CAPTURE_RECORD(LCD_CAPTURE_DATA(data));
+
+    // Set to data mode
+    HAL_LCD_setDataMode(true);
 
     // Transmit data
-    UCB0TXBUF = data;
+    HAL_LCD_send(data);
+}
+
+
+//*****************************************************************************
+//
+// Writes a command followed by its count parameter bytes.
+//
+//*****************************************************************************
+void HAL_LCD_writeCommandData(uint8_t command, const uint8_t *data, uint16_t count)
+{
+    HAL_LCD_writeCommand(command);
+    HAL_LCD_writeDataBurst(data, count);
+}
+
+
+//*****************************************************************************
+//
+// Writes count data bytes back to back.
+//
+//*****************************************************************************
+void HAL_LCD_writeDataBurst(const uint8_t *data, uint16_t count)
+{
+    uint16_t i;
+
+    while (lcdLink->deferred && count)
+    {
+        uint16_t run = (count < LCD_RECORD_MAX) ? count : LCD_RECORD_MAX;
+        uint32_t head = HAL_LCD_reserve(LCD_RUN_HEADER + run);
+        HAL_LCD_put(head, LCD_OP_RUN);
+        HAL_LCD_put(head + 1, run);
+        for (i = 0; i < run; i++)
+        {
+            LCD_CAPTURE_RECORD(LCD_CAPTURE_DATA(data[i]));
+            HAL_LCD_put(head + LCD_RUN_HEADER + i, data[i]);
+        }
+        HAL_LCD_publish(head + LCD_RUN_HEADER + run, run >= 2 * LCD_DMA_MIN_PIXELS);
+        data += run;
+        count -= run;
+    }
+
+    if (count)
+        HAL_LCD_setDataMode(true);
+
+    while (count--)
+    {
+        LCD_CAPTURE_RECORD(LCD_CAPTURE_DATA(*data));
+        HAL_LCD_send(*data++);
+    }
+}
+
+
+//*****************************************************************************
+//
+// Writes count data bytes like HAL_LCD_writeDataBurst(), but in deferred mode
+// queues only where they are: the engine sends them from there, through the
+// DMA if there are enough of them.  Whatever the bytes hold when the engine
+// gets to them is what the panel gets, which suits a frame buffer that is
+// flushed again once it has changed.
+//
+//*****************************************************************************
+void HAL_LCD_writeSpan(const uint8_t *data, uint16_t count)
+{
+    uint16_t i;
+
+    if (!lcdLink->deferred)
+    {
+        HAL_LCD_writeDataBurst(data, count);
+        return;
+    }
+    if (!count)
+        return;
+
+#ifdef LCD_CAPTURE
+    for (i = 0; i < count; i++)
+        LCD_CAPTURE_RECORD(LCD_CAPTURE_DATA(data[i]));
+#endif
+    uint32_t head = HAL_LCD_reserve(LCD_SPAN_LENGTH);
+    HAL_LCD_put(head, LCD_OP_SPAN);
+    for (i = 0; i < sizeof(data); i++)
+        HAL_LCD_put(head + 1 + i, ((const uint8_t *) &data)[i]);
+    HAL_LCD_put(head + LCD_SPAN_LENGTH - 2, count);
+    HAL_LCD_put(head + LCD_SPAN_LENGTH - 1, count >> 8);
+    HAL_LCD_publish(head + LCD_SPAN_LENGTH, count >= 2 * LCD_DMA_MIN_PIXELS);
+}
+
+
+//*****************************************************************************
+//
+// Sets the window drawing goes to: CM_CASET with the 4 bytes of columns, then
+// CM_RASET with the 4 bytes of rows.
+//
+//*****************************************************************************
+void HAL_LCD_writeWindow(const uint8_t *columns, const uint8_t *rows)
+{
+    uint16_t i;
+
+    if (!lcdLink->deferred)
+    {
+        HAL_LCD_writeCommandData(CM_CASET, columns, 4);
+        HAL_LCD_writeCommandData(CM_RASET, rows, 4);
+        return;
+    }
+
+    uint32_t head = HAL_LCD_reserve(LCD_WINDOW_LENGTH);
+    HAL_LCD_put(head, LCD_OP_WINDOW);
+    LCD_CAPTURE_RECORD(LCD_CAPTURE_COMMAND(CM_CASET));
+    for (i = 0; i < 4; i++)
+    {
+        LCD_CAPTURE_RECORD(LCD_CAPTURE_DATA(columns[i]));
+        HAL_LCD_put(head + 1 + i, columns[i]);
+    }
+    LCD_CAPTURE_RECORD(LCD_CAPTURE_COMMAND(CM_RASET));
+    for (i = 0; i < 4; i++)
+    {
+        LCD_CAPTURE_RECORD(LCD_CAPTURE_DATA(rows[i]));
+        HAL_LCD_put(head + 5 + i, rows[i]);
+    }
+    lcdLink->commandCount += 2;
+    HAL_LCD_publish(head + LCD_WINDOW_LENGTH, false);
+}
+
+
+//*****************************************************************************
+//
+// Writes one 5-6-5 color count times, high byte first, after a CM_RAMWR.  This
+// is what fills and lines are made of; the wire runs at the full SPI clock.
+//
+//*****************************************************************************
+void HAL_LCD_writeColor(uint16_t color, uint16_t count)
+{
+    uint8_t high = color >> 8;
+    uint8_t low = color;
+
+    if (lcdLink->deferred)
+    {
+#ifdef LCD_CAPTURE
+        uint16_t i;
+        for (i = 0; i < count; i++)
+        {
+            LCD_CAPTURE_RECORD(LCD_CAPTURE_DATA(high));
+            LCD_CAPTURE_RECORD(LCD_CAPTURE_DATA(low));
+        }
+#endif
+        uint32_t head = HAL_LCD_reserve(LCD_FILL_LENGTH);
+        HAL_LCD_put(head, LCD_OP_FILL);
+        HAL_LCD_put(head + 1, high);
+        HAL_LCD_put(head + 2, low);
+        HAL_LCD_put(head + 3, count);
+        HAL_LCD_put(head + 4, count >> 8);
+        HAL_LCD_publish(head + LCD_FILL_LENGTH, count >= LCD_DMA_MIN_PIXELS);
+        return;
+    }
+
+    HAL_LCD_setDataMode(true);
+
+    while (count--)
+    {
+        LCD_CAPTURE_RECORD(LCD_CAPTURE_DATA(high));
+        HAL_LCD_send(high);
+        LCD_CAPTURE_RECORD(LCD_CAPTURE_DATA(low));
+        HAL_LCD_send(low);
+    }
+}
+
+
+//*****************************************************************************
+//
+// Writes count pixels of a 1 bit per pixel image that starts firstBit bits
+// into data, most significant bit first: color0 for a 0 bit and color1 for a
+// 1 bit.  This is what text is made of.
+//
+//*****************************************************************************
+void HAL_LCD_writeBits(const uint8_t *data, uint16_t firstBit, uint16_t count,
+                       uint16_t color0, uint16_t color1)
+{
+    uint16_t i;
+
+    data += firstBit >> 3;
+    firstBit &= 7;
+
+    while (lcdLink->deferred && count)
+    {
+        uint16_t pixels = (count < LCD_RECORD_MAX) ? count : LCD_RECORD_MAX;
+        uint16_t bytes = (firstBit + pixels + 7) >> 3;
+        uint32_t head = HAL_LCD_reserve(LCD_GLYPH_HEADER + bytes);
+        HAL_LCD_put(head, LCD_OP_GLYPH);
+        HAL_LCD_put(head + 1, color0 >> 8);
+        HAL_LCD_put(head + 2, color0);
+        HAL_LCD_put(head + 3, color1 >> 8);
+        HAL_LCD_put(head + 4, color1);
+        HAL_LCD_put(head + 5, firstBit);
+        HAL_LCD_put(head + 6, pixels);
+        for (i = 0; i < bytes; i++)
+            HAL_LCD_put(head + LCD_GLYPH_HEADER + i, data[i]);
+#ifdef LCD_CAPTURE
+        for (i = firstBit; i < firstBit + pixels; i++)
+        {
+            uint16_t color = HAL_LCD_bitColor(data, i, color0, color1);
+            LCD_CAPTURE_RECORD(LCD_CAPTURE_DATA(color >> 8));
+            LCD_CAPTURE_RECORD(LCD_CAPTURE_DATA((uint8_t) color));
+        }
+#endif
+        HAL_LCD_publish(head + LCD_GLYPH_HEADER + bytes, pixels >= LCD_DMA_MIN_PIXELS);
+
+        firstBit += pixels;
+        data += firstBit >> 3;
+        firstBit &= 7;
+        count -= pixels;
+    }
+
+    if (count)
+        HAL_LCD_setDataMode(true);
+
+    for (i = firstBit; i < firstBit + count; i++)
+    {
+        uint16_t color = HAL_LCD_bitColor(data, i, color0, color1);
+        LCD_CAPTURE_RECORD(LCD_CAPTURE_DATA(color >> 8));
+        HAL_LCD_send(color >> 8);
+        LCD_CAPTURE_RECORD(LCD_CAPTURE_DATA((uint8_t) color));
+        HAL_LCD_send(color);
+    }
+}
+
+
+//*****************************************************************************
+//
+// Hands the DMA the next transfer of the one in progress.
+//
+//*****************************************************************************
+static void HAL_LCD_startDmaTransfer(void)
+{
+    uint32_t size = lcdLink->dmaRemaining;
+    uint32_t limit = (lcdLink->dmaKind == LCD_DMA_STAGE) ? LCD_STAGE_SIZE : LCD_DMA_MAX_TRANSFER;
+    if (size > limit)
+        size = limit;
+    lcdLink->dmaRemaining -= size;
+
+    DMA_setChannelTransfer(UDMA_PRI_SELECT | LCD_DMA_TRIGGER, UDMA_MODE_BASIC,
+                           (void *) lcdLink->dmaSource,
+                           (void *) (uintptr_t) SPI_getTransmitBufferAddressForDMA(LCD_EUSCI_BASE),
+                           size);
+    DMA_enableChannel(LCD_DMA_CHANNEL);
 
+    if (lcdLink->dmaKind == LCD_DMA_MEMORY)
+        lcdLink->dmaSource += size;
+}
+
+
+//*****************************************************************************
+//
+// Sends count bytes through the DMA, from source as kind says.  It is done in
+// pieces chained from DMA_INT0; the stage sends its first LCD_STAGE_SIZE bytes
+// again for every piece, which is how it repeats a two-byte color.
+//
+//*****************************************************************************
+static void HAL_LCD_startDma(const uint8_t *source, LcdDmaSource kind, uint32_t count)
+{
+    lcdLink->dmaSource = source;
+    lcdLink->dmaKind = kind;
+    lcdLink->dmaRemaining = count;
+    lcdLink->dmaBusy = true;
+
+    DMA_setChannelControl(UDMA_PRI_SELECT | LCD_DMA_TRIGGER,
+                          UDMA_SIZE_8 | ((kind == LCD_DMA_BYTE) ? UDMA_SRC_INC_NONE : UDMA_SRC_INC_8) |
+                          UDMA_DST_INC_NONE | UDMA_ARB_1);
+    HAL_LCD_startDmaTransfer();
+}
+
+
+static inline uint8_t HAL_LCD_peek(uint32_t offset)
+{
+    return lcdLink->list[(lcdLink->listTail + offset) & LCD_LIST_MASK];
+}
+
+
+//*****************************************************************************
+//
+// Writes the record at the tail if it is a command or a window, which toggle
+// D/C between their bytes and so cannot go through the DMA.  They are at most
+// LCD_WINDOW_LENGTH bytes.  Returns the length of the record, or 0 if it holds
+// data.
+//
+//*****************************************************************************
+static uint16_t HAL_LCD_runCommand(void)
+{
+    uint16_t i;
+
+    switch (HAL_LCD_peek(0))
+    {
+        case LCD_OP_COMMAND:
+            HAL_LCD_setDataMode(false);
+            HAL_LCD_send(HAL_LCD_peek(1));
+            return 2;
+
+        case LCD_OP_WINDOW:
+            HAL_LCD_setDataMode(false);
+            HAL_LCD_send(CM_CASET);
+            HAL_LCD_setDataMode(true);
+            for (i = 1; i <= 4; i++)
+                HAL_LCD_send(HAL_LCD_peek(i));
+            HAL_LCD_setDataMode(false);
+            HAL_LCD_send(CM_RASET);
+            HAL_LCD_setDataMode(true);
+            for (i = 5; i <= 8; i++)
+                HAL_LCD_send(HAL_LCD_peek(i));
+            return LCD_WINDOW_LENGTH;
+
+        default:
+            return 0;
+    }
+}
+
+
+//*****************************************************************************
+//
+// Hands the DMA the record at the tail if it is a fill or a span too long for
+// the stage: a fill straight from lcdLink->dmaPattern if it repeats one byte
+// and from a stage of its color otherwise, a span from its memory.  Returns
+// the length of the record, or 0 if it is not one of those.
+//
+//*****************************************************************************
+static uint16_t HAL_LCD_startLong(void)
+{
+    uint16_t i, count;
+    uint8_t high, low;
+    const uint8_t *source;
+
+    switch (HAL_LCD_peek(0))
+    {
+        case LCD_OP_FILL:
+            count = HAL_LCD_peek(3) | (uint16_t) HAL_LCD_peek(4) << 8;
+            if (count < LCD_DMA_MIN_PIXELS)
+                return 0;
+            high = HAL_LCD_peek(1);
+            low = HAL_LCD_peek(2);
+            if (high == low)
+            {
+                lcdLink->dmaPattern = high;
+                HAL_LCD_startDma(&lcdLink->dmaPattern, LCD_DMA_BYTE, 2 * (uint32_t) count);
+            }
+            else
+            {
+                for (i = 0; i < LCD_STAGE_SIZE; i += 2)
+                {
+                    lcdLink->stage[i] = high;
+                    lcdLink->stage[i + 1] = low;
+                }
+                HAL_LCD_startDma(lcdLink->stage, LCD_DMA_STAGE, 2 * (uint32_t) count);
+            }
+            return LCD_FILL_LENGTH;
+
+        case LCD_OP_SPAN:
+            count = HAL_LCD_peek(LCD_SPAN_LENGTH - 2) |
+                    (uint16_t) HAL_LCD_peek(LCD_SPAN_LENGTH - 1) << 8;
+            if (count < 2 * LCD_DMA_MIN_PIXELS)
+                return 0;
+            for (i = 0; i < sizeof(source); i++)
+                ((uint8_t *) &source)[i] = HAL_LCD_peek(1 + i);
+            HAL_LCD_startDma(source, LCD_DMA_MEMORY, count);
+            return LCD_SPAN_LENGTH;
+
+        default:
+            return 0;
+    }
+}
+
+
+//*****************************************************************************
+//
+// Expands the data record offset bytes past the tail into the stage, after the
+// staged bytes already there.  Returns the length of the record, or 0 if it is
+// not data, is left to HAL_LCD_startLong(), or does not fit.
+//
+//*****************************************************************************
+static uint16_t HAL_LCD_stageRecord(uint32_t offset, uint16_t *staged_p)
+{
+    uint16_t i, count, bytes, length;
+    uint8_t high, low, firstBit;
+    uint8_t *stage_p = lcdLink->stage + *staged_p;
+    const uint8_t *source;
+
+    switch (HAL_LCD_peek(offset))
+    {
+        case LCD_OP_FILL:
+            count = HAL_LCD_peek(offset + 3) | (uint16_t) HAL_LCD_peek(offset + 4) << 8;
+            bytes = 2 * count;
+            if (count >= LCD_DMA_MIN_PIXELS || *staged_p + bytes > LCD_STAGE_SIZE)
+                return 0;
+            high = HAL_LCD_peek(offset + 1);
+            low = HAL_LCD_peek(offset + 2);
+            for (i = 0; i < bytes; i += 2)
+            {
+                stage_p[i] = high;
+                stage_p[i + 1] = low;
+            }
+            length = LCD_FILL_LENGTH;
+            break;
+
+        case LCD_OP_RUN:
+            bytes = HAL_LCD_peek(offset + 1);
+            if (*staged_p + bytes > LCD_STAGE_SIZE)
+                return 0;
+            for (i = 0; i < bytes; i++)
+                stage_p[i] = HAL_LCD_peek(offset + LCD_RUN_HEADER + i);
+            length = LCD_RUN_HEADER + bytes;
+            break;
+
+        case LCD_OP_GLYPH:
+            firstBit = HAL_LCD_peek(offset + 5);
+            count = HAL_LCD_peek(offset + 6);
+            bytes = 2 * count;
+            if (*staged_p + bytes > LCD_STAGE_SIZE)
+                return 0;
+            for (i = 0; i < count; i++)
+            {
+                uint16_t bit = firstBit + i;
+                uint8_t color = ((HAL_LCD_peek(offset + LCD_GLYPH_HEADER + (bit >> 3)) >>
+                                  (7 - (bit & 7))) & 1) ? 3 : 1;
+                stage_p[2 * i] = HAL_LCD_peek(offset + color);
+                stage_p[2 * i + 1] = HAL_LCD_peek(offset + color + 1);
+            }
+            length = LCD_GLYPH_HEADER + ((firstBit + count + 7) >> 3);
+            break;
+
+        case LCD_OP_SPAN:
+            bytes = HAL_LCD_peek(offset + LCD_SPAN_LENGTH - 2) |
+                    (uint16_t) HAL_LCD_peek(offset + LCD_SPAN_LENGTH - 1) << 8;
+            if (bytes >= 2 * LCD_DMA_MIN_PIXELS || *staged_p + bytes > LCD_STAGE_SIZE)
+                return 0;
+            for (i = 0; i < sizeof(source); i++)
+                ((uint8_t *) &source)[i] = HAL_LCD_peek(offset + 1 + i);
+            for (i = 0; i < bytes; i++)
+                stage_p[i] = source[i];
+            length = LCD_SPAN_LENGTH;
+            break;
+
+        default:
+            return 0;
+    }
+
+    *staged_p += bytes;
+    return length;
+}
+
+
+//*****************************************************************************
+//
+// The display list engine, one step per DMA_INT0: writes at most one command
+// or window itself, then hands the DMA the data that follows, either one long
+// fill or span or as many of the other data records as the stage holds.  The
+// tail moves past them once the DMA has finished.  A command that follows
+// another pends the interrupt again instead, so that the other handlers get
+// their turn in between.  The engine stops when the list is empty, until
+// HAL_LCD_flush() starts it.
+//
+//*****************************************************************************
+static void HAL_LCD_drain(void)
+{
+    uint32_t head = lcdLink->listHead;
+    uint16_t length;
+
+    if (lcdLink->listTail != head)
+        lcdLink->listTail += HAL_LCD_runCommand();
+
+    if (lcdLink->listTail == head)
+    {
+        lcdLink->engineRunning = false;
+        return;
+    }
+    if (HAL_LCD_peek(0) == LCD_OP_COMMAND || HAL_LCD_peek(0) == LCD_OP_WINDOW)
+    {
+        Interrupt_pendInterrupt(INT_DMA_INT0);
+        return;
+    }
+
+    HAL_LCD_setDataMode(true);
+    length = HAL_LCD_startLong();
+    if (!length)
+    {
+        uint16_t staged = 0;
+        uint16_t record;
+
+        while (lcdLink->listTail + length != head &&
+               (record = HAL_LCD_stageRecord(length, &staged)) != 0)
+            length += record;
+
+        // An opcode the engine does not know is skipped a byte at a time
+        if (!length)
+            length = 1;
+        if (!staged)
+        {
+            lcdLink->listTail += length;
+            Interrupt_pendInterrupt(INT_DMA_INT0);
+            return;
+        }
+        HAL_LCD_startDma(lcdLink->stage, LCD_DMA_STAGE, staged);
+    }
+    lcdLink->sending = length;
+}
+
+
+//*****************************************************************************
+//
+// A DMA transfer ended, or the engine or HAL_LCD_flush() pended the interrupt:
+// chains the next piece of the transfer, or frees the records it sent and
+// takes the next step through the display list.
+//
+//*****************************************************************************
+void DMA_INT0_IRQHandler(void)
+{
+    WakeStats_interrupt(WAKE_DMA_INT0);
+    EventTrace_record(EVENT_INTERRUPT, WAKE_DMA_INT0);
+
+    DMA_clearInterruptFlag(LCD_DMA_CHANNEL);
+    if (lcdLink->dmaRemaining)
+    {
+        HAL_LCD_startDmaTransfer();
+        return;
+    }
+
+    lcdLink->dmaBusy = false;
+    lcdLink->listTail += lcdLink->sending;
+    lcdLink->sending = 0;
+    if (lcdLink->engineRunning)
+        HAL_LCD_drain();
+    Latency_lcdProgress();
+}
+
+
+static bool HAL_LCD_dmaDone(uint32_t unused)
+{
+    return !lcdLink->dmaBusy;
+}
+
+
+//*****************************************************************************
+//
+// Writes one 5-6-5 color count times, like HAL_LCD_writeColor(), but through
+// the DMA while the CPU sleeps in LPM0.  The DMA repeats a single byte, so
+// this only works for colors whose two bytes are the same, such as black and
+// white, which are what the game fills with; other colors, and fills too
+// short to be worth it, are written by the CPU.  In deferred mode the fill is
+// queued like any other, and the engine makes the same choice.
+//
+//*****************************************************************************
+void HAL_LCD_fillColor(uint16_t color, uint16_t count)
+{
+    uint8_t high = color >> 8;
+    uint8_t low = color;
+
+    if (lcdLink->deferred || high != low || count < LCD_DMA_MIN_PIXELS)
+    {
+        HAL_LCD_writeColor(color, count);
+        return;
+    }
+
+#ifdef LCD_CAPTURE
+    uint32_t i;
+    for (i = 0; i < 2 * (uint32_t) count; i++)
+        LCD_CAPTURE_RECORD(LCD_CAPTURE_DATA(high));
+#endif
+
+    HAL_LCD_setDataMode(true);
+
+    lcdLink->dmaPattern = high;
+    HAL_LCD_startDma(&lcdLink->dmaPattern, LCD_DMA_BYTE, 2 * (uint32_t) count);
+    HAL_LCD_sleepUntil(HAL_LCD_dmaDone, 0);
+}
+
+
+//*****************************************************************************
+//
+// Waits until the last byte written has left the shift register.  The writes
+// return as soon as their last byte is queued, so a delay the panel needs
+// after a command only starts counting once this returns.
+//
+//*****************************************************************************
+void HAL_LCD_waitIdle(void)
+{
     // USCI_B0 Busy? //
     while (UCB0STATW & UCBUSY);
 }
 
+
+//*****************************************************************************
+//
+// Switches between deferred mode, in which the write calls queue records in
+// the display list and return, and writing directly.  Switching back sends
+// whatever is queued first.  HAL_LCD_SpiInit() drops anything still queued and
+// starts out writing directly.
+//
+//*****************************************************************************
+void HAL_LCD_setDeferred(bool deferred)
+{
+    if (!deferred)
+        HAL_LCD_finish();
+    lcdLink->deferred = deferred;
+}
+
+
+//*****************************************************************************
+//
+// Starts the engine on whatever the display list holds, if it is not running
+// already, and returns.  It runs in DMA_INT0_IRQHandler, so pending that
+// interrupt starts it.
+//
+//*****************************************************************************
+void HAL_LCD_flush(void)
+{
+    if (lcdLink->engineRunning || lcdLink->listTail == lcdLink->listHead)
+        return;
+
+    lcdLink->engineRunning = true;
+    Interrupt_pendInterrupt(INT_DMA_INT0);
+}
+
+
+//*****************************************************************************
+//
+// Returns a fence behind everything queued so far.  It is reached once the
+// engine has handed the last of it to the SPI; in direct mode at once.
+//
+//*****************************************************************************
+uint32_t HAL_LCD_fence(void)
+{
+    return lcdLink->listHead;
+}
+
+bool HAL_LCD_fenceReached(uint32_t fence)
+{
+    return (int32_t) (lcdLink->listTail - fence) >= 0;
+}
+
+
+//*****************************************************************************
+//
+// Flushes the display list and sleeps in LPM0 until a fence is reached.
+//
+//*****************************************************************************
+void HAL_LCD_waitFence(uint32_t fence)
+{
+    if (HAL_LCD_fenceReached(fence))
+        return;
+
+    HAL_LCD_flush();
+    HAL_LCD_sleepUntil(HAL_LCD_fenceReached, fence);
+}
+
+
+//*****************************************************************************
+//
+// Waits until everything written so far is on the panel: sends what the
+// display list holds, then waits for the shift register.
+//
+//*****************************************************************************
+void HAL_LCD_finish(void)
+{
+    HAL_LCD_waitFence(HAL_LCD_fence());
+    HAL_LCD_waitIdle();
+}
+
+
+//*****************************************************************************
+//
+// Returns how many times a write had to wait for room in the display list.
+//
+//*****************************************************************************
+uint32_t HAL_LCD_listStalls(void)
+{
+    return lcdLink->listStalls;
+}
+
+//*****************************************************************************
+//
+// Returns the number of commands sent to the LCD so far.
+//
+//*****************************************************************************
+uint32_t HAL_LCD_commandCount(void)
+{
+    return lcdLink->commandCount;
+}
+
 //*****************************************************************************
 //
 //! Provides a small delay.
@@ -154,7 +1033,7 @@ SysCtlDelay(uint32_t ui32Count)
           "    bx      lr");
 }
 #endif
-#if defined(codered) || defined( __GNUC__ ) || defined(sourcerygxx)
+#if defined(codered) || (defined( __GNUC__ ) && defined(__arm__)) || defined(sourcerygxx)
 void __attribute__((naked))
 SysCtlDelay(uint32_t ui32Count)
 {
@@ -42,6 +42,7 @@
 
 
 #include <stdint.h>
+#include <stdbool.h>
 #include <ti/devices/msp432p4xx/driverlib/driverlib.h>
 //*****************************************************************************
 //
@@ -73,6 +74,79 @@
 // Definition of USCI base address to be used for SPI communication
 #define LCD_EUSCI_BASE        EUSCI_B0_BASE
 
+// DMA channel that feeds the USCI's TXBUF for solid fills, and its trigger
+#define LCD_DMA_CHANNEL       DMA_CHANNEL_0
+#define LCD_DMA_TRIGGER       DMA_CH0_EUSCIB0TX0
+
+// Most bytes one DMA transfer moves; longer fills are chained from DMA_INT0
+#define LCD_DMA_MAX_TRANSFER  1024
+
+// Fills shorter than this are written by the CPU; the DMA would not save it the set-up
+#define LCD_DMA_MIN_PIXELS    64
+
+// Bytes of the display list that deferred mode queues drawing in (a power of two)
+#ifndef LCD_LIST_SIZE
+#define LCD_LIST_SIZE         4096
+#endif
+
+// Bytes the display list engine expands a record into for the DMA; the longest
+// run is 255 bytes and the longest glyph 255 pixels
+#define LCD_STAGE_SIZE        512
+
+//*****************************************************************************
+//
+// The state of the link to one panel: its SPI, the DMA transfer feeding it and
+// the display list. It is a member of the Crystalfontz128x128 it serves, and
+// HAL_LCD_SpiInit() binds it; the HAL_LCD_* calls and DMA_INT0_IRQHandler act
+// on the link bound last.
+//
+//*****************************************************************************
+
+// Where the bytes of a DMA transfer come from: one byte over and over, the stage over and
+// over, or memory the source address moves on through
+enum _LcdDmaSource
+{
+    LCD_DMA_BYTE,
+    LCD_DMA_STAGE,
+    LCD_DMA_MEMORY
+};
+typedef enum _LcdDmaSource LcdDmaSource;
+
+typedef struct _HAL_LCD_Link
+{
+    // Commands sent to the panel. Every drawing call starts with one, so a change in the
+    // count means something was drawn.
+    uint32_t commandCount;
+
+    // The level D/C was last driven to. The panel samples it with the last bit of every byte,
+    // so it only changes between a command and data, once the shift register has gone idle.
+    bool dataMode;
+
+    // The DMA transfer in progress: where its bytes come from and how, the bytes it has still
+    // to be given, and whether its last piece is still running
+    const uint8_t *dmaSource;
+    LcdDmaSource dmaKind;
+    volatile uint32_t dmaRemaining;
+    volatile bool dmaBusy;
+
+    // The byte a solid fill repeats, and the pixels a longer record is expanded into
+    uint8_t dmaPattern;
+    uint8_t stage[LCD_STAGE_SIZE];
+
+    // The display list. In deferred mode the write calls append records at the head and
+    // return. Once HAL_LCD_flush() starts it, the engine, which runs in DMA_INT0_IRQHandler,
+    // sends the record at the tail and frees it when its last byte is in TXBUF, until the
+    // list is empty. Head and tail count bytes since the list was set up and wrap at 2^32,
+    // so head - tail is what the list holds, and a fence is a value of the head.
+    bool deferred;
+    uint8_t list[LCD_LIST_SIZE];
+    volatile uint32_t listHead;
+    volatile uint32_t listTail;
+    volatile bool engineRunning;
+    uint32_t sending;           // List bytes the DMA transfer in progress sends
+    uint32_t listStalls;
+} HAL_LCD_Link;
+
 //*****************************************************************************
 //
 // Prototypes for the globals exported by this driver.
@@ -80,8 +154,25 @@
 //*****************************************************************************
 extern void HAL_LCD_writeCommand(uint8_t command);
 extern void HAL_LCD_writeData(uint8_t data);
+extern void HAL_LCD_writeCommandData(uint8_t command, const uint8_t *data, uint16_t count);
+extern void HAL_LCD_writeDataBurst(const uint8_t *data, uint16_t count);
+extern void HAL_LCD_writeSpan(const uint8_t *data, uint16_t count);
+extern void HAL_LCD_writeWindow(const uint8_t *columns, const uint8_t *rows);
+extern void HAL_LCD_writeColor(uint16_t color, uint16_t count);
+extern void HAL_LCD_writeBits(const uint8_t *data, uint16_t firstBit, uint16_t count,
+                              uint16_t color0, uint16_t color1);
+extern void HAL_LCD_fillColor(uint16_t color, uint16_t count);
+extern void HAL_LCD_waitIdle(void);
+extern void HAL_LCD_setDeferred(bool deferred);
+extern void HAL_LCD_flush(void);
+extern uint32_t HAL_LCD_fence(void);
+extern bool HAL_LCD_fenceReached(uint32_t fence);
+extern void HAL_LCD_waitFence(uint32_t fence);
+extern void HAL_LCD_finish(void);
+extern uint32_t HAL_LCD_listStalls(void);
 extern void HAL_LCD_PortInit(void);
-extern void HAL_LCD_SpiInit(void);
+extern void HAL_LCD_SpiInit(HAL_LCD_Link *link_p);
+extern uint32_t HAL_LCD_commandCount(void);
 
 // Custom __delay_cycles() for non CCS Compiler
 #if !defined( __TI_ARM__ )
@@ -0,0 +1,22 @@
+//*****************************************************************************
+//
+// LcdCapture.c - The RAM ring behind LCD_CAPTURE builds.
+//
+//*****************************************************************************
+
+#include "LcdCapture.h"
+
+#ifdef LCD_CAPTURE
+
+LcdCaptureLog LcdCapture_log =
+{
+    { LCD_CAPTURE_MAGIC, LCD_CAPTURE_LENGTH, 0 }
+};
+
+void LcdCapture_record(uint16_t record)
+{
+    LcdCapture_log.records[LcdCapture_log.header.count % LCD_CAPTURE_LENGTH] = record;
+    LcdCapture_log.header.count++;
+}
+
+#endif
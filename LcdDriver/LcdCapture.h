@@ -0,0 +1,93 @@
+//*****************************************************************************
+//
+// LcdCapture.h - A record of the byte stream the display driver sends to the
+//                ST7735, for decoding and analysis off the board.
+//
+// Every byte HAL_LCD_writeCommand() and HAL_LCD_writeData() send becomes one
+// 16-bit record, and each display driver entry point records a marker as it
+// starts, so the analyzer can tell which entry point sent which bytes. An
+// entry point that calls another (ClearScreen calls RectFill) shows up as two
+// markers in a row. HAL/Compositor.c marks what it sends as well, with
+// LCD_ENTRY_COMPOSE.
+//
+// Building with LCD_CAPTURE defined keeps the records in LcdCapture_log, a
+// RAM ring that holds the latest LCD_CAPTURE_LENGTH of them. Saving the
+// whole LcdCapture_log structure from the debugger gives a file that
+// host/lcd_analyze reads directly; the host build writes the same format.
+// Without LCD_CAPTURE the recording compiles to nothing.
+//
+// All fields are little-endian, as on the MSP432.
+//
+//*****************************************************************************
+
+#ifndef LCDCAPTURE_H_
+#define LCDCAPTURE_H_
+
+#include <stdint.h>
+
+#define LCD_CAPTURE_MAGIC       0x4344434C      // "LCDC"
+
+// Number of records the RAM ring holds (2 bytes each)
+#ifndef LCD_CAPTURE_LENGTH
+#define LCD_CAPTURE_LENGTH      4096
+#endif
+
+// The display driver entry points that mark the stream
+enum _LcdCaptureEntry
+{
+    LCD_ENTRY_INIT,
+    LCD_ENTRY_SET_ORIENTATION,
+    LCD_ENTRY_PIXEL_DRAW,
+    LCD_ENTRY_PIXEL_DRAW_MULTIPLE,
+    LCD_ENTRY_LINE_DRAW_H,
+    LCD_ENTRY_LINE_DRAW_V,
+    LCD_ENTRY_RECT_FILL,
+    LCD_ENTRY_CLEAR_SCREEN,
+    LCD_ENTRY_FLUSH,
+    LCD_ENTRY_COMPOSE,
+    LCD_ENTRY_COUNT
+};
+typedef enum _LcdCaptureEntry LcdCaptureEntry;
+
+// A record is a command byte, a data byte, or an entry point marker
+#define LCD_CAPTURE_COMMAND(command)    ((uint16_t) (command))
+#define LCD_CAPTURE_DATA(data)          ((uint16_t) (0x0100 | (data)))
+#define LCD_CAPTURE_ENTRY(entry)        ((uint16_t) (0x8000 | (entry)))
+
+#define LCD_CAPTURE_IS_ENTRY(record)    (((record) & 0x8000) != 0)
+#define LCD_CAPTURE_IS_DATA(record)     (((record) & 0x8100) == 0x0100)
+#define LCD_CAPTURE_BYTE(record)        ((uint8_t) (record))
+
+// A capture: this header, then capacity records. Once count exceeds capacity
+// the ring has wrapped and the oldest record is at count % capacity.
+struct _LcdCaptureHeader
+{
+    uint32_t magic;
+    uint32_t capacity;
+    uint32_t count;         // Records written so far
+};
+typedef struct _LcdCaptureHeader LcdCaptureHeader;
+
+#ifdef LCD_CAPTURE
+
+struct _LcdCaptureLog
+{
+    LcdCaptureHeader header;
+    uint16_t records[LCD_CAPTURE_LENGTH];
+};
+typedef struct _LcdCaptureLog LcdCaptureLog;
+
+extern LcdCaptureLog LcdCapture_log;
+
+// Appends one record (the host build provides its own)
+extern void LcdCapture_record(uint16_t record);
+
+#define LCD_CAPTURE_RECORD(record)      LcdCapture_record(record)
+
+#else
+
+#define LCD_CAPTURE_RECORD(record)
+
+#endif
+
+#endif /* LCDCAPTURE_H_ */
@@ -0,0 +1,373 @@
+/*
+ * driverlib.h (host stand-in)
+ *
+ * The subset of the MSP432 DriverLib API used by the firmware, declared for the Linux host
+ * build. Constants keep their DriverLib values where the firmware could observe them; the
+ * functions are implemented by the peripheral models in host/sim/.
+ */
+
+#ifndef HOST_DRIVERLIB_H_
+#define HOST_DRIVERLIB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+//*****************************************************************************
+// GPIO
+//*****************************************************************************
+#define GPIO_PORT_P1                                                          1
+#define GPIO_PORT_P2                                                          2
+#define GPIO_PORT_P3                                                          3
+#define GPIO_PORT_P4                                                          4
+#define GPIO_PORT_P5                                                          5
+#define GPIO_PORT_P6                                                          6
+#define GPIO_PORT_P7                                                          7
+#define GPIO_PORT_P8                                                          8
+#define GPIO_PORT_P9                                                          9
+#define GPIO_PORT_P10                                                        10
+#define GPIO_PORT_PJ                                                         11
+
+#define GPIO_PIN0                                                      (0x0001)
+#define GPIO_PIN1                                                      (0x0002)
+#define GPIO_PIN2                                                      (0x0004)
+#define GPIO_PIN3                                                      (0x0008)
+#define GPIO_PIN4                                                      (0x0010)
+#define GPIO_PIN5                                                      (0x0020)
+#define GPIO_PIN6                                                      (0x0040)
+#define GPIO_PIN7                                                      (0x0080)
+
+#define GPIO_PRIMARY_MODULE_FUNCTION                                       (0x01)
+#define GPIO_SECONDARY_MODULE_FUNCTION                                     (0x02)
+#define GPIO_TERTIARY_MODULE_FUNCTION                                      (0x03)
+
+#define GPIO_HIGH_TO_LOW_TRANSITION                                        (0x01)
+#define GPIO_LOW_TO_HIGH_TRANSITION                                        (0x00)
+
+#define GPIO_INPUT_PIN_HIGH                                                (0x01)
+#define GPIO_INPUT_PIN_LOW                                                 (0x00)
+
+extern void GPIO_setAsOutputPin(uint_fast8_t selectedPort, uint_fast16_t selectedPins);
+extern void GPIO_setAsInputPinWithPullUpResistor(uint_fast8_t selectedPort,
+                                                 uint_fast16_t selectedPins);
+extern void GPIO_setAsPeripheralModuleFunctionInputPin(uint_fast8_t selectedPort,
+                                                       uint_fast16_t selectedPins,
+                                                       uint_fast8_t mode);
+extern void GPIO_setAsPeripheralModuleFunctionOutputPin(uint_fast8_t selectedPort,
+                                                        uint_fast16_t selectedPins,
+                                                        uint_fast8_t mode);
+extern void GPIO_setOutputHighOnPin(uint_fast8_t selectedPort, uint_fast16_t selectedPins);
+extern void GPIO_setOutputLowOnPin(uint_fast8_t selectedPort, uint_fast16_t selectedPins);
+extern void GPIO_toggleOutputOnPin(uint_fast8_t selectedPort, uint_fast16_t selectedPins);
+extern uint8_t GPIO_getInputPinValue(uint_fast8_t selectedPort, uint_fast16_t selectedPins);
+extern void GPIO_enableInterrupt(uint_fast8_t selectedPort, uint_fast16_t selectedPins);
+extern void GPIO_disableInterrupt(uint_fast8_t selectedPort, uint_fast16_t selectedPins);
+extern uint_fast16_t GPIO_getInterruptStatus(uint_fast8_t selectedPort,
+                                             uint_fast16_t selectedPins);
+extern void GPIO_clearInterruptFlag(uint_fast8_t selectedPort, uint_fast16_t selectedPins);
+extern void GPIO_interruptEdgeSelect(uint_fast8_t selectedPort, uint_fast16_t selectedPins,
+                                     uint_fast8_t edgeSelect);
+
+//*****************************************************************************
+// Interrupt (NVIC)
+//*****************************************************************************
+#define INT_EUSCIA0                                                    (32)
+#define INT_EUSCIB0                                                    (36)
+#define INT_ADC14                                                      (40)
+#define INT_T32_INT1                                                   (41)
+#define INT_T32_INT2                                                   (42)
+#define INT_DMA_ERR                                                    (46)
+#define INT_DMA_INT3                                                   (47)
+#define INT_DMA_INT2                                                   (48)
+#define INT_DMA_INT1                                                   (49)
+#define INT_DMA_INT0                                                   (50)
+#define INT_PORT1                                                      (51)
+#define INT_PORT2                                                      (52)
+#define INT_PORT3                                                      (53)
+#define INT_PORT4                                                      (54)
+#define INT_PORT5                                                      (55)
+#define INT_PORT6                                                      (56)
+
+#define NUM_INTERRUPTS                                                 (64)
+
+extern bool Interrupt_enableMaster(void);
+extern bool Interrupt_disableMaster(void);
+extern void Interrupt_enableInterrupt(uint32_t interruptNumber);
+extern void Interrupt_disableInterrupt(uint32_t interruptNumber);
+extern void Interrupt_pendInterrupt(uint32_t interruptNumber);
+
+//*****************************************************************************
+// SysTick, used only by HAL/Profiler.c; the simulator does not model it
+//*****************************************************************************
+extern void SysTick_enableModule(void);
+extern void SysTick_disableModule(void);
+extern void SysTick_enableInterrupt(void);
+extern void SysTick_setPeriod(uint32_t period);
+
+//*****************************************************************************
+// WDT_A, FlashCtl, CS
+//*****************************************************************************
+#define WDT_A_BASE                                                 (0x40004800)
+
+#define FLASH_BANK0                                                        0x00
+#define FLASH_BANK1                                                        0x01
+
+#define CS_ACLK                                                            0x01
+#define CS_MCLK                                                            0x02
+#define CS_SMCLK                                                           0x04
+#define CS_HSMCLK                                                          0x08
+
+#define CS_REFOCLK_SELECT                                                  0x02
+#define CS_DCOCLK_SELECT                                                   0x03
+
+#define CS_CLOCK_DIVIDER_1                                                 0x00
+
+extern void WDT_A_hold(uint32_t timer);
+extern bool FlashCtl_setWaitState(uint32_t bank, uint32_t waitState);
+extern void CS_setDCOFrequency(uint32_t dcoFrequency);
+extern void CS_initClockSignal(uint32_t selectedClockSignal, uint32_t clockSource,
+                               uint32_t clockSourceDivider);
+
+//*****************************************************************************
+// PCM
+//*****************************************************************************
+extern bool PCM_gotoLPM0(void);
+extern bool PCM_gotoLPM0InterruptSafe(void);
+
+//*****************************************************************************
+// ResetCtl
+//*****************************************************************************
+#define RESET_SRC_0                                                      0x0001
+#define RESET_SRC_1                                                      0x0002
+#define RESET_SRC_2                                                      0x0004
+#define RESET_SRC_3                                                      0x0008
+
+// The flags of the reset that started the run; all clear after a power-up
+extern uint32_t ResetCtl_getHardResetSource(void);
+extern uint32_t ResetCtl_getSoftResetSource(void);
+extern void ResetCtl_clearHardResetSource(uint32_t mask);
+extern void ResetCtl_clearSoftResetSource(uint32_t mask);
+
+//*****************************************************************************
+// Timer32
+//*****************************************************************************
+#define TIMER32_0_BASE                                             (0x4000C000)
+#define TIMER32_1_BASE                                             (0x4000C020)
+
+#define TIMER32_PRESCALER_1                                                0x00
+#define TIMER32_PRESCALER_16                                               0x04
+#define TIMER32_PRESCALER_256                                              0x08
+
+#define TIMER32_16BIT                                                      0x00
+#define TIMER32_32BIT                                                      0x01
+
+#define TIMER32_FREE_RUN_MODE                                              0x00
+#define TIMER32_PERIODIC_MODE                                              0x40
+
+extern void Timer32_initModule(uint32_t timer, uint32_t preScaler, uint32_t resolution,
+                               uint32_t mode);
+extern void Timer32_setCount(uint32_t timer, uint32_t count);
+extern uint32_t Timer32_getValue(uint32_t timer);
+extern void Timer32_startTimer(uint32_t timer, bool oneShot);
+extern void Timer32_haltTimer(uint32_t timer);
+extern void Timer32_clearInterruptFlag(uint32_t timer);
+extern uint32_t Timer32_getInterruptStatus(uint32_t timer);
+
+//*****************************************************************************
+// ADC14
+//*****************************************************************************
+#define ADC_CLOCKSOURCE_MODOSC                                       (0x00000000)
+#define ADC_CLOCKSOURCE_SYSOSC                                       (0x00600000)
+
+#define ADC_PREDIVIDER_1                                             (0x00000000)
+#define ADC_PREDIVIDER_4                                             (0x20000000)
+#define ADC_PREDIVIDER_32                                            (0x40000000)
+#define ADC_PREDIVIDER_64                                            (0x60000000)
+
+#define ADC_DIVIDER_1                                                (0x00000000)
+#define ADC_DIVIDER_8                                                (0x001C0000)
+
+#define ADC_MEM0                                                     (0x00000000)
+#define ADC_MEM1                                                     (0x00000001)
+
+#define ADC_PULSE_WIDTH_4                                            (0x00000000)
+#define ADC_PULSE_WIDTH_192                                          (0x00000700)
+
+#define ADC_AUTOMATIC_ITERATION                                      (0x00000080)
+#define ADC_MANUAL_ITERATION                                         (0x00000000)
+
+#define ADC_VREFPOS_AVCC_VREFNEG_VSS                                 (0x00000000)
+
+#define ADC_INPUT_A9                                                 (0x00000009)
+#define ADC_INPUT_A15                                                (0x0000000F)
+
+#define ADC_NONDIFFERENTIAL_INPUTS                                   false
+
+#define ADC_INT0                                                     (0x00000001)
+#define ADC_INT1                                                     (0x00000002)
+
+extern bool ADC14_enableModule(void);
+extern bool ADC14_initModule(uint32_t clockSource, uint32_t clockPredivider,
+                             uint32_t clockDivider, uint32_t internalChannelMask);
+extern bool ADC14_configureMultiSequenceMode(uint32_t memoryStart, uint32_t memoryEnd,
+                                             bool repeatMode);
+extern bool ADC14_setSampleHoldTime(uint32_t firstPulseWidth, uint32_t secondPulseWidth);
+extern bool ADC14_enableSampleTimer(uint32_t multiSampleConvert);
+extern bool ADC14_enableConversion(void);
+extern bool ADC14_toggleConversionTrigger(void);
+extern bool ADC14_configureConversionMemory(uint32_t memorySelect, uint32_t refSelect,
+                                            uint32_t channelSelect, bool differntialMode);
+extern uint_fast16_t ADC14_getResult(uint32_t memorySelect);
+extern void ADC14_enableInterrupt(uint_fast64_t mask);
+extern void ADC14_clearInterruptFlag(uint_fast64_t mask);
+extern uint_fast64_t ADC14_getEnabledInterruptStatus(void);
+
+//*****************************************************************************
+// eUSCI_A UART
+//*****************************************************************************
+#define EUSCI_A0_BASE                                              (0x40001000)
+
+#define EUSCI_A_UART_CLOCKSOURCE_SMCLK                                   0x0080
+#define EUSCI_A_UART_NO_PARITY                                           0x0000
+#define EUSCI_A_UART_LSB_FIRST                                           0x0000
+#define EUSCI_A_UART_ONE_STOP_BIT                                        0x0000
+#define EUSCI_A_UART_MODE                                                0x0000
+#define EUSCI_A_UART_OVERSAMPLING_BAUDRATE_GENERATION                    0x01
+#define EUSCI_A_UART_8_BIT_LEN                                           0x0000
+#define EUSCI_A_UART_TRANSMIT_INTERRUPT                                  0x0002
+#define EUSCI_A_UART_TRANSMIT_INTERRUPT_FLAG                             0x0002
+
+typedef struct _eUSCI_UART_ConfigV1
+{
+    uint_fast8_t selectClockSource;
+    uint_fast16_t clockPrescalar;
+    uint_fast8_t firstModReg;
+    uint_fast8_t secondModReg;
+    uint_fast8_t parity;
+    uint_fast16_t msborLsbFirst;
+    uint_fast16_t numberofStopBits;
+    uint_fast16_t uartMode;
+    uint_fast8_t overSampling;
+    uint_fast16_t dataLength;
+} eUSCI_UART_ConfigV1;
+
+// Only eUSCI_A0 and its transmit path are modelled (sim/Uart.c)
+extern bool UART_initModule(uint32_t moduleInstance, const eUSCI_UART_ConfigV1 *config);
+extern void UART_enableModule(uint32_t moduleInstance);
+extern void UART_transmitData(uint32_t moduleInstance, uint_fast8_t transmitData);
+extern void UART_enableInterrupt(uint32_t moduleInstance, uint_fast8_t mask);
+extern void UART_disableInterrupt(uint32_t moduleInstance, uint_fast8_t mask);
+
+//*****************************************************************************
+// eUSCI_B SPI
+//*****************************************************************************
+#define EUSCI_B0_BASE                                              (0x40002000)
+
+#define EUSCI_B_SPI_CLOCKSOURCE_ACLK                                     0x0040
+#define EUSCI_B_SPI_CLOCKSOURCE_SMCLK                                    0x0080
+#define EUSCI_B_SPI_MSB_FIRST                                            0x2000
+#define EUSCI_B_SPI_LSB_FIRST                                            0x0000
+#define EUSCI_B_SPI_PHASE_DATA_CHANGED_ONFIRST_CAPTURED_ON_NEXT          0x0000
+#define EUSCI_B_SPI_PHASE_DATA_CAPTURED_ONFIRST_CHANGED_ON_NEXT          0x8000
+#define EUSCI_B_SPI_CLOCKPOLARITY_INACTIVITY_HIGH                        0x4000
+#define EUSCI_B_SPI_CLOCKPOLARITY_INACTIVITY_LOW                         0x0000
+#define EUSCI_B_SPI_3PIN                                                 0x0000
+
+typedef struct _eUSCI_SPI_MasterConfig
+{
+    uint_fast8_t selectClockSource;
+    uint32_t clockSourceFrequency;
+    uint32_t desiredSpiClock;
+    uint_fast16_t msbFirst;
+    uint_fast16_t clockPhase;
+    uint_fast16_t clockPolarity;
+    uint_fast16_t spiMode;
+} eUSCI_SPI_MasterConfig;
+
+extern bool SPI_initMaster(uint32_t moduleInstance, const eUSCI_SPI_MasterConfig *config);
+extern void SPI_enableModule(uint32_t moduleInstance);
+extern uint32_t SPI_getTransmitBufferAddressForDMA(uint32_t moduleInstance);
+
+// The registers the LCD driver touches directly. Every access goes through the SPI model so
+// it can move bytes onto the wire and charge the CPU time the access takes.
+extern volatile uint16_t* Sim_UCB0TXBUF(void);
+extern uint16_t Sim_UCB0STATW(void);
+extern uint16_t Sim_UCB0IFG(void);
+
+#define UCBUSY                                                          (0x0001)
+#define UCTXIFG                                                         (0x0002)
+#define UCB0STATW                                                       (Sim_UCB0STATW())
+#define UCB0IFG                                                         (Sim_UCB0IFG())
+#define UCB0TXBUF                                                       (*Sim_UCB0TXBUF())
+
+//*****************************************************************************
+// DMA (basic mode only, into UCB0TXBUF)
+//*****************************************************************************
+#define DMA_CHANNEL_0                                                         0
+#define DMA_CH0_EUSCIB0TX0                                           0x00000000
+
+#define UDMA_PRI_SELECT                                              0x00000000
+#define UDMA_ALT_SELECT                                              0x00000008
+
+#define UDMA_ATTR_USEBURST                                           0x00000001
+#define UDMA_ATTR_ALTSELECT                                          0x00000002
+#define UDMA_ATTR_HIGH_PRIORITY                                      0x00000004
+#define UDMA_ATTR_REQMASK                                            0x00000008
+#define UDMA_ATTR_ALL                                                0x0000000F
+
+#define UDMA_DST_INC_8                                               0x00000000
+#define UDMA_DST_INC_NONE                                            0xc0000000
+#define UDMA_SRC_INC_8                                               0x00000000
+#define UDMA_SRC_INC_NONE                                            0x0c000000
+#define UDMA_SIZE_8                                                  0x00000000
+#define UDMA_ARB_1                                                   0x00000000
+
+#define UDMA_MODE_BASIC                                              0x00000001
+
+extern void DMA_enableModule(void);
+extern void DMA_setControlBase(void *controlTable);
+extern void DMA_assignChannel(uint32_t mapping);
+extern void DMA_disableChannelAttribute(uint32_t channelNum, uint32_t attr);
+extern void DMA_setChannelControl(uint32_t channelStructIndex, uint32_t control);
+extern void DMA_setChannelTransfer(uint32_t channelStructIndex, uint32_t mode, void *srcAddr,
+                                   void *dstAddr, uint32_t transferSize);
+extern void DMA_enableChannel(uint32_t channelNum);
+extern void DMA_clearInterruptFlag(uint32_t intChannel);
+extern void DMA_enableInterrupt(uint32_t interruptNumber);
+
+//*****************************************************************************
+// Cortex-M4 core debug: the DWT cycle counter
+//*****************************************************************************
+typedef struct
+{
+    volatile uint32_t CTRL;
+    volatile uint32_t CYCCNT;
+} DWT_Type;
+
+typedef struct
+{
+    volatile uint32_t DEMCR;
+} CoreDebug_Type;
+
+#define DWT_CTRL_CYCCNTENA_Msk                                          (0x00000001)
+#define CoreDebug_DEMCR_TRCENA_Msk                                      (0x01000000)
+
+// CYCCNT follows the simulated clock while both enable bits are set; the firmware may also
+// write it
+extern DWT_Type* Sim_DWT(void);
+extern CoreDebug_Type* Sim_CoreDebug(void);
+
+#define DWT                                                             (Sim_DWT())
+#define CoreDebug                                                       (Sim_CoreDebug())
+
+//*****************************************************************************
+// Linker: the bounds of the .stack section
+//*****************************************************************************
+// The firmware runs on the host thread's own stack; the simulator sets aside the stretch below
+// the frame that entered it (HAL/StackUsage.h)
+extern uint32_t* Sim_stackBottom(void);
+extern uint32_t* Sim_stackTop(void);
+
+#define STACK_USAGE_BOTTOM                                              (Sim_stackBottom())
+#define STACK_USAGE_TOP                                                 (Sim_stackTop())
+
+#endif /* HOST_DRIVERLIB_H_ */
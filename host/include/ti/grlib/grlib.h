@@ -0,0 +1,115 @@
+/*
+ * grlib.h (host stand-in)
+ *
+ * The subset of the TI Graphics Library used by the firmware and the Crystalfontz driver,
+ * declared for the Linux host build. Structure layouts follow grlib so the driver's
+ * Graphics_Display_Functions table compiles unchanged; the drawing algorithms are in
+ * host/sim/grlib.c and go through the display function table exactly like grlib does.
+ */
+
+#ifndef HOST_GRLIB_H_
+#define HOST_GRLIB_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+typedef struct Graphics_Rectangle
+{
+    int16_t sXMin;
+    int16_t sYMin;
+    int16_t sXMax;
+    int16_t sYMax;
+} Graphics_Rectangle;
+
+typedef struct Graphics_Display
+{
+    int32_t size;
+    void *displayData;
+    uint16_t width;
+    uint16_t heigth;
+} Graphics_Display;
+
+typedef struct Graphics_Display_Functions
+{
+    void (*pfnPixelDraw)(const Graphics_Display *pDisplay, int16_t lX, int16_t lY,
+                         uint16_t ulValue);
+    void (*pfnPixelDrawMultiple)(const Graphics_Display *pDisplay, int16_t lX, int16_t lY,
+                                 int16_t lX0, int16_t lCount, int16_t lBPP,
+                                 const uint8_t *pucData, const uint32_t *pucPalette);
+    void (*pfnLineDrawH)(const Graphics_Display *pDisplay, int16_t lX1, int16_t lX2,
+                         int16_t lY, uint16_t ulValue);
+    void (*pfnLineDrawV)(const Graphics_Display *pDisplay, int16_t lX, int16_t lY1,
+                         int16_t lY2, uint16_t ulValue);
+    void (*pfnRectFill)(const Graphics_Display *pDisplay, const Graphics_Rectangle *pRect,
+                        uint16_t ulValue);
+    uint32_t (*pfnColorTranslate)(const Graphics_Display *pDisplay, uint32_t ulValue);
+    void (*pfnFlush)(const Graphics_Display *pDisplay);
+    void (*pfnClearDisplay)(const Graphics_Display *pDisplay, uint16_t ulValue);
+} Graphics_Display_Functions;
+
+// Fonts use the uncompressed grlib layout: data[offset[c - ' ']] is the glyph size in bytes,
+// followed by its width in pixels and its rows as one stream of bits, most significant bit
+// first: the pixel at column x of row y is bit y * width + x of the stream.
+#define FONT_FMT_UNCOMPRESSED   0x00
+
+typedef struct Graphics_Font
+{
+    uint8_t format;
+    uint8_t maxWidth;
+    uint8_t height;
+    uint8_t baseline;
+    uint16_t offset[96];
+    const uint8_t *data;
+} Graphics_Font;
+
+extern const Graphics_Font g_sFontFixed6x8;
+
+typedef struct Graphics_Context
+{
+    int32_t size;
+    const Graphics_Display *display;
+    const Graphics_Display_Functions *displayFunctions;
+    Graphics_Rectangle clipRegion;
+    uint32_t foreground;
+    uint32_t background;
+    const Graphics_Font *font;
+} Graphics_Context;
+
+#define GRAPHICS_COLOR_BLACK        0x00000000
+#define GRAPHICS_COLOR_BLUE         0x000000FF
+#define GRAPHICS_COLOR_GREEN        0x00008000
+#define GRAPHICS_COLOR_RED          0x00FF0000
+#define GRAPHICS_COLOR_YELLOW       0x00FFFF00
+#define GRAPHICS_COLOR_WHITE        0x00FFFFFF
+
+#define OPAQUE_TEXT                 1
+#define TRANSPARENT_TEXT            0
+
+#define Graphics_getFontHeight(font)    ((font)->height)
+#define Graphics_getFontMaxWidth(font)  ((font)->maxWidth)
+
+extern void Graphics_initContext(Graphics_Context *context, Graphics_Display *display,
+                                 const Graphics_Display_Functions *pFxns);
+extern void Graphics_setFont(Graphics_Context *context, const Graphics_Font *font);
+extern void Graphics_setForegroundColor(Graphics_Context *context, int32_t value);
+extern void Graphics_setBackgroundColor(Graphics_Context *context, int32_t value);
+extern void Graphics_clearDisplay(const Graphics_Context *context);
+extern void Graphics_flushBuffer(const Graphics_Context *context);
+
+extern void Graphics_drawPixel(const Graphics_Context *context, int32_t x, int32_t y);
+extern void Graphics_drawLineH(const Graphics_Context *context, int32_t x1, int32_t x2,
+                               int32_t y);
+extern void Graphics_drawLineV(const Graphics_Context *context, int32_t x, int32_t y1,
+                               int32_t y2);
+extern void Graphics_drawRectangle(const Graphics_Context *context,
+                                   const Graphics_Rectangle *rect);
+extern void Graphics_fillRectangle(const Graphics_Context *context,
+                                   const Graphics_Rectangle *rect);
+extern void Graphics_drawCircle(const Graphics_Context *context, int32_t x, int32_t y,
+                                int32_t lRadius);
+extern void Graphics_fillCircle(const Graphics_Context *context, int32_t x, int32_t y,
+                                int32_t lRadius);
+extern void Graphics_drawString(const Graphics_Context *context, int8_t *string,
+                                int32_t lLength, int32_t x, int32_t y, bool opaque);
+
+#endif /* HOST_GRLIB_H_ */
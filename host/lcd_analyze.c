@@ -0,0 +1,449 @@
+/*
+ * lcd_analyze.c
+ *
+ * Decodes a capture of the display driver's byte stream (LcdDriver/LcdCapture.h), saved by
+ * tamagotchi_sim --lcd-capture or from the LcdCapture_log ring of an LCD_CAPTURE build on the
+ * board, into ST7735 transactions, and reports the bytes that did not need to be sent:
+ *
+ *   repeated window    CASET or RASET setting the column or row range it already has, as
+ *                      Crystalfontz128x128_SetDrawFrame() does for every call
+ *   1-pixel window     the window setup of a RAMWR that writes a single pixel, which is most of
+ *                      what Crystalfontz128x128_PixelDraw() sends
+ *   past the window    pixels a RAMWR writes beyond the window area, which the controller
+ *                      wraps back over the start (RectFill's loop runs one pixel too far)
+ *   repeated MADCTL    MADCTL setting the value it already has
+ *
+ * The waste is ranked by bytes lost per call site, the driver entry point that sent the bytes
+ * (or "outer > inner" when one entry point called another).
+ *
+ *   lcd_analyze [--dump N] FILE
+ *
+ * --dump prints the first N decoded transactions.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <LcdDriver/Crystalfontz128x128_ST7735.h>
+#include <LcdDriver/LcdCapture.h>
+
+// A call site is an entry point, optionally with the entry point it called
+#define SITE_NONE       LCD_ENTRY_COUNT
+#define SITE_COUNT      ((LCD_ENTRY_COUNT + 1) * (LCD_ENTRY_COUNT + 1))
+
+static const char* const entryNames[LCD_ENTRY_COUNT + 1] =
+{
+    "Init",
+    "SetOrientation",
+    "PixelDraw",
+    "PixelDrawMultiple",
+    "LineDrawH",
+    "LineDrawV",
+    "RectFill",
+    "ClearScreen",
+    "Flush",
+    "Compose",
+    "(unmarked)",
+};
+
+enum _Waste
+{
+    WASTE_REPEATED_WINDOW,
+    WASTE_SINGLE_PIXEL,
+    WASTE_PAST_WINDOW,
+    WASTE_REPEATED_MADCTL,
+    WASTE_COUNT
+};
+typedef enum _Waste Waste;
+
+static const char* const wasteNames[WASTE_COUNT] =
+{
+    "repeated window",
+    "1-pixel window",
+    "past the window",
+    "repeated MADCTL",
+};
+
+struct _SiteStats
+{
+    uint64_t calls;
+    uint64_t bytes;
+    uint64_t transfers;         // RAMWR transactions
+    uint64_t pixels;
+    uint64_t wasteCount[WASTE_COUNT];
+    uint64_t wasteBytes[WASTE_COUNT];
+};
+typedef struct _SiteStats SiteStats;
+
+struct _CommandStats
+{
+    uint64_t count;
+    uint64_t bytes;
+};
+typedef struct _CommandStats CommandStats;
+
+struct _Analyzer
+{
+    // Where the stream is
+    int site;
+    bool lastWasEntry;
+    uint8_t command;
+    int commandSite;
+    bool haveCommand;
+    uint8_t params[4];
+    int paramCount;
+    uint64_t ramwrBytes;
+
+    // What the controller holds; a value is unknown until the stream sets it
+    bool haveColumns, haveRows, haveMadctl;
+    uint16_t columns[2], rows[2];
+    uint8_t madctl;
+
+    // Window setup bytes sent since the last RAMWR ended, not already counted as waste
+    uint64_t setupBytes;
+
+    // Results
+    SiteStats sites[SITE_COUNT];
+    CommandStats commands[256];
+    uint64_t bytes;
+    uint64_t skipped;           // Records before the first entry marker of a wrapped ring
+    long dumpLeft;
+};
+typedef struct _Analyzer Analyzer;
+
+static void siteName(int site, char* name, size_t size)
+{
+    int outer = site / (LCD_ENTRY_COUNT + 1), inner = site % (LCD_ENTRY_COUNT + 1);
+    if (inner == SITE_NONE)
+        snprintf(name, size, "%s", entryNames[outer]);
+    else
+        snprintf(name, size, "%s > %s", entryNames[outer], entryNames[inner]);
+}
+
+static const char* commandName(uint8_t command)
+{
+    switch (command)
+    {
+        case CM_SLPOUT:     return "SLPOUT";
+        case CM_NORON:      return "NORON";
+        case CM_GAMSET:     return "GAMSET";
+        case CM_DISPOFF:    return "DISPOFF";
+        case CM_DISPON:     return "DISPON";
+        case CM_CASET:      return "CASET";
+        case CM_RASET:      return "RASET";
+        case CM_RAMWR:      return "RAMWR";
+        case CM_MADCTL:     return "MADCTL";
+        case CM_COLMOD:     return "COLMOD";
+        case CM_SETPWCTR:   return "SETPWCTR";
+        case CM_SETSTBA:    return "SETSTBA";
+        default:            return NULL;
+    }
+}
+
+static void waste(Analyzer* analyzer_p, int site, Waste kind, uint64_t bytes)
+{
+    analyzer_p->sites[site].wasteCount[kind]++;
+    analyzer_p->sites[site].wasteBytes[kind] += bytes;
+}
+
+// Ends the RAMWR in progress, once the next command shows where its data stops
+static void endTransfer(Analyzer* analyzer_p)
+{
+    SiteStats* site_p = &analyzer_p->sites[analyzer_p->commandSite];
+    uint64_t pixels = analyzer_p->ramwrBytes / 2;
+    site_p->transfers++;
+    site_p->pixels += pixels;
+
+    if (analyzer_p->haveColumns && analyzer_p->haveRows &&
+        analyzer_p->columns[1] >= analyzer_p->columns[0] &&
+        analyzer_p->rows[1] >= analyzer_p->rows[0]) {
+        uint64_t width = analyzer_p->columns[1] - analyzer_p->columns[0] + 1;
+        uint64_t height = analyzer_p->rows[1] - analyzer_p->rows[0] + 1;
+        if (pixels > width * height)
+            waste(analyzer_p, analyzer_p->commandSite, WASTE_PAST_WINDOW,
+                  2 * (pixels - width * height));
+    }
+    if (pixels == 1)
+        waste(analyzer_p, analyzer_p->commandSite, WASTE_SINGLE_PIXEL, analyzer_p->setupBytes);
+
+    if (analyzer_p->dumpLeft > 0) {
+        char name[64];
+        siteName(analyzer_p->commandSite, name, sizeof(name));
+        printf("  %-30s RAMWR %llu pixels\n", name, (unsigned long long) pixels);
+        analyzer_p->dumpLeft--;
+    }
+
+    analyzer_p->ramwrBytes = 0;
+    analyzer_p->setupBytes = 0;
+}
+
+// Handles a command once all its parameters are in
+static void endCommand(Analyzer* analyzer_p)
+{
+    uint8_t* params = analyzer_p->params;
+    int site = analyzer_p->commandSite;
+
+    switch (analyzer_p->command)
+    {
+        case CM_CASET:
+        case CM_RASET:
+        {
+            bool columns = analyzer_p->command == CM_CASET;
+            bool* have_p = columns ? &analyzer_p->haveColumns : &analyzer_p->haveRows;
+            uint16_t* range = columns ? analyzer_p->columns : analyzer_p->rows;
+            uint16_t start = (params[0] << 8) | params[1], end = (params[2] << 8) | params[3];
+            if (*have_p && range[0] == start && range[1] == end)
+                waste(analyzer_p, site, WASTE_REPEATED_WINDOW, 5);
+            else
+                analyzer_p->setupBytes += 5;
+            *have_p = true;
+            range[0] = start;
+            range[1] = end;
+            break;
+        }
+
+        case CM_MADCTL:
+            if (analyzer_p->haveMadctl && analyzer_p->madctl == params[0])
+                waste(analyzer_p, site, WASTE_REPEATED_MADCTL, 2);
+            analyzer_p->haveMadctl = true;
+            analyzer_p->madctl = params[0];
+            break;
+
+        default:
+            break;
+    }
+
+    if (analyzer_p->dumpLeft > 0) {
+        char name[64];
+        const char* command = commandName(analyzer_p->command);
+        siteName(site, name, sizeof(name));
+        if (command)
+            printf("  %-30s %-8s", name, command);
+        else
+            printf("  %-30s 0x%02X    ", name, analyzer_p->command);
+        if (analyzer_p->command == CM_CASET || analyzer_p->command == CM_RASET)
+            printf(" %u..%u", (params[0] << 8) | params[1], (params[2] << 8) | params[3]);
+        else {
+            int i;
+            for (i = 0; i < analyzer_p->paramCount; i++)
+                printf(" 0x%02X", params[i]);
+        }
+        printf("\n");
+        analyzer_p->dumpLeft--;
+    }
+}
+
+static void analyze(Analyzer* analyzer_p, uint16_t record)
+{
+    if (LCD_CAPTURE_IS_ENTRY(record)) {
+        int entry = record & 0x7FFF;
+        if (entry >= LCD_ENTRY_COUNT)
+            entry = SITE_NONE;
+
+        // A marker right after another is an entry point called by the first
+        int outer = analyzer_p->site / (LCD_ENTRY_COUNT + 1);
+        if (analyzer_p->lastWasEntry && analyzer_p->site % (LCD_ENTRY_COUNT + 1) == SITE_NONE)
+            analyzer_p->site = outer * (LCD_ENTRY_COUNT + 1) + entry;
+        else
+            analyzer_p->site = entry * (LCD_ENTRY_COUNT + 1) + SITE_NONE;
+        analyzer_p->sites[analyzer_p->site].calls++;
+        analyzer_p->lastWasEntry = true;
+        return;
+    }
+    analyzer_p->lastWasEntry = false;
+
+    uint8_t byte = LCD_CAPTURE_BYTE(record);
+    analyzer_p->bytes++;
+    analyzer_p->sites[analyzer_p->site].bytes++;
+
+    if (!LCD_CAPTURE_IS_DATA(record)) {
+        if (analyzer_p->haveCommand) {
+            if (analyzer_p->command == CM_RAMWR)
+                endTransfer(analyzer_p);
+            else
+                endCommand(analyzer_p);
+        }
+        analyzer_p->command = byte;
+        analyzer_p->commandSite = analyzer_p->site;
+        analyzer_p->haveCommand = true;
+        analyzer_p->paramCount = 0;
+        analyzer_p->commands[byte].count++;
+        analyzer_p->commands[byte].bytes++;
+        if (byte == CM_RAMWR)
+            analyzer_p->setupBytes++;
+        return;
+    }
+
+    if (!analyzer_p->haveCommand)
+        return;
+    analyzer_p->commands[analyzer_p->command].bytes++;
+    if (analyzer_p->command == CM_RAMWR)
+        analyzer_p->ramwrBytes++;
+    else if (analyzer_p->paramCount < 4)
+        analyzer_p->params[analyzer_p->paramCount++] = byte;
+}
+
+struct _Ranked
+{
+    int site;
+    Waste kind;
+    uint64_t count;
+    uint64_t bytes;
+};
+typedef struct _Ranked Ranked;
+
+static int compareRanked(const void* a, const void* b)
+{
+    const Ranked* x = a;
+    const Ranked* y = b;
+    return (x->bytes < y->bytes) - (x->bytes > y->bytes);
+}
+
+static double percent(uint64_t part, uint64_t whole)
+{
+    return whole ? 100.0 * part / whole : 0.0;
+}
+
+static void report(const Analyzer* analyzer_p)
+{
+    int site, kind, command;
+    uint64_t lost = 0;
+
+    printf("%llu bytes on the link\n", (unsigned long long) analyzer_p->bytes);
+    if (analyzer_p->skipped)
+        printf("  (the ring wrapped: skipped %llu records up to the first entry point)\n",
+               (unsigned long long) analyzer_p->skipped);
+
+    printf("\n  %-10s %10s %12s\n", "command", "count", "bytes");
+    for (command = 0; command < 256; command++) {
+        const CommandStats* stats_p = &analyzer_p->commands[command];
+        if (!stats_p->count)
+            continue;
+        const char* name = commandName((uint8_t) command);
+        char hex[8];
+        snprintf(hex, sizeof(hex), "0x%02X", command);
+        printf("  %-10s %10llu %12llu\n", name ? name : hex, (unsigned long long) stats_p->count,
+               (unsigned long long) stats_p->bytes);
+    }
+
+    // Rank every (call site, kind of waste) by the bytes it lost
+    Ranked ranked[SITE_COUNT * WASTE_COUNT];
+    int rankedCount = 0;
+    for (site = 0; site < SITE_COUNT; site++) {
+        for (kind = 0; kind < WASTE_COUNT; kind++) {
+            const SiteStats* stats_p = &analyzer_p->sites[site];
+            if (!stats_p->wasteBytes[kind])
+                continue;
+            ranked[rankedCount].site = site;
+            ranked[rankedCount].kind = (Waste) kind;
+            ranked[rankedCount].count = stats_p->wasteCount[kind];
+            ranked[rankedCount].bytes = stats_p->wasteBytes[kind];
+            lost += stats_p->wasteBytes[kind];
+            rankedCount++;
+        }
+    }
+    qsort(ranked, rankedCount, sizeof(Ranked), compareRanked);
+
+    printf("\n  %-4s %-30s %-16s %10s %12s %7s\n", "rank", "call site", "waste", "count",
+           "bytes lost", "of all");
+    int i;
+    for (i = 0; i < rankedCount; i++) {
+        char name[64];
+        siteName(ranked[i].site, name, sizeof(name));
+        printf("  %-4d %-30s %-16s %10llu %12llu %6.1f%%\n", i + 1, name,
+               wasteNames[ranked[i].kind], (unsigned long long) ranked[i].count,
+               (unsigned long long) ranked[i].bytes, percent(ranked[i].bytes, analyzer_p->bytes));
+    }
+
+    printf("\n  %-30s %8s %12s %10s %10s %12s %7s\n", "call site", "calls", "bytes", "RAMWRs",
+           "pixels", "bytes lost", "lost");
+    for (site = 0; site < SITE_COUNT; site++) {
+        const SiteStats* stats_p = &analyzer_p->sites[site];
+        if (!stats_p->bytes && !stats_p->calls)
+            continue;
+        uint64_t siteLost = 0;
+        for (kind = 0; kind < WASTE_COUNT; kind++)
+            siteLost += stats_p->wasteBytes[kind];
+        char name[64];
+        siteName(site, name, sizeof(name));
+        printf("  %-30s %8llu %12llu %10llu %10llu %12llu %6.1f%%\n", name,
+               (unsigned long long) stats_p->calls, (unsigned long long) stats_p->bytes,
+               (unsigned long long) stats_p->transfers, (unsigned long long) stats_p->pixels,
+               (unsigned long long) siteLost, percent(siteLost, stats_p->bytes));
+    }
+
+    printf("\n%llu of %llu bytes lost (%.1f%%)\n", (unsigned long long) lost,
+           (unsigned long long) analyzer_p->bytes, percent(lost, analyzer_p->bytes));
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: lcd_analyze [--dump N] FILE\n");
+    exit(2);
+}
+
+int main(int argc, char** argv)
+{
+    static Analyzer analyzer;
+    const char* path = NULL;
+
+    int i;
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--dump") == 0 && i + 1 < argc)
+            analyzer.dumpLeft = atol(argv[++i]);
+        else if (argv[i][0] != '-' && !path)
+            path = argv[i];
+        else
+            usage();
+    }
+    if (!path)
+        usage();
+
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "lcd_analyze: cannot read %s\n", path);
+        return 1;
+    }
+    LcdCaptureHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != LCD_CAPTURE_MAGIC) {
+        fprintf(stderr, "lcd_analyze: %s is not an LCD capture\n", path);
+        return 1;
+    }
+    uint16_t* records = malloc((size_t) header.capacity * sizeof(uint16_t) + 1);
+    if (!records || fread(records, sizeof(uint16_t), header.capacity, file) != header.capacity) {
+        fprintf(stderr, "lcd_analyze: %s is truncated\n", path);
+        return 1;
+    }
+    fclose(file);
+
+    // A wrapped ring starts at its oldest record, somewhere inside a transaction
+    uint32_t count = header.count, first = 0;
+    bool synced = true;
+    if (header.count > header.capacity) {
+        count = header.capacity;
+        first = header.count % header.capacity;
+        synced = false;
+    }
+
+    analyzer.site = SITE_NONE * (LCD_ENTRY_COUNT + 1) + SITE_NONE;
+    uint32_t n;
+    for (n = 0; n < count; n++) {
+        uint16_t record = records[(first + n) % header.capacity];
+        if (!synced && !LCD_CAPTURE_IS_ENTRY(record)) {
+            analyzer.skipped++;
+            continue;
+        }
+        synced = true;
+        analyze(&analyzer, record);
+    }
+    if (analyzer.haveCommand && analyzer.command == CM_RAMWR)
+        endTransfer(&analyzer);
+    else if (analyzer.haveCommand)
+        endCommand(&analyzer);
+
+    report(&analyzer);
+    free(records);
+    return 0;
+}
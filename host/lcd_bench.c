@@ -0,0 +1,355 @@
+/*
+ * lcd_bench.c
+ *
+ * Microbenchmarks of the graphics stack on the simulated SPI link: every entry point of
+ * g_sCrystalfontz128x128_funcs, the GFX_* wrappers the game uses and the grlib primitives
+ * behind them, each called many times at the sizes the game draws. For every benchmark it
+ * reports the CPU cycles, SPI bytes and pixels per call, and the pixels per second that
+ * makes at 48 MHz.
+ *
+ *   lcd_bench [--iterations N] [--json FILE] [--baseline FILE]
+ *
+ * The clock is virtual, so the numbers are exact and repeat run after run. --json saves them
+ * as a baseline; --baseline compares a run against a saved one, so a driver change comes with
+ * its before and after numbers.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <HAL/Graphics.h>
+#include "sim/Sim.h"
+
+#define BENCH_MAX_NAME      48
+#define BENCH_MAX_BASELINE  64
+
+struct _Benchmark
+{
+    const char* name;
+    void (*run)(GFX* gfx_p, int size);
+    int size;
+};
+typedef struct _Benchmark Benchmark;
+
+struct _BenchResult
+{
+    char name[BENCH_MAX_NAME];
+    uint64_t calls;
+    double cyclesPerCall;
+    double bytesPerCall;
+    double pixelsPerCall;
+    double pixelsPerSecond;
+};
+typedef struct _BenchResult BenchResult;
+
+static uint16_t nativeColor(GFX* gfx_p, uint32_t color)
+{
+    return (uint16_t) g_sCrystalfontz128x128_funcs.pfnColorTranslate(&gfx_p->display, color);
+}
+
+//*****************************************************************************
+// Display driver entry points
+//*****************************************************************************
+static void benchPixelDraw(GFX* gfx_p, int size)
+{
+    g_sCrystalfontz128x128_funcs.pfnPixelDraw(&gfx_p->display, 64, 64,
+                                              nativeColor(gfx_p, GRAPHICS_COLOR_RED));
+}
+
+// A 1 bpp run, like one row of a glyph
+static void benchPixelDrawMultiple(GFX* gfx_p, int size)
+{
+    static const uint8_t pattern[16] = { 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55,
+                                         0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55, 0xAA, 0x55 };
+    uint32_t palette[2] = { nativeColor(gfx_p, GRAPHICS_COLOR_BLACK),
+                            nativeColor(gfx_p, GRAPHICS_COLOR_WHITE) };
+    g_sCrystalfontz128x128_funcs.pfnPixelDrawMultiple(&gfx_p->display, 0, 64, 0, size, 1,
+                                                      pattern, palette);
+}
+
+static void benchLineDrawH(GFX* gfx_p, int size)
+{
+    g_sCrystalfontz128x128_funcs.pfnLineDrawH(&gfx_p->display, 0, size - 1, 64,
+                                              nativeColor(gfx_p, GRAPHICS_COLOR_RED));
+}
+
+static void benchLineDrawV(GFX* gfx_p, int size)
+{
+    g_sCrystalfontz128x128_funcs.pfnLineDrawV(&gfx_p->display, 64, 0, size - 1,
+                                              nativeColor(gfx_p, GRAPHICS_COLOR_RED));
+}
+
+static void benchRectFill(GFX* gfx_p, int size)
+{
+    Graphics_Rectangle rect = { 0, 0, size - 1, size - 1 };
+    g_sCrystalfontz128x128_funcs.pfnRectFill(&gfx_p->display, &rect,
+                                             nativeColor(gfx_p, GRAPHICS_COLOR_RED));
+}
+
+static void benchFlush(GFX* gfx_p, int size)
+{
+    g_sCrystalfontz128x128_funcs.pfnFlush(&gfx_p->display);
+}
+
+static void benchClearDisplay(GFX* gfx_p, int size)
+{
+    g_sCrystalfontz128x128_funcs.pfnClearDisplay(&gfx_p->display,
+                                                 nativeColor(gfx_p, GRAPHICS_COLOR_BLACK));
+}
+
+//*****************************************************************************
+// GFX wrappers and grlib
+//*****************************************************************************
+static void benchGfxPrint(GFX* gfx_p, int size)
+{
+    static char text[] = "Happiness: 5 Age: 12";
+    char string[sizeof(text)];
+    memcpy(string, text, size);
+    string[size] = '\0';
+    GFX_print(gfx_p, string, 5, 0);
+}
+
+static void benchGfxDrawSolidCircle(GFX* gfx_p, int size)
+{
+    GFX_drawSolidCircle(gfx_p, 64, 85, size);
+}
+
+static void benchGfxRemoveSolidCircle(GFX* gfx_p, int size)
+{
+    GFX_removeSolidCircle(gfx_p, 64, 85, size);
+}
+
+static void benchGfxClear(GFX* gfx_p, int size)
+{
+    GFX_clear(gfx_p);
+}
+
+static void benchFillCircle(GFX* gfx_p, int size)
+{
+    Graphics_fillCircle(&gfx_p->context, 64, 64, size);
+}
+
+static void benchDrawString(GFX* gfx_p, int size)
+{
+    static const char text[] = "Happiness: 5 Age: 12";
+    char string[sizeof(text)];
+    memcpy(string, text, size);
+    string[size] = '\0';
+    Graphics_drawString(&gfx_p->context, (int8_t*) string, -1, 0, 40, true);
+}
+
+// The sizes the game draws: status text, the pet's circles (8, 10 and 12) and full screens
+static const Benchmark benchmarks[] =
+{
+    { "PixelDraw",                  benchPixelDraw,             1 },
+    { "PixelDrawMultiple 8 1bpp",   benchPixelDrawMultiple,     8 },
+    { "PixelDrawMultiple 64 1bpp",  benchPixelDrawMultiple,     64 },
+    { "PixelDrawMultiple 128 1bpp", benchPixelDrawMultiple,     128 },
+    { "LineDrawH 8",                benchLineDrawH,             8 },
+    { "LineDrawH 128",              benchLineDrawH,             128 },
+    { "LineDrawV 8",                benchLineDrawV,             8 },
+    { "LineDrawV 128",              benchLineDrawV,             128 },
+    { "RectFill 4x4",               benchRectFill,              4 },
+    { "RectFill 16x16",             benchRectFill,              16 },
+    { "RectFill 64x64",             benchRectFill,              64 },
+    { "RectFill 128x128",           benchRectFill,              128 },
+    { "Flush",                      benchFlush,                 0 },
+    { "ClearDisplay",               benchClearDisplay,          0 },
+    { "GFX_print 7 chars",          benchGfxPrint,              7 },
+    { "GFX_print 20 chars",         benchGfxPrint,              20 },
+    { "GFX_drawSolidCircle r8",     benchGfxDrawSolidCircle,    8 },
+    { "GFX_drawSolidCircle r12",    benchGfxDrawSolidCircle,    12 },
+    { "GFX_removeSolidCircle r8",   benchGfxRemoveSolidCircle,  8 },
+    { "GFX_removeSolidCircle r12",  benchGfxRemoveSolidCircle,  12 },
+    { "GFX_clear",                  benchGfxClear,              0 },
+    { "Graphics_fillCircle r10",    benchFillCircle,            10 },
+    { "Graphics_fillCircle r40",    benchFillCircle,            40 },
+    { "Graphics_drawString 7",      benchDrawString,            7 },
+    { "Graphics_drawString 20",     benchDrawString,            20 },
+};
+
+#define BENCH_COUNT ((int) (sizeof(benchmarks) / sizeof(benchmarks[0])))
+
+static uint64_t spiBytes(const SimDevice* sim_p)
+{
+    return sim_p->spi.total.commandBytes + sim_p->spi.total.dataBytes;
+}
+
+/**
+ * Lets the bytes still queued or shifting go out, so that a benchmark starts on an idle link
+ * and its time runs until its last pixel is on the panel. The writes return as soon as their
+ * last byte is in TXBUF, so the CPU cycles alone would leave out the tail on the wire.
+ */
+static void drain(SimDevice* sim_p)
+{
+    Spi_sync(sim_p);
+    if (sim_p->spi.shiftEnd > sim_p->cycles)
+        Sim_spend(sim_p, (uint32_t) (sim_p->spi.shiftEnd - sim_p->cycles));
+}
+
+static void runBenchmark(SimDevice* sim_p, GFX* gfx_p, const Benchmark* bench_p, int iterations,
+                         BenchResult* result_p)
+{
+    drain(sim_p);
+    uint64_t cycles = sim_p->cycles;
+    uint64_t bytes = spiBytes(sim_p);
+    uint32_t pixels = sim_p->panel.pixels;
+
+    int i;
+    for (i = 0; i < iterations; i++)
+        bench_p->run(gfx_p, bench_p->size);
+
+    drain(sim_p);
+    cycles = sim_p->cycles - cycles;
+    bytes = spiBytes(sim_p) - bytes;
+    pixels = sim_p->panel.pixels - pixels;
+
+    snprintf(result_p->name, sizeof(result_p->name), "%s", bench_p->name);
+    result_p->calls = iterations;
+    result_p->cyclesPerCall = (double) cycles / iterations;
+    result_p->bytesPerCall = (double) bytes / iterations;
+    result_p->pixelsPerCall = (double) pixels / iterations;
+    result_p->pixelsPerSecond = cycles ? (double) pixels * SIM_CPU_HZ / cycles : 0.0;
+}
+
+static bool saveJson(const char* path, const SimDevice* sim_p, const BenchResult* results)
+{
+    FILE* file = fopen(path, "w");
+    if (!file)
+        return false;
+
+    fprintf(file, "{\n  \"cpu_hz\": %d,\n  \"spi_byte_cycles\": %u,\n  \"benchmarks\": [\n",
+            SIM_CPU_HZ, (unsigned) sim_p->spi.byteCycles);
+    int i;
+    for (i = 0; i < BENCH_COUNT; i++) {
+        fprintf(file, "    { \"name\": \"%s\", \"calls\": %llu, \"cycles_per_call\": %.1f, "
+                      "\"bytes_per_call\": %.1f, \"pixels_per_call\": %.1f, "
+                      "\"pixels_per_second\": %.0f }%s\n",
+                results[i].name, (unsigned long long) results[i].calls,
+                results[i].cyclesPerCall, results[i].bytesPerCall, results[i].pixelsPerCall,
+                results[i].pixelsPerSecond, i + 1 < BENCH_COUNT ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+
+    return fclose(file) == 0;
+}
+
+/**
+ * Reads back a file written by saveJson(). Only that layout is understood: one benchmark
+ * object per line. Returns the number of benchmarks read, or -1 if the file cannot be opened.
+ */
+static int loadJson(const char* path, BenchResult* results, int capacity)
+{
+    FILE* file = fopen(path, "r");
+    if (!file)
+        return -1;
+
+    int count = 0;
+    char line[512];
+    while (count < capacity && fgets(line, sizeof(line), file)) {
+        BenchResult* result_p = &results[count];
+        unsigned long long calls;
+        if (sscanf(line, " { \"name\": \"%47[^\"]\", \"calls\": %llu, \"cycles_per_call\": %lf, "
+                         "\"bytes_per_call\": %lf, \"pixels_per_call\": %lf, "
+                         "\"pixels_per_second\": %lf", result_p->name, &calls,
+                   &result_p->cyclesPerCall, &result_p->bytesPerCall, &result_p->pixelsPerCall,
+                   &result_p->pixelsPerSecond) == 6) {
+            result_p->calls = calls;
+            count++;
+        }
+    }
+
+    fclose(file);
+    return count;
+}
+
+static const BenchResult* findResult(const BenchResult* results, int count, const char* name)
+{
+    int i;
+    for (i = 0; i < count; i++) {
+        if (strcmp(results[i].name, name) == 0)
+            return &results[i];
+    }
+    return NULL;
+}
+
+static double change(double before, double after)
+{
+    return before ? 100.0 * (after - before) / before : 0.0;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: lcd_bench [--iterations N] [--json FILE] [--baseline FILE]\n");
+    exit(2);
+}
+
+int main(int argc, char** argv)
+{
+    int iterations = 100;
+    const char* jsonPath = NULL;
+    const char* baselinePath = NULL;
+
+    int i;
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--iterations") == 0 && i + 1 < argc)
+            iterations = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+            jsonPath = argv[++i];
+        else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+            baselinePath = argv[++i];
+        else
+            usage();
+    }
+    if (iterations < 1)
+        usage();
+
+    static BenchResult baseline[BENCH_MAX_BASELINE];
+    int baselineCount = 0;
+    if (baselinePath) {
+        baselineCount = loadJson(baselinePath, baseline, BENCH_MAX_BASELINE);
+        if (baselineCount < 0) {
+            fprintf(stderr, "lcd_bench: cannot read %s\n", baselinePath);
+            return 1;
+        }
+    }
+
+    static SimDevice sim;
+    Sim_init(&sim);
+
+    static GFX gfx;
+    GFX_construct(&gfx, FG_COLOR, BG_COLOR);
+
+    BenchResult results[BENCH_COUNT];
+    for (i = 0; i < BENCH_COUNT; i++)
+        runBenchmark(&sim, &gfx, &benchmarks[i], iterations, &results[i]);
+
+    printf("%d calls each, SPI at %u CPU cycles per byte\n", iterations,
+           (unsigned) sim.spi.byteCycles);
+    printf("  %-28s %12s %10s %10s %14s", "benchmark", "cycles/call", "bytes/call",
+           "pixels/call", "pixels/s");
+    if (baselinePath)
+        printf(" %9s %9s", "cycles", "bytes");
+    printf("\n");
+    for (i = 0; i < BENCH_COUNT; i++) {
+        const BenchResult* result_p = &results[i];
+        printf("  %-28s %12.1f %10.1f %11.1f %14.0f", result_p->name, result_p->cyclesPerCall,
+               result_p->bytesPerCall, result_p->pixelsPerCall, result_p->pixelsPerSecond);
+        if (baselinePath) {
+            const BenchResult* before_p = findResult(baseline, baselineCount, result_p->name);
+            if (before_p)
+                printf(" %+8.1f%% %+8.1f%%", change(before_p->cyclesPerCall,
+                                                     result_p->cyclesPerCall),
+                       change(before_p->bytesPerCall, result_p->bytesPerCall));
+            else
+                printf(" %9s %9s", "new", "new");
+        }
+        printf("\n");
+    }
+
+    if (jsonPath && !saveJson(jsonPath, &sim, results)) {
+        fprintf(stderr, "lcd_bench: cannot write %s\n", jsonPath);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,377 @@
+/*
+ * pc_profile.c
+ *
+ * Symbolizes the program counter histogram of the firmware's sampling profiler
+ * (HAL/Profiler.h). Build the firmware with PROFILER defined, run it on the board, halt it and
+ * save the Profiler_profile structure from the debugger as raw binary; then
+ *
+ *   pc_profile [--top N] MAP PROFILE
+ *
+ * MAP is the linker map of the same build (the .map file the TI linker writes next to the
+ * .out with msp432p401r.cmd). Functions are taken from its section allocation map, where the
+ * compiler's per-function subsections (.text:NAME) give each function, static ones included,
+ * its address and length. Library objects linked as one .text section are split at the global
+ * symbols inside them. A histogram bucket that straddles two functions is shared by the bytes
+ * each has in it.
+ *
+ * The report ranks the --top N functions (30 by default) and every object file by the share of
+ * the awake samples they took, with the DriverLib ROM and unknown addresses as rows of their own.
+ */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <HAL/Profiler.h>
+
+#define MAX_NAME 96
+
+struct _Function
+{
+    uint32_t start;
+    uint32_t end;
+    char name[MAX_NAME];
+    char object[MAX_NAME];
+    double samples;
+};
+typedef struct _Function Function;
+
+struct _FunctionList
+{
+    Function* functions;
+    int count;
+    int capacity;
+};
+typedef struct _FunctionList FunctionList;
+
+static Function* addFunction(FunctionList* list_p, uint32_t start, uint32_t end, const char* name,
+                             const char* object)
+{
+    if (list_p->count == list_p->capacity) {
+        list_p->capacity = list_p->capacity ? 2 * list_p->capacity : 256;
+        list_p->functions = realloc(list_p->functions, list_p->capacity * sizeof(Function));
+        if (!list_p->functions) {
+            fprintf(stderr, "pc_profile: out of memory\n");
+            exit(1);
+        }
+    }
+
+    Function* function_p = &list_p->functions[list_p->count++];
+    memset(function_p, 0, sizeof(*function_p));
+    function_p->start = start;
+    function_p->end = end;
+    snprintf(function_p->name, MAX_NAME, "%s", name);
+    snprintf(function_p->object, MAX_NAME, "%s", object);
+    return function_p;
+}
+
+static int byStart(const void* a, const void* b)
+{
+    const Function* left_p = a;
+    const Function* right_p = b;
+    return (left_p->start > right_p->start) - (left_p->start < right_p->start);
+}
+
+static int bySamples(const void* a, const void* b)
+{
+    const Function* left_p = a;
+    const Function* right_p = b;
+    return (left_p->samples < right_p->samples) - (left_p->samples > right_p->samples);
+}
+
+/**
+ * Parses an input section line of the section allocation map, such as
+ *
+ *                   00000b32    0000032c     tamagotchi_main.obj (.text:main_loop)
+ *                   000000e4    00000a4e     msp432p4xx_driverlib.lib : adc14.o (.text)
+ *                   00000b32    0000009c                              : dma.o (.text)
+ *
+ * Returns false for lines that are not .text input sections.
+ */
+static bool parseSection(const char* line, uint32_t* start_p, uint32_t* length_p, char* name,
+                         char* object)
+{
+    unsigned start, length;
+    int consumed;
+    if (sscanf(line, " %x %x %n", &start, &length, &consumed) != 2 || length == 0)
+        return false;
+
+    const char* rest = line + consumed;
+    const char* open = strrchr(rest, '(');
+    const char* close = open ? strchr(open, ')') : NULL;
+    if (!open || !close || strncmp(open + 1, ".text", 5) != 0)
+        return false;
+
+    // The object is the member of the library when there is one; the library's name is left out
+    // on the lines that follow its first member
+    const char* objectStart = strstr(rest, ": ");
+    objectStart = objectStart && objectStart < open ? objectStart + 2 : rest;
+    int objectLength = (int) (open - objectStart);
+    while (objectLength > 0 && objectStart[objectLength - 1] == ' ')
+        objectLength--;
+    if (objectLength >= MAX_NAME)
+        objectLength = MAX_NAME - 1;
+    memcpy(object, objectStart, objectLength);
+    object[objectLength] = '\0';
+
+    // .text:NAME, or .text:NAME:NAME for some run-time library functions; plain .text has none
+    name[0] = '\0';
+    if (open[6] == ':') {
+        const char* nameStart = open + 7;
+        int nameLength = 0;
+        while (nameStart + nameLength < close && nameStart[nameLength] != ':')
+            nameLength++;
+        if (nameLength >= MAX_NAME)
+            nameLength = MAX_NAME - 1;
+        memcpy(name, nameStart, nameLength);
+        name[nameLength] = '\0';
+    }
+
+    *start_p = start;
+    *length_p = length;
+    return true;
+}
+
+/**
+ * Reads the functions out of a TI linker map. Returns false if the map has no code in it.
+ */
+static bool loadMap(const char* path, FunctionList* list_p)
+{
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "pc_profile: cannot read %s\n", path);
+        return false;
+    }
+
+    // Whole-object sections, to be split at the global symbols they contain
+    FunctionList objects = { 0 };
+    FunctionList symbols = { 0 };
+    bool inSymbols = false;
+
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        if (strstr(line, "GLOBAL SYMBOLS:")) {
+            inSymbols = strstr(line, "SORTED BY Symbol Address") != NULL;
+            continue;
+        }
+
+        // Addresses are eight digits, which keeps the "address   name" heading out
+        if (inSymbols) {
+            unsigned address;
+            int digits = 0;
+            char name[MAX_NAME];
+            if (sscanf(line, "%x%n %95s", &address, &digits, name) == 2 && digits == 8)
+                addFunction(&symbols, address & ~1u, 0, name, "");
+            continue;
+        }
+
+        uint32_t start, length;
+        char name[MAX_NAME], object[MAX_NAME];
+        if (!parseSection(line, &start, &length, name, object))
+            continue;
+        if (name[0])
+            addFunction(list_p, start, start + length, name, object);
+        else
+            addFunction(&objects, start, start + length, object, object);
+    }
+    fclose(file);
+
+    qsort(symbols.functions, symbols.count, sizeof(Function), byStart);
+
+    int i, j;
+    for (i = 0; i < objects.count; i++) {
+        const Function* object_p = &objects.functions[i];
+        uint32_t start = object_p->start;
+        const char* name = object_p->name;
+
+        for (j = 0; j < symbols.count; j++) {
+            const Function* symbol_p = &symbols.functions[j];
+            if (symbol_p->start < object_p->start || symbol_p->start >= object_p->end)
+                continue;
+            if (symbol_p->start > start)
+                addFunction(list_p, start, symbol_p->start, name, object_p->object);
+            start = symbol_p->start;
+            name = symbol_p->name;
+        }
+        addFunction(list_p, start, object_p->end, name, object_p->object);
+    }
+
+    free(objects.functions);
+    free(symbols.functions);
+
+    qsort(list_p->functions, list_p->count, sizeof(Function), byStart);
+    if (list_p->count == 0) {
+        fprintf(stderr, "pc_profile: no .text sections in %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+static Profile* loadProfile(const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "pc_profile: cannot read %s\n", path);
+        return NULL;
+    }
+
+    // The header is followed by as many buckets as the firmware was built with
+    size_t headerBytes = offsetof(Profile, buckets);
+    Profile header;
+    if (fread(&header, headerBytes, 1, file) != 1 || header.magic != PROFILER_MAGIC) {
+        fprintf(stderr, "pc_profile: %s is not a profile\n", path);
+        return NULL;
+    }
+    Profile* profile_p = malloc(headerBytes + header.bucketCount * sizeof(uint16_t));
+    if (!profile_p) {
+        fprintf(stderr, "pc_profile: out of memory\n");
+        return NULL;
+    }
+    memcpy(profile_p, &header, headerBytes);
+    if (fread(profile_p->buckets, sizeof(uint16_t), header.bucketCount, file) !=
+        header.bucketCount) {
+        fprintf(stderr, "pc_profile: %s is truncated\n", path);
+        return NULL;
+    }
+    fclose(file);
+    return profile_p;
+}
+
+/**
+ * Shares the samples of each bucket among the functions it overlaps. Returns the samples that
+ * fell on flash no function covers.
+ */
+static double attribute(const Profile* profile_p, FunctionList* list_p)
+{
+    uint32_t bucketBytes = 1u << profile_p->bucketShift;
+    double unmapped = 0;
+
+    int bucket, i = 0;
+    for (bucket = 0; bucket < profile_p->bucketCount; bucket++) {
+        uint32_t samples = profile_p->buckets[bucket];
+        if (samples == 0)
+            continue;
+
+        uint32_t start = bucket * bucketBytes, end = start + bucketBytes;
+        while (i < list_p->count && list_p->functions[i].end <= start)
+            i++;
+
+        uint32_t covered = 0;
+        int j;
+        for (j = i; j < list_p->count && list_p->functions[j].start < end; j++) {
+            Function* function_p = &list_p->functions[j];
+            uint32_t from = function_p->start > start ? function_p->start : start;
+            uint32_t to = function_p->end < end ? function_p->end : end;
+            if (to <= from)
+                continue;
+            function_p->samples += (double) samples * (to - from) / bucketBytes;
+            covered += to - from;
+        }
+        unmapped += (double) samples * (bucketBytes - covered) / bucketBytes;
+    }
+
+    return unmapped;
+}
+
+static void printRow(const char* name, const char* object, double samples, double total)
+{
+    printf("  %10.1f %6.2f%%  ", samples, total ? 100.0 * samples / total : 0.0);
+    if (object[0])
+        printf("%-40s %s\n", name, object);
+    else
+        printf("%s\n", name);
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: pc_profile [--top N] MAP PROFILE\n");
+    exit(2);
+}
+
+int main(int argc, char** argv)
+{
+    const char* mapPath = NULL;
+    const char* profilePath = NULL;
+    int top = 30;
+
+    int i;
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--top") == 0 && i + 1 < argc)
+            top = atoi(argv[++i]);
+        else if (!mapPath)
+            mapPath = argv[i];
+        else if (!profilePath)
+            profilePath = argv[i];
+        else
+            usage();
+    }
+    if (!profilePath)
+        usage();
+
+    FunctionList list = { 0 };
+    if (!loadMap(mapPath, &list))
+        return 1;
+    Profile* profile_p = loadProfile(profilePath);
+    if (!profile_p)
+        return 1;
+
+    uint32_t covered = (uint32_t) profile_p->bucketCount << profile_p->bucketShift;
+    uint32_t codeEnd = 0;
+    for (i = 0; i < list.count; i++) {
+        if (list.functions[i].end > codeEnd && list.functions[i].start < PROFILER_ROM_BASE)
+            codeEnd = list.functions[i].end;
+    }
+    if (codeEnd > covered)
+        fprintf(stderr, "pc_profile: the code ends at 0x%x but the histogram stops at 0x%x; "
+                        "raise PROFILER_CODE_BYTES\n", (unsigned) codeEnd, (unsigned) covered);
+
+    double unmapped = attribute(profile_p, &list);
+    double total = profile_p->samples;
+    double binned = total - profile_p->romSamples - profile_p->otherSamples;
+    double saturated = 0;
+    for (i = 0; i < profile_p->bucketCount; i++)
+        saturated += profile_p->buckets[i];
+    saturated = binned - saturated;
+
+    printf("%u samples at %u Hz, %.1f s awake\n", (unsigned) profile_p->samples,
+           (unsigned) profile_p->sampleHz,
+           profile_p->sampleHz ? (double) profile_p->samples / profile_p->sampleHz : 0.0);
+    if (saturated > 0)
+        printf("%.0f samples were lost to buckets that saturated\n", saturated);
+
+    // The objects, summed before the functions are reordered
+    FunctionList objects = { 0 };
+    for (i = 0; i < list.count; i++) {
+        const Function* function_p = &list.functions[i];
+        int j;
+        for (j = 0; j < objects.count; j++) {
+            if (strcmp(objects.functions[j].name, function_p->object) == 0)
+                break;
+        }
+        if (j == objects.count)
+            addFunction(&objects, 0, 0, function_p->object, "");
+        objects.functions[j].samples += function_p->samples;
+    }
+
+    qsort(list.functions, list.count, sizeof(Function), bySamples);
+    qsort(objects.functions, objects.count, sizeof(Function), bySamples);
+
+    printf("\n     samples  share  %-40s %s\n", "function", "object");
+    for (i = 0; i < list.count && i < top && list.functions[i].samples > 0; i++)
+        printRow(list.functions[i].name, list.functions[i].object, list.functions[i].samples,
+                 total);
+    printRow("(DriverLib ROM)", "", profile_p->romSamples, total);
+    printRow("(unmapped flash)", "", unmapped, total);
+    printRow("(other)", "", profile_p->otherSamples, total);
+
+    printf("\n     samples  share  %s\n", "object");
+    for (i = 0; i < objects.count && objects.functions[i].samples > 0; i++)
+        printRow(objects.functions[i].name, "", objects.functions[i].samples, total);
+
+    free(list.functions);
+    free(objects.functions);
+    free(profile_p);
+    return 0;
+}
@@ -0,0 +1,56 @@
+/*
+ * profile_synth.c
+ *
+ * Writes a profile the way the board would leave it, for host/pc_profile to read. HAL/Profiler.c
+ * is built with PROFILER defined and each PC:COUNT sample is fed to Profiler_sample() COUNT
+ * times in a stacked exception frame, as SysTick_Handler passes it; then Profiler_profile is
+ * saved as raw binary, as from the debugger:
+ *
+ *   profile_synth OUT PC:COUNT...
+ *
+ * PCs are hexadecimal. make check compares the output with traces/profile.bin, so a change to
+ * the Profile layout on either side shows up there.
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <HAL/Profiler.h>
+
+// The host has no SysTick; Profiler_start() only sets the header here
+void SysTick_enableModule(void) {}
+void SysTick_disableModule(void) {}
+void SysTick_enableInterrupt(void) {}
+void SysTick_setPeriod(uint32_t period) {}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2) {
+        fprintf(stderr, "usage: profile_synth OUT PC:COUNT...\n");
+        return 2;
+    }
+
+    Profiler_start(PROFILER_HZ);
+
+    int i;
+    for (i = 2; i < argc; i++) {
+        unsigned pc, count;
+        if (sscanf(argv[i], "%x:%u", &pc, &count) != 2) {
+            fprintf(stderr, "profile_synth: bad sample %s\n", argv[i]);
+            return 2;
+        }
+
+        uint32_t frame[8] = { 0 };
+        frame[6] = pc;
+        frame[7] = 0x01000000;      // xPSR with the Thumb bit
+        while (count--)
+            Profiler_sample(frame);
+    }
+
+    FILE* file = fopen(argv[1], "wb");
+    if (!file || fwrite(&Profiler_profile, sizeof(Profiler_profile), 1, file) != 1) {
+        fprintf(stderr, "profile_synth: cannot write %s\n", argv[1]);
+        return 1;
+    }
+    fclose(file);
+    return 0;
+}
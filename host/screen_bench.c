@@ -0,0 +1,287 @@
+/*
+ * screen_bench.c
+ *
+ * Measures the screen transitions of the game on the simulated board. It plays one full cycle,
+ * power-on -> TITLE_SCREEN -> INSTRUCTIONS_SCREEN -> GAME_SCREEN -> GAME_OVER ->
+ * INSTRUCTIONS_SCREEN, and reports for every transition the time from its trigger to the last
+ * pixel it changed, the SPI bytes it sent and the CPU cycles it took. The firmware does not
+ * look at its inputs until a transition is over, so the latency is also how long it is deaf.
+ *
+ *   screen_bench [--json FILE] [--baseline FILE] [--tolerance PCT]
+ *
+ * A transition is the unbroken run of wakes that change pixels around a screen clear: it is
+ * triggered when the first of them wakes up (the button press or the timer that ended the
+ * previous screen) and ends at the last byte that changed a pixel, once a whole wake went by
+ * without drawing anything new. --json saves the numbers; --baseline fails the run when any
+ * transition got slower, or sent more bytes, by more than the tolerance (5% by default).
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "sim/Sim.h"
+
+// The firmware's main(), renamed when tamagotchi_main.c is compiled for the host
+extern int Firmware_main(void);
+
+#define BENCH_MAX_TRANSITIONS   16
+#define BENCH_MAX_NAME          48
+
+// The transitions of the script below, in the order they happen
+static const char* const transitionNames[] =
+{
+    "power-on > TITLE_SCREEN",
+    "TITLE_SCREEN > INSTRUCTIONS_SCREEN",
+    "INSTRUCTIONS_SCREEN > GAME_SCREEN",
+    "GAME_SCREEN > GAME_OVER",
+    "GAME_OVER > INSTRUCTIONS_SCREEN",
+};
+
+#define NAMED_TRANSITIONS ((int) (sizeof(transitionNames) / sizeof(transitionNames[0])))
+
+// The title screen times out by itself; BB1 starts the game, the unfed pet leaves after about
+// 15 s, and BB1 on the end screen goes back to the instructions
+static const char* const script[] = { "5000:BB1", "25000:BB1" };
+#define SCRIPT_MS 27000
+
+struct _Transition
+{
+    char name[BENCH_MAX_NAME];
+    double latencyMs;
+    uint64_t bytes;
+    uint64_t cpuCycles;
+    uint64_t wakes;
+};
+typedef struct _Transition Transition;
+
+struct _Tracker
+{
+    // The device at the end of the previous wake
+    uint64_t bytes;
+    uint64_t waitCycles;
+    uint32_t changedPixels;
+    int screenCount;
+
+    // The run of drawing wakes in progress, if open
+    bool open;
+    int clears;
+    uint64_t triggerCycle;
+    Transition current;
+
+    Transition transitions[BENCH_MAX_TRANSITIONS];
+    int count;
+};
+typedef struct _Tracker Tracker;
+
+static uint64_t spiBytes(const SimDevice* sim_p)
+{
+    return sim_p->spi.total.commandBytes + sim_p->spi.total.dataBytes;
+}
+
+static void closeTransition(Tracker* tracker_p, const SimDevice* sim_p)
+{
+    tracker_p->open = false;
+
+    // Runs that did not clear the screen are updates within a screen
+    if (tracker_p->clears == 0 || tracker_p->count == BENCH_MAX_TRANSITIONS)
+        return;
+
+    Transition* transition_p = &tracker_p->transitions[tracker_p->count];
+    *transition_p = tracker_p->current;
+    if (tracker_p->count < NAMED_TRANSITIONS)
+        snprintf(transition_p->name, BENCH_MAX_NAME, "%s", transitionNames[tracker_p->count]);
+    else
+        snprintf(transition_p->name, BENCH_MAX_NAME, "#%d", tracker_p->count);
+    transition_p->latencyMs = (double) (sim_p->spi.lastPixelCycle - tracker_p->triggerCycle) /
+                              SIM_CYCLES_PER_MS;
+    tracker_p->count++;
+}
+
+// The sleep hook: looks at what the wake that is ending drew
+static void endWake(SimDevice* sim_p)
+{
+    Tracker* tracker_p = sim_p->sleepContext;
+
+    uint64_t bytes = spiBytes(sim_p);
+    uint32_t changedPixels = sim_p->panel.pixels - sim_p->panel.redundantPixels;
+    int clears = sim_p->spi.screenCount - tracker_p->screenCount;
+
+    // A deferred clear may not have changed a pixel yet by the end of the wake that queued it,
+    // and the DMA may still be sending a flushed frame buffer the panel mostly shows already
+    if (changedPixels != tracker_p->changedPixels || clears ||
+        (tracker_p->open && sim_p->dmaDoneCycle)) {
+        if (!tracker_p->open) {
+            tracker_p->open = true;
+            tracker_p->clears = 0;
+            tracker_p->triggerCycle = sim_p->wakeCycle;
+            memset(&tracker_p->current, 0, sizeof(tracker_p->current));
+        }
+        tracker_p->clears += clears;
+        tracker_p->current.bytes += bytes - tracker_p->bytes;
+        // Time spent in LPM0 waiting for the DMA is not CPU time
+        tracker_p->current.cpuCycles += sim_p->cycles - sim_p->wakeCycle -
+                                        (sim_p->waitCycles - tracker_p->waitCycles);
+        tracker_p->current.wakes++;
+    }
+    else if (tracker_p->open)
+        closeTransition(tracker_p, sim_p);
+
+    tracker_p->bytes = bytes;
+    tracker_p->waitCycles = sim_p->waitCycles;
+    tracker_p->changedPixels = changedPixels;
+    tracker_p->screenCount = sim_p->spi.screenCount;
+}
+
+static bool saveJson(const char* path, const Tracker* tracker_p)
+{
+    FILE* file = fopen(path, "w");
+    if (!file)
+        return false;
+
+    fprintf(file, "{\n  \"transitions\": [\n");
+    int i;
+    for (i = 0; i < tracker_p->count; i++) {
+        const Transition* transition_p = &tracker_p->transitions[i];
+        fprintf(file, "    { \"name\": \"%s\", \"latency_ms\": %.3f, \"bytes\": %llu, "
+                      "\"cpu_cycles\": %llu, \"wakes\": %llu }%s\n", transition_p->name,
+                transition_p->latencyMs, (unsigned long long) transition_p->bytes,
+                (unsigned long long) transition_p->cpuCycles,
+                (unsigned long long) transition_p->wakes, i + 1 < tracker_p->count ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+
+    return fclose(file) == 0;
+}
+
+/**
+ * Reads back a file written by saveJson(), one transition per line. Returns the number of
+ * transitions read, or -1 if the file cannot be opened.
+ */
+static int loadJson(const char* path, Transition* transitions, int capacity)
+{
+    FILE* file = fopen(path, "r");
+    if (!file)
+        return -1;
+
+    int count = 0;
+    char line[512];
+    while (count < capacity && fgets(line, sizeof(line), file)) {
+        Transition* transition_p = &transitions[count];
+        unsigned long long bytes, cpuCycles, wakes;
+        if (sscanf(line, " { \"name\": \"%47[^\"]\", \"latency_ms\": %lf, \"bytes\": %llu, "
+                         "\"cpu_cycles\": %llu, \"wakes\": %llu", transition_p->name,
+                   &transition_p->latencyMs, &bytes, &cpuCycles, &wakes) == 5) {
+            transition_p->bytes = bytes;
+            transition_p->cpuCycles = cpuCycles;
+            transition_p->wakes = wakes;
+            count++;
+        }
+    }
+
+    fclose(file);
+    return count;
+}
+
+static double change(double before, double after)
+{
+    return before ? 100.0 * (after - before) / before : 0.0;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: screen_bench [--json FILE] [--baseline FILE] [--tolerance PCT]\n");
+    exit(2);
+}
+
+int main(int argc, char** argv)
+{
+    const char* jsonPath = NULL;
+    const char* baselinePath = NULL;
+    double tolerance = 5;
+
+    int i;
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--json") == 0 && i + 1 < argc)
+            jsonPath = argv[++i];
+        else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc)
+            baselinePath = argv[++i];
+        else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc)
+            tolerance = atof(argv[++i]);
+        else
+            usage();
+    }
+
+    static Transition baseline[BENCH_MAX_TRANSITIONS];
+    int baselineCount = 0;
+    if (baselinePath) {
+        baselineCount = loadJson(baselinePath, baseline, BENCH_MAX_TRANSITIONS);
+        if (baselineCount < 0) {
+            fprintf(stderr, "screen_bench: cannot read %s\n", baselinePath);
+            return 1;
+        }
+    }
+
+    static SimDevice sim;
+    Sim_init(&sim);
+    for (i = 0; i < (int) (sizeof(script) / sizeof(script[0])); i++) {
+        SimInput input;
+        Sim_parseInput(script[i], &input);
+        Sim_addInput(&sim, &input);
+    }
+
+    static Tracker tracker;
+    tracker.screenCount = sim.spi.screenCount;
+    sim.sleepHook = endWake;
+    sim.sleepContext = &tracker;
+    Sim_run(&sim, Firmware_main, (uint64_t) SCRIPT_MS * SIM_CYCLES_PER_MS);
+    if (tracker.open)
+        closeTransition(&tracker, &sim);
+
+    printf("  %-36s %12s %8s %12s %6s", "transition", "latency ms", "bytes", "cpu cycles",
+           "wakes");
+    if (baselinePath)
+        printf(" %9s %9s %9s", "latency", "bytes", "cycles");
+    printf("\n");
+
+    bool regressed = false;
+    for (i = 0; i < tracker.count; i++) {
+        const Transition* transition_p = &tracker.transitions[i];
+        printf("  %-36s %12.3f %8llu %12llu %6llu", transition_p->name, transition_p->latencyMs,
+               (unsigned long long) transition_p->bytes,
+               (unsigned long long) transition_p->cpuCycles,
+               (unsigned long long) transition_p->wakes);
+
+        const Transition* before_p = NULL;
+        int j;
+        for (j = 0; j < baselineCount; j++) {
+            if (strcmp(baseline[j].name, transition_p->name) == 0)
+                before_p = &baseline[j];
+        }
+        if (before_p) {
+            double changes[3] = { change(before_p->latencyMs, transition_p->latencyMs),
+                                  change(before_p->bytes, transition_p->bytes),
+                                  change(before_p->cpuCycles, transition_p->cpuCycles) };
+            bool over = false;
+            for (j = 0; j < 3; j++) {
+                printf(" %+8.1f%%", changes[j]);
+                over |= changes[j] > tolerance;
+            }
+            if (over)
+                printf("  over the %.0f%% threshold", tolerance);
+            regressed |= over;
+        }
+        else if (baselinePath)
+            printf(" %9s %9s %9s", "new", "new", "new");
+        printf("\n");
+    }
+
+    if (jsonPath && !saveJson(jsonPath, &tracker)) {
+        fprintf(stderr, "screen_bench: cannot write %s\n", jsonPath);
+        return 1;
+    }
+    if (regressed) {
+        fprintf(stderr, "screen_bench: transitions regressed against %s\n", baselinePath);
+        return 1;
+    }
+    return 0;
+}
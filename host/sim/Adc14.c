@@ -0,0 +1,122 @@
+/*
+ * Adc14.c
+ *
+ * ADC14 running the repeated two-channel sequence HAL/Joystick.c sets up: MEM0 samples the
+ * joystick X axis and MEM1 the Y axis. The sequence period follows from the configured clock
+ * (SYSOSC at 25 MHz through the predivider and divider) and sample-and-hold time, plus the 16
+ * clocks a 14-bit conversion takes.
+ */
+
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include "Sim.h"
+
+#define SIM_SYSOSC_HZ           25000000
+#define SIM_ADC_CONVERT_CLOCKS  16
+#define SIM_ADC_CHANNELS        2
+
+static void Sim_adcUpdatePeriod(SimDevice* sim_p)
+{
+    uint64_t clocks = (uint64_t) (sim_p->adcSampleClocks + SIM_ADC_CONVERT_CLOCKS) *
+                      SIM_ADC_CHANNELS;
+    uint64_t divide = (uint64_t) sim_p->adcPredivider * sim_p->adcDivider;
+    sim_p->adcPeriod = clocks * divide * SIM_CPU_HZ / SIM_SYSOSC_HZ;
+}
+
+uint64_t Sim_adcNextEvent(const SimDevice* sim_p)
+{
+    return sim_p->adcRunning ? sim_p->adcNext : UINT64_MAX;
+}
+
+void Sim_adcEvent(SimDevice* sim_p)
+{
+    sim_p->adcMem[0] = sim_p->joystickX;
+    sim_p->adcMem[1] = sim_p->joystickY;
+    sim_p->adcNext += sim_p->adcPeriod;
+
+    // ADC_INT0 flags the end of the MEM0 conversion
+    sim_p->adcIfg |= ADC_INT0;
+    if (sim_p->adcIe & ADC_INT0)
+        Sim_raiseInterrupt(sim_p, INT_ADC14);
+}
+
+bool ADC14_enableModule(void)
+{
+    Sim_device->adcEnabled = true;
+    return true;
+}
+
+bool ADC14_initModule(uint32_t clockSource, uint32_t clockPredivider, uint32_t clockDivider,
+                      uint32_t internalChannelMask)
+{
+    switch (clockPredivider)
+    {
+        case ADC_PREDIVIDER_4:  Sim_device->adcPredivider = 4;  break;
+        case ADC_PREDIVIDER_32: Sim_device->adcPredivider = 32; break;
+        case ADC_PREDIVIDER_64: Sim_device->adcPredivider = 64; break;
+        default:                Sim_device->adcPredivider = 1;  break;
+    }
+    Sim_device->adcDivider = (clockDivider >> 18) + 1;
+    Sim_adcUpdatePeriod(Sim_device);
+    return true;
+}
+
+bool ADC14_configureMultiSequenceMode(uint32_t memoryStart, uint32_t memoryEnd, bool repeatMode)
+{
+    return true;
+}
+
+bool ADC14_setSampleHoldTime(uint32_t firstPulseWidth, uint32_t secondPulseWidth)
+{
+    Sim_device->adcSampleClocks = (firstPulseWidth == ADC_PULSE_WIDTH_192) ? 192 : 4;
+    Sim_adcUpdatePeriod(Sim_device);
+    return true;
+}
+
+bool ADC14_enableSampleTimer(uint32_t multiSampleConvert)
+{
+    return true;
+}
+
+bool ADC14_enableConversion(void)
+{
+    return Sim_device->adcEnabled;
+}
+
+bool ADC14_toggleConversionTrigger(void)
+{
+    SimDevice* sim_p = Sim_device;
+    if (!sim_p->adcEnabled)
+        return false;
+
+    Energy_update(sim_p);
+    sim_p->adcRunning = true;
+    sim_p->adcNext = sim_p->cycles + sim_p->adcPeriod;
+    Sim_reschedule(sim_p);
+    return true;
+}
+
+bool ADC14_configureConversionMemory(uint32_t memorySelect, uint32_t refSelect,
+                                     uint32_t channelSelect, bool differntialMode)
+{
+    return true;
+}
+
+uint_fast16_t ADC14_getResult(uint32_t memorySelect)
+{
+    return Sim_device->adcMem[memorySelect & 31];
+}
+
+void ADC14_enableInterrupt(uint_fast64_t mask)
+{
+    Sim_device->adcIe |= mask;
+}
+
+void ADC14_clearInterruptFlag(uint_fast64_t mask)
+{
+    Sim_device->adcIfg &= ~mask;
+}
+
+uint_fast64_t ADC14_getEnabledInterruptStatus(void)
+{
+    return Sim_device->adcIfg & Sim_device->adcIe;
+}
@@ -0,0 +1,99 @@
+/*
+ * Dma.c
+ *
+ * The DMA controller, in basic mode, feeding UCB0TXBUF. Once a channel is enabled it writes a
+ * byte into TXBUF every time TXIFG says TXBUF is free, so its bytes go out back to back at the
+ * SPI clock with no CPU time charged; they are handed to the SPI model right away, which
+ * schedules each on the wire where it belongs. The channel is done, and raises INT_DMA_INT0
+ * while that interrupt is enabled, when its last byte is in TXBUF: when the byte before it
+ * starts shifting. The firmware sleeps in the meantime. Only transfers into UCB0TXBUF are
+ * modelled, and the control table the firmware hands over is only checked for alignment.
+ */
+
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include "Sim.h"
+
+uint64_t Sim_dmaNextEvent(const SimDevice* sim_p)
+{
+    return sim_p->dmaDoneCycle ? sim_p->dmaDoneCycle : UINT64_MAX;
+}
+
+void Sim_dmaEvent(SimDevice* sim_p)
+{
+    sim_p->dmaDoneCycle = 0;
+    Sim_raiseInterrupt(sim_p, INT_DMA_INT0);
+}
+
+void DMA_enableModule(void)
+{
+    Sim_device->dmaEnabled = true;
+}
+
+// The table is not read, but the controller ignores the low address bits, so check them
+void DMA_setControlBase(void *controlTable)
+{
+    if ((uintptr_t) controlTable & 1023)
+        fprintf(stderr, "sim: DMA control table at %p is not aligned to 1024 bytes\n",
+                controlTable);
+}
+
+void DMA_assignChannel(uint32_t mapping)
+{
+}
+
+void DMA_disableChannelAttribute(uint32_t channelNum, uint32_t attr)
+{
+}
+
+void DMA_setChannelControl(uint32_t channelStructIndex, uint32_t control)
+{
+    Sim_device->dma[channelStructIndex & (SIM_DMA_CHANNELS - 1)].control = control;
+}
+
+void DMA_setChannelTransfer(uint32_t channelStructIndex, uint32_t mode, void *srcAddr,
+                            void *dstAddr, uint32_t transferSize)
+{
+    SimDmaChannel* channel_p = &Sim_device->dma[channelStructIndex & (SIM_DMA_CHANNELS - 1)];
+    channel_p->source = srcAddr;
+    channel_p->destination = dstAddr;
+    channel_p->size = (mode == UDMA_MODE_BASIC) ? transferSize : 0;
+}
+
+void DMA_enableChannel(uint32_t channelNum)
+{
+    SimDevice* sim_p = Sim_device;
+    SimDmaChannel* channel_p = &sim_p->dma[channelNum & (SIM_DMA_CHANNELS - 1)];
+    if (!sim_p->dmaEnabled || channel_p->size == 0)
+        return;
+    if ((uintptr_t) channel_p->destination !=
+        SPI_getTransmitBufferAddressForDMA(EUSCI_B0_BASE)) {
+        fprintf(stderr, "sim: DMA is only modelled into UCB0TXBUF\n");
+        return;
+    }
+
+    // Whatever the CPU left in TXBUF goes first
+    Spi_sync(sim_p);
+
+    bool fixed = (channel_p->control & UDMA_SRC_INC_NONE) == UDMA_SRC_INC_NONE;
+    uint64_t written = sim_p->cycles;
+    uint32_t i;
+    for (i = 0; i < channel_p->size; i++) {
+        // TXBUF takes the byte as soon as the one before it moves into the shift register
+        written = (sim_p->spi.shiftStart > sim_p->cycles) ? sim_p->spi.shiftStart : sim_p->cycles;
+        Spi_dmaWrite(sim_p, channel_p->source[fixed ? 0 : i]);
+    }
+    channel_p->size = 0;
+
+    sim_p->dmaDoneCycle = (written > sim_p->cycles) ? written : sim_p->cycles;
+    Sim_reschedule(sim_p);
+}
+
+void DMA_clearInterruptFlag(uint32_t intChannel)
+{
+}
+
+// As in DriverLib, this only sets the source routing of DMA_INT1-3, which the model does not
+// need; the NVIC line has to be enabled with Interrupt_enableInterrupt()
+void DMA_enableInterrupt(uint32_t interruptNumber)
+{
+}
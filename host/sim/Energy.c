@@ -0,0 +1,183 @@
+/*
+ * Energy.c
+ *
+ * The current model, its integration over the simulated clock and the energy report.
+ */
+
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Sim.h"
+
+/**
+ * Rough typical values at 3.3 V. The MCU figures are of the order the MSP432P401R datasheet
+ * gives for AM_LDO_VCORE1 at 48 MHz running from flash and for LPM0 with the DCO at 48 MHz;
+ * ADC14 and eUSCI_B0 add their module currents. The LED figures assume the boards' series
+ * resistors with the LED fully on. Measure the board and override with Energy_setCurrent().
+ */
+const EnergyModel Energy_defaultModel =
+{
+    .activeUa = 4600,
+    .lpm0Ua   = 1500,
+    .adcUa    = 200,
+    .spiUa    = 100,
+    .ledUa    = { 1500, 1500, 1000, 1000, 4000, 4000, 4000 },
+};
+
+// Where each LED is wired (HAL/LED.c); an LED is lit while its pin is an output driven high
+static const struct
+{
+    const char* name;
+    uint8_t port;
+    uint16_t pin;
+} Energy_leds[ENERGY_LED_COUNT] =
+{
+    { "LL1", GPIO_PORT_P1, GPIO_PIN0 },
+    { "LLR", GPIO_PORT_P2, GPIO_PIN0 },
+    { "LLG", GPIO_PORT_P2, GPIO_PIN1 },
+    { "LLB", GPIO_PORT_P2, GPIO_PIN2 },
+    { "BLR", GPIO_PORT_P2, GPIO_PIN6 },
+    { "BLG", GPIO_PORT_P2, GPIO_PIN4 },
+    { "BLB", GPIO_PORT_P5, GPIO_PIN6 },
+};
+
+static EnergyStats* Energy_screen(SimDevice* sim_p)
+{
+    return &sim_p->energy.screens[sim_p->spi.screenCount - 1];
+}
+
+static double Energy_ledCurrent(const SimDevice* sim_p)
+{
+    double ua = 0;
+    int i;
+    for (i = 0; i < ENERGY_LED_COUNT; i++) {
+        uint8_t port = Energy_leds[i].port;
+        if (sim_p->gpioDir[port] & sim_p->gpioOut[port] & Energy_leds[i].pin)
+            ua += sim_p->energy.model.ledUa[i];
+    }
+    return ua;
+}
+
+void Energy_update(SimDevice* sim_p)
+{
+    EnergyMeter* meter_p = &sim_p->energy;
+    if (sim_p->cycles <= meter_p->lastCycle)
+        return;
+
+    uint64_t elapsed = sim_p->cycles - meter_p->lastCycle;
+    meter_p->lastCycle = sim_p->cycles;
+
+    double cpu = (meter_p->sleeping ? meter_p->model.lpm0Ua : meter_p->model.activeUa) * elapsed;
+    double adc = sim_p->adcRunning ? meter_p->model.adcUa * elapsed : 0;
+    double leds = Energy_ledCurrent(sim_p) * elapsed;
+
+    EnergyStats* stats[2] = { Energy_screen(sim_p), &meter_p->total };
+    int i;
+    for (i = 0; i < 2; i++) {
+        stats[i]->cycles += elapsed;
+        if (!meter_p->sleeping)
+            stats[i]->activeCycles += elapsed;
+        stats[i]->cpu += cpu;
+        stats[i]->adc += adc;
+        stats[i]->leds += leds;
+    }
+}
+
+void Energy_sleep(SimDevice* sim_p, bool sleeping)
+{
+    Energy_update(sim_p);
+    sim_p->energy.sleeping = sleeping;
+}
+
+void Energy_spiByte(SimDevice* sim_p)
+{
+    double spi = sim_p->energy.model.spiUa * sim_p->spi.byteCycles;
+    Energy_screen(sim_p)->spi += spi;
+    sim_p->energy.total.spi += spi;
+}
+
+bool Energy_setCurrent(EnergyModel* model_p, const char* text)
+{
+    const char* equals = strchr(text, '=');
+    if (!equals)
+        return false;
+    char* end;
+    double ua = strtod(equals + 1, &end);
+    if (end == equals + 1 || *end != '\0' || ua < 0)
+        return false;
+
+    size_t length = equals - text;
+    double* current_p = NULL;
+    if (length == 6 && strncmp(text, "ACTIVE", length) == 0)
+        current_p = &model_p->activeUa;
+    else if (length == 4 && strncmp(text, "LPM0", length) == 0)
+        current_p = &model_p->lpm0Ua;
+    else if (length == 3 && strncmp(text, "ADC", length) == 0)
+        current_p = &model_p->adcUa;
+    else if (length == 3 && strncmp(text, "SPI", length) == 0)
+        current_p = &model_p->spiUa;
+    else {
+        int i;
+        for (i = 0; i < ENERGY_LED_COUNT; i++) {
+            if (length == 3 && strncmp(text, Energy_leds[i].name, length) == 0)
+                current_p = &model_p->ledUa[i];
+        }
+    }
+    if (!current_p)
+        return false;
+
+    *current_p = ua;
+    return true;
+}
+
+static double Energy_totalCharge(const EnergyStats* stats_p)
+{
+    return stats_p->cpu + stats_p->adc + stats_p->spi + stats_p->leds;
+}
+
+double Energy_averageUa(const SimDevice* sim_p)
+{
+    const EnergyStats* total_p = &sim_p->energy.total;
+    return total_p->cycles ? Energy_totalCharge(total_p) / total_p->cycles : 0.0;
+}
+
+static void Energy_printRow(FILE* out, const char* name, const EnergyStats* stats_p,
+                            double batteryMah)
+{
+    if (stats_p->cycles == 0)
+        return;
+
+    double cycles = (double) stats_p->cycles;
+    double averageUa = Energy_totalCharge(stats_p) / cycles;
+    fprintf(out, "  %-10s %10.0f %6.1f%% %9.1f %9.1f %9.1f %9.1f %9.1f %10.1f\n", name,
+            cycles / SIM_CYCLES_PER_MS, 100.0 * stats_p->activeCycles / cycles, averageUa,
+            stats_p->cpu / cycles, stats_p->adc / cycles, stats_p->spi / cycles,
+            stats_p->leds / cycles, batteryMah * 1000 / averageUa);
+}
+
+void Energy_printReport(FILE* out, const SimDevice* sim_p, double batteryMah)
+{
+    const EnergyMeter* meter_p = &sim_p->energy;
+    const EnergyModel* model_p = &meter_p->model;
+    int i;
+
+    fprintf(out, "Energy: active %.0f uA, LPM0 %.0f uA, ADC14 %.0f uA, SPI %.0f uA, LEDs",
+            model_p->activeUa, model_p->lpm0Ua, model_p->adcUa, model_p->spiUa);
+    for (i = 0; i < ENERGY_LED_COUNT; i++)
+        fprintf(out, " %s %.0f", Energy_leds[i].name, model_p->ledUa[i]);
+    fprintf(out, " uA\n");
+
+    fprintf(out, "  %-10s %10s %7s %9s %9s %9s %9s %9s %10s\n", "screen", "ms", "awake",
+            "avg uA", "cpu uA", "adc uA", "spi uA", "led uA", "battery h");
+    for (i = 0; i < sim_p->spi.screenCount; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), i ? "#%d" : "#%d (boot)", i);
+        Energy_printRow(out, name, &meter_p->screens[i], batteryMah);
+    }
+    Energy_printRow(out, "total", &meter_p->total, batteryMah);
+
+    double averageUa = Energy_averageUa(sim_p);
+    if (averageUa > 0)
+        fprintf(out, "  %.1f uA average: %.0f h (%.1f days) on %.0f mAh\n", averageUa,
+                batteryMah * 1000 / averageUa, batteryMah * 1000 / averageUa / 24, batteryMah);
+}
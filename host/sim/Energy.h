@@ -0,0 +1,82 @@
+/*
+ * Energy.h
+ *
+ * An estimate of the current the board draws from its supply, integrated over the simulated
+ * clock. The MCU draws the current of its power mode: active at 48 MHz while the firmware
+ * runs, LPM0 while it waits in PCM_gotoLPM0(). On top of that come ADC14 while its conversion
+ * sequence repeats, eUSCI_B0 for the wire time of every byte sent to the LCD, and each LED for
+ * as long as its pin drives it. The LCD panel's supply and backlight are not under the
+ * firmware's control and are left out.
+ *
+ * The totals are kept for the whole run and per screen (see Spi.h), so a report can tell what
+ * the device would draw, and how long a battery would last, if it stayed on any one screen.
+ */
+
+#ifndef SIM_ENERGY_H_
+#define SIM_ENERGY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "Spi.h"
+
+// The LEDs on the Launchpad (LL1, LLR, LLG, LLB) and the BoosterPack (BLR, BLG, BLB)
+#define ENERGY_LED_COUNT    7
+
+// Supply current of each consumer while it is on, in uA
+struct _EnergyModel
+{
+    double activeUa;
+    double lpm0Ua;
+    double adcUa;
+    double spiUa;
+    double ledUa[ENERGY_LED_COUNT];
+};
+typedef struct _EnergyModel EnergyModel;
+
+// Typical figures, not measurements; Energy_setCurrent() replaces any of them
+extern const EnergyModel Energy_defaultModel;
+
+// Charge drawn over a stretch of time, in uA x CPU cycles, split by consumer
+struct _EnergyStats
+{
+    uint64_t cycles;
+    uint64_t activeCycles;
+    double cpu;
+    double adc;
+    double spi;
+    double leds;
+};
+typedef struct _EnergyStats EnergyStats;
+
+struct _EnergyMeter
+{
+    EnergyModel model;
+    bool sleeping;
+    uint64_t lastCycle;         // Everything before this cycle has been integrated
+    EnergyStats screens[SPI_MAX_SCREENS];
+    EnergyStats total;
+};
+typedef struct _EnergyMeter EnergyMeter;
+
+struct _SimDevice;
+
+// Integrates the current drawn up to now; called before anything that changes the current
+void Energy_update(struct _SimDevice* sim_p);
+
+// The CPU enters (sleeping) or leaves LPM0
+void Energy_sleep(struct _SimDevice* sim_p, bool sleeping);
+
+// Charges the wire time of one byte on the SPI link
+void Energy_spiByte(struct _SimDevice* sim_p);
+
+// Parses "NAME=UA" (NAME is ACTIVE, LPM0, ADC, SPI or an LED: LL1, LLR, ..., BLB) into the model
+bool Energy_setCurrent(EnergyModel* model_p, const char* text);
+
+// Average current over the whole run so far, in uA
+double Energy_averageUa(const struct _SimDevice* sim_p);
+
+// Prints the average current and battery life per screen and for the whole run
+void Energy_printReport(FILE* out, const struct _SimDevice* sim_p, double batteryMah);
+
+#endif /* SIM_ENERGY_H_ */
@@ -0,0 +1,123 @@
+/*
+ * Gpio.c
+ *
+ * GPIO ports with the Launchpad and BoosterPack buttons wired to them.
+ */
+
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include "Sim.h"
+
+// Where each SimButton is wired, and the port interrupt it raises
+static const struct
+{
+    uint8_t port;
+    uint16_t pin;
+    uint32_t interruptNumber;
+} Sim_buttonPins[SIM_BUTTON_COUNT] =
+{
+    { GPIO_PORT_P1, GPIO_PIN1, INT_PORT1 },     // LB1
+    { GPIO_PORT_P1, GPIO_PIN4, INT_PORT1 },     // LB2
+    { GPIO_PORT_P5, GPIO_PIN1, INT_PORT5 },     // BB1
+    { GPIO_PORT_P3, GPIO_PIN5, INT_PORT3 },     // BB2
+    { GPIO_PORT_P4, GPIO_PIN1, INT_PORT4 },     // JSB
+};
+
+void Sim_gpioPress(SimDevice* sim_p, SimButton button)
+{
+    uint8_t port = Sim_buttonPins[button].port;
+    uint16_t pin = Sim_buttonPins[button].pin;
+
+    // Pressing pulls the pin low; releasing is not modelled since no handler watches it
+    sim_p->gpioIn[port] &= ~pin;
+    if (sim_p->gpioIes[port] & pin) {
+        sim_p->gpioIfg[port] |= pin;
+        if (sim_p->gpioIe[port] & pin)
+            Sim_raiseInterrupt(sim_p, Sim_buttonPins[button].interruptNumber);
+    }
+    sim_p->gpioIn[port] |= pin;
+}
+
+void GPIO_setAsOutputPin(uint_fast8_t selectedPort, uint_fast16_t selectedPins)
+{
+    Energy_update(Sim_device);
+    Sim_device->gpioDir[selectedPort] |= selectedPins;
+}
+
+void GPIO_setAsInputPinWithPullUpResistor(uint_fast8_t selectedPort, uint_fast16_t selectedPins)
+{
+    Sim_device->gpioDir[selectedPort] &= ~selectedPins;
+}
+
+void GPIO_setAsPeripheralModuleFunctionInputPin(uint_fast8_t selectedPort,
+                                                uint_fast16_t selectedPins, uint_fast8_t mode)
+{
+    Sim_device->gpioDir[selectedPort] &= ~selectedPins;
+}
+
+void GPIO_setAsPeripheralModuleFunctionOutputPin(uint_fast8_t selectedPort,
+                                                 uint_fast16_t selectedPins, uint_fast8_t mode)
+{
+    Sim_device->gpioDir[selectedPort] |= selectedPins;
+}
+
+void GPIO_setOutputHighOnPin(uint_fast8_t selectedPort, uint_fast16_t selectedPins)
+{
+    // A byte still in TXBUF leaves with the old pin levels (D/C in particular)
+    Spi_sync(Sim_device);
+    Spi_checkDc(Sim_device, selectedPort, Sim_device->gpioOut[selectedPort] | selectedPins);
+    Energy_update(Sim_device);
+    Sim_device->gpioOut[selectedPort] |= selectedPins;
+}
+
+void GPIO_setOutputLowOnPin(uint_fast8_t selectedPort, uint_fast16_t selectedPins)
+{
+    // A byte still in TXBUF leaves with the old pin levels (D/C in particular)
+    Spi_sync(Sim_device);
+    Spi_checkDc(Sim_device, selectedPort, Sim_device->gpioOut[selectedPort] & ~selectedPins);
+    Energy_update(Sim_device);
+    Sim_device->gpioOut[selectedPort] &= ~selectedPins;
+}
+
+void GPIO_toggleOutputOnPin(uint_fast8_t selectedPort, uint_fast16_t selectedPins)
+{
+    // A byte still in TXBUF leaves with the old pin levels (D/C in particular)
+    Spi_sync(Sim_device);
+    Spi_checkDc(Sim_device, selectedPort, Sim_device->gpioOut[selectedPort] ^ selectedPins);
+    Energy_update(Sim_device);
+    Sim_device->gpioOut[selectedPort] ^= selectedPins;
+}
+
+uint8_t GPIO_getInputPinValue(uint_fast8_t selectedPort, uint_fast16_t selectedPins)
+{
+    return (Sim_device->gpioIn[selectedPort] & selectedPins) ? GPIO_INPUT_PIN_HIGH
+                                                              : GPIO_INPUT_PIN_LOW;
+}
+
+void GPIO_enableInterrupt(uint_fast8_t selectedPort, uint_fast16_t selectedPins)
+{
+    Sim_device->gpioIe[selectedPort] |= selectedPins;
+}
+
+void GPIO_disableInterrupt(uint_fast8_t selectedPort, uint_fast16_t selectedPins)
+{
+    Sim_device->gpioIe[selectedPort] &= ~selectedPins;
+}
+
+uint_fast16_t GPIO_getInterruptStatus(uint_fast8_t selectedPort, uint_fast16_t selectedPins)
+{
+    return Sim_device->gpioIfg[selectedPort] & selectedPins;
+}
+
+void GPIO_clearInterruptFlag(uint_fast8_t selectedPort, uint_fast16_t selectedPins)
+{
+    Sim_device->gpioIfg[selectedPort] &= ~selectedPins;
+}
+
+void GPIO_interruptEdgeSelect(uint_fast8_t selectedPort, uint_fast16_t selectedPins,
+                              uint_fast8_t edgeSelect)
+{
+    if (edgeSelect == GPIO_HIGH_TO_LOW_TRANSITION)
+        Sim_device->gpioIes[selectedPort] |= selectedPins;
+    else
+        Sim_device->gpioIes[selectedPort] &= ~selectedPins;
+}
@@ -0,0 +1,102 @@
+/*
+ * InputReplay.c
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "Sim.h"
+#include "InputReplay.h"
+
+bool InputReplay_save(const char* path, const InputTraceEvent* events, uint32_t count)
+{
+    FILE* file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    InputTraceHeader header;
+    header.magic = INPUT_TRACE_MAGIC;
+    header.version = INPUT_TRACE_VERSION;
+    header.eventSize = sizeof(InputTraceEvent);
+    header.clockHz = SIM_CPU_HZ;
+    header.eventCount = count;
+
+    bool ok = fwrite(&header, sizeof(header), 1, file) == 1 &&
+              fwrite(events, sizeof(InputTraceEvent), count, file) == count;
+    return fclose(file) == 0 && ok;
+}
+
+static SimButton InputReplay_button(InputTraceSource source)
+{
+    switch (source)
+    {
+        case INPUT_TRACE_LB1:   return SIM_LB1;
+        case INPUT_TRACE_LB2:   return SIM_LB2;
+        case INPUT_TRACE_BB1:   return SIM_BB1;
+        case INPUT_TRACE_BB2:   return SIM_BB2;
+        default:                return SIM_JSB;
+    }
+}
+
+bool InputReplay_load(SimDevice* sim_p, const char* path)
+{
+    FILE* file = fopen(path, "rb");
+    if (!file) {
+        fprintf(stderr, "replay: cannot open %s\n", path);
+        return false;
+    }
+
+    InputTraceHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != INPUT_TRACE_MAGIC ||
+        header.version != INPUT_TRACE_VERSION || header.eventSize != sizeof(InputTraceEvent)) {
+        fprintf(stderr, "replay: %s is not a version %d input trace\n", path,
+                INPUT_TRACE_VERSION);
+        fclose(file);
+        return false;
+    }
+    if (header.clockHz != SIM_CPU_HZ) {
+        fprintf(stderr, "replay: %s was recorded at %u Hz, the model runs at %u Hz\n", path,
+                (unsigned) header.clockHz, (unsigned) SIM_CPU_HZ);
+        fclose(file);
+        return false;
+    }
+
+    uint64_t cycle = 0;
+    uint32_t i;
+    for (i = 0; i < header.eventCount; i++) {
+        InputTraceEvent event;
+        if (fread(&event, sizeof(event), 1, file) != 1) {
+            fprintf(stderr, "replay: %s ends after %u of %u events\n", path, (unsigned) i,
+                    (unsigned) header.eventCount);
+            fclose(file);
+            return false;
+        }
+        cycle += event.delta;
+
+        InputTraceSource source = INPUT_TRACE_SOURCE(event.payload);
+        if (source == INPUT_TRACE_IDLE)
+            continue;
+
+        SimInput input;
+        memset(&input, 0, sizeof(input));
+        if (source == INPUT_TRACE_JOYSTICK) {
+            input.cycle = (cycle > INPUT_REPLAY_SAMPLE_LEAD) ? cycle - INPUT_REPLAY_SAMPLE_LEAD : 0;
+            input.isJoystick = true;
+            input.x = INPUT_TRACE_X(event.payload);
+            input.y = INPUT_TRACE_Y(event.payload);
+        }
+        else {
+            input.cycle = cycle;
+            input.button = InputReplay_button(source);
+        }
+
+        if (!Sim_addInput(sim_p, &input)) {
+            fprintf(stderr, "replay: %s has more than %d events\n", path, SIM_MAX_INPUTS);
+            fclose(file);
+            return false;
+        }
+    }
+
+    fclose(file);
+    return true;
+}
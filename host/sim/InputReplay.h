@@ -0,0 +1,30 @@
+/*
+ * InputReplay.h
+ *
+ * Reads and writes input trace files (see HAL/InputTrace.h) and turns a trace into the
+ * scripted inputs of a simulation run, so a game recorded on the board or in an earlier run
+ * is played back with every tap and joystick reading at its recorded cycle.
+ */
+
+#ifndef SIM_INPUTREPLAY_H_
+#define SIM_INPUTREPLAY_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <HAL/InputTrace.h>
+
+struct _SimDevice;
+
+// A joystick reading is applied this long before the conversion that recorded it, which ends
+// at most an interrupt latency before the recorded time and a full sequence period after the
+// one before it
+#define INPUT_REPLAY_SAMPLE_LEAD    (SIM_CYCLES_PER_MS)
+
+// Writes a trace file; returns false if it cannot be written
+bool InputReplay_save(const char* path, const InputTraceEvent* events, uint32_t count);
+
+// Schedules every event of a trace file on the device; returns false and prints the reason if
+// the file cannot be read, is not a trace, or has more events than the device can schedule
+bool InputReplay_load(struct _SimDevice* sim_p, const char* path);
+
+#endif /* SIM_INPUTREPLAY_H_ */
@@ -0,0 +1,134 @@
+/*
+ * Overdraw.c
+ */
+
+#include <math.h>
+#include "Sim.h"
+
+#define HEATMAP_GAP     2
+
+void Overdraw_endPass(SimDevice* sim_p)
+{
+    OverdrawStats* stats_p = &sim_p->overdraw;
+    uint32_t pixels = sim_p->panel.pixels - stats_p->passPixels;
+    uint32_t redundantPixels = sim_p->panel.redundantPixels - stats_p->passRedundantPixels;
+    stats_p->passPixels = sim_p->panel.pixels;
+    stats_p->passRedundantPixels = sim_p->panel.redundantPixels;
+
+    stats_p->passes++;
+    if (pixels == 0)
+        return;
+    stats_p->drawingPasses++;
+    if (redundantPixels == pixels)
+        stats_p->wastedPasses++;
+    if (pixels > stats_p->maxPixels)
+        stats_p->maxPixels = pixels;
+    if (redundantPixels > stats_p->maxRedundantPixels)
+        stats_p->maxRedundantPixels = redundantPixels;
+}
+
+static double percent(uint64_t part, uint64_t whole)
+{
+    return whole ? 100.0 * part / whole : 0.0;
+}
+
+static void Overdraw_printRow(FILE* out, const char* name, const SpiStats* stats_p)
+{
+    fprintf(out, "  %-18s %10llu %10llu %6.1f%%\n", name, (unsigned long long) stats_p->pixels,
+            (unsigned long long) stats_p->redundantPixels,
+            percent(stats_p->redundantPixels, stats_p->pixels));
+}
+
+void Overdraw_printReport(FILE* out, const SimDevice* sim_p)
+{
+    const Panel* panel_p = &sim_p->panel;
+    const SpiLink* spi_p = &sim_p->spi;
+    const OverdrawStats* stats_p = &sim_p->overdraw;
+
+    // Every redundant pixel is two data bytes the panel did not need
+    uint64_t bytes = spi_p->total.commandBytes + spi_p->total.dataBytes;
+    uint64_t wastedBytes = 2 * (uint64_t) panel_p->redundantPixels;
+    fprintf(out, "LCD overdraw: %u pixels written, %u (%.1f%%) changed nothing\n",
+            (unsigned) panel_p->pixels, (unsigned) panel_p->redundantPixels,
+            percent(panel_p->redundantPixels, panel_p->pixels));
+    fprintf(out, "  wasted SPI bandwidth: %llu of %llu bytes (%.1f%%), %.1f ms of wire time\n",
+            (unsigned long long) wastedBytes, (unsigned long long) bytes,
+            percent(wastedBytes, bytes), wastedBytes * spi_p->byteCycles * 1e3 / SIM_CPU_HZ);
+
+    uint32_t untouched = 0, maxWrites = 0;
+    int x, y, maxX = 0, maxY = 0;
+    for (y = 0; y < PANEL_HEIGHT; y++) {
+        for (x = 0; x < PANEL_WIDTH; x++) {
+            untouched += panel_p->writes[y][x] == 0;
+            if (panel_p->writes[y][x] > maxWrites) {
+                maxWrites = panel_p->writes[y][x];
+                maxX = x;
+                maxY = y;
+            }
+        }
+    }
+    fprintf(out, "  %.1f writes per pixel, %u pixels never written, at most %u writes at "
+            "(%d, %d)\n", (double) panel_p->pixels / (PANEL_WIDTH * PANEL_HEIGHT),
+            (unsigned) untouched, (unsigned) maxWrites, maxX, maxY);
+    fprintf(out, "  %llu of %llu wakes drew, %llu of them changed nothing; "
+            "%.0f pixels per drawing wake, at most %u (%u redundant)\n",
+            (unsigned long long) stats_p->drawingPasses, (unsigned long long) stats_p->passes,
+            (unsigned long long) stats_p->wastedPasses,
+            stats_p->drawingPasses ? (double) panel_p->pixels / stats_p->drawingPasses : 0.0,
+            (unsigned) stats_p->maxPixels, (unsigned) stats_p->maxRedundantPixels);
+
+    int i;
+    fprintf(out, "  %-18s %10s %10s %7s\n", "entry point", "pixels", "redundant", "wasted");
+    for (i = 0; i < SPI_CALL_COUNT; i++) {
+        if (spi_p->calls[i].pixels)
+            Overdraw_printRow(out, Spi_callNames[i], &spi_p->calls[i]);
+    }
+    fprintf(out, "  %-18s %10s %10s %7s\n", "screen", "pixels", "redundant", "wasted");
+    for (i = 0; i < spi_p->screenCount; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), i ? "#%d" : "#%d (boot)", i);
+        Overdraw_printRow(out, name, &spi_p->screens[i]);
+    }
+}
+
+// Black through red and yellow to white as t goes from 0 to 1
+static void heatColor(double t, uint8_t rgb[3])
+{
+    double channel[3] = { 3 * t, 3 * t - 1, 3 * t - 2 };
+    int i;
+    for (i = 0; i < 3; i++)
+        rgb[i] = (uint8_t) (255 * fmin(fmax(channel[i], 0), 1) + 0.5);
+}
+
+bool Overdraw_writeHeatmap(const Panel* panel_p, const char* path)
+{
+    FILE* file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    uint32_t maxWrites = 0;
+    int x, y;
+    for (y = 0; y < PANEL_HEIGHT; y++)
+        for (x = 0; x < PANEL_WIDTH; x++)
+            if (panel_p->writes[y][x] > maxWrites)
+                maxWrites = panel_p->writes[y][x];
+    double scale = log1p(maxWrites ? maxWrites : 1);
+
+    fprintf(file, "P6\n%d %d\n255\n", 2 * PANEL_WIDTH + HEATMAP_GAP, PANEL_HEIGHT);
+    for (y = 0; y < PANEL_HEIGHT; y++) {
+        uint8_t rgb[3];
+        for (x = 0; x < PANEL_WIDTH; x++) {
+            heatColor(log1p(panel_p->writes[y][x]) / scale, rgb);
+            fwrite(rgb, 1, sizeof(rgb), file);
+        }
+        rgb[0] = rgb[1] = rgb[2] = 128;
+        for (x = 0; x < HEATMAP_GAP; x++)
+            fwrite(rgb, 1, sizeof(rgb), file);
+        for (x = 0; x < PANEL_WIDTH; x++) {
+            heatColor(log1p(panel_p->redundantWrites[y][x]) / scale, rgb);
+            fwrite(rgb, 1, sizeof(rgb), file);
+        }
+    }
+
+    return fclose(file) == 0;
+}
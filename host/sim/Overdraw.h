@@ -0,0 +1,47 @@
+/*
+ * Overdraw.h
+ *
+ * How much of the LCD traffic is wasted on pixels that already had the color written to them.
+ * The panel counts writes per pixel (Panel.h) and the SPI link per driver entry point and per
+ * screen (Spi.h); this adds the same per main loop pass, one pass per wake from LPM0, and
+ * turns the per-pixel counts into a heatmap.
+ */
+
+#ifndef SIM_OVERDRAW_H_
+#define SIM_OVERDRAW_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+#include "Panel.h"
+
+struct _OverdrawStats
+{
+    // Panel totals at the start of the current pass
+    uint32_t passPixels;
+    uint32_t passRedundantPixels;
+
+    uint64_t passes;
+    uint64_t drawingPasses;     // Passes that wrote at least one pixel
+    uint64_t wastedPasses;      // Drawing passes that changed no pixel at all
+    uint32_t maxPixels;         // Most pixels written by one pass
+    uint32_t maxRedundantPixels;
+};
+typedef struct _OverdrawStats OverdrawStats;
+
+struct _SimDevice;
+
+// Ends a main loop pass; called as the firmware goes to sleep
+void Overdraw_endPass(struct _SimDevice* sim_p);
+
+// Prints the overall waste, then the waste per pass, per entry point and per screen
+void Overdraw_printReport(FILE* out, const struct _SimDevice* sim_p);
+
+/**
+ * Writes the writes per pixel (left) and the redundant writes per pixel (right) side by side
+ * as a binary PPM, on a shared logarithmic black-red-yellow-white scale. Returns false if the
+ * file cannot be written.
+ */
+bool Overdraw_writeHeatmap(const Panel* panel_p, const char* path);
+
+#endif /* SIM_OVERDRAW_H_ */
@@ -0,0 +1,165 @@
+/*
+ * Panel.c
+ */
+
+#include <stdio.h>
+#include <string.h>
+#include <LcdDriver/Crystalfontz128x128_ST7735.h>
+#include "Panel.h"
+
+/**
+ * The glass is smaller than the controller's frame memory, so each orientation sees it at a
+ * different offset. These match the offsets Crystalfontz128x128_SetDrawFrame() adds for the
+ * MADCTL value Crystalfontz128x128_SetOrientation() sends.
+ */
+static void Panel_offsets(const Panel* panel_p, int* xOffset_p, int* yOffset_p)
+{
+    switch (panel_p->madctl & (CM_MADCTL_MX | CM_MADCTL_MY | CM_MADCTL_MV))
+    {
+        case CM_MADCTL_MY | CM_MADCTL_MV:   // LCD_ORIENTATION_LEFT
+            *xOffset_p = 3;
+            *yOffset_p = 2;
+            break;
+        case 0:                             // LCD_ORIENTATION_DOWN
+            *xOffset_p = 2;
+            *yOffset_p = 1;
+            break;
+        case CM_MADCTL_MX | CM_MADCTL_MV:   // LCD_ORIENTATION_RIGHT
+            *xOffset_p = 1;
+            *yOffset_p = 2;
+            break;
+        default:                            // LCD_ORIENTATION_UP
+            *xOffset_p = 2;
+            *yOffset_p = 3;
+            break;
+    }
+}
+
+void Panel_reset(Panel* panel_p)
+{
+    memset(panel_p, 0, sizeof(*panel_p));
+    memset(panel_p->framebuffer, 0xFF, sizeof(panel_p->framebuffer));
+    panel_p->command = CM_NOP;
+    panel_p->madctl = CM_MADCTL_MX | CM_MADCTL_MY;
+}
+
+void Panel_command(Panel* panel_p, uint8_t command)
+{
+    panel_p->command = command;
+    panel_p->paramCount = 0;
+    panel_p->haveHighByte = false;
+    panel_p->commands++;
+
+    switch (command)
+    {
+        case CM_RAMWR:
+            // A memory write always restarts at the top-left corner of the window
+            panel_p->x = panel_p->xStart;
+            panel_p->y = panel_p->yStart;
+            break;
+        case CM_DISPON:
+            panel_p->displayOn = true;
+            break;
+        case CM_DISPOFF:
+            panel_p->displayOn = false;
+            break;
+        default:
+            break;
+    }
+}
+
+static void Panel_pixel(Panel* panel_p, uint16_t color)
+{
+    int xOffset, yOffset;
+    Panel_offsets(panel_p, &xOffset, &yOffset);
+
+    int x = panel_p->x - xOffset;
+    int y = panel_p->y - yOffset;
+    if (x >= 0 && x < PANEL_WIDTH && y >= 0 && y < PANEL_HEIGHT) {
+        panel_p->writes[y][x]++;
+        if (panel_p->framebuffer[y][x] == color) {
+            panel_p->redundantWrites[y][x]++;
+            panel_p->redundantPixels++;
+        }
+        panel_p->framebuffer[y][x] = color;
+    }
+    else
+        panel_p->redundantPixels++;
+    panel_p->pixels++;
+
+    // The write pointer runs left to right, then top to bottom, and wraps inside the window
+    if (panel_p->x < panel_p->xEnd)
+        panel_p->x++;
+    else {
+        panel_p->x = panel_p->xStart;
+        panel_p->y = (panel_p->y < panel_p->yEnd) ? panel_p->y + 1 : panel_p->yStart;
+    }
+}
+
+void Panel_data(Panel* panel_p, uint8_t data)
+{
+    panel_p->dataBytes++;
+
+    switch (panel_p->command)
+    {
+        case CM_CASET:
+        case CM_RASET:
+            if (panel_p->paramCount < 4)
+                panel_p->params[panel_p->paramCount++] = data;
+            if (panel_p->paramCount == 4) {
+                uint16_t start = (panel_p->params[0] << 8) | panel_p->params[1];
+                uint16_t end = (panel_p->params[2] << 8) | panel_p->params[3];
+                if (panel_p->command == CM_CASET) {
+                    panel_p->xStart = start;
+                    panel_p->xEnd = end;
+                }
+                else {
+                    panel_p->yStart = start;
+                    panel_p->yEnd = end;
+                }
+            }
+            break;
+
+        case CM_MADCTL:
+            panel_p->madctl = data;
+            break;
+
+        case CM_RAMWR:
+            if (!panel_p->haveHighByte) {
+                panel_p->highByte = data;
+                panel_p->haveHighByte = true;
+            }
+            else {
+                Panel_pixel(panel_p, (panel_p->highByte << 8) | data);
+                panel_p->haveHighByte = false;
+            }
+            break;
+
+        default:
+            // Parameters of configuration commands do not change the image
+            break;
+    }
+}
+
+bool Panel_writePPM(const Panel* panel_p, const char* path)
+{
+    FILE* file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    fprintf(file, "P6\n%d %d\n255\n", PANEL_WIDTH, PANEL_HEIGHT);
+
+    int x, y;
+    for (y = 0; y < PANEL_HEIGHT; y++) {
+        for (x = 0; x < PANEL_WIDTH; x++) {
+            uint16_t color = panel_p->framebuffer[y][x];
+            uint8_t rgb[3];
+            rgb[0] = ((color >> 11) & 0x1F) * 255 / 31;
+            rgb[1] = ((color >> 5) & 0x3F) * 255 / 63;
+            rgb[2] = (color & 0x1F) * 255 / 31;
+            fwrite(rgb, 1, sizeof(rgb), file);
+        }
+    }
+
+    return fclose(file) == 0;
+}
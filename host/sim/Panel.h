@@ -0,0 +1,60 @@
+/*
+ * Panel.h
+ *
+ * A model of the ST7735 controller on the Crystalfontz 128x128 panel. It consumes the same
+ * command/data byte stream the driver sends over SPI, decodes the address window commands
+ * (CASET/RASET) and memory writes (RAMWR), and keeps the visible 128x128 image as RGB565.
+ * It also counts how often each pixel was written, and how many of those writes stored the
+ * color the pixel already had, which changes nothing on the glass but costs the full transfer.
+ */
+
+#ifndef SIM_PANEL_H_
+#define SIM_PANEL_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#define PANEL_WIDTH     128
+#define PANEL_HEIGHT    128
+
+struct _Panel
+{
+    // The visible image, in the coordinates the driver draws in (row-major, RGB565)
+    uint16_t framebuffer[PANEL_HEIGHT][PANEL_WIDTH];
+
+    // Command decoder state
+    uint8_t command;
+    uint8_t params[4];
+    int paramCount;
+    uint8_t madctl;
+    bool displayOn;
+
+    // Address window and write pointer, in controller (GRAM) coordinates
+    uint16_t xStart, xEnd, yStart, yEnd;
+    uint16_t x, y;
+    bool haveHighByte;
+    uint8_t highByte;
+
+    // Writes per visible pixel, and the ones among them that did not change its color
+    uint32_t writes[PANEL_HEIGHT][PANEL_WIDTH];
+    uint32_t redundantWrites[PANEL_HEIGHT][PANEL_WIDTH];
+
+    // Running totals
+    uint32_t commands;
+    uint32_t dataBytes;
+    uint32_t pixels;
+    uint32_t redundantPixels;   // Includes writes that fall outside the glass
+};
+typedef struct _Panel Panel;
+
+// Puts the panel in its power-on state (white screen, no window)
+void Panel_reset(Panel* panel_p);
+
+// Feeds one byte sent with D/C low (command) or high (data)
+void Panel_command(Panel* panel_p, uint8_t command);
+void Panel_data(Panel* panel_p, uint8_t data);
+
+// Writes the visible image as a binary PPM; returns false if the file cannot be written
+bool Panel_writePPM(const Panel* panel_p, const char* path);
+
+#endif /* SIM_PANEL_H_ */
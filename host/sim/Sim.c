@@ -0,0 +1,498 @@
+/*
+ * Sim.c
+ *
+ * Scheduler, NVIC and the small system peripherals (WDT_A, FlashCtl, CS, PCM).
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include "Sim.h"
+
+_Thread_local SimDevice* Sim_device;
+
+// Interrupt handlers are defined by the firmware; the ones it does not define stay null
+extern void EUSCIA0_IRQHandler(void) __attribute__((weak));
+extern void EUSCIB0_IRQHandler(void) __attribute__((weak));
+extern void ADC14_IRQHandler(void) __attribute__((weak));
+extern void T32_INT1_IRQHandler(void) __attribute__((weak));
+extern void T32_INT2_IRQHandler(void) __attribute__((weak));
+extern void DMA_INT0_IRQHandler(void) __attribute__((weak));
+extern void PORT1_IRQHandler(void) __attribute__((weak));
+extern void PORT2_IRQHandler(void) __attribute__((weak));
+extern void PORT3_IRQHandler(void) __attribute__((weak));
+extern void PORT4_IRQHandler(void) __attribute__((weak));
+extern void PORT5_IRQHandler(void) __attribute__((weak));
+extern void PORT6_IRQHandler(void) __attribute__((weak));
+
+static void (*Sim_handler(uint32_t interruptNumber))(void)
+{
+    switch (interruptNumber)
+    {
+        case INT_EUSCIA0:   return EUSCIA0_IRQHandler;
+        case INT_EUSCIB0:   return EUSCIB0_IRQHandler;
+        case INT_ADC14:     return ADC14_IRQHandler;
+        case INT_T32_INT1:  return T32_INT1_IRQHandler;
+        case INT_T32_INT2:  return T32_INT2_IRQHandler;
+        case INT_DMA_INT0:  return DMA_INT0_IRQHandler;
+        case INT_PORT1:     return PORT1_IRQHandler;
+        case INT_PORT2:     return PORT2_IRQHandler;
+        case INT_PORT3:     return PORT3_IRQHandler;
+        case INT_PORT4:     return PORT4_IRQHandler;
+        case INT_PORT5:     return PORT5_IRQHandler;
+        case INT_PORT6:     return PORT6_IRQHandler;
+        default:            return NULL;
+    }
+}
+
+static uint64_t Sim_wallNs(void)
+{
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    return (uint64_t) now.tv_sec * 1000000000u + now.tv_nsec;
+}
+
+void Sim_init(SimDevice* sim_p)
+{
+    memset(sim_p, 0, sizeof(*sim_p));
+
+    sim_p->t32Load = 0xFFFFFFFF;
+    sim_p->joystickX = SIM_JOYSTICK_CENTER;
+    sim_p->joystickY = SIM_JOYSTICK_CENTER;
+
+    // Buttons are pulled up and read high until pressed
+    int port;
+    for (port = 0; port < SIM_PORT_COUNT; port++)
+        sim_p->gpioIn[port] = 0xFFFF;
+
+    // 8 bits at the driver's 16 MHz SPI clock, until HAL_LCD_SpiInit() configures the link
+    sim_p->spi.byteCycles = 24;
+    sim_p->spi.screenCount = 1;
+    Panel_reset(&sim_p->panel);
+    sim_p->energy.model = Energy_defaultModel;
+
+    Sim_device = sim_p;
+}
+
+bool Sim_addInput(SimDevice* sim_p, const SimInput* input_p)
+{
+    if (sim_p->inputCount == SIM_MAX_INPUTS)
+        return false;
+
+    // Insertion sort keeps inputs with equal timestamps in the order they were given
+    int i = sim_p->inputCount++;
+    while (i > sim_p->nextInput && sim_p->inputs[i - 1].cycle > input_p->cycle) {
+        sim_p->inputs[i] = sim_p->inputs[i - 1];
+        i--;
+    }
+    sim_p->inputs[i] = *input_p;
+    Sim_reschedule(sim_p);
+    return true;
+}
+
+bool Sim_parseInput(const char* text, SimInput* input_p)
+{
+    static const char* buttonNames[SIM_BUTTON_COUNT] = { "LB1", "LB2", "BB1", "BB2", "JSB" };
+
+    char* name;
+    double ms = strtod(text, &name);
+    if (name == text || *name != ':' || ms < 0)
+        return false;
+    name++;
+
+    memset(input_p, 0, sizeof(*input_p));
+    input_p->cycle = (uint64_t) (ms * SIM_CYCLES_PER_MS);
+
+    int button;
+    for (button = 0; button < SIM_BUTTON_COUNT; button++) {
+        if (strcmp(name, buttonNames[button]) == 0) {
+            input_p->button = (SimButton) button;
+            return true;
+        }
+    }
+
+    input_p->isJoystick = true;
+    input_p->x = SIM_JOYSTICK_CENTER;
+    input_p->y = SIM_JOYSTICK_CENTER;
+    if (strcmp(name, "LEFT") == 0)
+        input_p->x = SIM_JOYSTICK_LOW;
+    else if (strcmp(name, "RIGHT") == 0)
+        input_p->x = SIM_JOYSTICK_HIGH;
+    else if (strcmp(name, "UP") == 0)
+        input_p->y = SIM_JOYSTICK_HIGH;
+    else if (strcmp(name, "DOWN") == 0)
+        input_p->y = SIM_JOYSTICK_LOW;
+    else if (strcmp(name, "CENTER") != 0)
+        return false;
+    return true;
+}
+
+void Sim_raiseInterrupt(SimDevice* sim_p, uint32_t interruptNumber)
+{
+    sim_p->irqPending[interruptNumber] = true;
+    Sim_deliverPending(sim_p);
+}
+
+void Sim_deliverPending(SimDevice* sim_p)
+{
+    if (sim_p->handlerActive)
+        return;
+
+    uint32_t irq = 0;
+    while (irq < SIM_IRQ_COUNT) {
+        if (!sim_p->masterEnabled)
+            return;
+        if (!sim_p->irqPending[irq] || !sim_p->irqEnabled[irq]) {
+            irq++;
+            continue;
+        }
+        sim_p->irqPending[irq] = false;
+        void (*handler)(void) = Sim_handler(irq);
+        if (!handler)
+            continue;
+
+        // A handler that runs in LPM0 has the CPU awake for as long as it runs
+        bool sleeping = sim_p->energy.sleeping;
+        if (sleeping)
+            Energy_sleep(sim_p, false);
+        sim_p->handlerActive = true;
+        handler();
+        sim_p->handlerActive = false;
+        if (sleeping)
+            Energy_sleep(sim_p, true);
+
+        // Tail-chain whatever it left pending, from the lowest number again
+        irq = 0;
+    }
+}
+
+static void Sim_applyInput(SimDevice* sim_p, const SimInput* input_p)
+{
+    if (input_p->isJoystick) {
+        sim_p->joystickX = input_p->x;
+        sim_p->joystickY = input_p->y;
+    }
+    else
+        Sim_gpioPress(sim_p, input_p->button);
+}
+
+void Sim_reschedule(SimDevice* sim_p)
+{
+    sim_p->nextEvent = 0;
+}
+
+/**
+ * Finds the earliest pending hardware event and which peripheral it belongs to: 0 for a
+ * scripted input, 1 for ADC14, 2 for Timer32, 3 for the UART, 4 for the DMA, or -1 when
+ * nothing is pending.
+ */
+static uint64_t Sim_nextEvent(const SimDevice* sim_p, int* source_p)
+{
+    uint64_t next = UINT64_MAX;
+    *source_p = -1;
+
+    if (sim_p->nextInput < sim_p->inputCount) {
+        next = sim_p->inputs[sim_p->nextInput].cycle;
+        *source_p = 0;
+    }
+    uint64_t adc = Sim_adcNextEvent(sim_p);
+    if (adc < next) {
+        next = adc;
+        *source_p = 1;
+    }
+    uint64_t t32 = Sim_timer32NextEvent(sim_p);
+    if (t32 < next) {
+        next = t32;
+        *source_p = 2;
+    }
+    uint64_t uart = Sim_uartNextEvent(sim_p);
+    if (uart < next) {
+        next = uart;
+        *source_p = 3;
+    }
+    uint64_t dma = Sim_dmaNextEvent(sim_p);
+    if (dma < next) {
+        next = dma;
+        *source_p = 4;
+    }
+    return next;
+}
+
+void Sim_advanceTo(SimDevice* sim_p, uint64_t cycle)
+{
+    // Nearly every call comes from a register access that ends well before the next event
+    if (cycle < sim_p->nextEvent) {
+        if (cycle > sim_p->cycles)
+            sim_p->cycles = cycle;
+        return;
+    }
+
+    while (true) {
+        int source;
+        uint64_t next = Sim_nextEvent(sim_p, &source);
+        if (source < 0 || next > cycle) {
+            sim_p->nextEvent = next;
+            break;
+        }
+
+        if (next > sim_p->cycles)
+            sim_p->cycles = next;
+
+        // Handling the event may change any peripheral's next event, so it is looked up again
+        sim_p->nextEvent = 0;
+        switch (source)
+        {
+            case 0:
+                Sim_applyInput(sim_p, &sim_p->inputs[sim_p->nextInput++]);
+                break;
+            case 1:
+                Sim_adcEvent(sim_p);
+                break;
+            case 2:
+                Sim_timer32Event(sim_p);
+                break;
+            case 3:
+                Sim_uartEvent(sim_p);
+                break;
+            case 4:
+                Sim_dmaEvent(sim_p);
+                break;
+        }
+    }
+
+    if (cycle > sim_p->cycles)
+        sim_p->cycles = cycle;
+}
+
+void Sim_spend(SimDevice* sim_p, uint32_t cycles)
+{
+    Sim_advanceTo(sim_p, sim_p->cycles + cycles);
+}
+
+/**
+ * Blocks until the wall clock catches up with the simulated clock, so the game on the host
+ * runs at the same speed as on the board.
+ */
+static void Sim_pace(SimDevice* sim_p, uint64_t cycle)
+{
+    uint64_t targetNs = sim_p->wallStartNs + cycle * 1000 / (SIM_CPU_HZ / 1000000);
+    struct timespec until;
+    until.tv_sec = targetNs / 1000000000u;
+    until.tv_nsec = targetNs % 1000000000u;
+    while (clock_nanosleep(CLOCK_MONOTONIC, TIMER_ABSTIME, &until, NULL) != 0)
+        ;
+}
+
+/**
+ * The sleep half of a wake cycle: skips ahead to the next event that raises an interrupt, runs
+ * it, and returns. Ends the run by jumping back into Sim_run() once the stop time is reached.
+ * A sleep that does not end the pass (endsPass false) counts as a wait rather than a wake, and
+ * always runs to its event, since the pass it is part of has to finish; the LCD tools, which
+ * never call Sim_run(), wait this way too.
+ */
+static void Sim_sleep(SimDevice* sim_p, bool endsPass)
+{
+    int source;
+    uint64_t wake = Sim_nextEvent(sim_p, &source);
+    if (!endsPass) {
+        if (wake == UINT64_MAX) {
+            fprintf(stderr, "sim: LPM0 wait with nothing to end it\n");
+            exit(1);
+        }
+        // The wait ends where the handler of the event starts
+        uint64_t start = sim_p->cycles;
+        if (wake < start)
+            wake = start;
+        Energy_sleep(sim_p, true);
+        Sim_advanceTo(sim_p, wake);
+        Energy_sleep(sim_p, false);
+        sim_p->waitCycles += wake - start;
+        return;
+    }
+
+    if (wake > sim_p->stopCycle)
+        wake = sim_p->stopCycle;
+    if (wake < sim_p->cycles)
+        wake = sim_p->cycles;
+
+    if (sim_p->realtime)
+        Sim_pace(sim_p, wake);
+
+    Energy_sleep(sim_p, true);
+    if (wake >= sim_p->stopCycle) {
+        sim_p->cycles = sim_p->stopCycle;
+        Energy_update(sim_p);
+        Spi_stop(sim_p);
+        if (sim_p->stopHook)
+            sim_p->stopHook(sim_p);
+        longjmp(sim_p->exit, 1);
+    }
+
+    Sim_advanceTo(sim_p, wake);
+    Energy_sleep(sim_p, false);
+    sim_p->wakes++;
+    // The wake starts with the handler of the event, not after it
+    sim_p->wakeCycle = wake;
+}
+
+void Sim_run(SimDevice* sim_p, int (*firmwareMain)(void), uint64_t stopCycle)
+{
+    Sim_device = sim_p;
+    sim_p->stopCycle = stopCycle;
+    sim_p->stackTop = __builtin_frame_address(0);
+    sim_p->wallStartNs = Sim_wallNs() - sim_p->cycles * 1000 / (SIM_CPU_HZ / 1000000);
+
+    if (setjmp(sim_p->exit) == 0)
+        firmwareMain();
+}
+
+//*****************************************************************************
+// Interrupt (NVIC)
+//*****************************************************************************
+bool Interrupt_enableMaster(void)
+{
+    bool wasDisabled = !Sim_device->masterEnabled;
+    Sim_device->masterEnabled = true;
+    Sim_deliverPending(Sim_device);
+    return wasDisabled;
+}
+
+bool Interrupt_disableMaster(void)
+{
+    bool wasDisabled = !Sim_device->masterEnabled;
+    Sim_device->masterEnabled = false;
+    return wasDisabled;
+}
+
+void Interrupt_enableInterrupt(uint32_t interruptNumber)
+{
+    Sim_device->irqEnabled[interruptNumber] = true;
+    Sim_deliverPending(Sim_device);
+}
+
+void Interrupt_pendInterrupt(uint32_t interruptNumber)
+{
+    Sim_raiseInterrupt(Sim_device, interruptNumber);
+}
+
+void Interrupt_disableInterrupt(uint32_t interruptNumber)
+{
+    Sim_device->irqEnabled[interruptNumber] = false;
+}
+
+//*****************************************************************************
+// WDT_A, FlashCtl, CS, PCM, ResetCtl
+//*****************************************************************************
+void WDT_A_hold(uint32_t timer)
+{
+}
+
+bool FlashCtl_setWaitState(uint32_t bank, uint32_t waitState)
+{
+    return true;
+}
+
+void CS_setDCOFrequency(uint32_t dcoFrequency)
+{
+    if (dcoFrequency != SIM_CPU_HZ)
+        fprintf(stderr, "sim: DCO set to %u Hz, the model assumes %u Hz\n",
+                (unsigned) dcoFrequency, (unsigned) SIM_CPU_HZ);
+}
+
+void CS_initClockSignal(uint32_t selectedClockSignal, uint32_t clockSource,
+                        uint32_t clockSourceDivider)
+{
+}
+
+uint32_t ResetCtl_getHardResetSource(void)
+{
+    return Sim_device->hardResetSource;
+}
+
+uint32_t ResetCtl_getSoftResetSource(void)
+{
+    return Sim_device->softResetSource;
+}
+
+void ResetCtl_clearHardResetSource(uint32_t mask)
+{
+    Sim_device->hardResetSource &= ~mask;
+}
+
+void ResetCtl_clearSoftResetSource(uint32_t mask)
+{
+    Sim_device->softResetSource &= ~mask;
+}
+
+bool PCM_gotoLPM0(void)
+{
+    Spi_sync(Sim_device);
+    Overdraw_endPass(Sim_device);
+    if (Sim_device->sleepHook)
+        Sim_device->sleepHook(Sim_device);
+    Sim_sleep(Sim_device, true);
+    return true;
+}
+
+// Interrupts stay masked while the CPU goes to sleep, so one that falls due before the WFI
+// still wakes it, and run once it is awake
+bool PCM_gotoLPM0InterruptSafe(void)
+{
+    SimDevice* sim_p = Sim_device;
+    Interrupt_disableMaster();
+    Spi_sync(sim_p);
+
+    // An interrupt already pending ends the WFI at once
+    bool pending = false;
+    uint32_t irq;
+    for (irq = 0; irq < SIM_IRQ_COUNT; irq++)
+        pending |= sim_p->irqPending[irq] && sim_p->irqEnabled[irq];
+    if (!pending)
+        Sim_sleep(sim_p, false);
+
+    Interrupt_enableMaster();
+    return true;
+}
+
+//*****************************************************************************
+// DWT, CoreDebug
+//*****************************************************************************
+DWT_Type* Sim_DWT(void)
+{
+    SimDevice* sim_p = Sim_device;
+
+    // Catch CYCCNT up with the clock, so that whatever the firmware wrote into it still counts
+    if ((sim_p->coreDebug.DEMCR & CoreDebug_DEMCR_TRCENA_Msk) &&
+        (sim_p->dwt.CTRL & DWT_CTRL_CYCCNTENA_Msk))
+        sim_p->dwt.CYCCNT += (uint32_t) (sim_p->cycles - sim_p->dwtCycle);
+    sim_p->dwtCycle = sim_p->cycles;
+    return &sim_p->dwt;
+}
+
+CoreDebug_Type* Sim_CoreDebug(void)
+{
+    return &Sim_device->coreDebug;
+}
+
+//*****************************************************************************
+// Stack bounds
+//*****************************************************************************
+uint32_t* Sim_stackBottom(void)
+{
+    return Sim_device->stackTop - SIM_STACK_BYTES / sizeof(uint32_t);
+}
+
+uint32_t* Sim_stackTop(void)
+{
+    return Sim_device->stackTop;
+}
+
+// The driver's delay loop: subs, bne and the pipeline refill, three cycles per iteration
+void SysCtlDelay(uint32_t ui32Count)
+{
+    Sim_spend(Sim_device, 3 * ui32Count);
+}
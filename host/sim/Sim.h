@@ -0,0 +1,220 @@
+/*
+ * Sim.h
+ *
+ * The simulated MSP432 + BoosterPack that the host build of the firmware runs on. One
+ * SimDevice holds the state of every stand-in peripheral: the NVIC, the GPIO ports, Timer32,
+ * ADC14, the backchannel UART, the DMA and the LCD panel on the end of the SPI link.
+ *
+ * Time is counted in CPU cycles at SIM_CPU_HZ and is virtual: it does not follow the wall
+ * clock. The firmware only ever waits in PCM_gotoLPM0(), so the simulation advances the clock
+ * there: it jumps straight to the next hardware event (an ADC conversion, a Timer32 rollover,
+ * the end of a DMA transfer or a scripted input), runs the interrupt handlers that event
+ * triggers and returns to main(), exactly like a wake from LPM0. PCM_gotoLPM0InterruptSafe(),
+ * which the LCD driver waits for its DMA with, sleeps the same way but without ending the
+ * pass of main() it is called from. Timer32_getValue() and the rollovers the firmware counts in
+ * T32_INT1_IRQHandler() follow the same clock, so its software timers expire on schedule no
+ * matter how fast the host is. Setting realtime paces the wakes against the wall clock
+ * instead, for playing the game interactively. While awake, the peripheral
+ * models charge the CPU time the firmware spends on them (see Spi.h) through Sim_spend(), and
+ * interrupts that fall due in the meantime preempt it as they would on the board. The same
+ * clock drives the estimate of the current the board draws (see Energy.h).
+ */
+
+#ifndef SIM_SIM_H_
+#define SIM_SIM_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <setjmp.h>
+#include <stdio.h>
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include "Panel.h"
+#include "Spi.h"
+#include "Overdraw.h"
+#include "Energy.h"
+
+// Matches SYSTEM_CLOCK in HAL/Timer.h
+#define SIM_CPU_HZ          48000000
+#define SIM_CYCLES_PER_MS   (SIM_CPU_HZ / 1000)
+
+#define SIM_PORT_COUNT      12      // Indexed by GPIO_PORT_Px, P1 = 1 ... PJ = 11
+#define SIM_IRQ_COUNT       64
+#define SIM_MAX_INPUTS      4096
+#define SIM_DMA_CHANNELS    8
+
+// The stack the firmware gets; x86-64 frames, and the simulator's own below the firmware's,
+// take several times what the same calls take on the Cortex-M4
+#define SIM_STACK_BYTES     65536
+
+// Raw ADC14 readings for the joystick at rest and at full deflection
+#define SIM_JOYSTICK_CENTER 8192
+#define SIM_JOYSTICK_LOW    400
+#define SIM_JOYSTICK_HIGH   16000
+
+// The buttons on the Launchpad and the BoosterPack
+enum _SimButton
+{
+    SIM_LB1, SIM_LB2, SIM_BB1, SIM_BB2, SIM_JSB, SIM_BUTTON_COUNT
+};
+typedef enum _SimButton SimButton;
+
+// A change on one of the board's inputs, scheduled at an absolute cycle count
+struct _SimInput
+{
+    uint64_t cycle;
+    bool isJoystick;
+    SimButton button;       // Pressed (high-to-low edge) when !isJoystick
+    uint16_t x, y;          // New joystick position when isJoystick
+};
+typedef struct _SimInput SimInput;
+
+// A DMA channel as the firmware last set it up
+struct _SimDmaChannel
+{
+    uint32_t control;
+    const uint8_t* source;
+    void* destination;
+    uint32_t size;          // Bytes left to move, 0 once the transfer is done
+};
+typedef struct _SimDmaChannel SimDmaChannel;
+
+struct _SimDevice
+{
+    // CPU clock and run control
+    uint64_t cycles;
+    uint64_t stopCycle;
+    bool realtime;
+    uint64_t wallStartNs;
+    uint64_t nextEvent;     // Earliest pending hardware event, 0 when it must be recomputed
+    jmp_buf exit;
+    uint64_t wakes;
+    uint64_t wakeCycle;     // When the current wake began
+    uint64_t waitCycles;    // Time in LPM0 within passes, in PCM_gotoLPM0InterruptSafe()
+
+    // Called once the stop time is reached, before the run unwinds, while the firmware's
+    // state on the stack of its main() is still live
+    void (*stopHook)(struct _SimDevice* sim_p);
+    void* stopContext;
+
+    // Called at the end of every wake, as the firmware enters LPM0
+    void (*sleepHook)(struct _SimDevice* sim_p);
+    void* sleepContext;
+
+    // The reset controller's flags for the reset the next run starts from
+    uint32_t hardResetSource;
+    uint32_t softResetSource;
+
+    // NVIC
+    bool masterEnabled;
+    bool irqEnabled[SIM_IRQ_COUNT];
+    bool irqPending[SIM_IRQ_COUNT];
+    // The firmware leaves every interrupt at the same priority, so a running handler is never
+    // preempted: what becomes pending meanwhile waits until it returns, lowest number first
+    bool handlerActive;
+
+    // GPIO, one 16-bit mask per port
+    uint16_t gpioDir[SIM_PORT_COUNT];
+    uint16_t gpioOut[SIM_PORT_COUNT];
+    uint16_t gpioIn[SIM_PORT_COUNT];
+    uint16_t gpioIe[SIM_PORT_COUNT];
+    uint16_t gpioIes[SIM_PORT_COUNT];
+    uint16_t gpioIfg[SIM_PORT_COUNT];
+
+    // Timer32 module 0
+    bool t32Running;
+    bool t32Ifg;
+    uint32_t t32Load;
+    uint64_t t32Start;
+
+    // ADC14 in repeat-sequence mode
+    bool adcEnabled;
+    bool adcRunning;
+    uint32_t adcPredivider;
+    uint32_t adcDivider;
+    uint32_t adcSampleClocks;
+    uint64_t adcPeriod;
+    uint64_t adcNext;
+    uint32_t adcIe;
+    uint32_t adcIfg;
+    uint16_t adcMem[32];
+    uint16_t joystickX, joystickY;
+
+    // Scripted inputs, sorted by cycle
+    SimInput inputs[SIM_MAX_INPUTS];
+    int inputCount;
+    int nextInput;
+
+    // Core debug; dwtCycle is the clock CYCCNT was last brought up to
+    DWT_Type dwt;
+    CoreDebug_Type coreDebug;
+    uint64_t dwtCycle;
+
+    // The stack the firmware runs on: SIM_STACK_BYTES below Sim_run()'s frame
+    uint32_t* stackTop;
+
+    // eUSCI_A0 in UART mode: the byte in TXBUF, if any, and the one in the shift register
+    bool uartEnabled;
+    bool uartTxie;
+    bool uartBuffered;
+    uint8_t uartBuffer;
+    uint8_t uartShifting;
+    uint64_t uartShiftEnd;      // When the byte in the shift register is out, 0 when idle
+    uint64_t uartByteCycles;
+    FILE* uartOut;              // Where the bytes go, if anywhere
+    uint64_t uartBytes;
+
+    // DMA; dmaDoneCycle is when the transfer in flight ends, 0 when there is none
+    bool dmaEnabled;
+    SimDmaChannel dma[SIM_DMA_CHANNELS];
+    uint64_t dmaDoneCycle;
+
+    // The LCD and the SPI link that drives it
+    SpiLink spi;
+    Panel panel;
+    OverdrawStats overdraw;
+
+    // The supply current the firmware draws
+    EnergyMeter energy;
+};
+typedef struct _SimDevice SimDevice;
+
+// The device the stand-in peripherals act on. Each thread runs its own device, which gets the
+// interrupts its firmware enables; the firmware's own pointers are DEVICE_LOCAL to match.
+extern _Thread_local SimDevice* Sim_device;
+
+// Resets a device to power-on state and makes it the current one on the calling thread
+void Sim_init(SimDevice* sim_p);
+
+// Schedules an input; returns false when the script is full
+bool Sim_addInput(SimDevice* sim_p, const SimInput* input_p);
+
+// Parses "MS:NAME" (NAME is LB1, LB2, BB1, BB2, JSB, LEFT, RIGHT, UP, DOWN or CENTER)
+bool Sim_parseInput(const char* text, SimInput* input_p);
+
+// Runs the firmware's main() on the calling thread until the clock reaches stopCycle
+void Sim_run(SimDevice* sim_p, int (*firmwareMain)(void), uint64_t stopCycle);
+
+// Advances the clock to the given cycle, running every interrupt that falls due on the way
+void Sim_advanceTo(SimDevice* sim_p, uint64_t cycle);
+
+// Charges CPU time spent by the firmware while awake
+void Sim_spend(SimDevice* sim_p, uint32_t cycles);
+
+// Requests an interrupt; it runs now if enabled, or stays pending until it is
+void Sim_raiseInterrupt(SimDevice* sim_p, uint32_t interruptNumber);
+void Sim_deliverPending(SimDevice* sim_p);
+
+// Peripheral hooks used by the scheduler; a peripheral calls Sim_reschedule() whenever it
+// changes the time of its next event
+void Sim_reschedule(SimDevice* sim_p);
+uint64_t Sim_timer32NextEvent(const SimDevice* sim_p);
+void Sim_timer32Event(SimDevice* sim_p);
+uint64_t Sim_adcNextEvent(const SimDevice* sim_p);
+void Sim_adcEvent(SimDevice* sim_p);
+uint64_t Sim_uartNextEvent(const SimDevice* sim_p);
+void Sim_uartEvent(SimDevice* sim_p);
+uint64_t Sim_dmaNextEvent(const SimDevice* sim_p);
+void Sim_dmaEvent(SimDevice* sim_p);
+void Sim_gpioPress(SimDevice* sim_p, SimButton button);
+
+#endif /* SIM_SIM_H_ */
@@ -0,0 +1,350 @@
+/*
+ * Spi.c
+ *
+ * The eUSCI_B0 transmit path, the per-access cycle charges and the cost report.
+ */
+
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include <stdlib.h>
+#include <LcdDriver/HAL_MSP_EXP432P401R_Crystalfontz128x128_ST7735.h>
+#include <LcdDriver/LcdCapture.h>
+#include "Sim.h"
+
+const char* const Spi_callNames[SPI_CALL_COUNT] =
+{
+    "(direct)",
+    "PixelDraw",
+    "PixelDrawMultiple",
+    "LineDrawH",
+    "LineDrawV",
+    "RectFill",
+    "Flush",
+    "ClearScreen",
+};
+
+static SpiStats* Spi_screen(SimDevice* sim_p)
+{
+    return &sim_p->spi.screens[sim_p->spi.screenCount - 1];
+}
+
+/**
+ * Tags the next byte the driver queues with the current entry point and screen.
+ */
+static void Spi_queue(SpiLink* spi_p)
+{
+    if (spi_p->queuedCount) {
+        SpiRun* last_p = &spi_p->queued[(spi_p->queuedFirst + spi_p->queuedCount - 1) %
+                                        SPI_QUEUED_RUNS];
+        if ((last_p->call == spi_p->call && last_p->screen == spi_p->screenCount - 1) ||
+            spi_p->queuedCount == SPI_QUEUED_RUNS) {
+            last_p->bytes++;
+            return;
+        }
+    }
+
+    SpiRun* run_p = &spi_p->queued[(spi_p->queuedFirst + spi_p->queuedCount) % SPI_QUEUED_RUNS];
+    run_p->call = spi_p->call;
+    run_p->screen = spi_p->screenCount - 1;
+    run_p->bytes = 1;
+    spi_p->queuedCount++;
+}
+
+/**
+ * Finds the totals the oldest queued byte is charged to: its entry point and screen, or the
+ * current ones if nothing is queued.
+ */
+static void Spi_charged(SimDevice* sim_p, SpiStats* stats[3])
+{
+    SpiLink* spi_p = &sim_p->spi;
+    if (spi_p->queuedCount) {
+        const SpiRun* run_p = &spi_p->queued[spi_p->queuedFirst];
+        stats[0] = &spi_p->calls[run_p->call];
+        stats[1] = &spi_p->screens[run_p->screen];
+    } else {
+        stats[0] = &spi_p->calls[spi_p->call];
+        stats[1] = Spi_screen(sim_p);
+    }
+    stats[2] = &spi_p->total;
+}
+
+// Drops the tag of the oldest queued byte once it is on the wire
+static void Spi_dequeue(SpiLink* spi_p)
+{
+    if (!spi_p->queuedCount)
+        return;
+    if (--spi_p->queued[spi_p->queuedFirst].bytes == 0) {
+        spi_p->queuedFirst = (spi_p->queuedFirst + 1) % SPI_QUEUED_RUNS;
+        spi_p->queuedCount--;
+    }
+}
+
+/**
+ * Moves the latched TXBUF byte into the shift register. It starts shifting as soon as the
+ * previous byte is out, and reaches the panel with whatever level D/C has at that moment.
+ */
+void Spi_sync(SimDevice* sim_p)
+{
+    SpiLink* spi_p = &sim_p->spi;
+    if (!spi_p->txLatched)
+        return;
+    spi_p->txLatched = false;
+
+    uint64_t start = (spi_p->shiftEnd > sim_p->cycles) ? spi_p->shiftEnd : sim_p->cycles;
+    spi_p->shiftStart = start;
+    spi_p->shiftEnd = start + spi_p->byteCycles;
+
+    bool isData = (sim_p->gpioOut[LCD_DC_PORT] & LCD_DC_PIN) != 0;
+    uint32_t pixels = sim_p->panel.pixels;
+    uint32_t redundantPixels = sim_p->panel.redundantPixels;
+    if (isData)
+        Panel_data(&sim_p->panel, (uint8_t) spi_p->txBuffer);
+    else
+        Panel_command(&sim_p->panel, (uint8_t) spi_p->txBuffer);
+    pixels = sim_p->panel.pixels - pixels;
+    redundantPixels = sim_p->panel.redundantPixels - redundantPixels;
+    if (pixels > redundantPixels)
+        spi_p->lastPixelCycle = spi_p->shiftEnd;
+
+    SpiStats* stats[3];
+    Spi_charged(sim_p, stats);
+    Spi_dequeue(spi_p);
+    int i;
+    for (i = 0; i < 3; i++) {
+        if (isData)
+            stats[i]->dataBytes++;
+        else
+            stats[i]->commandBytes++;
+        stats[i]->wireCycles += spi_p->byteCycles;
+        stats[i]->pixels += pixels;
+        stats[i]->redundantPixels += redundantPixels;
+    }
+    Energy_spiByte(sim_p);
+}
+
+/**
+ * Counts a change of D/C before the shift register went idle: the panel samples D/C with the
+ * last bit of a byte, so the byte on the wire would be taken for the wrong kind.
+ */
+void Spi_checkDc(SimDevice* sim_p, uint8_t port, uint16_t levels)
+{
+    if (port == LCD_DC_PORT && ((sim_p->gpioOut[port] ^ levels) & LCD_DC_PIN) &&
+        sim_p->cycles < sim_p->spi.shiftEnd)
+        sim_p->spi.dcGlitches++;
+}
+
+void Spi_dmaWrite(SimDevice* sim_p, uint8_t byte)
+{
+    Spi_sync(sim_p);
+    sim_p->spi.txBuffer = byte;
+    sim_p->spi.txLatched = true;
+    Spi_sync(sim_p);
+}
+
+void Spi_beginCall(SimDevice* sim_p, SpiCall call)
+{
+    SpiLink* spi_p = &sim_p->spi;
+
+    // Only the outermost call is attributed; ClearScreen, for example, calls RectFill
+    if (spi_p->callDepth++ > 0)
+        return;
+
+    if (call == SPI_CALL_CLEAR_SCREEN && spi_p->screenCount < SPI_MAX_SCREENS) {
+        Energy_update(sim_p);
+        spi_p->screenCount++;
+    }
+
+    spi_p->call = call;
+    spi_p->calls[call].calls++;
+    Spi_screen(sim_p)->calls++;
+    spi_p->total.calls++;
+}
+
+void Spi_endCall(SimDevice* sim_p)
+{
+    SpiLink* spi_p = &sim_p->spi;
+    if (--spi_p->callDepth == 0)
+        spi_p->call = SPI_CALL_DIRECT;
+}
+
+/**
+ * Charges the CPU time of one register access to the clock and to the current entry point
+ * and screen.
+ */
+static void Spi_spend(SimDevice* sim_p, uint32_t cycles, bool spinning)
+{
+    SpiStats* stats[3];
+    Spi_charged(sim_p, stats);
+    int i;
+    for (i = 0; i < 3; i++) {
+        stats[i]->cpuCycles += cycles;
+        if (spinning)
+            stats[i]->spinCycles += cycles;
+    }
+    Sim_spend(sim_p, cycles);
+}
+
+static void Spi_printRow(FILE* out, const char* name, const SpiStats* stats_p)
+{
+    uint64_t bytes = stats_p->commandBytes + stats_p->dataBytes;
+    fprintf(out, "  %-18s %8llu %10llu %10.1f %12.1f %12.1f %12llu %6.1f%%\n", name,
+            (unsigned long long) stats_p->calls, (unsigned long long) bytes,
+            stats_p->calls ? (double) bytes / stats_p->calls : 0.0,
+            (double) stats_p->wireCycles * 1e6 / SIM_CPU_HZ,
+            (double) stats_p->cpuCycles * 1e6 / SIM_CPU_HZ,
+            (unsigned long long) stats_p->spinCycles,
+            stats_p->cpuCycles ? 100.0 * stats_p->spinCycles / stats_p->cpuCycles : 0.0);
+}
+
+void Spi_stop(SimDevice* sim_p)
+{
+    sim_p->spi.listStalls = HAL_LCD_listStalls();
+}
+
+void Spi_printReport(FILE* out, const SimDevice* sim_p)
+{
+    const SpiLink* spi_p = &sim_p->spi;
+    int i;
+
+    fprintf(out, "LCD SPI link: %u CPU cycles per byte (%.3f us)\n",
+            (unsigned) spi_p->byteCycles, spi_p->byteCycles * 1e6 / SIM_CPU_HZ);
+    fprintf(out, "  %-18s %8s %10s %10s %12s %12s %12s %7s\n", "entry point", "calls", "bytes",
+            "bytes/call", "wire us", "cpu us", "spin cycles", "spin");
+    for (i = 0; i < SPI_CALL_COUNT; i++) {
+        if (spi_p->calls[i].calls || spi_p->calls[i].commandBytes + spi_p->calls[i].dataBytes)
+            Spi_printRow(out, Spi_callNames[i], &spi_p->calls[i]);
+    }
+    Spi_printRow(out, "total", &spi_p->total);
+    if (spi_p->dcGlitches)
+        fprintf(out, "  D/C changed %llu times with a byte still on the wire\n",
+                (unsigned long long) spi_p->dcGlitches);
+    if (spi_p->listStalls)
+        fprintf(out, "  writes waited %lu times for room in the display list\n",
+                (unsigned long) spi_p->listStalls);
+
+    fprintf(out, "  %-18s %8s %10s %10s %12s %12s %12s %7s\n", "screen", "calls", "bytes",
+            "bytes/call", "wire us", "cpu us", "spin cycles", "spin");
+    for (i = 0; i < spi_p->screenCount; i++) {
+        char name[32];
+        snprintf(name, sizeof(name), i ? "#%d" : "#%d (boot)", i);
+        Spi_printRow(out, name, &spi_p->screens[i]);
+    }
+}
+
+//*****************************************************************************
+// LCD capture
+//*****************************************************************************
+void Spi_startCapture(SimDevice* sim_p)
+{
+    sim_p->spi.capturing = true;
+}
+
+// The driver's LCD_CAPTURE hook; the records go to the device instead of a RAM ring
+void LcdCapture_record(uint16_t record)
+{
+    SpiLink* spi_p = &Sim_device->spi;
+    if (!LCD_CAPTURE_IS_ENTRY(record))
+        Spi_queue(spi_p);
+    if (!spi_p->capturing)
+        return;
+
+    if (spi_p->captureCount == spi_p->captureCapacity) {
+        uint32_t capacity = spi_p->captureCapacity ? 2 * spi_p->captureCapacity : 65536;
+        uint16_t* capture = realloc(spi_p->capture, capacity * sizeof(uint16_t));
+        if (!capture) {
+            fprintf(stderr, "sim: LCD capture stopped, out of memory\n");
+            spi_p->capturing = false;
+            return;
+        }
+        spi_p->capture = capture;
+        spi_p->captureCapacity = capacity;
+    }
+    spi_p->capture[spi_p->captureCount++] = record;
+}
+
+bool Spi_saveCapture(const SimDevice* sim_p, const char* path)
+{
+    FILE* file = fopen(path, "wb");
+    if (!file)
+        return false;
+
+    // A ring exactly as long as the capture, so it never wrapped
+    LcdCaptureHeader header;
+    header.magic = LCD_CAPTURE_MAGIC;
+    header.capacity = sim_p->spi.captureCount;
+    header.count = sim_p->spi.captureCount;
+    fwrite(&header, sizeof(header), 1, file);
+    fwrite(sim_p->spi.capture, sizeof(uint16_t), sim_p->spi.captureCount, file);
+
+    return fclose(file) == 0;
+}
+
+//*****************************************************************************
+// eUSCI_B0 registers and DriverLib calls
+//*****************************************************************************
+volatile uint16_t* Sim_UCB0TXBUF(void)
+{
+    SimDevice* sim_p = Sim_device;
+
+    // Storing a second byte before the first one moved on would overwrite it
+    Spi_sync(sim_p);
+
+    Spi_spend(sim_p, SPI_TXBUF_WRITE_CYCLES, false);
+    sim_p->spi.txLatched = true;
+    return (volatile uint16_t*) &sim_p->spi.txBuffer;
+}
+
+uint16_t Sim_UCB0STATW(void)
+{
+    SimDevice* sim_p = Sim_device;
+
+    Spi_sync(sim_p);
+
+    // The driver polls until UCBUSY clears, so the busy polls are charged all at once and the
+    // read returns the idle status the last poll would see
+    if (sim_p->cycles < sim_p->spi.shiftEnd) {
+        uint64_t wait = sim_p->spi.shiftEnd - sim_p->cycles;
+        uint64_t polls = (wait + SPI_STATUS_POLL_CYCLES - 1) / SPI_STATUS_POLL_CYCLES;
+        Spi_spend(sim_p, (uint32_t) (polls * SPI_STATUS_POLL_CYCLES), true);
+    }
+    Spi_spend(sim_p, SPI_STATUS_POLL_CYCLES, false);
+    return 0;
+}
+
+uint16_t Sim_UCB0IFG(void)
+{
+    SimDevice* sim_p = Sim_device;
+
+    Spi_sync(sim_p);
+
+    // As for UCBUSY, the polls until TXBUF empties into the shift register are charged at once
+    if (sim_p->cycles < sim_p->spi.shiftStart) {
+        uint64_t wait = sim_p->spi.shiftStart - sim_p->cycles;
+        uint64_t polls = (wait + SPI_STATUS_POLL_CYCLES - 1) / SPI_STATUS_POLL_CYCLES;
+        Spi_spend(sim_p, (uint32_t) (polls * SPI_STATUS_POLL_CYCLES), true);
+    }
+    Spi_spend(sim_p, SPI_STATUS_POLL_CYCLES, false);
+    return UCTXIFG;
+}
+
+bool SPI_initMaster(uint32_t moduleInstance, const eUSCI_SPI_MasterConfig *config)
+{
+    SpiLink* spi_p = &Sim_device->spi;
+
+    // The bit clock divides the source clock by an integer, at least 1
+    uint32_t divider = config->clockSourceFrequency / config->desiredSpiClock;
+    if (divider == 0)
+        divider = 1;
+    spi_p->byteCycles = 8 * divider * (SIM_CPU_HZ / config->clockSourceFrequency);
+    return true;
+}
+
+void SPI_enableModule(uint32_t moduleInstance)
+{
+    Sim_device->spi.enabled = true;
+}
+
+// UCBxTXBUF's address on the board; only the DMA model ever sees it
+uint32_t SPI_getTransmitBufferAddressForDMA(uint32_t moduleInstance)
+{
+    return moduleInstance + 0x000E;
+}
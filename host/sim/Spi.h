@@ -0,0 +1,134 @@
+/*
+ * Spi.h
+ *
+ * eUSCI_B0 in SPI master mode, wired to the LCD, with a cost model for the driver's side of
+ * the link. The driver polls UCTXIFG before storing each byte to UCB0TXBUF, so it waits for
+ * the previous byte to move into the shift register rather than to leave it, and polls UCBUSY
+ * only before it changes D/C. The model charges the polls and stores to the simulated clock
+ * and totals them per display driver entry point and per screen (everything drawn between
+ * two screen clears).
+ *
+ * With the display list the bytes go out long after the entry point that queued them has
+ * returned, so every byte is tagged with its entry point and screen when the driver queues it
+ * (its LcdDriver/LcdCapture.h record) and charged to them when it reaches the wire.
+ */
+
+#ifndef SIM_SPI_H_
+#define SIM_SPI_H_
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+// CPU cycles for the instructions on the driver's side of the link
+#define SPI_TXBUF_WRITE_CYCLES  2       // Store to UCB0TXBUF
+#define SPI_STATUS_POLL_CYCLES  4       // Load UCB0STATW or UCB0IFG, test the bit, branch back
+
+#define SPI_MAX_SCREENS         64
+
+// Stretches of queued bytes the link keeps tags for; more than the display list has records
+#define SPI_QUEUED_RUNS         4096
+
+// The display driver entry points costs are attributed to (g_sCrystalfontz128x128_funcs)
+enum _SpiCall
+{
+    SPI_CALL_DIRECT,                // Driver functions the firmware calls itself (Init, ...)
+    SPI_CALL_PIXEL_DRAW,
+    SPI_CALL_PIXEL_DRAW_MULTIPLE,
+    SPI_CALL_LINE_DRAW_H,
+    SPI_CALL_LINE_DRAW_V,
+    SPI_CALL_RECT_FILL,
+    SPI_CALL_FLUSH,
+    SPI_CALL_CLEAR_SCREEN,
+    SPI_CALL_COUNT
+};
+typedef enum _SpiCall SpiCall;
+
+struct _SpiStats
+{
+    uint64_t calls;
+    uint64_t commandBytes;
+    uint64_t dataBytes;
+    uint64_t wireCycles;        // Time the bytes spend on the wire
+    uint64_t spinCycles;        // CPU time spent polling UCBUSY and UCTXIFG
+    uint64_t cpuCycles;         // CPU time spent in UCB0 register accesses
+    uint64_t pixels;            // Pixels written to the panel
+    uint64_t redundantPixels;   // Of those, the ones that did not change (see Panel.h)
+};
+typedef struct _SpiStats SpiStats;
+
+// A stretch of queued bytes from the same entry point and screen
+struct _SpiRun
+{
+    SpiCall call;
+    int screen;
+    uint32_t bytes;
+};
+typedef struct _SpiRun SpiRun;
+
+struct _SpiLink
+{
+    bool enabled;
+    uint32_t byteCycles;        // CPU cycles per byte on the wire at the configured SPI clock
+
+    // The transmit path: a byte stored to TXBUF is latched until the next register access
+    bool txLatched;
+    uint16_t txBuffer;
+    uint64_t shiftStart;        // Cycle at which the last byte moved out of TXBUF
+    uint64_t shiftEnd;          // Cycle at which the shift register goes idle
+    uint64_t lastPixelCycle;    // When the last byte that changed a pixel finished shifting
+    uint64_t dcGlitches;        // D/C changes while a byte was still shifting
+
+    // Attribution
+    SpiCall call;
+    int callDepth;
+    SpiStats calls[SPI_CALL_COUNT];
+    SpiStats screens[SPI_MAX_SCREENS];
+    int screenCount;
+    SpiStats total;
+
+    // Tags of the bytes queued but not yet on the wire, oldest first
+    SpiRun queued[SPI_QUEUED_RUNS];
+    uint32_t queuedFirst;
+    uint32_t queuedCount;
+
+    // HAL_LCD_listStalls() when the run stopped, since the driver's state goes with the stack
+    uint32_t listStalls;
+
+    // The driver's byte stream in LcdDriver/LcdCapture.h records, while capturing
+    bool capturing;
+    uint16_t* capture;
+    uint32_t captureCount;
+    uint32_t captureCapacity;
+};
+typedef struct _SpiLink SpiLink;
+
+struct _SimDevice;
+
+// Brackets a call into the display driver so its cost is attributed to that entry point
+void Spi_beginCall(struct _SimDevice* sim_p, SpiCall call);
+void Spi_endCall(struct _SimDevice* sim_p);
+
+// Hands a byte still sitting in TXBUF to the shift register (before D/C changes, for example)
+void Spi_sync(struct _SimDevice* sim_p);
+
+// Stores a byte to TXBUF for the DMA, without charging the CPU
+void Spi_dmaWrite(struct _SimDevice* sim_p, uint8_t byte);
+
+// Called before the GPIO outputs of port change to levels, to catch D/C changing mid-byte
+void Spi_checkDc(struct _SimDevice* sim_p, uint8_t port, uint16_t levels);
+
+// Starts recording the driver's byte stream, which Spi_saveCapture() writes in the format of
+// LcdDriver/LcdCapture.h; returns false if the file cannot be written
+void Spi_startCapture(struct _SimDevice* sim_p);
+bool Spi_saveCapture(const struct _SimDevice* sim_p, const char* path);
+
+// Keeps what the report needs from the driver; called while the firmware is still running
+void Spi_stop(struct _SimDevice* sim_p);
+
+// Prints per-entry-point and per-screen totals
+void Spi_printReport(FILE* out, const struct _SimDevice* sim_p);
+
+extern const char* const Spi_callNames[SPI_CALL_COUNT];
+
+#endif /* SIM_SPI_H_ */
@@ -0,0 +1,76 @@
+/*
+ * Timer32.c
+ *
+ * Timer32 module 0 as a down-counter clocked by the CPU cycle count. Only the periodic mode
+ * with a prescaler of 1 that HAL/Timer.c configures is modelled. The interrupt enable bit is
+ * set out of reset on the real part, so rollovers raise INT_T32_INT1 without further setup.
+ */
+
+#include <stdio.h>
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include "Sim.h"
+
+uint64_t Sim_timer32NextEvent(const SimDevice* sim_p)
+{
+    if (!sim_p->t32Running)
+        return UINT64_MAX;
+
+    // The counter reaches zero once per (load + 1) cycles
+    uint64_t period = (uint64_t) sim_p->t32Load + 1;
+    uint64_t elapsed = sim_p->cycles - sim_p->t32Start;
+    return sim_p->t32Start + (elapsed / period + 1) * period;
+}
+
+void Sim_timer32Event(SimDevice* sim_p)
+{
+    sim_p->t32Ifg = true;
+    Sim_raiseInterrupt(sim_p, INT_T32_INT1);
+}
+
+void Timer32_initModule(uint32_t timer, uint32_t preScaler, uint32_t resolution, uint32_t mode)
+{
+    if (timer != TIMER32_0_BASE || preScaler != TIMER32_PRESCALER_1 ||
+        resolution != TIMER32_32BIT || mode != TIMER32_PERIODIC_MODE)
+        fprintf(stderr, "sim: only Timer32 0 in 32-bit periodic mode is modelled\n");
+}
+
+void Timer32_setCount(uint32_t timer, uint32_t count)
+{
+    Sim_device->t32Load = count;
+    Sim_device->t32Start = Sim_device->cycles;
+    Sim_reschedule(Sim_device);
+}
+
+uint32_t Timer32_getValue(uint32_t timer)
+{
+    SimDevice* sim_p = Sim_device;
+    if (!sim_p->t32Running)
+        return sim_p->t32Load;
+
+    uint64_t period = (uint64_t) sim_p->t32Load + 1;
+    uint64_t elapsed = sim_p->cycles - sim_p->t32Start;
+    return (uint32_t) (sim_p->t32Load - (elapsed % period));
+}
+
+void Timer32_startTimer(uint32_t timer, bool oneShot)
+{
+    Sim_device->t32Running = true;
+    Sim_device->t32Start = Sim_device->cycles;
+    Sim_reschedule(Sim_device);
+}
+
+void Timer32_haltTimer(uint32_t timer)
+{
+    Sim_device->t32Running = false;
+    Sim_reschedule(Sim_device);
+}
+
+void Timer32_clearInterruptFlag(uint32_t timer)
+{
+    Sim_device->t32Ifg = false;
+}
+
+uint32_t Timer32_getInterruptStatus(uint32_t timer)
+{
+    return Sim_device->t32Ifg;
+}
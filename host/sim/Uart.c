@@ -0,0 +1,110 @@
+/*
+ * Uart.c
+ *
+ * The transmit path of eUSCI_A0 in UART mode. A byte written to TXBUF moves into the shift
+ * register as soon as it is free and takes ten bit times (start, eight data bits, stop) to go
+ * out; TXIFG is set whenever TXBUF is free again, and raises INT_EUSCIA0 while the transmit
+ * interrupt is enabled. Each byte that goes out is written to uartOut, a file or a pty, if the
+ * harness opened one. The receive side is not modelled.
+ */
+
+#include <ti/devices/msp432p4xx/driverlib/driverlib.h>
+#include "Sim.h"
+
+static bool Uart_txifg(const SimDevice* sim_p)
+{
+    return sim_p->uartEnabled && !sim_p->uartBuffered;
+}
+
+// The interrupt line follows TXIFG and the enable bit
+static void Uart_update(SimDevice* sim_p)
+{
+    if (sim_p->uartTxie && Uart_txifg(sim_p))
+        Sim_raiseInterrupt(sim_p, INT_EUSCIA0);
+}
+
+// Starts shifting the byte in TXBUF if the shift register is free
+static void Uart_load(SimDevice* sim_p)
+{
+    if (!sim_p->uartBuffered || sim_p->uartShiftEnd)
+        return;
+    sim_p->uartBuffered = false;
+    sim_p->uartShifting = sim_p->uartBuffer;
+    sim_p->uartShiftEnd = sim_p->cycles + sim_p->uartByteCycles;
+    Sim_reschedule(sim_p);
+}
+
+uint64_t Sim_uartNextEvent(const SimDevice* sim_p)
+{
+    return sim_p->uartShiftEnd ? sim_p->uartShiftEnd : UINT64_MAX;
+}
+
+void Sim_uartEvent(SimDevice* sim_p)
+{
+    if (sim_p->uartOut) {
+        fputc(sim_p->uartShifting, sim_p->uartOut);
+        fflush(sim_p->uartOut);
+    }
+    sim_p->uartBytes++;
+    sim_p->uartShiftEnd = 0;
+
+    Uart_load(sim_p);
+    Uart_update(sim_p);
+}
+
+bool UART_initModule(uint32_t moduleInstance, const eUSCI_UART_ConfigV1 *config)
+{
+    SimDevice* sim_p = Sim_device;
+    if (moduleInstance != EUSCI_A0_BASE) {
+        fprintf(stderr, "sim: only eUSCI_A0 is modelled as a UART\n");
+        return false;
+    }
+
+    // The bit time is UCBR cycles of the clock, 16 of them with oversampling, plus the
+    // fraction UCBRF adds; the clock is SMCLK, which runs at the CPU's rate
+    uint64_t bitCycles16 = config->overSampling ?
+                           16 * (uint64_t) config->clockPrescalar + config->firstModReg :
+                           16 * (uint64_t) config->clockPrescalar;
+    sim_p->uartByteCycles = 10 * bitCycles16 / 16;
+    sim_p->uartEnabled = false;
+    sim_p->uartTxie = false;
+    sim_p->uartBuffered = false;
+    sim_p->uartShiftEnd = 0;
+    return true;
+}
+
+void UART_enableModule(uint32_t moduleInstance)
+{
+    Sim_device->uartEnabled = true;
+}
+
+void UART_transmitData(uint32_t moduleInstance, uint_fast8_t transmitData)
+{
+    SimDevice* sim_p = Sim_device;
+
+    // Like driverlib, wait for TXBUF only when the interrupt is not there to say it is free
+    if (!sim_p->uartTxie) {
+        while (sim_p->uartBuffered)
+            Sim_advanceTo(sim_p, sim_p->uartShiftEnd);
+    }
+
+    sim_p->uartBuffer = transmitData;
+    sim_p->uartBuffered = true;
+    Uart_load(sim_p);
+    Uart_update(sim_p);
+}
+
+void UART_enableInterrupt(uint32_t moduleInstance, uint_fast8_t mask)
+{
+    SimDevice* sim_p = Sim_device;
+    if (mask & EUSCI_A_UART_TRANSMIT_INTERRUPT) {
+        sim_p->uartTxie = true;
+        Uart_update(sim_p);
+    }
+}
+
+void UART_disableInterrupt(uint32_t moduleInstance, uint_fast8_t mask)
+{
+    if (mask & EUSCI_A_UART_TRANSMIT_INTERRUPT)
+        Sim_device->uartTxie = false;
+}
@@ -0,0 +1,131 @@
+/*
+ * fontfixed6x8.c (host stand-in)
+ *
+ * A fixed 6x8 font for the host grlib: 5x7 glyphs with one blank column and one blank row,
+ * stored in the uncompressed layout described in grlib.h, 6 bytes of bits per glyph.
+ */
+
+#include <ti/grlib/grlib.h>
+
+static const uint8_t g_pucFontFixed6x8Data[] =
+{
+    8, 6, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,   // ' '
+    8, 6, 0x20, 0x82, 0x08, 0x20, 0x02, 0x00,   // '!'
+    8, 6, 0x51, 0x45, 0x00, 0x00, 0x00, 0x00,   // '"'
+    8, 6, 0x51, 0x4F, 0x94, 0xF9, 0x45, 0x00,   // '#'
+    8, 6, 0x21, 0xEA, 0x1C, 0x2B, 0xC2, 0x00,   // '$'
+    8, 6, 0xC3, 0x21, 0x08, 0x42, 0x61, 0x80,   // '%'
+    8, 6, 0x62, 0x4A, 0x10, 0xAA, 0x46, 0x80,   // '&'
+    8, 6, 0x60, 0x84, 0x00, 0x00, 0x00, 0x00,   // '''
+    8, 6, 0x10, 0x84, 0x10, 0x40, 0x81, 0x00,   // '('
+    8, 6, 0x40, 0x81, 0x04, 0x10, 0x84, 0x00,   // ')'
+    8, 6, 0x01, 0x42, 0x3E, 0x21, 0x40, 0x00,   // '*'
+    8, 6, 0x00, 0x82, 0x3E, 0x20, 0x80, 0x00,   // '+'
+    8, 6, 0x00, 0x00, 0x00, 0x60, 0x84, 0x00,   // ','
+    8, 6, 0x00, 0x00, 0x3E, 0x00, 0x00, 0x00,   // '-'
+    8, 6, 0x00, 0x00, 0x00, 0x01, 0x86, 0x00,   // '.'
+    8, 6, 0x00, 0x21, 0x08, 0x42, 0x00, 0x00,   // '/'
+    8, 6, 0x72, 0x29, 0xAA, 0xCA, 0x27, 0x00,   // '0'
+    8, 6, 0x21, 0x82, 0x08, 0x20, 0x87, 0x00,   // '1'
+    8, 6, 0x72, 0x20, 0x84, 0x21, 0x0F, 0x80,   // '2'
+    8, 6, 0xF8, 0x42, 0x04, 0x0A, 0x27, 0x00,   // '3'
+    8, 6, 0x10, 0xC5, 0x24, 0xF8, 0x41, 0x00,   // '4'
+    8, 6, 0xFA, 0x0F, 0x02, 0x0A, 0x27, 0x00,   // '5'
+    8, 6, 0x31, 0x08, 0x3C, 0x8A, 0x27, 0x00,   // '6'
+    8, 6, 0xF8, 0x21, 0x08, 0x41, 0x04, 0x00,   // '7'
+    8, 6, 0x72, 0x28, 0x9C, 0x8A, 0x27, 0x00,   // '8'
+    8, 6, 0x72, 0x28, 0x9E, 0x08, 0x46, 0x00,   // '9'
+    8, 6, 0x01, 0x86, 0x00, 0x61, 0x80, 0x00,   // ':'
+    8, 6, 0x01, 0x86, 0x00, 0x60, 0x84, 0x00,   // ';'
+    8, 6, 0x08, 0x42, 0x10, 0x20, 0x40, 0x80,   // '<'
+    8, 6, 0x00, 0x0F, 0x80, 0xF8, 0x00, 0x00,   // '='
+    8, 6, 0x81, 0x02, 0x04, 0x21, 0x08, 0x00,   // '>'
+    8, 6, 0x72, 0x20, 0x84, 0x20, 0x02, 0x00,   // '?'
+    8, 6, 0x72, 0x20, 0x9A, 0xAA, 0xA7, 0x00,   // '@'
+    8, 6, 0x72, 0x28, 0xA2, 0xFA, 0x28, 0x80,   // 'A'
+    8, 6, 0xF2, 0x28, 0xBC, 0x8A, 0x2F, 0x00,   // 'B'
+    8, 6, 0x72, 0x28, 0x20, 0x82, 0x27, 0x00,   // 'C'
+    8, 6, 0xE2, 0x48, 0xA2, 0x8A, 0x4E, 0x00,   // 'D'
+    8, 6, 0xFA, 0x08, 0x3C, 0x82, 0x0F, 0x80,   // 'E'
+    8, 6, 0xFA, 0x08, 0x38, 0x82, 0x08, 0x00,   // 'F'
+    8, 6, 0x72, 0x28, 0x20, 0x9A, 0x27, 0x00,   // 'G'
+    8, 6, 0x8A, 0x28, 0xBE, 0x8A, 0x28, 0x80,   // 'H'
+    8, 6, 0x70, 0x82, 0x08, 0x20, 0x87, 0x00,   // 'I'
+    8, 6, 0x38, 0x41, 0x04, 0x12, 0x46, 0x00,   // 'J'
+    8, 6, 0x8A, 0x4A, 0x30, 0xA2, 0x48, 0x80,   // 'K'
+    8, 6, 0x82, 0x08, 0x20, 0x82, 0x0F, 0x80,   // 'L'
+    8, 6, 0x8B, 0x6A, 0xA2, 0x8A, 0x28, 0x80,   // 'M'
+    8, 6, 0x8A, 0x2C, 0xAA, 0x9A, 0x28, 0x80,   // 'N'
+    8, 6, 0x72, 0x28, 0xA2, 0x8A, 0x27, 0x00,   // 'O'
+    8, 6, 0xF2, 0x28, 0xBC, 0x82, 0x08, 0x00,   // 'P'
+    8, 6, 0x72, 0x28, 0xA2, 0xAA, 0x46, 0x80,   // 'Q'
+    8, 6, 0xF2, 0x28, 0xBC, 0xA2, 0x48, 0x80,   // 'R'
+    8, 6, 0x7A, 0x08, 0x1C, 0x08, 0x2F, 0x00,   // 'S'
+    8, 6, 0xF8, 0x82, 0x08, 0x20, 0x82, 0x00,   // 'T'
+    8, 6, 0x8A, 0x28, 0xA2, 0x8A, 0x27, 0x00,   // 'U'
+    8, 6, 0x8A, 0x28, 0xA2, 0x89, 0x42, 0x00,   // 'V'
+    8, 6, 0x8A, 0x28, 0xAA, 0xAB, 0x68, 0x80,   // 'W'
+    8, 6, 0x8A, 0x25, 0x08, 0x52, 0x28, 0x80,   // 'X'
+    8, 6, 0x8A, 0x25, 0x08, 0x20, 0x82, 0x00,   // 'Y'
+    8, 6, 0xF8, 0x21, 0x08, 0x42, 0x0F, 0x80,   // 'Z'
+    8, 6, 0x38, 0x82, 0x08, 0x20, 0x83, 0x80,   // '['
+    8, 6, 0x02, 0x04, 0x08, 0x10, 0x20, 0x00,   // backslash
+    8, 6, 0xE0, 0x82, 0x08, 0x20, 0x8E, 0x00,   // ']'
+    8, 6, 0x21, 0x48, 0x80, 0x00, 0x00, 0x00,   // '^'
+    8, 6, 0x00, 0x00, 0x00, 0x00, 0x0F, 0x80,   // '_'
+    8, 6, 0x40, 0x81, 0x00, 0x00, 0x00, 0x00,   // '`'
+    8, 6, 0x00, 0x07, 0x02, 0x7A, 0x27, 0x80,   // 'a'
+    8, 6, 0x82, 0x0B, 0x32, 0x8A, 0x2F, 0x00,   // 'b'
+    8, 6, 0x00, 0x07, 0x20, 0x82, 0x27, 0x00,   // 'c'
+    8, 6, 0x08, 0x26, 0xA6, 0x8A, 0x27, 0x80,   // 'd'
+    8, 6, 0x00, 0x07, 0x22, 0xFA, 0x07, 0x00,   // 'e'
+    8, 6, 0x31, 0x24, 0x38, 0x41, 0x04, 0x00,   // 'f'
+    8, 6, 0x00, 0x07, 0xA2, 0x78, 0x23, 0x00,   // 'g'
+    8, 6, 0x82, 0x0B, 0x32, 0x8A, 0x28, 0x80,   // 'h'
+    8, 6, 0x20, 0x06, 0x08, 0x20, 0x87, 0x00,   // 'i'
+    8, 6, 0x10, 0x03, 0x04, 0x12, 0x46, 0x00,   // 'j'
+    8, 6, 0x41, 0x04, 0x94, 0x61, 0x44, 0x80,   // 'k'
+    8, 6, 0x60, 0x82, 0x08, 0x20, 0x87, 0x00,   // 'l'
+    8, 6, 0x00, 0x0D, 0x2A, 0xAA, 0x28, 0x80,   // 'm'
+    8, 6, 0x00, 0x0B, 0x32, 0x8A, 0x28, 0x80,   // 'n'
+    8, 6, 0x00, 0x07, 0x22, 0x8A, 0x27, 0x00,   // 'o'
+    8, 6, 0x00, 0x0F, 0x22, 0xF2, 0x08, 0x00,   // 'p'
+    8, 6, 0x00, 0x06, 0xA6, 0x78, 0x20, 0x80,   // 'q'
+    8, 6, 0x00, 0x0B, 0x32, 0x82, 0x08, 0x00,   // 'r'
+    8, 6, 0x00, 0x07, 0x20, 0x70, 0x2F, 0x00,   // 's'
+    8, 6, 0x41, 0x0E, 0x10, 0x41, 0x23, 0x00,   // 't'
+    8, 6, 0x00, 0x08, 0xA2, 0x8A, 0x66, 0x80,   // 'u'
+    8, 6, 0x00, 0x08, 0xA2, 0x89, 0x42, 0x00,   // 'v'
+    8, 6, 0x00, 0x08, 0xA2, 0xAA, 0xA5, 0x00,   // 'w'
+    8, 6, 0x00, 0x08, 0x94, 0x21, 0x48, 0x80,   // 'x'
+    8, 6, 0x00, 0x08, 0xA2, 0x78, 0x27, 0x00,   // 'y'
+    8, 6, 0x00, 0x0F, 0x84, 0x21, 0x0F, 0x80,   // 'z'
+    8, 6, 0x10, 0x82, 0x10, 0x20, 0x81, 0x00,   // '{'
+    8, 6, 0x20, 0x82, 0x08, 0x20, 0x82, 0x00,   // '|'
+    8, 6, 0x40, 0x82, 0x04, 0x20, 0x84, 0x00,   // '}'
+    8, 6, 0x00, 0x81, 0x3E, 0x10, 0x80, 0x00,   // '~'
+    8, 6, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,   // DEL
+};
+
+const Graphics_Font g_sFontFixed6x8 =
+{
+    FONT_FMT_UNCOMPRESSED,
+    6,
+    8,
+    7,
+    {
+           0,    8,   16,   24,   32,   40,   48,   56,
+          64,   72,   80,   88,   96,  104,  112,  120,
+         128,  136,  144,  152,  160,  168,  176,  184,
+         192,  200,  208,  216,  224,  232,  240,  248,
+         256,  264,  272,  280,  288,  296,  304,  312,
+         320,  328,  336,  344,  352,  360,  368,  376,
+         384,  392,  400,  408,  416,  424,  432,  440,
+         448,  456,  464,  472,  480,  488,  496,  504,
+         512,  520,  528,  536,  544,  552,  560,  568,
+         576,  584,  592,  600,  608,  616,  624,  632,
+         640,  648,  656,  664,  672,  680,  688,  696,
+         704,  712,  720,  728,  736,  744,  752,  760,
+    },
+    g_pucFontFixed6x8Data
+};
@@ -0,0 +1,328 @@
+/*
+ * grlib.c (host stand-in)
+ *
+ * Implements the grlib calls used by the firmware on top of a Graphics_Display_Functions
+ * table, so every pixel still reaches the LCD through the Crystalfontz driver. The algorithms
+ * follow grlib's: circles are midpoint circles, filled circles and rectangle edges are
+ * clipped horizontal/vertical lines, and opaque text is drawn one glyph row at a time with
+ * the 1 BPP multiple-pixel primitive.
+ */
+
+#include <ti/grlib/grlib.h>
+#include "Sim.h"
+
+// Every call into the display driver is attributed to its entry point by the SPI model
+#define DpyCall(call, expr) \
+    do { \
+        Spi_beginCall(Sim_device, (call)); \
+        expr; \
+        Spi_endCall(Sim_device); \
+    } while (0)
+
+#define DpyPixelDraw(c, x, y, v) \
+    DpyCall(SPI_CALL_PIXEL_DRAW, \
+            (c)->displayFunctions->pfnPixelDraw((c)->display, (x), (y), (v)))
+#define DpyPixelDrawMultiple(c, x, y, x0, n, bpp, data, palette) \
+    DpyCall(SPI_CALL_PIXEL_DRAW_MULTIPLE, \
+            (c)->displayFunctions->pfnPixelDrawMultiple((c)->display, (x), (y), (x0), (n), \
+                                                        (bpp), (data), (palette)))
+#define DpyLineDrawH(c, x1, x2, y, v) \
+    DpyCall(SPI_CALL_LINE_DRAW_H, \
+            (c)->displayFunctions->pfnLineDrawH((c)->display, (x1), (x2), (y), (v)))
+#define DpyLineDrawV(c, x, y1, y2, v) \
+    DpyCall(SPI_CALL_LINE_DRAW_V, \
+            (c)->displayFunctions->pfnLineDrawV((c)->display, (x), (y1), (y2), (v)))
+#define DpyRectFill(c, r, v) \
+    DpyCall(SPI_CALL_RECT_FILL, \
+            (c)->displayFunctions->pfnRectFill((c)->display, (r), (v)))
+#define DpyColorTranslate(c, v) \
+    (c)->displayFunctions->pfnColorTranslate((c)->display, (v))
+#define DpyFlush(c) \
+    DpyCall(SPI_CALL_FLUSH, \
+            (c)->displayFunctions->pfnFlush((c)->display))
+#define DpyClearDisplay(c, v) \
+    DpyCall(SPI_CALL_CLEAR_SCREEN, \
+            (c)->displayFunctions->pfnClearDisplay((c)->display, (v)))
+
+void Graphics_initContext(Graphics_Context *context, Graphics_Display *display,
+                          const Graphics_Display_Functions *pFxns)
+{
+    context->size = sizeof(Graphics_Context);
+    context->display = display;
+    context->displayFunctions = pFxns;
+
+    context->clipRegion.sXMin = 0;
+    context->clipRegion.sYMin = 0;
+    context->clipRegion.sXMax = display->width - 1;
+    context->clipRegion.sYMax = display->heigth - 1;
+
+    context->foreground = 0;
+    context->background = 0;
+    context->font = 0;
+}
+
+void Graphics_setFont(Graphics_Context *context, const Graphics_Font *font)
+{
+    context->font = font;
+}
+
+void Graphics_setForegroundColor(Graphics_Context *context, int32_t value)
+{
+    context->foreground = DpyColorTranslate(context, value);
+}
+
+void Graphics_setBackgroundColor(Graphics_Context *context, int32_t value)
+{
+    context->background = DpyColorTranslate(context, value);
+}
+
+void Graphics_clearDisplay(const Graphics_Context *context)
+{
+    DpyClearDisplay(context, context->background);
+}
+
+void Graphics_flushBuffer(const Graphics_Context *context)
+{
+    DpyFlush(context);
+}
+
+void Graphics_drawPixel(const Graphics_Context *context, int32_t x, int32_t y)
+{
+    if ((x >= context->clipRegion.sXMin) && (x <= context->clipRegion.sXMax) &&
+        (y >= context->clipRegion.sYMin) && (y <= context->clipRegion.sYMax))
+    {
+        DpyPixelDraw(context, x, y, context->foreground);
+    }
+}
+
+void Graphics_drawLineH(const Graphics_Context *context, int32_t x1, int32_t x2, int32_t y)
+{
+    int32_t temp;
+
+    if ((y < context->clipRegion.sYMin) || (y > context->clipRegion.sYMax))
+    {
+        return;
+    }
+
+    if (x1 > x2)
+    {
+        temp = x1;
+        x1 = x2;
+        x2 = temp;
+    }
+
+    if ((x2 < context->clipRegion.sXMin) || (x1 > context->clipRegion.sXMax))
+    {
+        return;
+    }
+    if (x1 < context->clipRegion.sXMin)
+    {
+        x1 = context->clipRegion.sXMin;
+    }
+    if (x2 > context->clipRegion.sXMax)
+    {
+        x2 = context->clipRegion.sXMax;
+    }
+
+    DpyLineDrawH(context, x1, x2, y, context->foreground);
+}
+
+void Graphics_drawLineV(const Graphics_Context *context, int32_t x, int32_t y1, int32_t y2)
+{
+    int32_t temp;
+
+    if ((x < context->clipRegion.sXMin) || (x > context->clipRegion.sXMax))
+    {
+        return;
+    }
+
+    if (y1 > y2)
+    {
+        temp = y1;
+        y1 = y2;
+        y2 = temp;
+    }
+
+    if ((y2 < context->clipRegion.sYMin) || (y1 > context->clipRegion.sYMax))
+    {
+        return;
+    }
+    if (y1 < context->clipRegion.sYMin)
+    {
+        y1 = context->clipRegion.sYMin;
+    }
+    if (y2 > context->clipRegion.sYMax)
+    {
+        y2 = context->clipRegion.sYMax;
+    }
+
+    DpyLineDrawV(context, x, y1, y2, context->foreground);
+}
+
+void Graphics_drawRectangle(const Graphics_Context *context, const Graphics_Rectangle *rect)
+{
+    Graphics_drawLineH(context, rect->sXMin, rect->sXMax, rect->sYMin);
+    Graphics_drawLineH(context, rect->sXMin, rect->sXMax, rect->sYMax);
+    Graphics_drawLineV(context, rect->sXMin, rect->sYMin + 1, rect->sYMax - 1);
+    Graphics_drawLineV(context, rect->sXMax, rect->sYMin + 1, rect->sYMax - 1);
+}
+
+void Graphics_fillRectangle(const Graphics_Context *context, const Graphics_Rectangle *rect)
+{
+    Graphics_Rectangle temp;
+
+    temp.sXMin = (rect->sXMin < rect->sXMax) ? rect->sXMin : rect->sXMax;
+    temp.sXMax = (rect->sXMin < rect->sXMax) ? rect->sXMax : rect->sXMin;
+    temp.sYMin = (rect->sYMin < rect->sYMax) ? rect->sYMin : rect->sYMax;
+    temp.sYMax = (rect->sYMin < rect->sYMax) ? rect->sYMax : rect->sYMin;
+
+    if ((temp.sXMin > context->clipRegion.sXMax) || (temp.sXMax < context->clipRegion.sXMin) ||
+        (temp.sYMin > context->clipRegion.sYMax) || (temp.sYMax < context->clipRegion.sYMin))
+    {
+        return;
+    }
+    if (temp.sXMin < context->clipRegion.sXMin)
+    {
+        temp.sXMin = context->clipRegion.sXMin;
+    }
+    if (temp.sYMin < context->clipRegion.sYMin)
+    {
+        temp.sYMin = context->clipRegion.sYMin;
+    }
+    if (temp.sXMax > context->clipRegion.sXMax)
+    {
+        temp.sXMax = context->clipRegion.sXMax;
+    }
+    if (temp.sYMax > context->clipRegion.sYMax)
+    {
+        temp.sYMax = context->clipRegion.sYMax;
+    }
+
+    DpyRectFill(context, &temp, context->foreground);
+}
+
+void Graphics_drawCircle(const Graphics_Context *context, int32_t x, int32_t y,
+                         int32_t lRadius)
+{
+    int32_t lA, lB, lD;
+
+    lD = 3 - (2 * lRadius);
+
+    for (lA = 0, lB = lRadius; lA <= lB; lA++)
+    {
+        Graphics_drawPixel(context, x + lA, y - lB);
+        Graphics_drawPixel(context, x - lA, y - lB);
+        Graphics_drawPixel(context, x + lA, y + lB);
+        Graphics_drawPixel(context, x - lA, y + lB);
+        Graphics_drawPixel(context, x + lB, y - lA);
+        Graphics_drawPixel(context, x - lB, y - lA);
+        Graphics_drawPixel(context, x + lB, y + lA);
+        Graphics_drawPixel(context, x - lB, y + lA);
+
+        if (lD < 0)
+        {
+            lD += (4 * lA) + 6;
+        }
+        else
+        {
+            lD += (4 * (lA - lB)) + 10;
+            lB -= 1;
+        }
+    }
+}
+
+void Graphics_fillCircle(const Graphics_Context *context, int32_t x, int32_t y,
+                         int32_t lRadius)
+{
+    int32_t lA, lB, lD;
+
+    lD = 3 - (2 * lRadius);
+
+    for (lA = 0, lB = lRadius; lA <= lB; lA++)
+    {
+        Graphics_drawLineH(context, x - lB, x + lB, y - lA);
+        if (lA)
+        {
+            Graphics_drawLineH(context, x - lB, x + lB, y + lA);
+        }
+
+        if ((lD >= 0) && (lB != lA))
+        {
+            Graphics_drawLineH(context, x - lA, x + lA, y - lB);
+            Graphics_drawLineH(context, x - lA, x + lA, y + lB);
+            lD += (4 * (lA - lB)) + 10;
+            lB -= 1;
+        }
+        else
+        {
+            lD += (4 * lA) + 6;
+        }
+    }
+}
+
+void Graphics_drawString(const Graphics_Context *context, int8_t *string, int32_t lLength,
+                         int32_t x, int32_t y, bool opaque)
+{
+    const Graphics_Font *font = context->font;
+    uint32_t palette[2];
+    int32_t row;
+
+    palette[0] = context->background;
+    palette[1] = context->foreground;
+
+    while (lLength-- && *string)
+    {
+        uint8_t c = (uint8_t) *string++;
+        if ((c < ' ') || (c > '~'))
+        {
+            c = ' ';
+        }
+
+        const uint8_t *glyph = font->data + font->offset[c - ' '];
+        int32_t width = glyph[1];
+
+        for (row = 0; row < font->height; row++)
+        {
+            int32_t lY = y + row;
+            int32_t bit = row * width;
+            if ((lY < context->clipRegion.sYMin) || (lY > context->clipRegion.sYMax))
+            {
+                continue;
+            }
+
+            if (opaque)
+            {
+                // The whole glyph row, background included, in a single multiple-pixel run
+                int32_t lX = x, lX0 = 0, count = width;
+                if (lX < context->clipRegion.sXMin)
+                {
+                    lX0 = context->clipRegion.sXMin - lX;
+                    count -= lX0;
+                    lX = context->clipRegion.sXMin;
+                }
+                if (lX + count - 1 > context->clipRegion.sXMax)
+                {
+                    count = context->clipRegion.sXMax - lX + 1;
+                }
+                if (count > 0)
+                {
+                    DpyPixelDrawMultiple(context, lX, lY, (bit & 7) + lX0, count, 1,
+                                         &glyph[2 + (bit >> 3)], palette);
+                }
+            }
+            else
+            {
+                int32_t col;
+                for (col = 0; col < width; col++)
+                {
+                    if (glyph[2 + ((bit + col) >> 3)] & (0x80 >> ((bit + col) & 7)))
+                    {
+                        Graphics_drawPixel(context, x + col, lY);
+                    }
+                }
+            }
+        }
+
+        x += width;
+    }
+}
@@ -0,0 +1,303 @@
+/*
+ * sram_report.c
+ *
+ * Lists what the firmware keeps in SRAM, from the linker map of a build (the .map file the TI
+ * linker writes next to the .out with msp432p401r.cmd):
+ *
+ *   sram_report [--top N] MAP
+ *
+ * Every section the map places in the 64 KB of SRAM_DATA, or in SRAM_CODE, which is the same
+ * memory seen from the code bus, is counted: .data and .bss hold the statics, .sysmem is the
+ * heap and .stack the stack. The report gives the total against the 64 KB, the size of each
+ * output section, the bytes each object file takes in each of them, and the --top N biggest
+ * variables (20 by default), named by the compiler's per-variable subsections (.bss:NAME).
+ * Alignment padding, and the part of .stack and .sysmem that no object claims, show as rows of
+ * their own named after the section, such as "(.stack)".
+ *
+ * The stack is whatever --stack_size reserved; how much of it the game really uses is the high
+ * water mark of HAL/StackUsage.h, shown in the performance overlay.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MAX_NAME        96
+#define MAX_SECTIONS    16
+
+#define SRAM_DATA_BASE  0x20000000u
+#define SRAM_CODE_BASE  0x01000000u
+#define SRAM_BYTES      0x10000u
+
+struct _Section
+{
+    char name[MAX_NAME];
+    uint32_t bytes;
+};
+typedef struct _Section Section;
+
+struct _Module
+{
+    char name[MAX_NAME];
+    uint32_t bytes[MAX_SECTIONS];   // Per output section, indexed as in Report.sections
+    uint32_t total;
+};
+typedef struct _Module Module;
+
+struct _Variable
+{
+    char name[MAX_NAME];
+    char module[MAX_NAME];
+    const char* section;
+    uint32_t bytes;
+};
+typedef struct _Variable Variable;
+
+struct _Report
+{
+    Section sections[MAX_SECTIONS];
+    int sectionCount;
+
+    Module* modules;
+    int moduleCount;
+    int moduleCapacity;
+
+    Variable* variables;
+    int variableCount;
+    int variableCapacity;
+};
+typedef struct _Report Report;
+
+static void* grow(void* array, int* capacity_p, size_t size)
+{
+    *capacity_p = *capacity_p ? 2 * *capacity_p : 64;
+    array = realloc(array, *capacity_p * size);
+    if (!array) {
+        fprintf(stderr, "sram_report: out of memory\n");
+        exit(1);
+    }
+    return array;
+}
+
+static void copyName(char* name, const char* start, int length)
+{
+    while (length > 0 && start[length - 1] == ' ')
+        length--;
+    if (length >= MAX_NAME)
+        length = MAX_NAME - 1;
+    memcpy(name, start, length);
+    name[length] = '\0';
+}
+
+static bool inSram(uint32_t address)
+{
+    return (address >= SRAM_DATA_BASE && address - SRAM_DATA_BASE < SRAM_BYTES) ||
+           (address >= SRAM_CODE_BASE && address - SRAM_CODE_BASE < SRAM_BYTES);
+}
+
+static Module* findModule(Report* report_p, const char* name)
+{
+    int i;
+    for (i = 0; i < report_p->moduleCount; i++) {
+        if (strcmp(report_p->modules[i].name, name) == 0)
+            return &report_p->modules[i];
+    }
+
+    if (report_p->moduleCount == report_p->moduleCapacity)
+        report_p->modules = grow(report_p->modules, &report_p->moduleCapacity, sizeof(Module));
+    Module* module_p = &report_p->modules[report_p->moduleCount++];
+    memset(module_p, 0, sizeof(*module_p));
+    snprintf(module_p->name, MAX_NAME, "%s", name);
+    return module_p;
+}
+
+static void addVariable(Report* report_p, const char* name, const char* module,
+                        const char* section, uint32_t bytes)
+{
+    if (report_p->variableCount == report_p->variableCapacity)
+        report_p->variables = grow(report_p->variables, &report_p->variableCapacity,
+                                   sizeof(Variable));
+    Variable* variable_p = &report_p->variables[report_p->variableCount++];
+    snprintf(variable_p->name, MAX_NAME, "%s", name);
+    snprintf(variable_p->module, MAX_NAME, "%s", module);
+    variable_p->section = section;
+    variable_p->bytes = bytes;
+}
+
+/**
+ * Counts an input section line of the section allocation map, such as
+ *
+ *                   20000000    00000804     tamagotchi_main.obj (.bss:hal)
+ *                   20000a00    00000004     rtsv7M4_T_le_v4SPD16_eabi.lib : boot.c.obj (.stack)
+ *                   20000a04    000001fc     --HOLE--
+ *
+ * against the output section it belongs to.
+ */
+static void countInput(Report* report_p, int section, const char* line)
+{
+    unsigned start, length;
+    int consumed;
+    if (sscanf(line, " %x %x %n", &start, &length, &consumed) != 2 || length == 0)
+        return;
+    const char* rest = line + consumed;
+    const char* sectionName = report_p->sections[section].name;
+
+    char module[MAX_NAME];
+    const char* open = strrchr(rest, '(');
+    const char* close = open ? strchr(open, ')') : NULL;
+    if (strncmp(rest, "--HOLE--", 8) == 0 || !open || !close)
+        snprintf(module, MAX_NAME, "(%s)", sectionName);
+    else {
+        // The object is the member of the library when there is one; the library's name is left
+        // out on the lines that follow its first member
+        const char* objectStart = strstr(rest, ": ");
+        objectStart = objectStart && objectStart < open ? objectStart + 2 : rest;
+        copyName(module, objectStart, (int) (open - objectStart));
+
+        // .bss:NAME, .data:NAME or .common:NAME for one variable; plain .bss for a whole object
+        const char* colon = memchr(open, ':', close - open);
+        if (colon) {
+            char name[MAX_NAME];
+            copyName(name, colon + 1, (int) (close - colon - 1));
+            addVariable(report_p, name, module, sectionName, length);
+        }
+    }
+
+    Module* module_p = findModule(report_p, module);
+    module_p->bytes[section] += length;
+    module_p->total += length;
+}
+
+/**
+ * Reads the SRAM sections out of a TI linker map. Returns false if there are none.
+ */
+static bool loadMap(const char* path, Report* report_p)
+{
+    FILE* file = fopen(path, "r");
+    if (!file) {
+        fprintf(stderr, "sram_report: cannot read %s\n", path);
+        return false;
+    }
+
+    // The SRAM output section the input sections being read belong to, if any
+    int section = -1;
+    bool inMap = false;
+
+    char line[512];
+    while (fgets(line, sizeof(line), file)) {
+        if (strstr(line, "SECTION ALLOCATION MAP")) {
+            inMap = true;
+            continue;
+        }
+        if (strstr(line, "GLOBAL SYMBOLS:") || strstr(line, "LINKER GENERATED") ||
+            strstr(line, "MODULE SUMMARY"))
+            inMap = false;
+        if (!inMap)
+            continue;
+
+        // An output section starts in the first column: name, page, origin, length
+        if (line[0] == '.') {
+            char name[MAX_NAME];
+            unsigned page, origin, length;
+            section = -1;
+            if (sscanf(line, "%95s %u %x %x", name, &page, &origin, &length) == 4 &&
+                inSram(origin) && length > 0 && report_p->sectionCount < MAX_SECTIONS) {
+                section = report_p->sectionCount++;
+                snprintf(report_p->sections[section].name, MAX_NAME, "%s", name);
+                report_p->sections[section].bytes = length;
+            }
+            continue;
+        }
+
+        if (section >= 0)
+            countInput(report_p, section, line);
+    }
+    fclose(file);
+
+    if (report_p->sectionCount == 0) {
+        fprintf(stderr, "sram_report: no SRAM sections in %s\n", path);
+        return false;
+    }
+    return true;
+}
+
+static int byTotal(const void* a, const void* b)
+{
+    const Module* first = a;
+    const Module* second = b;
+    return (first->total < second->total) - (first->total > second->total);
+}
+
+static int byBytes(const void* a, const void* b)
+{
+    const Variable* first = a;
+    const Variable* second = b;
+    return (first->bytes < second->bytes) - (first->bytes > second->bytes);
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: sram_report [--top N] MAP\n");
+    exit(2);
+}
+
+int main(int argc, char** argv)
+{
+    int top = 20;
+    const char* mapPath = NULL;
+
+    int i;
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--top") == 0 && i + 1 < argc)
+            top = atoi(argv[++i]);
+        else if (!mapPath && argv[i][0] != '-')
+            mapPath = argv[i];
+        else
+            usage();
+    }
+    if (!mapPath)
+        usage();
+
+    static Report report;
+    if (!loadMap(mapPath, &report))
+        return 1;
+
+    uint32_t total = 0;
+    int section;
+    for (section = 0; section < report.sectionCount; section++)
+        total += report.sections[section].bytes;
+
+    printf("SRAM: %u of %u bytes (%.1f%%), %d bytes free\n", (unsigned) total,
+           (unsigned) SRAM_BYTES, 100.0 * total / SRAM_BYTES, (int) (SRAM_BYTES - total));
+    for (section = 0; section < report.sectionCount; section++)
+        printf("  %-12s %8u bytes %6.1f%%\n", report.sections[section].name,
+               (unsigned) report.sections[section].bytes,
+               100.0 * report.sections[section].bytes / SRAM_BYTES);
+
+    qsort(report.modules, report.moduleCount, sizeof(Module), byTotal);
+    printf("\nPer module, in bytes:\n  %-40s", "module");
+    for (section = 0; section < report.sectionCount; section++)
+        printf(" %8s", report.sections[section].name);
+    printf(" %8s\n", "total");
+    for (i = 0; i < report.moduleCount; i++) {
+        const Module* module_p = &report.modules[i];
+        printf("  %-40s", module_p->name);
+        for (section = 0; section < report.sectionCount; section++)
+            printf(" %8u", (unsigned) module_p->bytes[section]);
+        printf(" %8u\n", (unsigned) module_p->total);
+    }
+
+    qsort(report.variables, report.variableCount, sizeof(Variable), byBytes);
+    printf("\nLargest variables:\n");
+    for (i = 0; i < report.variableCount && i < top; i++) {
+        const Variable* variable_p = &report.variables[i];
+        printf("  %8u  %-8s %-32s %s\n", (unsigned) variable_p->bytes, variable_p->section,
+               variable_p->name, variable_p->module);
+    }
+
+    free(report.modules);
+    free(report.variables);
+    return 0;
+}
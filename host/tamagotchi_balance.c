@@ -0,0 +1,667 @@
+/*
+ * tamagotchi_balance.c
+ *
+ * Plays the game rules of tamagotchi_rules.c against a large number of randomized players,
+ * without the board, to see how a set of rules plays out: what share of pets is still around
+ * after a while, and how many grow up to a teen and an adult.
+ *
+ *   tamagotchi_balance [--policies N] [--threads N] [--minutes N] [--seed N]
+ *                      [--set NAME=VALUE]... [--vary NAME=LO:HI[:STEP]]... [--curve FILE]
+ *
+ * NAME is a TamagotchiRules field. --set changes the rules every run starts from and each
+ * --vary sweeps one field, so the runs cover every combination of the swept values, each
+ * played by the same N players. --curve writes the survival curve of every rule set as CSV.
+ *
+ * A player either taps at random (feeding and moving at their own average rates) or watches
+ * the screen (looking every so often and feeding or playing when a value is low), and walks
+ * away after a while. Every player is drawn from its own seed, so the results do not depend
+ * on the number of threads or on which thread ran which player.
+ *
+ * The work is split into ranges of players, dealt out evenly up front. How long a pet lives,
+ * and so how long a player takes to run, varies a lot, so a thread that runs out of work
+ * steals half of the oldest range of another thread.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <math.h>
+#include <pthread.h>
+#include <sched.h>
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include "tamagotchi_rules.h"
+
+#define BALANCE_BUCKET_MS   10000   // Resolution of the survival curve
+#define BALANCE_CHUNK       256     // Players a thread takes from its own ranges at once
+#define BALANCE_MAX_VARY    8
+#define BALANCE_MAX_SETS    65536
+
+// The TamagotchiRules fields that can be set and swept by name
+static const struct
+{
+    const char* name;
+    size_t offset;
+} ruleFields[] =
+{
+    { "decayInterval",   offsetof(TamagotchiRules, decayInterval) },
+    { "startEnergy",     offsetof(TamagotchiRules, startEnergy) },
+    { "startHappiness",  offsetof(TamagotchiRules, startHappiness) },
+    { "maxEnergy",       offsetof(TamagotchiRules, maxEnergy) },
+    { "maxHappiness",    offsetof(TamagotchiRules, maxHappiness) },
+    { "moveEnergyEvery", offsetof(TamagotchiRules, moveEnergyEvery) },
+    { "spotLimit",       offsetof(TamagotchiRules, spotLimit) },
+    { "teenAge",         offsetof(TamagotchiRules, teenAge) },
+    { "teenEnergy",      offsetof(TamagotchiRules, teenEnergy) },
+    { "teenHappiness",   offsetof(TamagotchiRules, teenHappiness) },
+    { "adultAge",        offsetof(TamagotchiRules, adultAge) },
+    { "adultEnergy",     offsetof(TamagotchiRules, adultEnergy) },
+    { "adultHappiness",  offsetof(TamagotchiRules, adultHappiness) },
+};
+#define RULE_FIELD_COUNT ((int) (sizeof(ruleFields) / sizeof(ruleFields[0])))
+
+struct _BalanceVary
+{
+    int field;
+    int low;
+    int high;
+    int step;
+};
+typedef struct _BalanceVary BalanceVary;
+
+// What the players of one rule set did, summed over all of them
+struct _BalanceStats
+{
+    uint64_t* gone;         // Pets that left during each bucket of the survival curve
+    uint64_t* teens;
+    uint64_t* adults;
+    double* teenMs;         // Summed time it took the pets that grew up
+    double* adultMs;
+    double* lifeMs;         // Summed time the pets stayed, up to the end of the run
+};
+typedef struct _BalanceStats BalanceStats;
+
+// Players [first, last) of one rule set
+struct _BalanceRange
+{
+    int set;
+    uint64_t first;
+    uint64_t last;
+};
+typedef struct _BalanceRange BalanceRange;
+
+struct _BalanceWorker
+{
+    pthread_mutex_t lock;       // Guards ranges and rangeCount
+    BalanceRange* ranges;       // The thread takes from the back, thieves from the front
+    int rangeCount;
+    int rangeCapacity;
+    BalanceStats stats;
+    uint64_t steals;
+    pthread_t thread;
+};
+typedef struct _BalanceWorker BalanceWorker;
+
+struct _Balance
+{
+    TamagotchiRules* rules;     // One per set
+    int setCount;
+    uint64_t policies;
+    uint64_t seed;
+    int horizonMs;
+    int bucketCount;
+    BalanceWorker* workers;
+    int workerCount;
+    atomic_uint_fast64_t unclaimed;     // Players not taken by any thread yet
+};
+typedef struct _Balance Balance;
+
+struct _BalanceTask
+{
+    Balance* balance_p;
+    int index;
+};
+typedef struct _BalanceTask BalanceTask;
+
+//*****************************************************************************
+// Players
+//*****************************************************************************
+static uint64_t splitmix64(uint64_t* state_p)
+{
+    uint64_t z = (*state_p += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+// Uniform in (0, 1]
+static double randomUnit(uint64_t* state_p)
+{
+    return ((splitmix64(state_p) >> 11) + 1) * (1.0 / 9007199254740992.0);
+}
+
+static double randomBetween(uint64_t* state_p, double low, double high)
+{
+    return low + (high - low) * randomUnit(state_p);
+}
+
+// The wait until the next of a series of events happening at random at an average rate
+static double randomWait(uint64_t* state_p, double perSecond)
+{
+    if (perSecond <= 0)
+        return INFINITY;
+    return -log(randomUnit(state_p)) * 1000 / perSecond;
+}
+
+enum _PlayerKind
+{
+    RANDOM_PLAYER, WATCHING_PLAYER
+};
+typedef enum _PlayerKind PlayerKind;
+
+struct _Player
+{
+    PlayerKind kind;
+    double feedsPerSecond;      // RANDOM_PLAYER
+    double movesPerSecond;
+    double lookMs;              // WATCHING_PLAYER: time between two looks at the screen
+    int feedBelow;              // Feeds while energy is at most this
+    int playBelow;              // Moves while happiness is at most this
+    double quitMs;              // When the player walks away
+    int direction;
+};
+typedef struct _Player Player;
+
+static Player Player_construct(uint64_t* state_p, const TamagotchiRules* rules_p, int horizonMs)
+{
+    Player player;
+
+    player.kind = (splitmix64(state_p) & 1) ? WATCHING_PLAYER : RANDOM_PLAYER;
+    player.feedsPerSecond = randomBetween(state_p, 0, 1);
+    player.movesPerSecond = randomBetween(state_p, 0, 1.5);
+    player.lookMs = randomBetween(state_p, 300, 2.0 * rules_p->decayInterval);
+    player.feedBelow = (int) (splitmix64(state_p) % rules_p->maxEnergy);
+    player.playBelow = (int) (splitmix64(state_p) % rules_p->maxHappiness);
+    player.quitMs = -log(randomUnit(state_p)) * randomBetween(state_p, 30000, 2.0 * horizonMs);
+    player.direction = 1;
+
+    return player;
+}
+
+// Moves the pet, turning around at either end of the screen
+static void Player_move(Player* player_p, TamagotchiPet* pet_p, const TamagotchiRules* rules_p)
+{
+    if (pet_p->spot + player_p->direction > rules_p->spotLimit ||
+        pet_p->spot + player_p->direction < -rules_p->spotLimit)
+        player_p->direction = -player_p->direction;
+    TamagotchiPet_move(pet_p, rules_p, player_p->direction);
+}
+
+/**
+ * Plays one pet to the end of the run or until it leaves, in the order the firmware's main
+ * loop applies things: the pet grows and can leave right after anything changes it.
+ */
+static void Balance_play(const Balance* balance_p, int set, uint64_t index, BalanceStats* stats_p)
+{
+    const TamagotchiRules* rules_p = &balance_p->rules[set];
+    uint64_t state = balance_p->seed ^ index * 0xD1B54A32D192ED03ull;
+    splitmix64(&state);
+
+    Player player = Player_construct(&state, rules_p, balance_p->horizonMs);
+    TamagotchiPet pet = TamagotchiPet_construct(rules_p);
+
+    double horizon = balance_p->horizonMs;
+    double nextDecay = rules_p->decayInterval;
+    double nextFeed = INFINITY, nextMove = INFINITY, nextLook = INFINITY;
+    if (player.kind == RANDOM_PLAYER) {
+        nextFeed = randomWait(&state, player.feedsPerSecond);
+        nextMove = randomWait(&state, player.movesPerSecond);
+    }
+    else
+        nextLook = randomBetween(&state, 0, player.lookMs);
+
+    double now = 0;
+    while (true) {
+        double nextAction = fmin(fmin(nextFeed, nextMove), nextLook);
+        if (nextAction > player.quitMs)
+            nextAction = INFINITY;
+
+        now = fmin(nextAction, nextDecay);
+        if (now > horizon)
+            break;
+
+        if (now == nextDecay) {
+            TamagotchiPet_decay(&pet, rules_p);
+            nextDecay += rules_p->decayInterval;
+        }
+        else if (now == nextFeed) {
+            TamagotchiPet_feed(&pet, rules_p);
+            nextFeed += randomWait(&state, player.feedsPerSecond);
+        }
+        else if (now == nextMove) {
+            Player_move(&player, &pet, rules_p);
+            nextMove += randomWait(&state, player.movesPerSecond);
+        }
+        else {
+            if (pet.energy <= player.feedBelow)
+                TamagotchiPet_feed(&pet, rules_p);
+            if (pet.happiness <= player.playBelow)
+                Player_move(&player, &pet, rules_p);
+            nextLook += player.lookMs;
+        }
+
+        if (TamagotchiPet_grow(&pet, rules_p)) {
+            if (pet.stage == TEEN) {
+                stats_p->teens[set]++;
+                stats_p->teenMs[set] += now;
+            }
+            else {
+                stats_p->adults[set]++;
+                stats_p->adultMs[set] += now;
+            }
+        }
+        if (TamagotchiPet_isGone(&pet)) {
+            stats_p->gone[(size_t) set * balance_p->bucketCount +
+                          (int) (now / BALANCE_BUCKET_MS)]++;
+            stats_p->lifeMs[set] += now;
+            return;
+        }
+    }
+    stats_p->lifeMs[set] += horizon;
+}
+
+//*****************************************************************************
+// Work stealing
+//*****************************************************************************
+static void Balance_push(BalanceWorker* worker_p, BalanceRange range)
+{
+    if (worker_p->rangeCount == worker_p->rangeCapacity) {
+        worker_p->rangeCapacity = worker_p->rangeCapacity ? 2 * worker_p->rangeCapacity : 16;
+        worker_p->ranges = realloc(worker_p->ranges,
+                                   worker_p->rangeCapacity * sizeof(BalanceRange));
+        if (!worker_p->ranges) {
+            fprintf(stderr, "tamagotchi_balance: out of memory\n");
+            exit(1);
+        }
+    }
+    worker_p->ranges[worker_p->rangeCount++] = range;
+}
+
+// Takes up to BALANCE_CHUNK players from the back of the thread's own ranges
+static bool Balance_take(Balance* balance_p, BalanceWorker* worker_p, BalanceRange* chunk_p)
+{
+    bool taken = false;
+    pthread_mutex_lock(&worker_p->lock);
+    if (worker_p->rangeCount > 0) {
+        BalanceRange* range_p = &worker_p->ranges[worker_p->rangeCount - 1];
+        *chunk_p = *range_p;
+        if (range_p->last - range_p->first > BALANCE_CHUNK) {
+            chunk_p->last = range_p->first + BALANCE_CHUNK;
+            range_p->first = chunk_p->last;
+        }
+        else
+            worker_p->rangeCount--;
+        atomic_fetch_sub(&balance_p->unclaimed, chunk_p->last - chunk_p->first);
+        taken = true;
+    }
+    pthread_mutex_unlock(&worker_p->lock);
+    return taken;
+}
+
+// Moves the back half of the oldest range of another thread to this thread
+static bool Balance_steal(Balance* balance_p, BalanceWorker* worker_p, uint64_t* state_p)
+{
+    int start = (int) (splitmix64(state_p) % balance_p->workerCount);
+    int i;
+    for (i = 0; i < balance_p->workerCount; i++) {
+        BalanceWorker* victim_p = &balance_p->workers[(start + i) % balance_p->workerCount];
+        if (victim_p == worker_p)
+            continue;
+
+        bool stolen = false;
+        BalanceRange loot;
+        pthread_mutex_lock(&victim_p->lock);
+        if (victim_p->rangeCount > 0) {
+            BalanceRange* range_p = &victim_p->ranges[0];
+            loot = *range_p;
+            if (range_p->last - range_p->first >= 2 * BALANCE_CHUNK) {
+                loot.first = range_p->first + (range_p->last - range_p->first) / 2;
+                range_p->last = loot.first;
+            }
+            else {
+                victim_p->rangeCount--;
+                memmove(&victim_p->ranges[0], &victim_p->ranges[1],
+                        victim_p->rangeCount * sizeof(BalanceRange));
+            }
+            stolen = true;
+        }
+        pthread_mutex_unlock(&victim_p->lock);
+
+        if (stolen) {
+            pthread_mutex_lock(&worker_p->lock);
+            Balance_push(worker_p, loot);
+            pthread_mutex_unlock(&worker_p->lock);
+            worker_p->steals++;
+            return true;
+        }
+    }
+    return false;
+}
+
+static void* worker(void* arg)
+{
+    BalanceTask* task_p = arg;
+    Balance* balance_p = task_p->balance_p;
+    BalanceWorker* worker_p = &balance_p->workers[task_p->index];
+    uint64_t state = (uint64_t) task_p->index;
+
+    while (true) {
+        BalanceRange chunk;
+        if (Balance_take(balance_p, worker_p, &chunk)) {
+            uint64_t index;
+            for (index = chunk.first; index < chunk.last; index++)
+                Balance_play(balance_p, chunk.set, index, &worker_p->stats);
+        }
+        else if (!Balance_steal(balance_p, worker_p, &state)) {
+            // Ranges in flight between two threads are still counted as unclaimed
+            if (atomic_load(&balance_p->unclaimed) == 0)
+                break;
+            sched_yield();
+        }
+    }
+    return NULL;
+}
+
+//*****************************************************************************
+// Setup and report
+//*****************************************************************************
+static bool BalanceStats_construct(BalanceStats* stats_p, int setCount, int bucketCount)
+{
+    stats_p->gone = calloc((size_t) setCount * bucketCount, sizeof(uint64_t));
+    stats_p->teens = calloc(setCount, sizeof(uint64_t));
+    stats_p->adults = calloc(setCount, sizeof(uint64_t));
+    stats_p->teenMs = calloc(setCount, sizeof(double));
+    stats_p->adultMs = calloc(setCount, sizeof(double));
+    stats_p->lifeMs = calloc(setCount, sizeof(double));
+    return stats_p->gone && stats_p->teens && stats_p->adults && stats_p->teenMs &&
+           stats_p->adultMs && stats_p->lifeMs;
+}
+
+static void BalanceStats_add(BalanceStats* sum_p, const BalanceStats* stats_p, int setCount,
+                             int bucketCount)
+{
+    size_t i;
+    for (i = 0; i < (size_t) setCount * bucketCount; i++)
+        sum_p->gone[i] += stats_p->gone[i];
+    for (i = 0; i < (size_t) setCount; i++) {
+        sum_p->teens[i] += stats_p->teens[i];
+        sum_p->adults[i] += stats_p->adults[i];
+        sum_p->teenMs[i] += stats_p->teenMs[i];
+        sum_p->adultMs[i] += stats_p->adultMs[i];
+        sum_p->lifeMs[i] += stats_p->lifeMs[i];
+    }
+}
+
+static int findField(const char* name, size_t length)
+{
+    int field;
+    for (field = 0; field < RULE_FIELD_COUNT; field++)
+        if (strlen(ruleFields[field].name) == length &&
+            strncmp(ruleFields[field].name, name, length) == 0)
+            return field;
+    return -1;
+}
+
+static int* ruleField(TamagotchiRules* rules_p, int field)
+{
+    return (int*) ((char*) rules_p + ruleFields[field].offset);
+}
+
+// Parses NAME=VALUE, or NAME=LO:HI[:STEP] when vary_p is given
+static bool parseField(const char* text, int* field_p, int* value_p, BalanceVary* vary_p)
+{
+    const char* equals = strchr(text, '=');
+    if (!equals || (*field_p = findField(text, equals - text)) < 0)
+        return false;
+
+    if (!vary_p) {
+        char* end;
+        *value_p = (int) strtol(equals + 1, &end, 10);
+        return end != equals + 1 && *end == '\0';
+    }
+
+    vary_p->field = *field_p;
+    vary_p->step = 1;
+    int parsed = sscanf(equals + 1, "%d:%d:%d", &vary_p->low, &vary_p->high, &vary_p->step);
+    return parsed >= 2 && vary_p->step > 0 && vary_p->low <= vary_p->high;
+}
+
+// A set of rules the game cannot be played with
+static bool rulesInvalid(const TamagotchiRules* rules_p)
+{
+    return rules_p->decayInterval <= 0 || rules_p->maxEnergy <= 0 ||
+           rules_p->maxHappiness <= 0 || rules_p->moveEnergyEvery <= 0 ||
+           rules_p->spotLimit <= 0 || rules_p->startEnergy > rules_p->maxEnergy ||
+           rules_p->startHappiness > rules_p->maxHappiness;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: tamagotchi_balance [--policies N] [--threads N] [--minutes N] "
+                    "[--seed N] [--set NAME=VALUE]... [--vary NAME=LO:HI[:STEP]]... "
+                    "[--curve FILE]\n  NAME is one of");
+    int field;
+    for (field = 0; field < RULE_FIELD_COUNT; field++)
+        fprintf(stderr, " %s", ruleFields[field].name);
+    fprintf(stderr, "\n");
+    exit(2);
+}
+
+int main(int argc, char** argv)
+{
+    TamagotchiRules base = Tamagotchi_defaultRules;
+    BalanceVary vary[BALANCE_MAX_VARY];
+    int varyCount = 0;
+    uint64_t policies = 1000000;
+    int threadCount = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    double minutes = 5;
+    uint64_t seed = 1;
+    const char* curvePath = NULL;
+
+    int i;
+    for (i = 1; i < argc; i++) {
+        int field, value;
+        if (strcmp(argv[i], "--policies") == 0 && i + 1 < argc)
+            policies = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threadCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--minutes") == 0 && i + 1 < argc)
+            minutes = atof(argv[++i]);
+        else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc)
+            seed = strtoull(argv[++i], NULL, 10);
+        else if (strcmp(argv[i], "--curve") == 0 && i + 1 < argc)
+            curvePath = argv[++i];
+        else if (strcmp(argv[i], "--set") == 0 && i + 1 < argc) {
+            if (!parseField(argv[++i], &field, &value, NULL)) {
+                fprintf(stderr, "tamagotchi_balance: bad setting '%s'\n", argv[i]);
+                usage();
+            }
+            *ruleField(&base, field) = value;
+        }
+        else if (strcmp(argv[i], "--vary") == 0 && i + 1 < argc) {
+            if (varyCount == BALANCE_MAX_VARY ||
+                !parseField(argv[++i], &field, &value, &vary[varyCount])) {
+                fprintf(stderr, "tamagotchi_balance: bad sweep '%s'\n", argv[i]);
+                usage();
+            }
+            varyCount++;
+        }
+        else
+            usage();
+    }
+    if (policies < 1 || threadCount < 1 || minutes <= 0)
+        usage();
+
+    // Every combination of the swept values, the first field varying slowest
+    Balance balance;
+    balance.setCount = 1;
+    for (i = 0; i < varyCount; i++) {
+        balance.setCount *= (vary[i].high - vary[i].low) / vary[i].step + 1;
+        if (balance.setCount > BALANCE_MAX_SETS) {
+            fprintf(stderr, "tamagotchi_balance: more than %d rule sets\n", BALANCE_MAX_SETS);
+            return 1;
+        }
+    }
+    balance.rules = malloc(balance.setCount * sizeof(TamagotchiRules));
+    if (!balance.rules) {
+        fprintf(stderr, "tamagotchi_balance: out of memory\n");
+        return 1;
+    }
+    int set;
+    for (set = 0; set < balance.setCount; set++) {
+        balance.rules[set] = base;
+        int rest = set;
+        for (i = varyCount - 1; i >= 0; i--) {
+            int values = (vary[i].high - vary[i].low) / vary[i].step + 1;
+            *ruleField(&balance.rules[set], vary[i].field) =
+                vary[i].low + (rest % values) * vary[i].step;
+            rest /= values;
+        }
+        if (rulesInvalid(&balance.rules[set])) {
+            fprintf(stderr, "tamagotchi_balance: rule set %d cannot be played\n", set);
+            return 1;
+        }
+    }
+
+    balance.policies = policies;
+    balance.seed = seed;
+    balance.horizonMs = (int) (minutes * 60000);
+    balance.bucketCount = balance.horizonMs / BALANCE_BUCKET_MS + 1;
+    balance.workerCount = threadCount;
+    balance.workers = calloc(threadCount, sizeof(BalanceWorker));
+    BalanceTask* tasks = calloc(threadCount, sizeof(BalanceTask));
+    if (!balance.workers || !tasks) {
+        fprintf(stderr, "tamagotchi_balance: out of memory\n");
+        return 1;
+    }
+
+    // Deal the players out evenly, in order; a thread's share may span several rule sets
+    uint64_t total = policies * balance.setCount;
+    atomic_init(&balance.unclaimed, total);
+    for (i = 0; i < threadCount; i++) {
+        BalanceWorker* worker_p = &balance.workers[i];
+        pthread_mutex_init(&worker_p->lock, NULL);
+        if (!BalanceStats_construct(&worker_p->stats, balance.setCount, balance.bucketCount)) {
+            fprintf(stderr, "tamagotchi_balance: out of memory\n");
+            return 1;
+        }
+
+        uint64_t first = total * i / threadCount, last = total * (i + 1) / threadCount;
+        while (first < last) {
+            BalanceRange range;
+            range.set = (int) (first / policies);
+            range.first = first % policies;
+            range.last = range.first + last - first;
+            if (range.last > policies)
+                range.last = policies;
+            first += range.last - range.first;
+            Balance_push(worker_p, range);
+        }
+        // The thread takes from the back, so its first range goes there
+        int a, b;
+        for (a = 0, b = worker_p->rangeCount - 1; a < b; a++, b--) {
+            BalanceRange swap = worker_p->ranges[a];
+            worker_p->ranges[a] = worker_p->ranges[b];
+            worker_p->ranges[b] = swap;
+        }
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < threadCount; i++) {
+        tasks[i].balance_p = &balance;
+        tasks[i].index = i;
+        if (pthread_create(&balance.workers[i].thread, NULL, worker, &tasks[i]) != 0) {
+            fprintf(stderr, "tamagotchi_balance: cannot start thread %d\n", i);
+            return 1;
+        }
+    }
+    for (i = 0; i < threadCount; i++)
+        pthread_join(balance.workers[i].thread, NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    // Sum the threads' results in a fixed order
+    BalanceStats sum;
+    if (!BalanceStats_construct(&sum, balance.setCount, balance.bucketCount)) {
+        fprintf(stderr, "tamagotchi_balance: out of memory\n");
+        return 1;
+    }
+    uint64_t steals = 0;
+    for (i = 0; i < threadCount; i++) {
+        BalanceStats_add(&sum, &balance.workers[i].stats, balance.setCount, balance.bucketCount);
+        steals += balance.workers[i].steals;
+    }
+
+    double wallMs = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+    printf("%llu players x %d rule sets over %.0f min on %d threads in %.1f ms "
+           "(%.0f players/s, %llu steals)\n", (unsigned long long) policies, balance.setCount,
+           minutes, threadCount, wallMs, total / wallMs * 1e3, (unsigned long long) steals);
+
+    // One row per rule set: survival at each quarter of the run, then growth
+    int quarter;
+    for (i = 0; i < varyCount; i++)
+        printf("%16s", ruleFields[vary[i].field].name);
+    for (quarter = 1; quarter <= 4; quarter++)
+        printf("  alive@%-4.4g", minutes * quarter / 4);
+    printf("  life s  teen %%  teen s adult %% adult s\n");
+
+    for (set = 0; set < balance.setCount; set++) {
+        const uint64_t* gone = &sum.gone[(size_t) set * balance.bucketCount];
+        for (i = 0; i < varyCount; i++)
+            printf("%16d", *ruleField(&balance.rules[set], vary[i].field));
+        for (quarter = 1; quarter <= 4; quarter++) {
+            int buckets = (int) ((int64_t) balance.horizonMs * quarter / 4 / BALANCE_BUCKET_MS);
+            uint64_t left = 0;
+            int bucket;
+            for (bucket = 0; bucket < buckets; bucket++)
+                left += gone[bucket];
+            printf("  %9.2f%%", 100.0 * (policies - left) / policies);
+        }
+        uint64_t teens = sum.teens[set], adults = sum.adults[set];
+        printf("  %6.1f  %6.2f  %6.1f  %6.2f  %6.1f\n", sum.lifeMs[set] / policies / 1e3,
+               100.0 * teens / policies, teens ? sum.teenMs[set] / teens / 1e3 : 0,
+               100.0 * adults / policies, adults ? sum.adultMs[set] / adults / 1e3 : 0);
+    }
+
+    if (curvePath) {
+        FILE* file = fopen(curvePath, "w");
+        if (!file) {
+            fprintf(stderr, "tamagotchi_balance: cannot write %s\n", curvePath);
+            return 1;
+        }
+        fprintf(file, "set");
+        for (i = 0; i < varyCount; i++)
+            fprintf(file, ",%s", ruleFields[vary[i].field].name);
+        fprintf(file, ",seconds,alive\n");
+        for (set = 0; set < balance.setCount; set++) {
+            const uint64_t* gone = &sum.gone[(size_t) set * balance.bucketCount];
+            uint64_t alive = policies;
+            int bucket;
+            for (bucket = 0; bucket < balance.bucketCount; bucket++) {
+                fprintf(file, "%d", set);
+                for (i = 0; i < varyCount; i++)
+                    fprintf(file, ",%d", *ruleField(&balance.rules[set], vary[i].field));
+                fprintf(file, ",%d,%.6f\n", bucket * BALANCE_BUCKET_MS / 1000,
+                        (double) alive / policies);
+                alive -= gone[bucket];
+            }
+        }
+        fclose(file);
+    }
+    return 0;
+}
@@ -0,0 +1,293 @@
+/*
+ * tamagotchi_fleet.c
+ *
+ * Runs many independent copies of the firmware at once, one simulated device per job, spread
+ * over a pool of worker threads. Every device plays the same input script, optionally shifted
+ * in time per device so the fleet covers many timings, and the run reports throughput and how
+ * many distinct final screens and distinct runs the fleet produced. A run is told apart by its
+ * wake counters, its post-mortem log and the telemetry it sent.
+ *
+ * The firmware's DEVICE_LOCAL state is thread-local, and a worker runs its devices one after
+ * the other on its own thread. Each boot clears that state as the board's start-up code clears
+ * .bss: the constructors clear the logs and tables they own and rebind the handlers' pointers.
+ * The post-mortem log is meant to outlive a reset, so the worker clears it at each device's
+ * power-up. A device never sees what the one before it left behind.
+ *
+ *   tamagotchi_fleet [--devices N] [--threads N] [--ms N] [--input MS:NAME]... [--replay FILE]
+ *                    [--jitter MS]
+ *
+ * Without --jitter all devices see identical inputs and must end identically; any divergence
+ * means some firmware state is still shared between devices, and the run fails.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <HAL/PostMortem.h>
+#include <HAL/Uart.h>
+#include <HAL/WakeStats.h>
+#include "sim/Sim.h"
+#include "sim/InputReplay.h"
+
+// The firmware's main(), renamed when tamagotchi_main.c is compiled for the host
+extern int Firmware_main(void);
+
+struct _FleetResult
+{
+    uint64_t cycles;
+    uint64_t wakes;
+    uint64_t screenHash;
+    uint64_t runHash;           // Of the wake counters, the post-mortem log and the telemetry
+};
+typedef struct _FleetResult FleetResult;
+
+struct _Fleet
+{
+    const SimDevice* script_p;      // Holds the inputs every device starts from
+    int deviceCount;
+    uint64_t stopCycle;
+    uint64_t jitterCycles;
+    atomic_int nextDevice;
+    FleetResult* results;
+};
+typedef struct _Fleet Fleet;
+
+#define FLEET_HASH_START    14695981039346656037ull
+
+// FNV-1a, continued over more bytes
+static uint64_t hashBytes(uint64_t hash, const void* data, size_t size)
+{
+    const uint8_t* bytes = data;
+    size_t i;
+    for (i = 0; i < size; i++) {
+        hash ^= bytes[i];
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+// Once the run is over, while the firmware's state is still live: what the device counted
+// and logged
+static void atStop(SimDevice* sim_p)
+{
+    FleetResult* result_p = sim_p->stopContext;
+    const WakeStats* stats_p = WakeStats_counters();
+    uint64_t hash = FLEET_HASH_START;
+
+    hash = hashBytes(hash, (const void*) stats_p->interrupts, sizeof(stats_p->interrupts));
+    hash = hashBytes(hash, (const void*) stats_p->wakes, sizeof(stats_p->wakes));
+    hash = hashBytes(hash, stats_p->uselessWakes, sizeof(stats_p->uselessWakes));
+    hash = hashBytes(hash, &stats_p->passes, sizeof(stats_p->passes));
+    hash = hashBytes(hash, &stats_p->passCycles, sizeof(stats_p->passCycles));
+    hash = hashBytes(hash, &PostMortem_log.boots, sizeof(PostMortem_log.boots));
+    hash = hashBytes(hash, PostMortem_log.entries, sizeof(PostMortem_log.entries));
+    result_p->runHash = hash;
+}
+
+// A fixed per-device offset in [0, jitterCycles), so runs are reproducible
+static uint64_t deviceShift(int device, uint64_t jitterCycles)
+{
+    if (jitterCycles == 0)
+        return 0;
+    uint64_t x = (uint64_t) device * 0x9E3779B97F4A7C15ull;
+    x ^= x >> 31;
+    return x % jitterCycles;
+}
+
+/**
+ * Powers a device up on the calling thread. Its peripherals go to their reset state, and the
+ * post-mortem log, in .noinit, reads as the garbage a power-up leaves, which PostMortem_construct()
+ * starts afresh. On a warm reset (tamagotchi_sim --warm-reset) the log is kept instead.
+ */
+static void powerUp(SimDevice* sim_p)
+{
+    memset(&PostMortem_log, 0, sizeof(PostMortem_log));
+    Sim_init(sim_p);
+}
+
+static void runDevice(Fleet* fleet_p, SimDevice* sim_p, int device)
+{
+    FleetResult* result_p = &fleet_p->results[device];
+
+    powerUp(sim_p);
+    sim_p->stopHook = atStop;
+    sim_p->stopContext = result_p;
+
+    // The telemetry the device sends, kept to tell its run apart. The buffer holds all the
+    // UART can send in the run, and is unbuffered, so that stdio allocates nothing while the
+    // firmware runs: a thread's first malloc() goes deeper and would move its stack mark.
+    size_t uartCapacity = fleet_p->stopCycle / SIM_CYCLES_PER_MS * UART_BAUD_RATE / 10000 + 1;
+    char* uart = malloc(uartCapacity);
+    sim_p->uartOut = uart ? fmemopen(uart, uartCapacity, "w") : NULL;
+    if (!sim_p->uartOut) {
+        fprintf(stderr, "tamagotchi_fleet: out of memory\n");
+        exit(1);
+    }
+    setvbuf(sim_p->uartOut, NULL, _IONBF, 0);
+
+    uint64_t shift = deviceShift(device, fleet_p->jitterCycles);
+    int i;
+    for (i = 0; i < fleet_p->script_p->inputCount; i++) {
+        SimInput input = fleet_p->script_p->inputs[i];
+        input.cycle += shift;
+        Sim_addInput(sim_p, &input);
+    }
+
+    Sim_run(sim_p, Firmware_main, fleet_p->stopCycle);
+
+    size_t uartSize = (size_t) ftell(sim_p->uartOut);
+    fclose(sim_p->uartOut);
+    sim_p->uartOut = NULL;
+    result_p->cycles = sim_p->cycles;
+    result_p->wakes = sim_p->wakes;
+    result_p->screenHash = hashBytes(FLEET_HASH_START, sim_p->panel.framebuffer,
+                                     sizeof(sim_p->panel.framebuffer));
+    result_p->runHash = hashBytes(result_p->runHash, uart, uartSize);
+    free(uart);
+}
+
+static void* worker(void* arg)
+{
+    Fleet* fleet_p = arg;
+    SimDevice* sim_p = malloc(sizeof(SimDevice));
+    if (!sim_p) {
+        fprintf(stderr, "tamagotchi_fleet: out of memory\n");
+        exit(1);
+    }
+
+    int device;
+    while ((device = atomic_fetch_add(&fleet_p->nextDevice, 1)) < fleet_p->deviceCount)
+        runDevice(fleet_p, sim_p, device);
+
+    free(sim_p);
+    return NULL;
+}
+
+static int compareHashes(const void* a, const void* b)
+{
+    uint64_t x = *(const uint64_t*) a, y = *(const uint64_t*) b;
+    return (x > y) - (x < y);
+}
+
+// Sorts the hashes and counts the distinct ones
+static int countDistinct(uint64_t* hashes, int count)
+{
+    qsort(hashes, count, sizeof(uint64_t), compareHashes);
+    int distinct = 1;
+    int i;
+    for (i = 1; i < count; i++)
+        distinct += hashes[i] != hashes[i - 1];
+    return distinct;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: tamagotchi_fleet [--devices N] [--threads N] [--ms N] "
+                    "[--input MS:NAME]... [--replay FILE] [--jitter MS]\n");
+    exit(2);
+}
+
+int main(int argc, char** argv)
+{
+    static SimDevice script;
+    Sim_init(&script);
+
+    int deviceCount = 64;
+    int threadCount = (int) sysconf(_SC_NPROCESSORS_ONLN);
+    double runMs = 10000;
+    double jitterMs = 0;
+
+    int i;
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--devices") == 0 && i + 1 < argc)
+            deviceCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc)
+            threadCount = atoi(argv[++i]);
+        else if (strcmp(argv[i], "--ms") == 0 && i + 1 < argc)
+            runMs = atof(argv[++i]);
+        else if (strcmp(argv[i], "--jitter") == 0 && i + 1 < argc)
+            jitterMs = atof(argv[++i]);
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            if (!InputReplay_load(&script, argv[++i]))
+                return 1;
+        }
+        else if (strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
+            SimInput input;
+            if (!Sim_parseInput(argv[++i], &input)) {
+                fprintf(stderr, "tamagotchi_fleet: bad input '%s'\n", argv[i]);
+                usage();
+            }
+            if (!Sim_addInput(&script, &input)) {
+                fprintf(stderr, "tamagotchi_fleet: too many inputs\n");
+                return 1;
+            }
+        }
+        else
+            usage();
+    }
+    if (deviceCount < 1 || threadCount < 1)
+        usage();
+    if (threadCount > deviceCount)
+        threadCount = deviceCount;
+
+    Fleet fleet;
+    fleet.script_p = &script;
+    fleet.deviceCount = deviceCount;
+    fleet.stopCycle = (uint64_t) (runMs * SIM_CYCLES_PER_MS);
+    fleet.jitterCycles = (uint64_t) (jitterMs * SIM_CYCLES_PER_MS);
+    atomic_init(&fleet.nextDevice, 0);
+    fleet.results = calloc(deviceCount, sizeof(FleetResult));
+    pthread_t* threads = calloc(threadCount, sizeof(pthread_t));
+    if (!fleet.results || !threads) {
+        fprintf(stderr, "tamagotchi_fleet: out of memory\n");
+        return 1;
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    for (i = 0; i < threadCount; i++) {
+        if (pthread_create(&threads[i], NULL, worker, &fleet) != 0) {
+            fprintf(stderr, "tamagotchi_fleet: cannot start thread %d\n", i);
+            return 1;
+        }
+    }
+    for (i = 0; i < threadCount; i++)
+        pthread_join(threads[i], NULL);
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    // Count the distinct final screens and runs
+    uint64_t* screens = malloc(deviceCount * sizeof(uint64_t));
+    uint64_t* runs = malloc(deviceCount * sizeof(uint64_t));
+    if (!screens || !runs) {
+        fprintf(stderr, "tamagotchi_fleet: out of memory\n");
+        return 1;
+    }
+    uint64_t wakes = 0;
+    double simulatedMs = 0;
+    for (i = 0; i < deviceCount; i++) {
+        screens[i] = fleet.results[i].screenHash;
+        runs[i] = fleet.results[i].runHash;
+        wakes += fleet.results[i].wakes;
+        simulatedMs += (double) fleet.results[i].cycles / SIM_CYCLES_PER_MS;
+    }
+    int distinct = countDistinct(screens, deviceCount);
+    int distinctRuns = countDistinct(runs, deviceCount);
+
+    double wallMs = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+    printf("%d devices on %d threads: simulated %.0f s in %.1f ms (%.0fx), %llu wakes, "
+           "%d distinct final screens, %d distinct runs\n", deviceCount, threadCount,
+           simulatedMs / 1e3, wallMs, simulatedMs / wallMs, (unsigned long long) wakes, distinct,
+           distinctRuns);
+
+    if (fleet.jitterCycles == 0 && (distinct != 1 || distinctRuns != 1)) {
+        fprintf(stderr, "tamagotchi_fleet: devices with identical inputs ended differently\n");
+        return 1;
+    }
+    return 0;
+}
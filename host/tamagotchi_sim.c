@@ -0,0 +1,442 @@
+/*
+ * tamagotchi_sim.c
+ *
+ * Runs the unmodified firmware on the simulated board for a fixed amount of time, feeding it
+ * scripted button presses and joystick moves, and saves what ended up on the LCD.
+ *
+ *   tamagotchi_sim [--ms N] [--input MS:NAME]... [--replay FILE] [--record FILE] [--ppm FILE]
+ *                  [--spi-report] [--overdraw FILE] [--lcd-capture FILE] [--energy]
+ *                  [--current NAME=UA]... [--battery MAH] [--budget-ua UA] [--latency]
+ *                  [--wakes] [--scopes] [--stack] [--event-trace FILE] [--uart FILE]
+ *                  [--warm-reset MS] [--post-mortem] [--realtime]
+ *
+ * The simulated clock skips every stretch the CPU spends in LPM0, so a run takes a small
+ * fraction of the time it covers; --realtime slows it down to the board's speed. NAME is one of LB1, LB2, BB1, BB2, JSB (a tap) or LEFT, RIGHT, UP, DOWN, CENTER (a new
+ * joystick position that holds until the next one). --spi-report prints the cost of the LCD
+ * traffic per display driver entry point and per screen. --overdraw reports how many of the
+ * pixel writes left the pixel as it was, overall, per wake, per entry point and per screen, and
+ * saves a heatmap of the writes per pixel. --lcd-capture saves every byte sent to the LCD, marked
+ * with the driver entry point that sent it, for host/lcd_analyze.
+ *
+ * --energy reports the average supply current and the battery life on a --battery of MAH
+ * (2000 by default) per screen and overall, from the current model in sim/Energy.h; --current
+ * replaces one of its figures. --budget-ua makes the run fail when the average current over
+ * the whole run is above UA, which turns a replayed trace into a power regression check.
+ *
+ * --latency prints the firmware's input-to-photon histograms (HAL/Latency.h): from the
+ * BB1 and joystick interrupts to the feed and move answers on the LCD.
+ *
+ * --wakes prints the firmware's wake counters (HAL/WakeStats.h): how often each interrupt
+ * ran, how many sleeps it ended and how many of those wakes changed nothing.
+ *
+ * --scopes prints the firmware's scope timings (HAL/ScopeTiming.h): the calls and the min, mean
+ * and max cycles of each timed hot path. The simulator only charges the cycles it models, the
+ * LCD link's above all, so these are lower bounds of what the board measures.
+ *
+ * --stack prints the deepest the firmware's stack went (HAL/StackUsage.h). The frames are the
+ * host compiler's, and the simulator's own run below the firmware's, so the figure only
+ * compares runs and builds with each other; the board's own is in the performance overlay.
+ *
+ * --event-trace saves the firmware's event trace (HAL/EventTrace.h) at the end of the run,
+ * for host/trace_json.
+ *
+ * --uart sends the bytes the firmware writes to its backchannel UART (HAL/Uart.h) to FILE as
+ * they go out, at the simulated baud rate: a file, or one end of a pty pair, for
+ * host/telemetry_decode.
+ *
+ * --warm-reset resets the board at MS, as if the watchdog had fired: the firmware starts over
+ * from main() with the scripted inputs still to come, and its post-mortem log (HAL/PostMortem.h)
+ * survives as the board's SRAM would. The other statics of the host build survive too, but the
+ * firmware's constructors set up everything it reads. The simulated time and the reports
+ * cover the run after the reset. --post-mortem prints the log at the end of the run.
+ *
+ * --record saves the firmware's input trace (HAL/InputTrace.h) at the end of the run and
+ * --replay schedules the inputs of a saved trace, so a run can be repeated exactly.
+ */
+
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include "sim/Sim.h"
+#include <HAL/Latency.h>
+#include <HAL/WakeStats.h>
+#include <HAL/ScopeTiming.h>
+#include <HAL/EventTrace.h>
+#include <HAL/StackUsage.h>
+#include <HAL/PostMortem.h>
+#include "sim/InputReplay.h"
+
+// The firmware's main(), renamed when tamagotchi_main.c is compiled for the host
+extern int Firmware_main(void);
+
+// What is taken from the firmware when the run stops, while its state is still live
+struct _StopActions
+{
+    const char* tracePath;
+    LatencyHistogram latency[LATENCY_INPUT_COUNT];
+    WakeStats wakeStats;
+    uint32_t stackHighWater;
+    uint32_t stackSize;
+};
+typedef struct _StopActions StopActions;
+
+// Saves the firmware's input trace to the file named by tracePath
+static void saveTrace(const char* path)
+{
+    InputTraceEvent events[INPUT_TRACE_CAPACITY];
+    uint32_t count = 0;
+    while (count < INPUT_TRACE_CAPACITY && InputTrace_read(&events[count]))
+        count++;
+    if (InputTrace_dropped())
+        fprintf(stderr, "tamagotchi_sim: input trace dropped %u events\n",
+                (unsigned) InputTrace_dropped());
+    if (!InputReplay_save(path, events, count))
+        fprintf(stderr, "tamagotchi_sim: cannot write %s\n", path);
+}
+
+static void atStop(SimDevice* sim_p)
+{
+    StopActions* actions_p = sim_p->stopContext;
+
+    // Before the trace is saved, whose buffer would count as the firmware's stack
+    actions_p->stackHighWater = StackUsage_highWater();
+    actions_p->stackSize = StackUsage_size();
+
+    if (actions_p->tracePath)
+        saveTrace(actions_p->tracePath);
+
+    int input;
+    for (input = 0; input < LATENCY_INPUT_COUNT; input++)
+        actions_p->latency[input] = *Latency_histogram(input);
+    actions_p->wakeStats = *WakeStats_counters();
+}
+
+static const char* const sourceNames[WAKE_SOURCE_COUNT] =
+{
+    "T32_INT1", "ADC14", "PORT1", "PORT3", "PORT4", "PORT5", "EUSCIA0", "DMA_INT0",
+    "(other)"
+};
+
+// The GameState values of tamagotchi_app.h
+static const char* const screenNames[] =
+{
+    "TITLE_SCREEN", "INSTRUCTIONS_SCREEN", "GAME_SCREEN", "GAME_OVER"
+};
+
+#define SCREEN_COUNT ((int) (sizeof(screenNames) / sizeof(screenNames[0])))
+
+static void printWakes(FILE* out, const WakeStats* stats_p, double simulatedMs)
+{
+    uint32_t wakes = 0, useless = 0;
+    int source;
+    for (source = 0; source < WAKE_SOURCE_COUNT; source++) {
+        wakes += stats_p->wakes[source];
+        useless += stats_p->uselessWakes[source];
+    }
+
+    fprintf(out, "Wakes: %u in %u passes of main_loop, %.1f per second, %u useless passes (%.1f%%)\n",
+            (unsigned) wakes, (unsigned) stats_p->passes, wakes * 1e3 / simulatedMs,
+            (unsigned) useless, stats_p->passes ? 100.0 * useless / stats_p->passes : 0.0);
+    fprintf(out, "CPU awake %.1f%% of the time, %.0f cycles from a wake to the end of its pass\n",
+            100.0 - 100.0 * stats_p->sleepCycles / (simulatedMs * SIM_CYCLES_PER_MS),
+            stats_p->passes ? (double) stats_p->passCycles / stats_p->passes : 0.0);
+    fprintf(out, "  %-10s %12s %10s %7s %10s %8s\n", "source", "interrupts", "wakes", "share",
+            "useless", "useless");
+    for (source = 0; source < WAKE_SOURCE_COUNT; source++) {
+        uint32_t sourceWakes = stats_p->wakes[source];
+        fprintf(out, "  %-10s %12u %10u %6.1f%% %10u %7.1f%%\n", sourceNames[source],
+                (unsigned) stats_p->interrupts[source], (unsigned) sourceWakes,
+                wakes ? 100.0 * sourceWakes / wakes : 0.0,
+                (unsigned) stats_p->uselessWakes[source],
+                sourceWakes ? 100.0 * stats_p->uselessWakes[source] / sourceWakes : 0.0);
+    }
+}
+
+static void printLatency(FILE* out, const LatencyHistogram* histograms)
+{
+    static const char* const inputNames[LATENCY_INPUT_COUNT] =
+    {
+        "BB1 > energy", "joystick > pet"
+    };
+
+    int input;
+    for (input = 0; input < LATENCY_INPUT_COUNT; input++) {
+        const LatencyHistogram* histogram_p = &histograms[input];
+        fprintf(out, "Input-to-photon latency, %s: %u samples", inputNames[input],
+                (unsigned) histogram_p->count);
+        if (histogram_p->count == 0) {
+            fprintf(out, "\n");
+            continue;
+        }
+        fprintf(out, ", min %.3f ms, mean %.3f ms, max %.3f ms\n",
+                (double) histogram_p->minCycles / SIM_CYCLES_PER_MS,
+                (double) histogram_p->totalCycles / histogram_p->count / SIM_CYCLES_PER_MS,
+                (double) histogram_p->maxCycles / SIM_CYCLES_PER_MS);
+
+        uint32_t most = 0;
+        int bucket;
+        for (bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+            if (histogram_p->buckets[bucket] > most)
+                most = histogram_p->buckets[bucket];
+        }
+        for (bucket = 0; bucket < LATENCY_BUCKETS; bucket++) {
+            uint32_t samples = histogram_p->buckets[bucket];
+            if (samples == 0)
+                continue;
+            char bar[41];
+            int length = (int) ((uint64_t) samples * 40 / most);
+            memset(bar, '#', length);
+            bar[length] = '\0';
+            fprintf(out, "  %9.3f ms - %9.3f ms %6u %s\n", (1u << bucket) / 1e3,
+                    (2u << bucket) / 1e3, (unsigned) samples, bar);
+        }
+    }
+}
+
+static void printScopes(FILE* out)
+{
+    fprintf(out, "Scope timing, in cycles at %u MHz:\n", (unsigned) (SIM_CPU_HZ / 1000000));
+    fprintf(out, "  %-34s %8s %10s %10s %10s %10s\n", "scope", "calls", "min", "mean", "max",
+            "mean us");
+
+    int scope;
+    for (scope = 0; scope < SCOPE_COUNT; scope++) {
+        const ScopeStats* stats_p = &ScopeTiming_stats[scope];
+        if (stats_p->calls == 0) {
+            fprintf(out, "  %-34s %8u\n", ScopeTiming_names[scope], 0u);
+            continue;
+        }
+        double mean = (double) stats_p->totalCycles / stats_p->calls;
+        fprintf(out, "  %-34s %8u %10u %10.0f %10u %10.1f\n", ScopeTiming_names[scope],
+                (unsigned) stats_p->calls, (unsigned) stats_p->minCycles, mean,
+                (unsigned) stats_p->maxCycles, mean * 1e6 / SIM_CPU_HZ);
+    }
+}
+
+// Prints the intact entries of the firmware's post-mortem log, oldest first
+static void printPostMortem(FILE* out)
+{
+    const PostMortemLog* log_p = &PostMortem_log;
+    fprintf(out, "Post-mortem log: boot %u, hard reset sources 0x%04x, soft 0x%04x\n",
+            (unsigned) log_p->boots, (unsigned) log_p->hardResets, (unsigned) log_p->softResets);
+    fprintf(out, "  %4s %6s %-9s %-20s %5s %10s\n", "boot", "pass", "source", "screen", "spot",
+            "cycles");
+
+    int n;
+    for (n = 0; n < POST_MORTEM_LENGTH; n++) {
+        const PostMortemEntry* entry_p = &log_p->entries[(log_p->head + n) % POST_MORTEM_LENGTH];
+        if (!PostMortem_valid(entry_p))
+            continue;
+        fprintf(out, "  %4u %6u %-9s %-20s %5d %10u\n", (unsigned) entry_p->boot,
+                (unsigned) entry_p->pass,
+                entry_p->source < WAKE_SOURCE_COUNT ? sourceNames[entry_p->source] : "?",
+                entry_p->state < SCREEN_COUNT ? screenNames[entry_p->state] : "?",
+                entry_p->spot, (unsigned) entry_p->passCycles);
+    }
+}
+
+/**
+ * Resets the board at the current time: its peripherals return to their reset state, with
+ * the reset controller reporting a watchdog time-out, and the inputs still to come are moved
+ * to the new run's clock. What the harness set up on the device is kept.
+ */
+static void warmReset(SimDevice* sim_p)
+{
+    static SimDevice before;
+    before = *sim_p;
+
+    Sim_init(sim_p);
+    sim_p->realtime = before.realtime;
+    sim_p->stopHook = before.stopHook;
+    sim_p->stopContext = before.stopContext;
+    sim_p->uartOut = before.uartOut;
+    sim_p->energy.model = before.energy.model;
+    sim_p->hardResetSource = RESET_SRC_1;
+
+    int i;
+    for (i = before.nextInput; i < before.inputCount; i++) {
+        SimInput input = before.inputs[i];
+        input.cycle -= before.cycles;
+        Sim_addInput(sim_p, &input);
+    }
+}
+
+// Saves the firmware's event trace ring, header and all
+static bool saveEventTrace(const char* path)
+{
+    FILE* file = fopen(path, "wb");
+    if (!file)
+        return false;
+    bool written = fwrite(&EventTrace_log, sizeof(EventTrace_log), 1, file) == 1;
+    return fclose(file) == 0 && written;
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: tamagotchi_sim [--ms N] [--input MS:NAME]... [--replay FILE] "
+                    "[--record FILE] [--ppm FILE] [--spi-report] [--overdraw FILE] "
+                    "[--lcd-capture FILE] [--energy] [--current NAME=UA]... [--battery MAH] "
+                    "[--budget-ua UA] [--latency] [--wakes] [--scopes] [--stack] "
+                    "[--event-trace FILE] [--uart FILE] [--warm-reset MS] [--post-mortem] "
+                    "[--realtime]\n");
+    exit(2);
+}
+
+int main(int argc, char** argv)
+{
+    static SimDevice sim;
+    Sim_init(&sim);
+
+    static StopActions actions;
+    sim.stopHook = atStop;
+    sim.stopContext = &actions;
+
+    double runMs = 10000;
+    const char* ppmPath = NULL;
+    const char* heatmapPath = NULL;
+    const char* capturePath = NULL;
+    const char* eventTracePath = NULL;
+    bool spiReport = false;
+    bool energyReport = false;
+    bool latencyReport = false;
+    bool wakesReport = false;
+    bool scopesReport = false;
+    bool stackReport = false;
+    bool postMortemReport = false;
+    double warmResetMs = 0;
+    double batteryMah = 2000;
+    double budgetUa = 0;
+
+    int i;
+    for (i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--ms") == 0 && i + 1 < argc)
+            runMs = atof(argv[++i]);
+        else if (strcmp(argv[i], "--ppm") == 0 && i + 1 < argc)
+            ppmPath = argv[++i];
+        else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc)
+            actions.tracePath = argv[++i];
+        else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            if (!InputReplay_load(&sim, argv[++i]))
+                return 1;
+        }
+        else if (strcmp(argv[i], "--overdraw") == 0 && i + 1 < argc)
+            heatmapPath = argv[++i];
+        else if (strcmp(argv[i], "--lcd-capture") == 0 && i + 1 < argc) {
+            capturePath = argv[++i];
+            Spi_startCapture(&sim);
+        }
+        else if (strcmp(argv[i], "--wakes") == 0)
+            wakesReport = true;
+        else if (strcmp(argv[i], "--event-trace") == 0 && i + 1 < argc)
+            eventTracePath = argv[++i];
+        else if (strcmp(argv[i], "--scopes") == 0)
+            scopesReport = true;
+        else if (strcmp(argv[i], "--uart") == 0 && i + 1 < argc) {
+            if (!(sim.uartOut = fopen(argv[++i], "wb"))) {
+                fprintf(stderr, "tamagotchi_sim: cannot write %s\n", argv[i]);
+                return 1;
+            }
+        }
+        else if (strcmp(argv[i], "--warm-reset") == 0 && i + 1 < argc)
+            warmResetMs = atof(argv[++i]);
+        else if (strcmp(argv[i], "--post-mortem") == 0)
+            postMortemReport = true;
+        else if (strcmp(argv[i], "--stack") == 0)
+            stackReport = true;
+        else if (strcmp(argv[i], "--latency") == 0)
+            latencyReport = true;
+        else if (strcmp(argv[i], "--energy") == 0)
+            energyReport = true;
+        else if (strcmp(argv[i], "--battery") == 0 && i + 1 < argc)
+            batteryMah = atof(argv[++i]);
+        else if (strcmp(argv[i], "--budget-ua") == 0 && i + 1 < argc)
+            budgetUa = atof(argv[++i]);
+        else if (strcmp(argv[i], "--current") == 0 && i + 1 < argc) {
+            if (!Energy_setCurrent(&sim.energy.model, argv[++i])) {
+                fprintf(stderr, "tamagotchi_sim: bad current '%s'\n", argv[i]);
+                usage();
+            }
+        }
+        else if (strcmp(argv[i], "--spi-report") == 0)
+            spiReport = true;
+        else if (strcmp(argv[i], "--realtime") == 0)
+            sim.realtime = true;
+        else if (strcmp(argv[i], "--input") == 0 && i + 1 < argc) {
+            SimInput input;
+            if (!Sim_parseInput(argv[++i], &input)) {
+                fprintf(stderr, "tamagotchi_sim: bad input '%s'\n", argv[i]);
+                usage();
+            }
+            if (!Sim_addInput(&sim, &input)) {
+                fprintf(stderr, "tamagotchi_sim: too many inputs\n");
+                return 1;
+            }
+        }
+        else
+            usage();
+    }
+
+    struct timespec start, end;
+    clock_gettime(CLOCK_MONOTONIC, &start);
+    if (warmResetMs > 0 && warmResetMs < runMs) {
+        Sim_run(&sim, Firmware_main, (uint64_t) (warmResetMs * SIM_CYCLES_PER_MS));
+        warmReset(&sim);
+        if (capturePath)
+            Spi_startCapture(&sim);
+        runMs -= warmResetMs;
+    }
+    Sim_run(&sim, Firmware_main, (uint64_t) (runMs * SIM_CYCLES_PER_MS));
+    clock_gettime(CLOCK_MONOTONIC, &end);
+
+    double simulatedMs = (double) sim.cycles / SIM_CYCLES_PER_MS;
+    double wallMs = (end.tv_sec - start.tv_sec) * 1e3 + (end.tv_nsec - start.tv_nsec) / 1e6;
+    printf("simulated %.0f ms in %.1f ms (%.0fx), %llu wakes, %u LCD commands, "
+           "%u data bytes, %u pixels\n", simulatedMs, wallMs, simulatedMs / wallMs,
+           (unsigned long long) sim.wakes, sim.panel.commands, sim.panel.dataBytes,
+           sim.panel.pixels);
+    if (spiReport)
+        Spi_printReport(stdout, &sim);
+    if (heatmapPath)
+        Overdraw_printReport(stdout, &sim);
+    if (energyReport)
+        Energy_printReport(stdout, &sim, batteryMah);
+    if (latencyReport)
+        printLatency(stdout, actions.latency);
+    if (wakesReport)
+        printWakes(stdout, &actions.wakeStats, simulatedMs);
+    if (scopesReport)
+        printScopes(stdout);
+    if (postMortemReport)
+        printPostMortem(stdout);
+    if (stackReport)
+        printf("Stack: %u of %u bytes at the deepest\n", (unsigned) actions.stackHighWater,
+               (unsigned) actions.stackSize);
+
+    if (ppmPath && !Panel_writePPM(&sim.panel, ppmPath)) {
+        fprintf(stderr, "tamagotchi_sim: cannot write %s\n", ppmPath);
+        return 1;
+    }
+    if (capturePath && !Spi_saveCapture(&sim, capturePath)) {
+        fprintf(stderr, "tamagotchi_sim: cannot write %s\n", capturePath);
+        return 1;
+    }
+    if (heatmapPath && !Overdraw_writeHeatmap(&sim.panel, heatmapPath)) {
+        fprintf(stderr, "tamagotchi_sim: cannot write %s\n", heatmapPath);
+        return 1;
+    }
+    if (eventTracePath && !saveEventTrace(eventTracePath)) {
+        fprintf(stderr, "tamagotchi_sim: cannot write %s\n", eventTracePath);
+        return 1;
+    }
+
+    double averageUa = Energy_averageUa(&sim);
+    if (budgetUa > 0 && averageUa > budgetUa) {
+        fprintf(stderr, "tamagotchi_sim: average current %.1f uA is over the %.1f uA budget\n",
+                averageUa, budgetUa);
+        return 1;
+    }
+    return 0;
+}
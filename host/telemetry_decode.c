@@ -0,0 +1,175 @@
+/*
+ * telemetry_decode.c
+ *
+ * Prints the telemetry records (HAL/Telemetry.h) the firmware sends over the backchannel UART,
+ * one line per record, as they arrive:
+ *
+ *   telemetry_decode [FILE]
+ *
+ * FILE is the Launchpad's serial port (/dev/ttyACM0 or the like, set to 115200 8N1 raw with
+ * stty first), a pty or a file written by tamagotchi_sim --uart, or the standard input. The
+ * decoder locks onto the stream at the first record whose checksum is right, so it can be
+ * started at any time; bytes that belong to no valid record are skipped and counted.
+ */
+
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <HAL/Telemetry.h>
+#include <HAL/WakeStats.h>
+
+static const char* const sourceNames[WAKE_SOURCE_COUNT] =
+{
+    "T32_INT1", "ADC14", "PORT1", "PORT3", "PORT4", "PORT5", "EUSCIA0", "DMA_INT0",
+    "(other)"
+};
+
+// The GameState values of tamagotchi_app.h
+static const char* const screenNames[] =
+{
+    "TITLE_SCREEN", "INSTRUCTIONS_SCREEN", "GAME_SCREEN", "GAME_OVER"
+};
+
+#define SCREEN_COUNT ((int) (sizeof(screenNames) / sizeof(screenNames[0])))
+
+// The largest record, and then some, so that a bad length never overruns the window
+#define WINDOW_BYTES (TELEMETRY_MAX_PAYLOAD + 4)
+
+struct _Decoder
+{
+    uint8_t window[WINDOW_BYTES];
+    int count;
+
+    uint64_t records;
+    uint64_t skipped;
+};
+typedef struct _Decoder Decoder;
+
+static void print(const uint8_t* record)
+{
+    uint8_t type = record[1];
+    uint8_t length = record[2];
+    const uint8_t* payload = &record[3];
+
+    if (type == TELEMETRY_BOOT && length == sizeof(TelemetryBoot)) {
+        TelemetryBoot boot;
+        memcpy(&boot, payload, sizeof(boot));
+        printf("           BOOT    %u MHz, telemetry version %u, %u bytes of stack\n",
+               (unsigned) (boot.clockHz / 1000000), (unsigned) boot.version,
+               (unsigned) boot.stackBytes);
+    }
+    else if (type == TELEMETRY_PERF && length == sizeof(TelemetryPerf)) {
+        TelemetryPerf perf;
+        memcpy(&perf, payload, sizeof(perf));
+        printf("%10.3f PERF    CPU %2u.%u%% awake, %4u wakes/s, %7u cycles/wake, stack %5u bytes, "
+               "%u writes dropped\n", perf.ms / 1e3, (unsigned) (perf.awakePermille / 10),
+               (unsigned) (perf.awakePermille % 10), (unsigned) perf.wakesPerSecond,
+               (unsigned) perf.cyclesPerWake, (unsigned) perf.stackHighWater,
+               (unsigned) perf.droppedWrites);
+    }
+    else if (type == TELEMETRY_SCREEN && length == sizeof(TelemetryScreen)) {
+        TelemetryScreen screen;
+        memcpy(&screen, payload, sizeof(screen));
+        printf("%10.3f SCREEN  %s\n", screen.ms / 1e3,
+               screen.state < SCREEN_COUNT ? screenNames[screen.state] : "?");
+    }
+    else if (type == TELEMETRY_RESET && length == sizeof(TelemetryReset)) {
+        TelemetryReset reset;
+        memcpy(&reset, payload, sizeof(reset));
+        printf("           RESET   boot %u, hard reset sources 0x%04x, soft 0x%04x, ",
+               (unsigned) reset.boots, (unsigned) reset.hardResets, (unsigned) reset.softResets);
+        if (reset.entries == 0)
+            printf("no passes kept\n");
+        else
+            printf("%u passes kept: the last was pass %u, woken by %s on %s at spot %d, "
+                   "%u cycles; the longest took %u cycles\n", (unsigned) reset.entries,
+                   (unsigned) reset.lastPass,
+                   reset.lastSource < WAKE_SOURCE_COUNT ? sourceNames[reset.lastSource] : "?",
+                   reset.lastState < SCREEN_COUNT ? screenNames[reset.lastState] : "?",
+                   reset.lastSpot, (unsigned) reset.lastPassCycles,
+                   (unsigned) reset.longestPassCycles);
+    }
+    else
+        printf("           type %u, %u bytes\n", (unsigned) type, (unsigned) length);
+
+    fflush(stdout);
+}
+
+static void drop(Decoder* decoder_p, int bytes, bool skipped)
+{
+    memmove(decoder_p->window, decoder_p->window + bytes, decoder_p->count - bytes);
+    decoder_p->count -= bytes;
+    if (skipped)
+        decoder_p->skipped += bytes;
+}
+
+/**
+ * Takes the records out of the front of the window. A record that does not check out only
+ * costs its SYNC byte, so a real record that starts inside it is still found.
+ */
+static void decode(Decoder* decoder_p)
+{
+    while (decoder_p->count > 0) {
+        const uint8_t* record = decoder_p->window;
+        if (record[0] != TELEMETRY_SYNC) {
+            drop(decoder_p, 1, true);
+            continue;
+        }
+        if (decoder_p->count < 3)
+            return;
+        int length = record[2];
+        if (length > TELEMETRY_MAX_PAYLOAD) {
+            drop(decoder_p, 1, true);
+            continue;
+        }
+        if (decoder_p->count < length + 4)
+            return;
+
+        uint8_t sum = 0;
+        int i;
+        for (i = 1; i < length + 4; i++)
+            sum += record[i];
+        if (sum != 0) {
+            drop(decoder_p, 1, true);
+            continue;
+        }
+
+        print(record);
+        decoder_p->records++;
+        drop(decoder_p, length + 4, false);
+    }
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: telemetry_decode [FILE]\n");
+    exit(2);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc > 2 || (argc == 2 && argv[1][0] == '-' && argv[1][1]))
+        usage();
+
+    FILE* file = stdin;
+    if (argc == 2 && strcmp(argv[1], "-") != 0 && !(file = fopen(argv[1], "rb"))) {
+        fprintf(stderr, "telemetry_decode: cannot read %s\n", argv[1]);
+        return 1;
+    }
+
+    static Decoder decoder;
+    int byte;
+    while ((byte = fgetc(file)) != EOF) {
+        decoder.window[decoder.count++] = (uint8_t) byte;
+        decode(&decoder);
+    }
+    if (file != stdin)
+        fclose(file);
+
+    fprintf(stderr, "%llu records, %llu bytes skipped, %d left at the end\n",
+            (unsigned long long) decoder.records,
+            (unsigned long long) decoder.skipped, decoder.count);
+    return 0;
+}
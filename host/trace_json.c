@@ -0,0 +1,331 @@
+/*
+ * trace_json.c
+ *
+ * Converts the firmware's event trace (HAL/EventTrace.h), saved by tamagotchi_sim --event-trace
+ * or from the EventTrace_log ring of an EVENT_TRACE build on the board, into the Chrome trace
+ * event format, for chrome://tracing or ui.perfetto.dev:
+ *
+ *   trace_json FILE [OUT]
+ *
+ * The timeline has one track per kind of activity: "CPU" alternates awake and LPM0 slices,
+ * "interrupts" marks every handler, "LCD" nests the display driver entry points, and "game"
+ * marks the expired timers and the screen changes, with the screen and the pet's spot as
+ * counters. The JSON goes to OUT, or to the standard output.
+ *
+ * A summary goes to the standard error: the share of the trace spent in LPM0 and the longest
+ * wakes, each with the interrupt that started it and the time it spent in the LCD driver, which
+ * is where the LPM0 residency goes.
+ */
+
+#include <stdarg.h>
+#include <stdbool.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <HAL/EventTrace.h>
+#include <HAL/WakeStats.h>
+#include <LcdDriver/LcdCapture.h>
+
+#define LONGEST_WAKES   5
+
+enum _Track
+{
+    TRACK_CPU = 1,
+    TRACK_INTERRUPTS,
+    TRACK_LCD,
+    TRACK_GAME
+};
+
+static const char* const trackNames[] = { "", "CPU", "interrupts", "LCD", "game" };
+
+static const char* const sourceNames[WAKE_SOURCE_COUNT] =
+{
+    "T32_INT1",
+    "ADC14",
+    "PORT1",
+    "PORT3",
+    "PORT4",
+    "PORT5",
+    "EUSCIA0",
+    "DMA_INT0",
+    "other",
+};
+
+static const char* const entryNames[LCD_ENTRY_COUNT] =
+{
+    "Init",
+    "SetOrientation",
+    "PixelDraw",
+    "PixelDrawMultiple",
+    "LineDrawH",
+    "LineDrawV",
+    "RectFill",
+    "ClearScreen",
+    "Flush",
+    "Compose",
+};
+
+// The GameState values of tamagotchi_app.h
+static const char* const screenNames[] =
+{
+    "TITLE_SCREEN", "INSTRUCTIONS_SCREEN", "GAME_SCREEN", "GAME_OVER"
+};
+
+#define SCREEN_COUNT ((int) (sizeof(screenNames) / sizeof(screenNames[0])))
+
+struct _Wake
+{
+    uint64_t start;
+    uint64_t end;
+    uint64_t lcdCycles;
+    int source;             // The first interrupt of the wake, -1 if none was recorded, or
+                            // WAKE_SOURCE_COUNT for the stretch the trace starts in
+};
+typedef struct _Wake Wake;
+
+struct _Converter
+{
+    FILE* out;
+    double cyclesPerUs;
+    bool firstEvent;
+
+    bool asleep;
+    uint64_t since;         // When the CPU last went to sleep or woke up
+    Wake wake;
+    int lcdDepth;
+    uint64_t lcdStart;
+
+    uint64_t sleepCycles;
+    uint64_t wakes;
+    Wake longest[LONGEST_WAKES];
+};
+typedef struct _Converter Converter;
+
+static void emit(Converter* converter_p, const char* format, ...)
+    __attribute__((format(printf, 2, 3)));
+
+static void emit(Converter* converter_p, const char* format, ...)
+{
+    fprintf(converter_p->out, "%s\n    ", converter_p->firstEvent ? "" : ",");
+    converter_p->firstEvent = false;
+
+    va_list args;
+    va_start(args, format);
+    vfprintf(converter_p->out, format, args);
+    va_end(args);
+}
+
+static double us(const Converter* converter_p, uint64_t cycles)
+{
+    return cycles / converter_p->cyclesPerUs;
+}
+
+static void emitSlice(Converter* converter_p, const char* name, uint64_t start, uint64_t end)
+{
+    emit(converter_p, "{ \"name\": \"%s\", \"ph\": \"X\", \"ts\": %.3f, \"dur\": %.3f, "
+                      "\"pid\": 1, \"tid\": %d }", name, us(converter_p, start),
+         us(converter_p, end - start), TRACK_CPU);
+}
+
+static void emitInstant(Converter* converter_p, const char* name, uint64_t cycles, int track)
+{
+    emit(converter_p, "{ \"name\": \"%s\", \"ph\": \"i\", \"s\": \"t\", \"ts\": %.3f, "
+                      "\"pid\": 1, \"tid\": %d }", name, us(converter_p, cycles), track);
+}
+
+static void emitCounter(Converter* converter_p, const char* name, uint64_t cycles, int value)
+{
+    emit(converter_p, "{ \"name\": \"%s\", \"ph\": \"C\", \"ts\": %.3f, \"pid\": 1, "
+                      "\"args\": { \"%s\": %d } }", name, us(converter_p, cycles), name, value);
+}
+
+// Keeps the wake that just ended if it is one of the longest
+static void endWake(Converter* converter_p, uint64_t cycles)
+{
+    Wake* wake_p = &converter_p->wake;
+    wake_p->end = cycles;
+    converter_p->wakes++;
+
+    int i = LONGEST_WAKES;
+    while (i > 0 && wake_p->end - wake_p->start >
+                    converter_p->longest[i - 1].end - converter_p->longest[i - 1].start) {
+        if (i < LONGEST_WAKES)
+            converter_p->longest[i] = converter_p->longest[i - 1];
+        i--;
+    }
+    if (i < LONGEST_WAKES)
+        converter_p->longest[i] = *wake_p;
+}
+
+static void convert(Converter* converter_p, const EventRecord* record_p, uint64_t cycles)
+{
+    char name[64];
+    int arg = record_p->arg;
+
+    switch (record_p->type) {
+        case EVENT_INTERRUPT:
+            if (converter_p->wake.source < 0)
+                converter_p->wake.source = arg;
+            emitInstant(converter_p, arg >= 0 && arg < WAKE_SOURCE_COUNT ? sourceNames[arg] : "?",
+                        cycles, TRACK_INTERRUPTS);
+            break;
+
+        case EVENT_SLEEP:
+            if (!converter_p->asleep) {
+                emitSlice(converter_p, "awake", converter_p->since, cycles);
+                endWake(converter_p, cycles);
+            }
+            converter_p->asleep = true;
+            converter_p->since = cycles;
+            converter_p->wake.source = -1;
+            break;
+
+        case EVENT_WAKE:
+            if (converter_p->asleep) {
+                emitSlice(converter_p, "LPM0", converter_p->since, cycles);
+                converter_p->sleepCycles += cycles - converter_p->since;
+            }
+            converter_p->asleep = false;
+            converter_p->since = cycles;
+            converter_p->wake.start = cycles;
+            converter_p->wake.lcdCycles = 0;
+            break;
+
+        case EVENT_TIMER_EXPIRED:
+            snprintf(name, sizeof(name), "%d ms timer expired", arg);
+            emitInstant(converter_p, name, cycles, TRACK_GAME);
+            break;
+
+        case EVENT_SCREEN:
+            emitInstant(converter_p, arg >= 0 && arg < SCREEN_COUNT ? screenNames[arg] : "?",
+                        cycles, TRACK_GAME);
+            emitCounter(converter_p, "screen", cycles, arg);
+            break;
+
+        case EVENT_SPOT:
+            emitCounter(converter_p, "spot", cycles, arg);
+            break;
+
+        case EVENT_LCD_BEGIN:
+        case EVENT_LCD_END:
+        {
+            bool begin = record_p->type == EVENT_LCD_BEGIN;
+            if (arg < 0 || arg >= LCD_ENTRY_COUNT)
+                break;
+            // A ring that wrapped may start inside a call; its end has nothing to close
+            if (!begin && converter_p->lcdDepth == 0)
+                break;
+            emit(converter_p, "{ \"name\": \"%s\", \"ph\": \"%s\", \"ts\": %.3f, \"pid\": 1, "
+                              "\"tid\": %d }", entryNames[arg], begin ? "B" : "E",
+                 us(converter_p, cycles), TRACK_LCD);
+
+            // Only the outermost call counts, so ClearScreen's RectFill is not counted twice
+            if (begin && converter_p->lcdDepth++ == 0)
+                converter_p->lcdStart = cycles;
+            else if (!begin && --converter_p->lcdDepth == 0)
+                converter_p->wake.lcdCycles += cycles - converter_p->lcdStart;
+            break;
+        }
+    }
+}
+
+static void usage(void)
+{
+    fprintf(stderr, "usage: trace_json FILE [OUT]\n");
+    exit(2);
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argc > 3)
+        usage();
+
+    FILE* file = fopen(argv[1], "rb");
+    if (!file) {
+        fprintf(stderr, "trace_json: cannot read %s\n", argv[1]);
+        return 1;
+    }
+    EventTraceHeader header;
+    if (fread(&header, sizeof(header), 1, file) != 1 || header.magic != EVENT_TRACE_MAGIC ||
+        header.clockHz == 0) {
+        fprintf(stderr, "trace_json: %s is not an event trace\n", argv[1]);
+        return 1;
+    }
+    EventRecord* records = malloc((size_t) header.capacity * sizeof(EventRecord) + 1);
+    if (!records || fread(records, sizeof(EventRecord), header.capacity, file) != header.capacity) {
+        fprintf(stderr, "trace_json: %s is truncated\n", argv[1]);
+        return 1;
+    }
+    fclose(file);
+
+    // A wrapped ring starts at its oldest record
+    uint32_t count = header.count, first = 0;
+    if (header.count > header.capacity) {
+        count = header.capacity;
+        first = header.count % header.capacity;
+    }
+    if (count == 0) {
+        fprintf(stderr, "trace_json: %s holds no events\n", argv[1]);
+        return 1;
+    }
+
+    static Converter converter;
+    converter.out = stdout;
+    if (argc == 3 && !(converter.out = fopen(argv[2], "w"))) {
+        fprintf(stderr, "trace_json: cannot write %s\n", argv[2]);
+        return 1;
+    }
+    converter.cyclesPerUs = header.clockHz / 1e6;
+    converter.firstEvent = true;
+    converter.wake.source = WAKE_SOURCE_COUNT;
+
+    fprintf(converter.out, "{\n  \"displayTimeUnit\": \"ms\",\n  \"traceEvents\": [");
+    emit(&converter, "{ \"name\": \"process_name\", \"ph\": \"M\", \"pid\": 1, "
+                     "\"args\": { \"name\": \"MSP432\" } }");
+    int track;
+    for (track = TRACK_CPU; track <= TRACK_GAME; track++)
+        emit(&converter, "{ \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 1, \"tid\": %d, "
+                         "\"args\": { \"name\": \"%s\" } }", track, trackNames[track]);
+
+    // The stamps are 32 bits; the firmware records far more often than they wrap
+    uint64_t cycles = 0, base = 0, traceStart = 0;
+    uint32_t last = 0, n;
+    for (n = 0; n < count; n++) {
+        const EventRecord* record_p = &records[(first + n) % header.capacity];
+        if (n > 0 && record_p->cycles < last)
+            base += (uint64_t) 1 << 32;
+        last = record_p->cycles;
+        cycles = base + record_p->cycles;
+
+        if (n == 0) {
+            traceStart = cycles;
+            converter.since = cycles;
+            converter.wake.start = cycles;
+        }
+        convert(&converter, record_p, cycles);
+    }
+
+    fprintf(converter.out, "\n  ]\n}\n");
+    if (converter.out != stdout)
+        fclose(converter.out);
+
+    uint64_t span = cycles - traceStart;
+    fprintf(stderr, "%u events over %.1f ms, %llu wakes, %.1f%% in LPM0\n", (unsigned) count,
+            span / converter.cyclesPerUs / 1e3, (unsigned long long) converter.wakes,
+            span ? 100.0 * converter.sleepCycles / span : 0.0);
+    fprintf(stderr, "longest wakes:\n");
+    int i;
+    for (i = 0; i < LONGEST_WAKES && converter.longest[i].end; i++) {
+        const Wake* wake_p = &converter.longest[i];
+        fprintf(stderr, "  at %10.3f ms  %9.3f ms awake  %9.3f ms in the LCD driver  woken by %s\n",
+                us(&converter, wake_p->start - traceStart) / 1e3,
+                us(&converter, wake_p->end - wake_p->start) / 1e3,
+                us(&converter, wake_p->lcdCycles) / 1e3,
+                wake_p->source == WAKE_SOURCE_COUNT ? "(start of trace)" :
+                wake_p->source >= 0 ? sourceNames[wake_p->source] : "?");
+    }
+
+    free(records);
+    return 0;
+}
@@ -126,6 +126,9 @@ SECTIONS
     .sysmem :   > SRAM_DATA
     .stack  :   > SRAM_DATA (HIGH)
 
+    /* Left alone by the C start-up code, so that it survives warm resets (HAL/PostMortem.h) */
+    .noinit :   > SRAM_DATA, type = NOINIT
+
 #ifdef  __TI_COMPILER_VERSION__
 #if     __TI_COMPILER_VERSION__ >= 15009000
     .TI.ramfunc : {} load=MAIN, run=SRAM_CODE, table(BINIT)
@@ -11,9 +11,11 @@
 #include <HAL/HAL.h>
 #include <HAL/Graphics.h>
 #include <HAL/Timer.h>
+#include <HAL/PerfOverlay.h>
+#include <HAL/Compositor.h>
+#include <tamagotchi_rules.h>
 
 #define TITLE_SCREEN_WAIT   3000  // 3 seconds
-#define DECREASE_INT        3000  // 3 seconds
 
 enum _GameState
 {
@@ -21,12 +23,6 @@ enum _GameState
 };
 typedef enum _GameState GameState;
 
-enum _GameSpot
-{
-    CHILD, TEEN, ADULT
-};
-typedef enum _GameSpot GameSpot;
-
 /**
  * The top-level application object, initialized in main() and
  * passed around to most functions. It holds the state variables
@@ -34,27 +30,25 @@ typedef enum _GameSpot GameSpot;
  */
 struct _TamagotchiApp
 {
-    GameSpot gamespot;
+    const TamagotchiRules* rules_p;  // The balance of the game
+    TamagotchiPet pet;
     GameState state;  // Determines which screen is currently shown
     SWTimer timer;    // General-purpose timer for screen transitions
     SWTimer Dtimer;
-    int age;          // Age display
     int ageSpot;
-    int energy;
-    int happiness;
-    int spot;
     int begin;        // Starting position
-    int end;
     int spotloc;
     bool needRemoved;
-    int waitToPass;
-    int movements;    // Total movements
+    PerfOverlay overlay;  // Shown and hidden by LB2
+    Compositor scene;     // What the game screen shows
 };
 typedef struct _TamagotchiApp TamagotchiApp;
 
 // Constructor for the application
 TamagotchiApp Tamagotchi_construct(HAL* hal_p);
-void main_loop(TamagotchiApp* app_p, Graphics_Context *g_sContext_p, Joystick *joystick_p, HAL* hal_p);
+// One pass of the game. Returns whether it changed anything, so that a pass that did not can be
+// counted as a useless wake.
+bool main_loop(TamagotchiApp* app_p, Graphics_Context *g_sContext_p, Joystick *joystick_p, HAL* hal_p);
 
 // Callback functions for each state of the game
 void Tamagotchi_handleTitleScreen(TamagotchiApp* app_p, HAL* hal_p);
@@ -62,6 +56,7 @@ void Tamagotchi_showTitleScreen(GFX* gfx_p);
 void Tamagotchi_showInstructionsScreen(TamagotchiApp* app_p, GFX* gfx_p);
 void Tamagotchi_handleGameScreen(TamagotchiApp* app_p, GFX* gfx_p, HAL* hal_p);
 void Tamagotchi_showGameScreen(TamagotchiApp* app_p, GFX* gfx_p);
+void Tamagotchi_showStats(TamagotchiApp* app_p, GFX* gfx_p, int changed);
 void Tamagotchi_GameMovement(TamagotchiApp* app_p, GFX* gfx_p);
 void Tamagotchi_GAMEFSM(TamagotchiApp* app_p, GFX* gfx_p, Joystick *joystick_p);
 void Tamagotchi_showEndScreen(TamagotchiApp* app_p, GFX* gfx_p);
@@ -71,5 +66,6 @@ void Tamagotchi_movingRight(TamagotchiApp* app_p, GFX* gfx_p, Joystick *joystick
 void Tamagotchi_childState(TamagotchiApp* app_p, GFX* gfx_p);
 void Tamagotchi_teenState(TamagotchiApp* app_p, GFX* gfx_p);
 void Tamagotchi_adultState(TamagotchiApp* app_p, GFX* gfx_p);
+void Tamagotchi_drawPet(TamagotchiApp* app_p, GFX* gfx_p, uint32_t color, int radius);
 
 #endif /* TAMAGOTCHI_APP_H_ */
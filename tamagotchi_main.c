@@ -5,6 +5,7 @@
 
 /* Standard includes */
 #include <stdio.h>
+#include <string.h>
 
 /* HAL includes */
 #include "HAL/LED.h"
@@ -13,32 +14,47 @@
 #include "HAL/Joystick.h"
 #include <HAL/HAL.h>
 #include <tamagotchi_app.h>
+#include <LcdDriver/HAL_MSP_EXP432P401R_Crystalfontz128x128_ST7735.h>
 
 #define BUFFER_SIZE 100
 
-void initialize();
-void initGraphics(Graphics_Context *g_sContext_p);
-void main_loop(TamagotchiApp* app_p, Graphics_Context *g_sContext_p, Joystick *joystick_p, HAL* hal_p);
+void initialize(HAL* hal_p);
+void initGraphics(Graphics_Context *g_sContext_p, GFX* gfx_p);
+bool main_loop(TamagotchiApp* app_p, Graphics_Context *g_sContext_p, Joystick *joystick_p, HAL* hal_p);
 void sleep();
 
 int main(void)
 {
-    initialize();
+    /* Create the HAL instance; it holds the state of every peripheral of this device */
+    HAL hal;
+    initialize(&hal);
 
-    /* Create a HAL instance and construct the Tamagotchi application */
-    HAL hal = HAL_construct();
+    /* Construct the Tamagotchi application */
     TamagotchiApp app = Tamagotchi_construct(&hal);
     Graphics_Context g_sContext;
-    initGraphics(&g_sContext);
+    initGraphics(&g_sContext, &hal.gfx);
     initLEDs();
-    Joystick joystick = Joystick_construct();
 
     Tamagotchi_showTitleScreen(&hal.gfx);
+    GFX_flush(&hal.gfx);
 
     while (1) {
         sleep();
-        Joystick_refresh(&joystick);
-        main_loop(&app, &g_sContext, &joystick, &hal);
+        Joystick_refresh(&hal.joystick);
+
+        GameState state = app.state;
+        int spot = app.pet.spot;
+        SCOPE_TIMING_BEGIN(SCOPE_MAIN_LOOP);
+        bool changed = main_loop(&app, &g_sContext, &hal.joystick, &hal);
+        SCOPE_TIMING_END(SCOPE_MAIN_LOOP);
+        WakeStats_endPass(changed);
+        PostMortem_record(app.state, app.pet.spot);
+        if (app.state != state) {
+            EventTrace_record(EVENT_SCREEN, app.state);
+            Telemetry_sendScreen(app.state);
+        }
+        if (app.pet.spot != spot)
+            EventTrace_record(EVENT_SPOT, app.pet.spot);
     }
 }
 
@@ -49,44 +65,63 @@ TamagotchiApp Tamagotchi_construct(HAL* hal_p)
 {
     TamagotchiApp app;
 
+    app.rules_p = &Tamagotchi_defaultRules;
+    app.pet = TamagotchiPet_construct(app.rules_p);
+
     app.state = TITLE_SCREEN;
     app.timer = SWTimer_construct(TITLE_SCREEN_WAIT);
     SWTimer_start(&app.timer);
-    app.Dtimer = SWTimer_construct(DECREASE_INT);
+    app.Dtimer = SWTimer_construct(app.rules_p->decayInterval);
 
-    app.age = 0;
     app.ageSpot = 0;
-    app.energy = 5;
-    app.happiness = 3;
-    app.spot = 0;
     app.begin = 0;
-    app.end = 0;
-    app.waitToPass = 0;
-    app.movements = 0;
     app.spotloc = 65;
     app.needRemoved = false;
+    app.overlay = PerfOverlay_construct();
+    app.scene = Compositor_construct();
 
     return app;
 }
 
 void sleep() {
+    /* Start sending what the pass drew; the DMA goes on with it in LPM0 */
+    HAL_LCD_flush();
+
     /* Indicate low-power mode with the Launchpad Green LED */
     TurnOn_LLG();
-    PCM_gotoLPM0();
+    WakeStats_sleep();
+    EventTrace_record(EVENT_SLEEP, 0);
+    Profiler_pause();
+    /* The LCD's DMA and UART interrupts carry on sending by themselves; they need no pass */
+    do {
+        PCM_gotoLPM0();
+    } while (WakeStats_sleepAgain());
+    Profiler_resume();
+    EventTrace_record(EVENT_WAKE, 0);
+    WakeStats_wake();
     TurnOff_LLG();
 }
 
-void main_loop(TamagotchiApp* app_p, Graphics_Context *g_sContext_p, Joystick *joystick_p, HAL* hal_p) {
-    buttons_t buttons = updateButtons();
+bool main_loop(TamagotchiApp* app_p, Graphics_Context *g_sContext_p, Joystick *joystick_p, HAL* hal_p) {
+    /* The rest of the app only moves along with the screen, the pet or what is drawn */
+    GameState state = app_p->state;
+    TamagotchiPet pet = app_p->pet;
+    uint32_t lcdCommands = HAL_LCD_commandCount();
+
+    buttons_t buttons = updateButtons(&hal_p->buttons);
 
     /* Non-blocking code: Tapping the joystick push button toggles the BoosterPack Green LED */
     if (buttons.JSBtapped)
         Toggle_BLG();
 
     /* Additional button functionality: Check other buttons */
-    if (buttons.LB1tapped || buttons.LB2tapped || buttons.BB2tapped)
+    if (buttons.LB1tapped || buttons.BB2tapped)
         Toggle_BLB();
 
+    /* LB2 shows or hides the performance overlay */
+    if (buttons.LB2tapped)
+        PerfOverlay_toggle(&app_p->overlay, &hal_p->gfx);
+
     switch (app_p->state)
     {
         case TITLE_SCREEN:
@@ -96,14 +131,9 @@ void main_loop(TamagotchiApp* app_p, Graphics_Context *g_sContext_p, Joystick *j
         case INSTRUCTIONS_SCREEN:
             if(buttons.BB1tapped){
                 /* Reset state variables for a new game */
-                app_p->age = 0;
-                app_p->energy = 5;
-                app_p->happiness = 3;
-                app_p->spot = 0;
+                app_p->pet = TamagotchiPet_construct(app_p->rules_p);
                 app_p->begin = 0;
-                app_p->end = 0;
                 app_p->ageSpot = 0;
-                app_p->movements = 0;
                 app_p->spotloc = 65;
                 Tamagotchi_showGameScreen(app_p, &hal_p->gfx);
                 SWTimer_start(&app_p->Dtimer);
@@ -116,55 +146,65 @@ void main_loop(TamagotchiApp* app_p, Graphics_Context *g_sContext_p, Joystick *j
             Tamagotchi_handleGameScreen(app_p, &hal_p->gfx, hal_p);
 
             /* Increase energy when the pet is fed (BB1 pressed) */
-            if(buttons.BB1tapped && app_p->energy < 5) {
-                app_p->energy++;
-                char buffer[BUFFER_SIZE];
-                snprintf(buffer, BUFFER_SIZE, "%d", app_p->energy);
-                GFX_print(&hal_p->gfx, buffer, 3, 11);
+            if(buttons.BB1tapped){
+                int changed = TamagotchiPet_feed(&app_p->pet, app_p->rules_p);
+                Tamagotchi_showStats(app_p, &hal_p->gfx, changed);
+                if(changed){
+                    GFX_flush(&hal_p->gfx);
+                    Latency_markOutput(LATENCY_BB1);
+                }
             }
-            /* Transition to game over if energy and happiness are depleted */
-            if (app_p->energy == 0 && app_p->happiness == 0){
+
+            /* Transition to game over if energy and happiness are depleted, drawing the end
+             * screen in this pass as the other transitions do */
+            if (TamagotchiPet_isGone(&app_p->pet)){
                 app_p->state = GAME_OVER;
+                Tamagotchi_showEndScreen(app_p, &hal_p->gfx);
             }
             break;
 
         case GAME_OVER:
-            if (app_p->end == 0){
-                Tamagotchi_showEndScreen(app_p, &hal_p->gfx);
-                app_p->end++;
-            }
             /* Return to instructions screen when BB1 is pressed */
-            if(buttons.BB1tapped && app_p->energy < 5){
+            if(buttons.BB1tapped && app_p->pet.energy < app_p->rules_p->maxEnergy){
                 app_p->state = INSTRUCTIONS_SCREEN;
                 Tamagotchi_showInstructionsScreen(app_p, &hal_p->gfx);
             }
             break;
     }
+
+    bool sampled = PerfOverlay_refresh(&app_p->overlay, &hal_p->gfx);
+
+    /* Send what this pass drew; with a frame buffer only the rectangles it changed go out */
+    GFX_flush(&hal_p->gfx);
+
+    return sampled || app_p->state != state || memcmp(&pet, &app_p->pet, sizeof(pet)) != 0 ||
+           HAL_LCD_commandCount() != lcdCommands;
 }
 
-void initialize()
+void initialize(HAL* hal_p)
 {
-    /* Stop watchdog timer and initialize system timing */
+    /* Stop watchdog timer, then initialize system timing and the rest of the HAL */
     WDT_A_hold(WDT_A_BASE);
-    InitSystemTiming();
-
-    initLEDs();
-    initButtons();
+    HAL_construct(hal_p);
 
     /* Additional initializations if necessary */
 }
 
-void initGraphics(Graphics_Context *g_sContext_p) {
-    Crystalfontz128x128_Init();
-    Crystalfontz128x128_SetOrientation(LCD_ORIENTATION_UP);
+void initGraphics(Graphics_Context *g_sContext_p, GFX* gfx_p) {
+    Crystalfontz128x128_Init(&gfx_p->lcd, &gfx_p->display);
+    Crystalfontz128x128_SetOrientation(&gfx_p->lcd, LCD_ORIENTATION_UP);
 
-    Graphics_initContext(g_sContext_p, &g_sCrystalfontz128x128, &g_sCrystalfontz128x128_funcs);
+    Graphics_initContext(g_sContext_p, &gfx_p->display, &g_sCrystalfontz128x128_funcs);
     Graphics_setFont(g_sContext_p, &g_sFontFixed6x8);
 
     Graphics_setForegroundColor(g_sContext_p, GRAPHICS_COLOR_BLACK);
     Graphics_setBackgroundColor(g_sContext_p, GRAPHICS_COLOR_WHITE);
 
     Graphics_clearDisplay(g_sContext_p);
+
+    /* From here on the drawing calls queue their commands in the display list and return;
+       sleep() flushes the list, and the DMA sends it while main_loop sleeps */
+    HAL_LCD_setDeferred(true);
 }
 
 void Tamagotchi_handleTitleScreen(TamagotchiApp* app_p, HAL* hal_p)
@@ -205,55 +245,62 @@ void Tamagotchi_showInstructionsScreen(TamagotchiApp* app_p, GFX* gfx_p)
 }
 
 void Tamagotchi_handleGameScreen(TamagotchiApp* app_p, GFX* gfx_p, HAL* hal_p){
-    char buffer[BUFFER_SIZE];
     if(SWTimer_expired(&app_p->Dtimer)){
-        if(app_p->energy > 0){
-            app_p->energy--;
-            snprintf(buffer, BUFFER_SIZE, "%d", app_p->energy);
-            GFX_print(gfx_p, buffer, 3, 11);
-        }
-        if(app_p->happiness > 0){
-            app_p->happiness--;
-            snprintf(buffer, BUFFER_SIZE, "%d", app_p->happiness);
-            GFX_print(gfx_p, buffer, 5, 13);
-        }
-        app_p->age++;
-        snprintf(buffer, BUFFER_SIZE, "%01d", app_p->age);
-        GFX_print(gfx_p, buffer, 1, 10);
+        Tamagotchi_showStats(app_p, gfx_p, TamagotchiPet_decay(&app_p->pet, app_p->rules_p));
         SWTimer_start(&app_p->Dtimer);
    }
 }
 
+/**
+ * Redraws the values of the game screen that a TamagotchiPet function reported as changed.
+ */
+void Tamagotchi_showStats(TamagotchiApp* app_p, GFX* gfx_p, int changed){
+    char buffer[BUFFER_SIZE];
+    if(changed & PET_ENERGY_CHANGED){
+        snprintf(buffer, BUFFER_SIZE, "%d", app_p->pet.energy);
+        Compositor_print(&app_p->scene, gfx_p, buffer, 3, 11);
+    }
+    if(changed & PET_HAPPINESS_CHANGED){
+        snprintf(buffer, BUFFER_SIZE, "%d", app_p->pet.happiness);
+        Compositor_print(&app_p->scene, gfx_p, buffer, 5, 13);
+    }
+    if(changed & PET_AGE_CHANGED){
+        snprintf(buffer, BUFFER_SIZE, "%01d", app_p->pet.age);
+        Compositor_print(&app_p->scene, gfx_p, buffer, 1, 10);
+    }
+}
+
 void Tamagotchi_showGameScreen(TamagotchiApp* app_p, GFX* gfx_p){
     char buffer[BUFFER_SIZE];
 
-    GFX_clear(gfx_p);
+    Compositor_clear(&app_p->scene, gfx_p);
 
-    GFX_print(gfx_p, "Age: ", 1, 2);
-    snprintf(buffer, BUFFER_SIZE, "%01d", app_p->age);
-    GFX_print(gfx_p, buffer, 1, 10);
+    Compositor_print(&app_p->scene, gfx_p, "Age: ", 1, 2);
+    snprintf(buffer, BUFFER_SIZE, "%01d", app_p->pet.age);
+    Compositor_print(&app_p->scene, gfx_p, buffer, 1, 10);
 
-    GFX_print(gfx_p, "Energy:", 3, 2);
-    snprintf(buffer, BUFFER_SIZE, "%d", app_p->energy);
-    GFX_print(gfx_p, buffer, 3, 11);
+    Compositor_print(&app_p->scene, gfx_p, "Energy:", 3, 2);
+    snprintf(buffer, BUFFER_SIZE, "%d", app_p->pet.energy);
+    Compositor_print(&app_p->scene, gfx_p, buffer, 3, 11);
 
-    GFX_print(gfx_p, "Happiness:", 5, 2);
-    snprintf(buffer, BUFFER_SIZE, "%d", app_p->happiness);
-    GFX_print(gfx_p, buffer, 5, 13);
+    Compositor_print(&app_p->scene, gfx_p, "Happiness:", 5, 2);
+    snprintf(buffer, BUFFER_SIZE, "%d", app_p->pet.happiness);
+    Compositor_print(&app_p->scene, gfx_p, buffer, 5, 13);
 
     static Graphics_Rectangle recOut = {120, 60, 10, 110};
-    Graphics_drawRectangle(&gfx_p->context, &recOut);
+    Compositor_drawRectangle(&app_p->scene, gfx_p, &recOut);
 }
 
 void Tamagotchi_GAMEFSM(TamagotchiApp* app_p, GFX* gfx_p, Joystick *joystick_p){
     if(app_p->begin == 0){
-        app_p->gamespot = CHILD;
+        app_p->pet.stage = CHILD;
         app_p->begin++;
     }
     Tamagotchi_movingLeft(app_p, gfx_p, joystick_p);
     Tamagotchi_movingRight(app_p, gfx_p, joystick_p);
+    bool moved = app_p->needRemoved;
 
-    switch (app_p->gamespot)
+    switch (app_p->pet.stage)
     {
         case CHILD:
             Tamagotchi_childState(app_p, gfx_p);
@@ -265,6 +312,12 @@ void Tamagotchi_GAMEFSM(TamagotchiApp* app_p, GFX* gfx_p, Joystick *joystick_p){
             Tamagotchi_adultState(app_p, gfx_p);
             break;
     }
+
+    /* The pet is now drawn in its new spot */
+    if(moved){
+        GFX_flush(gfx_p);
+        Latency_markOutput(LATENCY_JOYSTICK);
+    }
 }
 
 void Tamagotchi_showEndScreen(TamagotchiApp* app_p, GFX* gfx_p){
@@ -276,89 +329,57 @@ void Tamagotchi_showEndScreen(TamagotchiApp* app_p, GFX* gfx_p){
     GFX_print(gfx_p, "and left...", 6, 5);
 
     GFX_print(gfx_p, "Age: ", 9, 5);
-    snprintf(buffer, BUFFER_SIZE, "%01d", app_p->age);
+    snprintf(buffer, BUFFER_SIZE, "%01d", app_p->pet.age);
     GFX_print(gfx_p, buffer, 9, 10);
 
     GFX_print(gfx_p, "Play Again? (BB1)", 13, 2);
 }
 
 void Tamagotchi_movingRight(TamagotchiApp* app_p, GFX* gfx_p, Joystick *joystick_p){
-    char buffer[BUFFER_SIZE];
-    if(Joystick_isTappedRight(joystick_p) && app_p->spot < 3 && app_p->energy > 0){
-        app_p->spot++;
-        app_p->spotloc += 10;
-        app_p->needRemoved = true;
-        app_p->movements++;
-        if(app_p->happiness < 5){
-            app_p->happiness++;
-            snprintf(buffer, BUFFER_SIZE, "%d", app_p->happiness);
-            GFX_print(gfx_p, buffer, 5, 13);
-        }
-        if(app_p->movements % 2 == 0){
-            app_p->energy--;
-            snprintf(buffer, BUFFER_SIZE, "%d", app_p->energy);
-            GFX_print(gfx_p, buffer, 3, 11);
+    if(Joystick_isTappedRight(joystick_p)){
+        int changed = TamagotchiPet_move(&app_p->pet, app_p->rules_p, 1);
+        if(changed & PET_SPOT_CHANGED){
+            app_p->spotloc += 10;
+            app_p->needRemoved = true;
         }
+        Tamagotchi_showStats(app_p, gfx_p, changed);
     }
 }
 
 void Tamagotchi_movingLeft(TamagotchiApp* app_p, GFX* gfx_p, Joystick *joystick_p){
-    char buffer[BUFFER_SIZE];
-    if(Joystick_isTappedLeft(joystick_p) && app_p->spot > -3 && app_p->energy > 0){
-        app_p->spot--;
-        app_p->spotloc -= 10;
-        app_p->needRemoved = true;
-        app_p->movements++;
-        if(app_p->happiness < 5){
-            app_p->happiness++;
-            snprintf(buffer, BUFFER_SIZE, "%d", app_p->happiness);
-            GFX_print(gfx_p, buffer, 5, 13);
-        }
-        if(app_p->movements % 2 == 0){
-            app_p->energy--;
-            snprintf(buffer, BUFFER_SIZE, "%d", app_p->energy);
-            GFX_print(gfx_p, buffer, 3, 11);
+    if(Joystick_isTappedLeft(joystick_p)){
+        int changed = TamagotchiPet_move(&app_p->pet, app_p->rules_p, -1);
+        if(changed & PET_SPOT_CHANGED){
+            app_p->spotloc -= 10;
+            app_p->needRemoved = true;
         }
+        Tamagotchi_showStats(app_p, gfx_p, changed);
     }
 }
 
 void Tamagotchi_childState(TamagotchiApp* app_p, GFX* gfx_p){
-    if(app_p->needRemoved){
-        GFX_removeSolidCircle(gfx_p, app_p->spotloc + 10, 85, 8);
-        GFX_removeSolidCircle(gfx_p, app_p->spotloc - 10, 85, 8);
-        app_p->needRemoved = false;
-    }
-    Graphics_setForegroundColor(&gfx_p->context, GRAPHICS_COLOR_GREEN);
-    Graphics_fillCircle(&gfx_p->context, app_p->spotloc, 85, 8);
-    Graphics_setForegroundColor(&gfx_p->context, GRAPHICS_COLOR_BLACK);
-    if(app_p->age >= 3 && app_p->energy >= 3 && app_p->happiness >= 4){
-        app_p->waitToPass = app_p->age + 1;
-        app_p->gamespot = TEEN;
-    }
+    Tamagotchi_drawPet(app_p, gfx_p, GRAPHICS_COLOR_GREEN, 8);
+    TamagotchiPet_grow(&app_p->pet, app_p->rules_p);
 }
 
 void Tamagotchi_teenState(TamagotchiApp* app_p, GFX* gfx_p){
-    if(app_p->needRemoved){
-        GFX_removeSolidCircle(gfx_p, app_p->spotloc + 10, 85, 10);
-        GFX_removeSolidCircle(gfx_p, app_p->spotloc - 10, 85, 10);
-        app_p->needRemoved = false;
-    }
-    Graphics_setForegroundColor(&gfx_p->context, GRAPHICS_COLOR_BLUE);
-    Graphics_fillCircle(&gfx_p->context, app_p->spotloc, 85, 10);
-    Graphics_setForegroundColor(&gfx_p->context, GRAPHICS_COLOR_BLACK);
-    if(app_p->age >= 7 && app_p->energy >= 2 && app_p->happiness >= 2 && app_p->age > app_p->waitToPass){
-        app_p->gamespot = ADULT;
-        app_p->waitToPass = 0;
-    }
+    Tamagotchi_drawPet(app_p, gfx_p, GRAPHICS_COLOR_BLUE, 10);
+    TamagotchiPet_grow(&app_p->pet, app_p->rules_p);
 }
 
 void Tamagotchi_adultState(TamagotchiApp* app_p, GFX* gfx_p){
-    if(app_p->needRemoved){
-        GFX_removeSolidCircle(gfx_p, app_p->spotloc + 10, 85, 12);
-        GFX_removeSolidCircle(gfx_p, app_p->spotloc - 10, 85, 12);
-        app_p->needRemoved = false;
-    }
-    Graphics_setForegroundColor(&gfx_p->context, GRAPHICS_COLOR_RED);
-    Graphics_fillCircle(&gfx_p->context, app_p->spotloc, 85, 12);
+    Tamagotchi_drawPet(app_p, gfx_p, GRAPHICS_COLOR_RED, 12);
+}
+
+/**
+ * Shows the pet at spotloc. The game screen's compositor moves it from its old spot in the same
+ * pass, and draws nothing when neither its spot nor its stage changed.
+ */
+void Tamagotchi_drawPet(TamagotchiApp* app_p, GFX* gfx_p, uint32_t color, int radius){
+    app_p->needRemoved = false;
+    Graphics_setForegroundColor(&gfx_p->context, color);
+    SCOPE_TIMING_BEGIN(SCOPE_COMPOSE_CIRCLE);
+    Compositor_fillCircle(&app_p->scene, gfx_p, app_p->spotloc, 85, radius);
+    SCOPE_TIMING_END(SCOPE_COMPOSE_CIRCLE);
     Graphics_setForegroundColor(&gfx_p->context, GRAPHICS_COLOR_BLACK);
 }
@@ -0,0 +1,120 @@
+/*
+ * tamagotchi_rules.c
+ */
+
+#include <tamagotchi_rules.h>
+
+const TamagotchiRules Tamagotchi_defaultRules =
+{
+    .decayInterval   = DECREASE_INT,
+    .startEnergy     = 5,
+    .startHappiness  = 3,
+    .maxEnergy       = 5,
+    .maxHappiness    = 5,
+    .moveEnergyEvery = 2,
+    .spotLimit       = 3,
+    .teenAge         = 3,
+    .teenEnergy      = 3,
+    .teenHappiness   = 4,
+    .adultAge        = 7,
+    .adultEnergy     = 2,
+    .adultHappiness  = 2,
+};
+
+TamagotchiPet TamagotchiPet_construct(const TamagotchiRules* rules_p)
+{
+    TamagotchiPet pet;
+
+    pet.stage = CHILD;
+    pet.age = 0;
+    pet.energy = rules_p->startEnergy;
+    pet.happiness = rules_p->startHappiness;
+    pet.spot = 0;
+    pet.movements = 0;
+    pet.waitToPass = 0;
+
+    return pet;
+}
+
+int TamagotchiPet_decay(TamagotchiPet* pet_p, const TamagotchiRules* rules_p)
+{
+    int changed = PET_AGE_CHANGED;
+
+    if (pet_p->energy > 0) {
+        pet_p->energy--;
+        changed |= PET_ENERGY_CHANGED;
+    }
+    if (pet_p->happiness > 0) {
+        pet_p->happiness--;
+        changed |= PET_HAPPINESS_CHANGED;
+    }
+    pet_p->age++;
+
+    return changed;
+}
+
+int TamagotchiPet_feed(TamagotchiPet* pet_p, const TamagotchiRules* rules_p)
+{
+    if (pet_p->energy >= rules_p->maxEnergy)
+        return 0;
+
+    pet_p->energy++;
+    return PET_ENERGY_CHANGED;
+}
+
+int TamagotchiPet_move(TamagotchiPet* pet_p, const TamagotchiRules* rules_p, int direction)
+{
+    // A tired pet does not move, and it cannot leave its spotLimit
+    int spot = pet_p->spot + direction;
+    if (pet_p->energy <= 0 || spot > rules_p->spotLimit || spot < -rules_p->spotLimit)
+        return 0;
+
+    int changed = PET_SPOT_CHANGED;
+    pet_p->spot = spot;
+    pet_p->movements++;
+
+    if (pet_p->happiness < rules_p->maxHappiness) {
+        pet_p->happiness++;
+        changed |= PET_HAPPINESS_CHANGED;
+    }
+    if (pet_p->movements % rules_p->moveEnergyEvery == 0) {
+        pet_p->energy--;
+        changed |= PET_ENERGY_CHANGED;
+    }
+
+    return changed;
+}
+
+bool TamagotchiPet_grow(TamagotchiPet* pet_p, const TamagotchiRules* rules_p)
+{
+    switch (pet_p->stage)
+    {
+        case CHILD:
+            if (pet_p->age >= rules_p->teenAge && pet_p->energy >= rules_p->teenEnergy &&
+                pet_p->happiness >= rules_p->teenHappiness) {
+                pet_p->waitToPass = pet_p->age + 1;
+                pet_p->stage = TEEN;
+                return true;
+            }
+            break;
+
+        case TEEN:
+            if (pet_p->age >= rules_p->adultAge && pet_p->energy >= rules_p->adultEnergy &&
+                pet_p->happiness >= rules_p->adultHappiness && pet_p->age > pet_p->waitToPass) {
+                pet_p->stage = ADULT;
+                pet_p->waitToPass = 0;
+                return true;
+            }
+            break;
+
+        case ADULT:
+            break;
+    }
+
+    return false;
+}
+
+bool TamagotchiPet_isGone(const TamagotchiPet* pet_p)
+{
+    return pet_p->energy == 0 && pet_p->happiness == 0;
+}
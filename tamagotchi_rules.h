@@ -0,0 +1,89 @@
+/*
+ * tamagotchi_rules.h
+ *
+ * The game rules of the Tamagotchi, kept apart from the screens so they can be run without
+ * the board. Every number that sets the balance of the game lives in TamagotchiRules; the
+ * firmware plays with Tamagotchi_defaultRules and host tools can try other values.
+ */
+
+#ifndef TAMAGOTCHI_RULES_H_
+#define TAMAGOTCHI_RULES_H_
+
+#include <stdbool.h>
+
+#define DECREASE_INT        3000  // 3 seconds
+
+enum _GameSpot
+{
+    CHILD, TEEN, ADULT
+};
+typedef enum _GameSpot GameSpot;
+
+/**
+ * The balance of the game. A pet loses one energy and one happiness every decayInterval and
+ * ages by one. Feeding gives one energy, a move gives one happiness and every
+ * moveEnergyEvery-th move costs one energy. A pet grows up once its age, energy and happiness
+ * all reach the thresholds of the next stage, and leaves when energy and happiness are both 0.
+ */
+struct _TamagotchiRules
+{
+    int decayInterval;      // ms between two decreases
+    int startEnergy;
+    int startHappiness;
+    int maxEnergy;
+    int maxHappiness;
+    int moveEnergyEvery;
+    int spotLimit;          // How many moves the pet can go left or right of the middle
+    int teenAge;
+    int teenEnergy;
+    int teenHappiness;
+    int adultAge;
+    int adultEnergy;
+    int adultHappiness;
+};
+typedef struct _TamagotchiRules TamagotchiRules;
+
+// The rules the game ships with
+extern const TamagotchiRules Tamagotchi_defaultRules;
+
+/**
+ * The state of one pet. Nothing in here refers to the screen; the functions acting on it
+ * return which of the values they changed so the caller can redraw only those.
+ */
+struct _TamagotchiPet
+{
+    GameSpot stage;
+    int age;
+    int energy;
+    int happiness;
+    int spot;          // Position, from -spotLimit to spotLimit
+    int movements;     // Total movements
+    int waitToPass;    // Age a teen has to exceed before it can become an adult
+};
+typedef struct _TamagotchiPet TamagotchiPet;
+
+// The values TamagotchiPet functions report as changed
+#define PET_AGE_CHANGED         0x01
+#define PET_ENERGY_CHANGED      0x02
+#define PET_HAPPINESS_CHANGED   0x04
+#define PET_SPOT_CHANGED        0x08
+
+// Constructs a newborn pet
+TamagotchiPet TamagotchiPet_construct(const TamagotchiRules* rules_p);
+
+// One decay interval has passed
+int TamagotchiPet_decay(TamagotchiPet* pet_p, const TamagotchiRules* rules_p);
+
+// The player fed the pet
+int TamagotchiPet_feed(TamagotchiPet* pet_p, const TamagotchiRules* rules_p);
+
+// The player moved the pet one spot to the right (direction 1) or to the left (direction -1)
+int TamagotchiPet_move(TamagotchiPet* pet_p, const TamagotchiRules* rules_p, int direction);
+
+// Moves the pet to its next stage if it qualifies. Returns true if it did.
+bool TamagotchiPet_grow(TamagotchiPet* pet_p, const TamagotchiRules* rules_p);
+
+// Returns true once the pet has left, which ends the game
+bool TamagotchiPet_isGone(const TamagotchiPet* pet_p);
+
+#endif /* TAMAGOTCHI_RULES_H_ */